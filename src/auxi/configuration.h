@@ -30,6 +30,16 @@
   * @brief Constant declaring maximum AK_free space in block
 */
 #define MAX_FREE_SPACE_SIZE (iniparser_getint(AK_config,"blocks:max_AK_free_space_size",4000))
+/**
+  * @def BLOCK_COMPACTION_THRESHOLD
+  * @brief Constant declaring percentage of used data space in block that can be held by deleted values before the block is compacted
+*/
+#define BLOCK_COMPACTION_THRESHOLD (iniparser_getint(AK_config,"blocks:compaction_threshold",25))
+/**
+  * @def VACUUM_IO_BUDGET
+  * @brief Constant declaring maximum number of blocks one step of segment vacuum may read or write
+*/
+#define VACUUM_IO_BUDGET (iniparser_getint(AK_config,"blocks:vacuum_io_budget",32))
 /**
   * @def MAX_LAST_TUPLE_DICT_SIZE_TO_USE
   * @brief Constant declaring maximum size od last tuple in dictionary
@@ -50,6 +60,11 @@
   * @brief Constant declaring initial extent size in blocks
  */
 #define INITIAL_EXTENT_SIZE (iniparser_getint(AK_config,"extents:initial_extent_size",15))
+/**
+  * @def INITIAL_EXTENT_SIZE_TEMP
+  * @brief Constant declaring initial extent size of temporary segments in blocks
+ */
+#define INITIAL_EXTENT_SIZE_TEMP (iniparser_getint(AK_config,"extents:initial_extent_size_temp",1))
 /**
   * @def EXTENT_GROWTH_TABLE
   * @brief Constant declaring extent growth factor for tables
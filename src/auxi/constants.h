@@ -289,6 +289,10 @@
 #define RO_INTERSECT 'i'
 #define RO_EXCEPT 'e'
 #define RO_THETA_JOIN 't'
+#define RO_SORT 'o'
+#define RO_LIMIT 'l'
+#define RO_TOP_K 'k'
+#define RO_MERGE_JOIN 'm'
 /**
   * @def NEW_VALUE
   * @brief Constant indicating that data is new value
@@ -174,7 +174,13 @@ void AK_debmod_enter_critical_sec(AK_debmod_state* ds){
 #ifdef __linux__
     pthread_mutex_lock(&AK_debmod_critical_section);
 #endif
+#ifdef __linux__
+    /* wait loop, the thread holding ds may be waiting for this processor */
+    while (ds->ready != 1)
+        sched_yield();
+#else
     while (ds->ready != 1); /* wait loop */
+#endif
     ds->ready = 0;
 #ifdef _WIN32
     LeaveCriticalSection(&ds->critical_section);
@@ -45,6 +45,7 @@ memory wrappers and debug mode of Kalashnikov DB.
 #ifdef __linux__
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
 #include <sys/mman.h>
 #endif
@@ -141,8 +141,9 @@ int * AK_get_allocation_set(int* bitsetbs, int fromWhere, int gaplength, int num
 
         k = 1;
         for (; i < numAK_free - num + 1; i++){
-            for (j = i; j<i + num; j++)
-            if (((AK_freebe[j + 1] - AK_freebe[j]) == 1) || ((j>0) && ((AK_freebe[j - 1] + 1) == AK_freebe[j]) && ((j - i + 1) == num))){
+            //every block of the set but the last one has to be followed by the next free block (a set of one block is always a sequence)
+            for (j = i; j<i + num - 1; j++)
+            if ((AK_freebe[j + 1] - AK_freebe[j]) == 1){
 
                 continue;
             }
@@ -731,6 +732,8 @@ AK_block *  AK_init_block(){
     block->chained_with = NOT_CHAINED;
     block->AK_free_space = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE * sizeof (int);
     block->last_tuple_dict_id = 0;
+    block->free_slot = FREE_INT;
+    block->deleted_space = 0;
     AK_EPI;
     return block;
 }
@@ -1237,6 +1240,8 @@ int AK_copy_header(AK_header *header, int * blocknum, int num)
         block->type = BLOCK_TYPE_NORMAL;
         block->AK_free_space = 0;
         block->last_tuple_dict_id = 0;
+        block->free_slot = FREE_INT;
+        block->deleted_space = 0;
 
         /// if write of block succeded increase var num_blocks, else nothing
         if (AK_write_block(block) == EXIT_SUCCESS) {
@@ -1420,9 +1425,9 @@ int AK_new_extent(int start_address, int old_size, int extent_type, AK_header *h
     int firstAddress = 0;
     int * blocknum;
     AK_PRO;
-    /// if the old_size is 0 then the size of new extent is INITIAL_EXTENT_SIZE
+    /// if the old_size is 0 then the size of new extent is INITIAL_EXTENT_SIZE (INITIAL_EXTENT_SIZE_TEMP for temporary segments)
     if (old_size == 0) {
-        req_AK_free_space = INITIAL_EXTENT_SIZE;
+        req_AK_free_space = extent_type == SEGMENT_TYPE_TEMP ? INITIAL_EXTENT_SIZE_TEMP : INITIAL_EXTENT_SIZE;
     }
     else {
         float RESIZE_FACTOR = 0;
@@ -1669,6 +1674,8 @@ int AK_init_system_tables_catalog(int relation, int attribute, int index, int vi
     catalog_block->type = BLOCK_TYPE_NORMAL;
     catalog_block->chained_with = NOT_CHAINED;
     catalog_block->AK_free_space = 0; ///using as an address for the first AK_free space in block->data
+    catalog_block->free_slot = FREE_INT;
+    catalog_block->deleted_space = 0;
 
 
     /// merge catalog_heder with heders created before
@@ -2430,6 +2437,8 @@ int AK_delete_block(int address) {
     block->type = BLOCK_TYPE_FREE;
     block->chained_with = NOT_CHAINED;
     block->AK_free_space = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE * sizeof (int);
+    block->free_slot = FREE_INT;
+    block->deleted_space = 0;
     memcpy(block->header, head, sizeof (*head));
     memcpy(block->tuple_dict, tuple_dict, sizeof (*tuple_dict));
     memcpy(block->data, data, sizeof (*data));
@@ -2465,6 +2474,7 @@ int AK_delete_extent(int begin, int end) {
         }
         AK_allocationbit->allocationtable[address] = 0xFFFFFFFF;
     }
+    AK_zone_map_release_extent(begin, end + 1);
     AK_EPI;
     return (EXIT_SUCCESS);
 }
@@ -2480,13 +2490,16 @@ int AK_delete_segment(char * name, int type) {
     table_addresses *addresses;
     AK_PRO;
     addresses = (table_addresses*)AK_get_segment_addresses(name);
-    while (addresses->address_from[i] != 0) {
-        if (AK_delete_extent(addresses->address_from[i], addresses->address_to[i]) == EXIT_ERROR){
+    while (i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0) {
+        //end address in the system catalog is the first block after the extent
+        if (AK_delete_extent(addresses->address_from[i], addresses->address_to[i] - 1) == EXIT_ERROR){
+            AK_free(addresses);
             AK_EPI;
             return EXIT_ERROR;
         }
         i++;
     }
+    AK_free(addresses);
 	
 	struct list_node * row_root = (struct list_node*) AK_malloc(sizeof(struct list_node));
     Ak_Init_L3(&row_root);
@@ -2506,10 +2519,8 @@ int AK_delete_segment(char * name, int type) {
         return EXIT_ERROR;
         break;
     case SEGMENT_TYPE_TEMP:
-        //TO-DO
-        printf("Not implemented yet!\n");
-        AK_EPI;
-        return EXIT_ERROR;
+        //temporary segments are registered in AK_relation like tables (see AK_initialize_new_segment)
+        system_table = "AK_relation";
         break;
     default:
         AK_EPI;
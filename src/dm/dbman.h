@@ -95,6 +95,10 @@ typedef struct {
     /// AK_free space in block
     int AK_free_space;
     int last_tuple_dict_id;
+    /// first tuple_dict index of a deleted row, deleted rows are chained through address of their first entry; FREE_INT if there is none
+    int free_slot;
+    /// bytes of data held by deleted or replaced values (reclaimed by compaction)
+    int deleted_space;
     /// attribute definitions
     AK_header header[MAX_ATTRIBUTES];
     /// dictionary of data entries
@@ -268,6 +272,10 @@ int AK_init_system_catalog();
 int AK_delete_block(int address);
 int AK_delete_extent(int begin, int end);
 int AK_delete_segment(char * name, int type);
+/* defined in memoman.c, declared here because AK_delete_segment uses the returned pointer */
+table_addresses *AK_get_segment_addresses(char * segmentName);
+/* defined in zonemap.c, declared here because zone maps must not keep blocks released by AK_delete_extent */
+void AK_zone_map_release_extent(int begin, int end);
 int AK_init_disk_manager();
 
 #endif
@@ -0,0 +1,774 @@
+/**
+@file bulkload.c Provides functions for bulk loading of tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "bulkload.h"
+#include "zonemap.h"
+#include "idx/bitmap.h"
+#include "idx/hash.h"
+
+/**
+ * @brief Function hashes a key of a reference (FNV-1a over its stored bytes)
+ * @param key key stored like a row of a scan
+ * @param size size of the key
+ * @return hash of the key
+ */
+static unsigned int AK_bulk_key_hash(const char *key, int size) {
+    unsigned int hash = 2166136261u;
+    int i;
+    for (i = 0; i < size; i++) {
+        hash ^= (unsigned char) key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Function returns the size of a key stored like a row of a scan
+ * @param key key
+ * @return size of the key
+ */
+static int AK_bulk_key_size(const char *key) {
+    int num_values, size, offset = sizeof (int), i;
+    memcpy(&num_values, key, sizeof (int));
+    for (i = 0; i < num_values; i++) {
+        memcpy(&size, key + offset + 2 * sizeof (int), sizeof (int));
+        offset += 3 * sizeof (int) + size;
+    }
+    return offset;
+}
+
+/**
+ * @brief Function copies referenced values of all rows of a block, called by scan workers
+ * @param block block read by the worker
+ * @param context reference (AK_bulk_reference)
+ * @param result keys copied by the worker (AK_scan_rows)
+ * @return EXIT_SUCCESS
+ */
+static int AK_bulk_key_block(AK_block *block, void *context, void *result) {
+    AK_bulk_reference *reference = (AK_bulk_reference *) context;
+    int num_attr = reference->parent_attr, slot;
+
+    for (slot = 0; slot + num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[slot].type != FREE_INT; slot += num_attr) {
+        if (block->tuple_dict[slot].type != 0)
+            AK_scan_rows_add((AK_scan_rows *) result, block, slot, reference->parent_columns, reference->num_attr);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function reads keys of the parent table of a reference with a pool of scan workers and puts them in a hash set
+ * @param reference reference with attribute indexes set
+ * @param parent parent table name
+ * @param parent_attr number of attributes of the parent table
+ * @return No return value
+ */
+static void AK_bulk_read_keys(AK_bulk_reference *reference, char *parent, int parent_attr) {
+    AK_scan_rows rows[SCAN_MAX_WORKERS];
+    int num_workers, num_buckets = 16, offset, i, n;
+    unsigned int hash;
+    AK_PRO;
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(parent);
+    memset(rows, 0, sizeof (rows));
+    reference->parent_attr = parent_attr;
+    num_workers = AK_scan_parallel(addresses, NULL, NULL, AK_bulk_key_block, reference, rows, sizeof (AK_scan_rows));
+    AK_free(addresses);
+
+    //keys of workers are joined in one buffer
+    memset(&reference->keys, 0, sizeof (AK_scan_rows));
+    for (i = 0; i < num_workers; i++) {
+        reference->keys.size += rows[i].size;
+        reference->keys.num_rows += rows[i].num_rows;
+    }
+    reference->keys.capacity = reference->keys.size;
+    reference->keys.data = (char *) AK_malloc(reference->keys.size + 1);
+    for (i = offset = 0; i < num_workers; i++) {
+        if (rows[i].size > 0)
+            memcpy(reference->keys.data + offset, rows[i].data, rows[i].size);
+        offset += rows[i].size;
+        AK_scan_rows_free(&rows[i]);
+    }
+
+    while (num_buckets < 2 * reference->keys.num_rows)
+        num_buckets *= 2;
+    reference->mask = num_buckets - 1;
+    reference->buckets = (int *) AK_malloc(num_buckets * sizeof (int));
+    reference->offsets = (int *) AK_malloc((reference->keys.num_rows + 1) * sizeof (int));
+    reference->chain = (int *) AK_malloc((reference->keys.num_rows + 1) * sizeof (int));
+    memset(reference->buckets, -1, num_buckets * sizeof (int));
+    for (n = offset = 0; n < reference->keys.num_rows; n++) {
+        int size = AK_bulk_key_size(reference->keys.data + offset);
+        hash = AK_bulk_key_hash(reference->keys.data + offset, size) & reference->mask;
+        reference->offsets[n] = offset;
+        reference->chain[n] = reference->buckets[hash];
+        reference->buckets[hash] = n;
+        offset += size;
+    }
+    Ak_dbg_messg(MIDDLE, FILE_MAN, "bulk_read_keys: %d keys of %s\n", reference->keys.num_rows, parent);
+    AK_EPI;
+}
+
+/**
+ * @brief Function reads references of a table when a load begins. Keys of every parent table are read once, so
+          constraints are checked for the whole load with one scan of each parent table.
+ * @param loader bulk loader with table and header set
+ * @return No return value
+ */
+static void AK_bulk_read_references(AK_bulk_loader *loader) {
+    char constraints[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+    struct list_node *row;
+    AK_ref_item item;
+    AK_header *parent_header;
+    int num_constraints = 0, parent_attr, i = 0, j, k;
+    AK_PRO;
+    while ((row = AK_get_row(i, "AK_reference")) != NULL) {
+        if (strcmp(row->next->data, loader->table) == 0) {
+            for (j = 0; j < num_constraints && strcmp(constraints[j], row->next->next->data) != 0; j++)
+                ;
+            if (j == num_constraints && num_constraints < MAX_ATTRIBUTES)
+                strcpy(constraints[num_constraints++], row->next->next->data);
+        }
+        Ak_DeleteAll_L3(&row);
+        AK_free(row);
+        i++;
+    }
+    if (num_constraints == 0) {
+        AK_EPI;
+        return;
+    }
+
+    loader->references = (AK_bulk_reference *) AK_calloc(num_constraints, sizeof (AK_bulk_reference));
+    for (i = 0; i < num_constraints; i++) {
+        AK_bulk_reference *reference = &loader->references[loader->num_references];
+        item = AK_get_reference(loader->table, constraints[i]);
+        parent_header = (AK_header *) AK_get_header(item.parent);
+        parent_attr = AK_num_attr(item.parent);
+        reference->num_attr = item.attributes_number;
+        for (j = 0; j < item.attributes_number; j++) {
+            for (k = 0; k < loader->num_attr && strcmp(loader->header[k].att_name, item.attributes[j]) != 0; k++)
+                ;
+            reference->columns[j] = k < loader->num_attr ? k : EXIT_ERROR;
+            for (k = 0; k < parent_attr && strcmp(parent_header[k].att_name, item.parent_attributes[j]) != 0; k++)
+                ;
+            reference->parent_columns[j] = k < parent_attr ? k : EXIT_ERROR;
+            if (reference->columns[j] == EXIT_ERROR || reference->parent_columns[j] == EXIT_ERROR)
+                reference->num_attr = 0;
+        }
+        AK_free(parent_header);
+        if (reference->num_attr == 0) {
+            printf("AK_bulk_begin: Reference %s of table %s can not be checked\n", constraints[i], loader->table);
+            continue;
+        }
+        AK_bulk_read_keys(reference, item.parent, parent_attr);
+        loader->num_references++;
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks a row against keys of parent tables of all references. A reference with a null value in
+          any of its attributes is satisfied, as in SQL.
+ * @param loader bulk loader
+ * @param type array of value types
+ * @param data array of values
+ * @param size array of value sizes
+ * @param null array with 1 for every null value
+ * @return EXIT_SUCCESS if the row satisfies all references, EXIT_ERROR otherwise
+ */
+static int AK_bulk_check_references(AK_bulk_loader *loader, int *type, char **data, int *size, int *null) {
+    char key[sizeof (int) + MAX_REFERENCE_ATTRIBUTES * (3 * sizeof (int) + MAX_VARCHAR_LENGTH)];
+    int i, j, n, key_size, column;
+    AK_PRO;
+    for (i = 0; i < loader->num_references; i++) {
+        AK_bulk_reference *reference = &loader->references[i];
+        memcpy(key, &reference->num_attr, sizeof (int));
+        key_size = sizeof (int);
+        for (j = 0; j < reference->num_attr; j++) {
+            column = reference->columns[j];
+            if (null[column] || size[column] > MAX_VARCHAR_LENGTH)
+                break;
+            memcpy(key + key_size, &reference->parent_columns[j], sizeof (int));
+            memcpy(key + key_size + sizeof (int), &type[column], sizeof (int));
+            memcpy(key + key_size + 2 * sizeof (int), &size[column], sizeof (int));
+            memcpy(key + key_size + 3 * sizeof (int), data[column], size[column]);
+            key_size += 3 * sizeof (int) + size[column];
+        }
+        if (j < reference->num_attr)
+            continue;
+
+        n = reference->buckets[AK_bulk_key_hash(key, key_size) & reference->mask];
+        while (n != -1 && (AK_bulk_key_size(reference->keys.data + reference->offsets[n]) != key_size
+                || memcmp(reference->keys.data + reference->offsets[n], key, key_size) != 0))
+            n = reference->chain[n];
+        if (n == -1) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function builds indexes of a loaded table again. Rows of a load are written to blocks directly, so index
+          builds are deferred to the end of the load: every bitmap index (table + attribute + "_bmapIndex") and every
+          hash index registered for the table is dropped and built once over all rows.
+ * @param loader bulk loader
+ * @return No return value
+ */
+static void AK_bulk_build_indexes(AK_bulk_loader *loader) {
+    char index_name[2 * MAX_ATT_NAME + 11], hash_names[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+    struct list_node *row, *attributes;
+    AK_header *index_header;
+    table_addresses *addresses;
+    int num_hash = 0, i = 0, j, num_index_attr, exists;
+    AK_PRO;
+    for (j = 0; j < loader->num_attr; j++) {
+        snprintf(index_name, sizeof (index_name), "%s%s_bmapIndex", loader->table, loader->header[j].att_name);
+        addresses = (table_addresses *) AK_get_index_addresses(index_name);
+        exists = addresses->address_from[0] != 0;
+        AK_free(addresses);
+        if (!exists)
+            continue;
+        attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        Ak_Init_L3(&attributes);
+        Ak_Insert_New_Element(TYPE_VARCHAR, loader->header[j].att_name, loader->table, loader->header[j].att_name, attributes);
+        AK_delete_bitmap_index(index_name);
+        AK_create_Index_Table(loader->table, attributes);
+        Ak_DeleteAll_L3(&attributes);
+        AK_free(attributes);
+    }
+
+    //hash indexes keep the table name in table_id of AK_index and indexed attributes in their header
+    while ((row = AK_get_row(i++, "AK_index")) != NULL) {
+        struct list_node *table_id = Ak_GetNth_L2(5, row);
+        if (num_hash < MAX_ATTRIBUTES && table_id != NULL && table_id->type == TYPE_VARCHAR && strcmp(table_id->data, loader->table) == 0)
+            strcpy(hash_names[num_hash++], Ak_GetNth_L2(2, row)->data);
+        Ak_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    for (i = 0; i < num_hash; i++) {
+        if ((index_header = AK_get_index_header(hash_names[i])) == NULL)
+            continue;
+        num_index_attr = AK_num_index_attr(hash_names[i]);
+        attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        Ak_Init_L3(&attributes);
+        for (j = 0; j < num_index_attr; j++)
+            Ak_InsertAtEnd_L3(TYPE_VARCHAR, index_header[j].att_name, strlen(index_header[j].att_name), attributes);
+        AK_free(index_header);
+        AK_delete_hash_index(hash_names[i]);
+        AK_create_hash_index(loader->table, attributes, hash_names[i]);
+        Ak_DeleteAll_L3(&attributes);
+        AK_free(attributes);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function writes the current block to disk. A cached copy of the block is refreshed so that cache and disk
+          stay the same.
+ * @param loader bulk loader
+ * @return No return value
+ */
+static void AK_bulk_release_block(AK_bulk_loader *loader) {
+    AK_mem_block *cached;
+    AK_PRO;
+    if (loader->temp_block != NULL) {
+        AK_write_block(loader->temp_block);
+        cached = AK_get_cached_block(loader->block);
+        if (cached != NULL) {
+            memcpy(cached->block, loader->temp_block, sizeof (AK_block));
+            AK_mem_block_modify(cached, BLOCK_CLEAN);
+        }
+        AK_zone_map_update_block(loader->temp_block);
+        AK_free(loader->temp_block);
+        loader->temp_block = NULL;
+        loader->blocks_written++;
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function makes a block current. The block is copied from cache if it is there (it may be dirty), otherwise it
+          is read from disk. The first AK_free tuple_dict entry is searched only once per block.
+ * @param loader bulk loader
+ * @param address block address
+ * @return No return value
+ */
+static void AK_bulk_open_block(AK_bulk_loader *loader, int address) {
+    AK_mem_block *cached;
+    AK_PRO;
+    loader->block = address;
+    cached = AK_get_cached_block(address);
+    if (cached != NULL) {
+        loader->temp_block = (AK_block *) AK_malloc(sizeof (AK_block));
+        memcpy(loader->temp_block, cached->block, sizeof (AK_block));
+    } else {
+        loader->temp_block = (AK_block *) AK_read_block(address);
+    }
+    loader->next_slot = 0;
+    while (loader->next_slot < DATA_BLOCK_SIZE && loader->temp_block->tuple_dict[loader->next_slot].size != FREE_INT)
+        loader->next_slot++;
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks whether a row fits in the current block
+ * @param loader bulk loader
+ * @param row_size size of row data
+ * @return 1 if row fits, 0 otherwise
+ */
+static int AK_bulk_row_fits(AK_bulk_loader *loader, int row_size) {
+    AK_PRO;
+    int fits = loader->temp_block != NULL
+            && loader->next_slot + loader->num_attr <= DATA_BLOCK_SIZE
+            && loader->temp_block->AK_free_space + row_size <= DATA_BLOCK_SIZE * DATA_ENTRY_SIZE;
+    AK_EPI;
+    return fits;
+}
+
+/**
+ * @brief Function moves the loader to the next block that can hold a row. Blocks of existing extents are used in
+          order; when they run out, one extent big enough for the remaining rows is allocated.
+ * @param loader bulk loader
+ * @param row_size size of row data
+ * @param rows_left number of rows that are still to be loaded (estimate)
+ * @return EXIT_SUCCESS if success, EXIT_ERROR if no extent could be allocated
+ */
+static int AK_bulk_next_block(AK_bulk_loader *loader, int row_size, int rows_left) {
+    int next, start_address, rows_per_block, i;
+    AK_PRO;
+    do {
+        next = loader->block ? loader->block + 1 : 0;
+        AK_bulk_release_block(loader);
+
+        if (next != 0 && next < loader->addresses->address_to[loader->extent]) {
+            AK_bulk_open_block(loader, next);
+        } else if (next != 0 && loader->extent + 1 < MAX_EXTENTS_IN_SEGMENT && loader->addresses->address_from[loader->extent + 1] != 0) {
+            loader->extent++;
+            AK_bulk_open_block(loader, loader->addresses->address_from[loader->extent]);
+        } else {
+            rows_per_block = DATA_BLOCK_SIZE / loader->num_attr;
+            if (row_size > 0 && DATA_BLOCK_SIZE * DATA_ENTRY_SIZE / row_size < rows_per_block)
+                rows_per_block = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE / row_size;
+            start_address = AK_init_new_extent_size(loader->table, SEGMENT_TYPE_TABLE, rows_left / rows_per_block + 1);
+            if (start_address == EXIT_ERROR) {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            Ak_dbg_messg(MIDDLE, FILE_MAN, "bulk_next_block: new extent for %s at %d\n", loader->table, start_address);
+
+            AK_free(loader->addresses);
+            loader->addresses = (table_addresses *) AK_get_table_addresses(loader->table);
+            for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && loader->addresses->address_from[i] != start_address; i++);
+            if (i == MAX_EXTENTS_IN_SEGMENT) {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            loader->extent = i;
+            AK_zone_map_get(loader->table);
+            AK_bulk_open_block(loader, start_address);
+        }
+    } while (!AK_bulk_row_fits(loader, row_size));
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function starts a bulk load into a table. Loading continues at the first block of the table that has AK_free
+          space.
+ * @param loader bulk loader to initialize
+ * @param table table name
+ * @return EXIT_SUCCESS if success, EXIT_ERROR if table does not exist
+ */
+int AK_bulk_begin(AK_bulk_loader *loader, char *table) {
+    int address, i;
+    AK_PRO;
+    memset(loader, 0, sizeof (AK_bulk_loader));
+    strncpy(loader->table, table, MAX_ATT_NAME - 1);
+
+    loader->addresses = (table_addresses *) AK_get_table_addresses(table);
+    if (loader->addresses->address_from[0] == 0) {
+        printf("AK_bulk_begin: Table %s does not exist\n", table);
+        AK_free(loader->addresses);
+        loader->addresses = NULL;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(loader->addresses->address_from[0]);
+    while (loader->num_attr < MAX_ATTRIBUTES && strcmp(mem_block->block->header[loader->num_attr].att_name, "\0") != 0) {
+        memcpy(&loader->header[loader->num_attr], &mem_block->block->header[loader->num_attr], sizeof (AK_header));
+        loader->num_attr++;
+    }
+    AK_bulk_read_references(loader);
+    //zone maps and Bloom filters of written blocks are built as they are released
+    AK_zone_map_get(table);
+
+    address = AK_find_AK_free_space(loader->addresses);
+    for (i = 0; address > 0 && i < MAX_EXTENTS_IN_SEGMENT && loader->addresses->address_from[i] != 0; i++) {
+        if (address >= loader->addresses->address_from[i] && address < loader->addresses->address_to[i]) {
+            loader->extent = i;
+            AK_bulk_open_block(loader, address);
+            break;
+        }
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function appends one row to the current block. Values are given in table attribute order; a NULL value is
+          stored the same way as in Ak_insert_row_to_block. If the table has references, the row is checked against
+          keys of their parent tables read by AK_bulk_begin.
+ * @param loader bulk loader
+ * @param type array of value types
+ * @param data array of values, NULL for null value
+ * @param size array of value sizes
+ * @param rows_left number of rows that are still to be loaded including this one (used to size new extents)
+ * @return EXIT_SUCCESS if row is loaded, EXIT_ERROR if it is rejected
+ */
+int AK_bulk_add_row(AK_bulk_loader *loader, int *type, char **data, int *size, int rows_left) {
+    int null[MAX_ATTRIBUTES];
+    int i, row_size = 0;
+    AK_PRO;
+    for (i = 0; i < loader->num_attr; i++) {
+        null[i] = data[i] == NULL;
+        if (data[i] == NULL) {
+            type[i] = TYPE_VARCHAR;
+            data[i] = "null";
+            size[i] = strlen("null");
+        }
+        row_size += size[i];
+    }
+    if (row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE) {
+        loader->rows_rejected++;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (loader->num_references > 0 && AK_bulk_check_references(loader, type, data, size, null) == EXIT_ERROR) {
+        loader->rows_rejected++;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (!AK_bulk_row_fits(loader, row_size) && AK_bulk_next_block(loader, row_size, rows_left) == EXIT_ERROR) {
+        loader->rows_rejected++;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_block *temp_block = loader->temp_block;
+    for (i = 0; i < loader->num_attr; i++) {
+        AK_tuple_dict *tuple_dict = &temp_block->tuple_dict[loader->next_slot + i];
+        memcpy(temp_block->data + temp_block->AK_free_space, data[i], size[i]);
+        tuple_dict->type = type[i];
+        tuple_dict->address = temp_block->AK_free_space;
+        tuple_dict->size = size[i];
+        temp_block->AK_free_space += size[i];
+    }
+    loader->next_slot += loader->num_attr;
+    temp_block->last_tuple_dict_id = loader->next_slot - 1;
+    loader->rows_loaded++;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function finishes a bulk load. The last block is written, indexes of the table are built again if rows were
+          loaded and loader memory is released.
+ * @param loader bulk loader
+ * @return number of loaded rows
+ */
+int AK_bulk_end(AK_bulk_loader *loader) {
+    int i;
+    AK_PRO;
+    AK_bulk_release_block(loader);
+    if (loader->addresses != NULL) {
+        AK_free(loader->addresses);
+        loader->addresses = NULL;
+    }
+    for (i = 0; i < loader->num_references; i++) {
+        AK_scan_rows_free(&loader->references[i].keys);
+        AK_free(loader->references[i].offsets);
+        AK_free(loader->references[i].chain);
+        AK_free(loader->references[i].buckets);
+    }
+    if (loader->references != NULL) {
+        AK_free(loader->references);
+        loader->references = NULL;
+    }
+    loader->num_references = 0;
+    if (loader->rows_loaded > 0) {
+        AK_table_modified(loader->table);
+        AK_bulk_build_indexes(loader);
+    }
+    Ak_dbg_messg(LOW, FILE_MAN, "bulk_end: %s: %d rows loaded, %d rejected, %d blocks written\n", loader->table,
+            loader->rows_loaded, loader->rows_rejected, loader->blocks_written);
+    AK_EPI;
+    return loader->rows_loaded;
+}
+
+/**
+ * @brief Function inserts a batch of rows into a table. Every row is a list like the one given to Ak_insert_row;
+          values are matched to attributes by name, missing attributes are null. Indexes of the table are built once
+          at the end of the load.
+ * @param table table name
+ * @param rows array of rows
+ * @param num_rows number of rows
+ * @return number of inserted rows, EXIT_ERROR if table does not exist
+ */
+int AK_bulk_insert(char *table, struct list_node **rows, int num_rows) {
+    AK_bulk_loader loader;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    struct list_node *el;
+    int i, j;
+    AK_PRO;
+    if (AK_bulk_begin(&loader, table) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (i = 0; i < num_rows; i++) {
+        for (j = 0; j < loader.num_attr; j++) {
+            data[j] = NULL;
+            for (el = (struct list_node *) Ak_First_L2(rows[i]); el != NULL; el = (struct list_node *) Ak_Next_L2(el)) {
+                if (el->constraint == NEW_VALUE && strcmp(el->attribute_name, loader.header[j].att_name) == 0) {
+                    type[j] = el->type;
+                    data[j] = el->data;
+                    size[j] = AK_type_size(el->type, el->data);
+                    break;
+                }
+            }
+        }
+        AK_bulk_add_row(&loader, type, data, size, num_rows - i);
+    }
+
+    i = AK_bulk_end(&loader);
+    AK_EPI;
+    return i;
+}
+
+/**
+ * @brief Function converts one text field of a loaded file into attribute value
+ * @param type attribute type
+ * @param field text of the field
+ * @param value buffer for the value (at least MAX_VARCHAR_LENGTH bytes)
+ * @return size of value, EXIT_ERROR if field is null (empty or "null")
+ */
+static int AK_bulk_parse_field(int type, char *field, char *value) {
+    int int_value;
+    float float_value;
+    double double_value;
+    AK_PRO;
+    if (field[0] == '\0' || strcmp(field, "null") == 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    memset(value, '\0', MAX_VARCHAR_LENGTH);
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            int_value = atoi(field);
+            memcpy(value, &int_value, sizeof (int));
+            break;
+        case TYPE_FLOAT:
+            //floats are read as float, but take AK_type_size bytes like in Ak_insert_row
+            float_value = (float) atof(field);
+            memcpy(value, &float_value, sizeof (float));
+            break;
+        case TYPE_NUMBER:
+            double_value = atof(field);
+            memcpy(value, &double_value, sizeof (double));
+            break;
+        case TYPE_BOOL:
+            value[0] = (char) atoi(field);
+            break;
+        default:
+            strncpy(value, field, MAX_VARCHAR_LENGTH - 1);
+            AK_EPI;
+            return strlen(value);
+    }
+    AK_EPI;
+    return AK_type_size(type, value);
+}
+
+/**
+ * @brief Function loads a delimited text file (CSV) into a table. Every line is one row with fields in table attribute
+          order; an empty field or "null" is null. Quoting is not supported.
+ * @param table table name
+ * @param path path of the file
+ * @param delimiter field delimiter
+ * @param skip_header 1 if the first line holds column names
+ * @return number of loaded rows, EXIT_ERROR if file or table can not be opened
+ */
+int AK_bulk_load_file(char *table, char *path, char delimiter, int skip_header) {
+    AK_bulk_loader loader;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    char values[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+    char line[BULK_LINE_SIZE];
+    long file_size, line_bytes = 0;
+    int line_num = 0, rows_left, i;
+    AK_PRO;
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        printf("AK_bulk_load_file: Could not open file %s\n", path);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    fseek(fp, 0, SEEK_END);
+    file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (AK_bulk_begin(&loader, table) == EXIT_ERROR) {
+        fclose(fp);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    while (fgets(line, BULK_LINE_SIZE, fp) != NULL) {
+        line_bytes += strlen(line);
+        line_num++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if ((skip_header && line_num == 1) || line[0] == '\0')
+            continue;
+
+        char *field = line;
+        for (i = 0; i < loader.num_attr; i++) {
+            char *end = field != NULL ? strchr(field, delimiter) : NULL;
+            if (end != NULL)
+                *end = '\0';
+            type[i] = loader.header[i].type;
+            size[i] = field != NULL ? AK_bulk_parse_field(type[i], field, values[i]) : EXIT_ERROR;
+            data[i] = size[i] == EXIT_ERROR ? NULL : values[i];
+            field = end != NULL ? end + 1 : NULL;
+        }
+
+        //remaining rows are estimated from average line length so far
+        rows_left = (int) ((file_size - line_bytes) / (line_bytes / line_num + 1)) + 1;
+        if (AK_bulk_add_row(&loader, type, data, size, rows_left) == EXIT_ERROR)
+            Ak_dbg_messg(MIDDLE, FILE_MAN, "bulk_load_file: line %d rejected\n", line_num);
+    }
+    fclose(fp);
+
+    i = AK_bulk_end(&loader);
+    AK_EPI;
+    return i;
+}
+
+/**
+ * @brief Function for testing bulk load. A table is filled with a batch of rows and with a generated CSV file that
+          takes more than one extent, then rows of a table that references it are checked against its keys.
+ * @return No return value
+ */
+void AK_bulk_load_test() {
+    char *tblName = "bulk_student";
+    char *fileName = "bulk_student.csv";
+    AK_header t_header[MAX_ATTRIBUTES];
+    AK_header *temp;
+    struct list_node *rows[3];
+    int i, mbr, loaded;
+    AK_PRO;
+    printf("\n\nThis is bulk load test!\n");
+
+    memset(t_header, 0, sizeof (t_header));
+    temp = (AK_header *) AK_create_header("mbr", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header, temp, sizeof (AK_header));
+    temp = (AK_header *) AK_create_header("firstname", TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header + 1, temp, sizeof (AK_header));
+    temp = (AK_header *) AK_create_header("weight", TYPE_FLOAT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header + 2, temp, sizeof (AK_header));
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header);
+
+    char *names[] = {"Ana", "Ivan", "Marko"};
+    float weight = 70.5;
+    for (i = 0; i < 3; i++) {
+        mbr = i + 1;
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        Ak_Init_L3(&rows[i]);
+        Ak_Insert_New_Element(TYPE_INT, &mbr, tblName, "mbr", rows[i]);
+        Ak_Insert_New_Element(TYPE_VARCHAR, names[i], tblName, "firstname", rows[i]);
+        if (i != 1)
+            Ak_Insert_New_Element(TYPE_FLOAT, &weight, tblName, "weight", rows[i]);
+    }
+    loaded = AK_bulk_insert(tblName, rows, 3);
+    printf("Batch insert: %d rows loaded\n", loaded);
+    for (i = 0; i < 3; i++) {
+        Ak_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_print_table(tblName);
+
+    FILE *fp = fopen(fileName, "w");
+    fprintf(fp, "mbr;firstname;weight\n");
+    for (i = 4; i <= 5000; i++)
+        fprintf(fp, "%d;Student%d;%d.25\n", i, i, 50 + i % 40);
+    fclose(fp);
+
+    loaded = AK_bulk_load_file(tblName, fileName, ';', 1);
+    remove(fileName);
+    printf("File load: %d rows loaded\n", loaded);
+
+    int num_rec = AK_get_num_records(tblName);
+    struct list_node *last = AK_get_row(num_rec - 1, tblName);
+    printf("Table %s has %d rows, last row: %d %s %.2f\n", tblName, num_rec, *((int *) Ak_GetNth_L2(1, last)->data),
+            Ak_GetNth_L2(2, last)->data, *((float *) Ak_GetNth_L2(3, last)->data));
+    Ak_DeleteAll_L3(&last);
+    AK_free(last);
+
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        printf("Extent %d: blocks %d - %d\n", i, addresses->address_from[i], addresses->address_to[i]);
+    AK_free(addresses);
+
+    //rows of a referencing table are checked against keys of bulk_student read once
+    char *exam_name = "bulk_exam", *att[1] = {"mbr"}, *patt[1] = {"mbr"}, *data[2];
+    int type[2], size[2], grade, rejected;
+    AK_bulk_loader loader;
+    memset(t_header, 0, sizeof (t_header));
+    temp = (AK_header *) AK_create_header("mbr", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header, temp, sizeof (AK_header));
+    temp = (AK_header *) AK_create_header("grade", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header + 1, temp, sizeof (AK_header));
+    AK_initialize_new_segment(exam_name, SEGMENT_TYPE_TABLE, t_header);
+    AK_add_reference(exam_name, att, tblName, patt, 1, "bulk_exam_mbr", REF_TYPE_RESTRICT);
+
+    AK_bulk_begin(&loader, exam_name);
+    for (i = 0; i < 4; i++) {
+        //student 6000 does not exist, a null member is not checked
+        mbr = i == 2 ? 6000 : i * 1000 + 1;
+        grade = i + 2;
+        type[0] = type[1] = TYPE_INT;
+        data[0] = i == 3 ? NULL : (char *) &mbr;
+        data[1] = (char *) &grade;
+        size[0] = size[1] = sizeof (int);
+        AK_bulk_add_row(&loader, type, data, size, 4 - i);
+    }
+    rejected = loader.rows_rejected;
+    loaded = AK_bulk_end(&loader);
+    printf("Referencing load: %d rows loaded, %d rejected\n", loaded, rejected);
+
+    printf("bulk_load_test: %s\n", num_rec == 5000 && loaded == 3 && rejected == 1 ? "Present!" : "FAILED");
+    AK_EPI;
+}
@@ -0,0 +1,103 @@
+/**
+@file bulkload.h Header file that provides data structures and functions for bulk loading of tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef BULKLOAD
+#define BULKLOAD
+
+#include "../mm/memoman.h"
+#include "../sql/cs/reference.h"
+#include "table.h"
+#include "fileio.h"
+#include "scan.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def BULK_LINE_SIZE
+  * @brief Constant declaring maximal length of one line of a loaded file
+  */
+#define BULK_LINE_SIZE (MAX_ATTRIBUTES * (MAX_VARCHAR_LENGTH + 1) + 2)
+
+/**
+ * @struct AK_bulk_reference
+ * @brief Structure that holds keys of the parent table of one reference. Keys are read once when a load begins and
+          kept in a hash set, so rows are checked against the set instead of searching the parent table for every row.
+ */
+typedef struct {
+    /// indexes of referencing attributes in the loaded table
+    int columns[MAX_REFERENCE_ATTRIBUTES];
+    /// indexes of referenced attributes in the parent table
+    int parent_columns[MAX_REFERENCE_ATTRIBUTES];
+    /// number of attributes of the reference
+    int num_attr;
+    /// number of attributes of the parent table
+    int parent_attr;
+    /// keys of the parent table, stored like rows of a scan (see AK_scan_rows_add)
+    AK_scan_rows keys;
+    /// offset of every key in keys
+    int *offsets;
+    /// next key in the same bucket, -1 at the end of chain
+    int *chain;
+    /// first key of every bucket, -1 for empty bucket
+    int *buckets;
+    /// number of buckets minus one (number of buckets is a power of two)
+    unsigned int mask;
+} AK_bulk_reference;
+
+/**
+ * @struct AK_bulk_loader
+ * @brief Structure that holds state of one bulk load. Rows are appended to the current block, which is kept in memory
+          and written to disk when it is full.
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// number of attributes
+    int num_attr;
+    /// table header
+    AK_header header[MAX_ATTRIBUTES];
+    /// references of the table, every row is checked against keys of their parent tables
+    AK_bulk_reference *references;
+    /// number of references
+    int num_references;
+    /// extents of the table
+    table_addresses *addresses;
+    /// index of current extent in addresses
+    int extent;
+    /// address of current block, 0 if there is none
+    int block;
+    /// private copy of current block
+    AK_block *temp_block;
+    /// tuple_dict index for the next row
+    int next_slot;
+    /// number of loaded rows
+    int rows_loaded;
+    /// number of rejected rows
+    int rows_rejected;
+    /// number of written blocks
+    int blocks_written;
+} AK_bulk_loader;
+
+int AK_bulk_begin(AK_bulk_loader *loader, char *table);
+int AK_bulk_add_row(AK_bulk_loader *loader, int *type, char **data, int *size, int rows_left);
+int AK_bulk_end(AK_bulk_loader *loader);
+int AK_bulk_insert(char *table, struct list_node **rows, int num_rows);
+int AK_bulk_load_file(char *table, char *path, char delimiter, int skip_header);
+void AK_bulk_load_test();
+
+#endif
@@ -17,6 +17,10 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  17 */
 #include "fileio.h"
+#include "idx/bitmap.h"
+#include "tuple.h"
+#include "zonemap.h"
+#include "filesort.h"
 
 //START SPECIAL FUNCTIONS FOR WORK WITH row_element_structure
 
@@ -78,69 +82,343 @@ void Ak_Insert_New_Element(int newtype, void * data, char * table, char * attrib
 
 //END SPECIAL FUNCTIONS row_element_structure
 
+/**
+ * @struct AK_block_entry
+ * @brief Structure that holds address and tuple_dict index of one live value while a block is compacted
+ */
+typedef struct {
+    /// address of value in block->data
+    int address;
+    /// tuple_dict index of value
+    int index;
+} AK_block_entry;
+
+/**
+ * @brief Function compares two block entries by their address, used for sorting in AK_block_compact
+ * @param a first entry
+ * @param b second entry
+ * @return difference of addresses
+ */
+static int AK_block_entry_compare(const void *a, const void *b) {
+    return ((AK_block_entry *) a)->address - ((AK_block_entry *) b)->address;
+}
+
+/**
+ * @brief Function compacts data of a block. Live values are moved to the beginning of block->data in the order of their
+          addresses and holes left by deleted or replaced values are removed. Tuple dict indexes are not changed, so RIDs
+          stay valid.
+ * @param temp_block block to compact
+ * @return No return value
+ */
+void AK_block_compact(AK_block *temp_block) {
+    AK_block_entry *entries;
+    int i, num_entries = 0, address = 0;
+    AK_PRO;
+    entries = (AK_block_entry *) AK_malloc(DATA_BLOCK_SIZE * sizeof (AK_block_entry));
+    for (i = 0; i < DATA_BLOCK_SIZE; i++) {
+        if (temp_block->tuple_dict[i].size > 0) {
+            entries[num_entries].address = temp_block->tuple_dict[i].address;
+            entries[num_entries].index = i;
+            num_entries++;
+        }
+    }
+    qsort(entries, num_entries, sizeof (AK_block_entry), AK_block_entry_compare);
+
+    for (i = 0; i < num_entries; i++) {
+        AK_tuple_dict *tuple_dict = &temp_block->tuple_dict[entries[i].index];
+        if (tuple_dict->address != address)
+            memmove(temp_block->data + address, temp_block->data + tuple_dict->address, tuple_dict->size);
+        tuple_dict->address = address;
+        address += tuple_dict->size;
+    }
+    if (temp_block->AK_free_space > address)
+        memset(temp_block->data + address, FREE_CHAR, temp_block->AK_free_space - address);
+
+    Ak_dbg_messg(HIGH, FILE_MAN, "block_compact: block %d compacted from %d to %d bytes\n", temp_block->address, temp_block->AK_free_space, address);
+    temp_block->AK_free_space = address;
+    temp_block->deleted_space = 0;
+    AK_free(entries);
+    AK_EPI;
+}
+
+/**
+ * @brief Function returns tuple_dict index where a new row of the block can be written. A slot of a deleted row is taken
+          from the free slot list of the block if there is one, otherwise the first unused slot after the last row is
+          returned.
+ * @param temp_block block to insert to
+ * @param num_attr number of attributes of the row
+ * @return tuple_dict index of the first attribute of the row, EXIT_ERROR if there is no room in the block
+ */
+int AK_block_get_slot(AK_block *temp_block, int num_attr) {
+    int slot = temp_block->free_slot;
+    AK_PRO;
+    if (slot != FREE_INT) {
+        if (slot >= 0 && slot + num_attr <= DATA_BLOCK_SIZE && temp_block->tuple_dict[slot].type == 0
+                && temp_block->tuple_dict[slot].size == 0) {
+            temp_block->free_slot = temp_block->tuple_dict[slot].address;
+            temp_block->tuple_dict[slot].address = 0;
+            AK_EPI;
+            return slot;
+        }
+        //slot was overwritten by someone who does not know about the list, forget the rest of it
+        Ak_dbg_messg(HIGH, FILE_MAN, "block_get_slot: free slot list of block %d is broken\n", temp_block->address);
+        temp_block->free_slot = FREE_INT;
+    }
+
+    slot = temp_block->last_tuple_dict_id > 0 ? temp_block->last_tuple_dict_id : 0;
+    while (slot < DATA_BLOCK_SIZE && temp_block->tuple_dict[slot].size != FREE_INT)
+        slot++;
+    if (slot + num_attr > DATA_BLOCK_SIZE) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_EPI;
+    return slot;
+}
+
+/**
+ * @brief Function releases a row of a block. Data of the row is cleared, its tuple dicts are marked as deleted and the slot
+          is put on the free slot list of the block so the next insert can reuse it. If deleted values hold more than
+          BLOCK_COMPACTION_THRESHOLD percent of used data space, the block is compacted.
+ * @param temp_block block to work with
+ * @param slot tuple_dict index of the first attribute of the row
+ * @param num_attr number of attributes of the row
+ * @return No return value
+ */
+void AK_block_release_row(AK_block *temp_block, int slot, int num_attr) {
+    int j;
+    AK_PRO;
+    for (j = slot; j < slot + num_attr; j++) {
+        if (temp_block->tuple_dict[j].size > 0) {
+            memset(temp_block->data + temp_block->tuple_dict[j].address, '\0', temp_block->tuple_dict[j].size);
+            temp_block->deleted_space += temp_block->tuple_dict[j].size;
+        }
+        Ak_dbg_messg(HIGH, FILE_MAN, "block_release_row: from: %d, to: %d\n", temp_block->tuple_dict[j].address, temp_block->tuple_dict[j].address + temp_block->tuple_dict[j].size);
+        temp_block->tuple_dict[j].size = 0;
+        temp_block->tuple_dict[j].type = 0;
+        temp_block->tuple_dict[j].address = 0;
+    }
+    temp_block->tuple_dict[slot].address = temp_block->free_slot;
+    temp_block->free_slot = slot;
+    AK_zone_map_invalidate(temp_block->address);
+
+    if (temp_block->deleted_space * 100 > BLOCK_COMPACTION_THRESHOLD * temp_block->AK_free_space)
+        AK_block_compact(temp_block);
+    AK_EPI;
+}
+
+/**
+ * @brief Function moves a row from one block to another. Values are copied without building a list, the row is written
+          to a free slot of the target block and released in the source block.
+ * @param from block the row is moved from
+ * @param slot tuple_dict index of the first attribute of the row in the source block
+ * @param num_attr number of attributes of the row
+ * @param to block the row is moved to
+ * @return tuple_dict index of the row in the target block, EXIT_ERROR if there is no room in the target block
+ */
+int AK_block_move_row(AK_block *from, int slot, int num_attr, AK_block *to) {
+    int j, id, row_size = 0;
+    AK_PRO;
+    for (j = slot; j < slot + num_attr; j++)
+        row_size += from->tuple_dict[j].size;
+
+    if (to->AK_free_space + row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE && to->deleted_space > 0)
+        AK_block_compact(to);
+    if (to->AK_free_space + row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE || (id = AK_block_get_slot(to, num_attr)) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (j = 0; j < num_attr; j++) {
+        AK_tuple_dict *source = &from->tuple_dict[slot + j];
+        memcpy(to->data + to->AK_free_space, from->data + source->address, source->size);
+        to->tuple_dict[id + j].address = to->AK_free_space;
+        to->tuple_dict[id + j].type = source->type;
+        to->tuple_dict[id + j].size = source->size;
+        to->AK_free_space += source->size;
+    }
+    if (id + num_attr - 1 > to->last_tuple_dict_id)
+        to->last_tuple_dict_id = id + num_attr - 1;
+    AK_zone_map_insert_row(to, id);
+
+    AK_block_release_row(from, slot, num_attr);
+    AK_EPI;
+    return id;
+}
+
+/**
+ * @brief Function writes one row into a block the same way as Ak_insert_row_to_block, but reports the tuple_dict index
+          the row was written to, so callers can build its RID.
+ * @param row_root list of elements to insert
+ * @param temp_block block in which we insert data
+ * @return tuple_dict index of the first attribute of the row, EXIT_ERROR if there is no room in the block
+ */
+static int AK_insert_row_to_slot(struct list_node *row_root, AK_block *temp_block) {
+    struct list_node *some_element;
+    int type[MAX_ATTRIBUTES]; //types of entry data
+    int size[MAX_ATTRIBUTES]; //sizes of entry data
+    char entry_data[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+    int id; //id tuple dict in which the row is inserted
+    int head = 0; //index of header which is curently inserted
+    int row_size = 0;
+    AK_PRO;
+
+    while (head < MAX_ATTRIBUTES && strcmp(temp_block->header[head].att_name, "\0") != 0) {//gathering values of the list one by one
+        memset(entry_data[head], '\0', MAX_VARCHAR_LENGTH);
+        some_element = (struct list_node *) Ak_First_L2(row_root);
+        while (some_element && !((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0)
+                && (some_element->constraint == 0))) {
+            some_element = (struct list_node *) Ak_Next_L2(some_element);
+        }
+        if (some_element) {//found correct element
+            type[head] = some_element->type;
+            memcpy(entry_data[head], some_element->data, AK_type_size(type[head], some_element->data));
+        } else { //no data exist for this header write null
+            type[head] = TYPE_VARCHAR;
+            memcpy(entry_data[head], "null", strlen("null"));
+        }
+        size[head] = AK_type_size(type[head], entry_data[head]);
+        row_size += size[head];
+        head++; //go to next header
+    }
+
+    if (temp_block->AK_free_space + row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE && temp_block->deleted_space > 0)
+        AK_block_compact(temp_block);
+
+    id = AK_block_get_slot(temp_block, head);
+    if (head == 0 || id == EXIT_ERROR || temp_block->AK_free_space + row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE) {
+        Ak_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: No room for row in block %d\n", temp_block->address);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (head = 0; head < MAX_ATTRIBUTES && strcmp(temp_block->header[head].att_name, "\0") != 0; head++) {
+        Ak_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id + head, temp_block->header[head].att_name);
+
+        memcpy(temp_block->data + temp_block->AK_free_space, entry_data[head], size[head]);
+        temp_block->tuple_dict[id + head].address = temp_block->AK_free_space;
+        temp_block->AK_free_space += size[head];
+        temp_block->tuple_dict[id + head].type = type[head];
+        temp_block->tuple_dict[id + head].size = size[head];
+
+        Ak_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Insert: data: %s, size: %d\n", entry_data[head], size[head]);
+    }
+    //writes the last used tuple dict id
+    if (id + head - 1 > temp_block->last_tuple_dict_id)
+        temp_block->last_tuple_dict_id = id + head - 1;
+    AK_zone_map_insert_row(temp_block, id);
+    AK_EPI;
+    return id;
+}
+
 /** @author Matija Novak, updated by Dino Laktašić
         @brief Function inserts one row into some block.  Firstly it checks wether block contain attributes from the list. Then
-               data, type, size and last_tuple_id are put in temp_block.
+               data, type, size and last_tuple_id are put in temp_block. The row is written to a slot of a deleted row if the
+               block has one, and the block is compacted first if the row does not fit behind the last value.
         @param row_root list of elements to insert
         @param temp_block block in which we insert data
-        @return EXIT SUCCES if success
+        @return EXIT SUCCES if success, EXIT_ERROR if there is no room in the block
  */
 int Ak_insert_row_to_block(struct list_node *row_root, AK_block *temp_block) {
-    struct list_node *some_element;
-    int type; //type od entry data
-    int id = 0; //id tuple dict in which is inserted next data
-    int head = 0; //index of header which is curently inserted
+    int end;
+    AK_PRO;
+    end = AK_insert_row_to_slot(row_root, temp_block) == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+    AK_EPI;
+    return end;
+}
 
-    int search_elem; //serch for tuple dict id and searc for data in list
-    char entry_data[MAX_VARCHAR_LENGTH];
+/**
+ * @brief Function is called after rows of a table were written. Indexes are not maintained by writes, so indexes of
+          the table are no longer used to find rows until they are built again (see AK_index_set_current), and the
+          table is no longer known to be ordered until it is sorted again (see AK_sort_set_order).
+ * @param table table name
+ * @return No return value
+ */
+void AK_table_modified(char *table) {
     AK_PRO;
+    AK_index_invalidate(table);
+    AK_sort_set_order(table, NULL, 0);
+    AK_EPI;
+}
 
-    while (strcmp(temp_block->header[head].att_name, "\0") != 0) {//inserting values of the list one by one
-        while (temp_block->tuple_dict[id].size != FREE_INT) {//searches for AK_free tuple dict, maybe it can be last_tuple_dict_id
-            id++;
-        }
-        //printf("insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, temp_block->header[head].att_name);
+/**
+ * @brief Function writes one row into a given block of a table. The block is marked dirty only if the row was written.
+ * @param row_root list of elements which contain data of one row
+ * @param table table name
+ * @param address block address
+ * @param rid set to the row identifier of the written row
+ * @return EXIT_SUCCESS if success, EXIT_ERROR if there is no room in the block
+ */
+static int AK_insert_row_to_address(struct list_node *row_root, char *table, int address, AK_rid *rid) {
+    AK_PRO;
+    Ak_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", address);
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
 
+    //AK_add_to_redolog("INSERT", row_root);
 
-        Ak_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, temp_block->header[head].att_name);
+    rid->block = address;
+    rid->slot = AK_insert_row_to_slot(row_root, mem_block->block);
+    if (rid->slot == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
 
-        search_elem = 1;
-        some_element = (struct list_node *) Ak_First_L2(row_root);
-        while (search_elem) {
-            if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0)
-                    && (some_element->constraint == 0)) {//found correct element
-                type = some_element->type;
+    //AK_write_block(mem_block->block);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_table_modified(table);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
-                memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                memcpy(entry_data, some_element->data, AK_type_size(type, some_element->data));
-
-                search_elem = 0;
-            } else {
-                some_element = (struct list_node *) Ak_Next_L2(some_element);
-                if (some_element == 0) { //no data exist for this header write null
-                    some_element =1 ;
-                    memcpy(entry_data, "null", strlen("null"));
-                    type = TYPE_VARCHAR;
-                    search_elem = 0;
-                }
-            }
-        }
+/**
+ * @brief Function writes one row into a block of its table that has free space. The block chosen by
+          AK_find_AK_free_space is tried first; if the row does not fit there, the other blocks of the table are tried
+          in order and a new extent is allocated only if none of them has room. Reference integrity is not checked here.
+ * @param row_root list of elements which contain data of one row
+ * @param table table name
+ * @param rid set to the row identifier of the written row
+ * @return EXIT_SUCCESS if success else EXIT_ERROR
+ */
+static int AK_insert_row_rid(struct list_node *row_root, char *table, AK_rid *rid) {
+    table_addresses *addresses;
+    int adr_to_write, extent_type = SEGMENT_TYPE_TABLE, i, j;
+    AK_PRO;
+    Ak_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into table: %s\n", table);
 
-        memcpy(temp_block->data + temp_block->AK_free_space, entry_data, (int)AK_type_size(type, entry_data));
-        temp_block->tuple_dict[id].address = temp_block->AK_free_space;
-        temp_block->AK_free_space += AK_type_size(type, entry_data);
-        temp_block->tuple_dict[id].type = type;
-        temp_block->tuple_dict[id].size = AK_type_size(type, entry_data);
+    //rows of bitmap indexes are written to index segments
+    if (strstr(table, "_bmapIndex")) {
+        addresses = (table_addresses *) AK_get_index_addresses(table);
+        extent_type = SEGMENT_TYPE_INDEX;
+    } else {
+        addresses = (table_addresses *) AK_get_table_addresses(table);
+    }
 
-        memcpy(entry_data, temp_block->data + temp_block->tuple_dict[id].address, temp_block->tuple_dict[id].size);
-        //printf("insert_row_to_block: Insert: data: %s, size: %d\n",entry_data, AK_type_size(type, entry_data));
+    adr_to_write = (int) AK_find_AK_free_space(addresses);
+    if (adr_to_write > 0 && AK_insert_row_to_address(row_root, table, adr_to_write, rid) == EXIT_SUCCESS) {
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
 
-        Ak_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Insert: data: %s, size: %d\n", entry_data, AK_type_size(type, entry_data));
-        head++; //go to next header
+    //free space of the found block is only an estimate, the row may still not fit in it
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            if (j != adr_to_write && AK_insert_row_to_address(row_root, table, j, rid) == EXIT_SUCCESS) {
+                AK_free(addresses);
+                AK_EPI;
+                return EXIT_SUCCESS;
+            }
+        }
     }
-    //writes the last used tuple dict id
+    AK_free(addresses);
 
-    temp_block->last_tuple_dict_id = id;
+    //a new extent of AK_relation would have to be registered in AK_relation itself
+    adr_to_write = strcmp(table, "AK_relation") == 0 ? EXIT_ERROR : (int) AK_init_new_extent(table, extent_type);
+    if (adr_to_write <= 0 || AK_insert_row_to_address(row_root, table, adr_to_write, rid) == EXIT_ERROR) {
+        printf("insert_row: No room for row in table %s\n", table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -166,55 +444,75 @@ int Ak_insert_row(struct list_node *row_root) {
     struct list_node *some_element = (struct list_node *) Ak_First_L2(row_root);
 
     char table[MAX_ATT_NAME];
-
+    AK_rid rid;
 
     memset(table, '\0', MAX_ATT_NAME);
     memcpy(&table, some_element->table, strlen(some_element->table));
 
-    Ak_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into table: %s\n", table);
-    int adr_to_write;
-    //printf("INSERT u %s\n",some_element->table);
-    adr_to_write = (int) AK_find_AK_free_space(AK_get_table_addresses(table));
-
-
-    if (adr_to_write == -1)
-        adr_to_write = (int) AK_init_new_extent(table, SEGMENT_TYPE_TABLE);
+    int end = AK_insert_row_rid(row_root, table, &rid);
+    AK_EPI;
+    return end;
+}
 
-    if(strstr(some_element->table,"_bmapIndex")){
-        adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(table));
+/**
+ * @brief Function overwrites values of a row in place if all new values are of fixed-width types (int, float, date...)
+          and have the same type and size as the old ones. Only values that differ are written, the row keeps its slot
+          and no new data space is used.
+ * @param temp_block block to work with
+ * @param slot tuple_dict index of the first attribute of the row
+ * @param num_attr number of attributes of the row
+ * @param row_root list of elements which contain data for update
+ * @return number of changed values, EXIT_ERROR if the row can not be updated in place
+ */
+static int AK_update_row_in_place(AK_block *temp_block, int slot, int num_attr, struct list_node *row_root) {
+    struct list_node *some_element;
+    int head, changed = 0;
+    AK_PRO;
+    for (some_element = (struct list_node *) Ak_First_L2(row_root); some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+        if (some_element->constraint != NEW_VALUE)
+            continue;
+        for (head = 0; head < num_attr; head++) {
+            if (strcmp(temp_block->header[head].att_name, some_element->attribute_name) == 0)
+                break;
+        }
+        if (head == num_attr || AK_tuple_type_width(some_element->type) == 0
+                || temp_block->tuple_dict[slot + head].type != some_element->type
+                || temp_block->tuple_dict[slot + head].size != AK_type_size(some_element->type, some_element->data)) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
     }
 
-    if (adr_to_write == 0) {
-        AK_EPI;
-        return EXIT_ERROR;
+    for (some_element = (struct list_node *) Ak_First_L2(row_root); some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+        if (some_element->constraint != NEW_VALUE)
+            continue;
+        for (head = 0; strcmp(temp_block->header[head].att_name, some_element->attribute_name) != 0; head++)
+            ;
+        AK_tuple_dict *tuple_dict = &temp_block->tuple_dict[slot + head];
+        if (memcmp(temp_block->data + tuple_dict->address, some_element->data, tuple_dict->size) != 0) {
+            Ak_dbg_messg(HIGH, FILE_MAN, "update_row_in_place: block %d, tuple_dict %d, %d bytes at %d\n", temp_block->address, slot + head, tuple_dict->size, tuple_dict->address);
+            memcpy(temp_block->data + tuple_dict->address, some_element->data, tuple_dict->size);
+            changed++;
+        }
     }
-    Ak_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
-    //printf("insert_row: Insert into block on adress: %d\n", adr_to_write);
-
-    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(adr_to_write);
-
-    //AK_add_to_redolog("INSERT", row_root);
-
-    int end = (int) Ak_insert_row_to_block(row_root, mem_block->block);
-
-    //AK_write_block(mem_block->block);
-    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
     AK_EPI;
-    return end;
+    return changed;
 }
 
 /**
    * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion
-   * @brief Function updates row from table in given block.
+   * @brief Function updates row from table in given block. Rows whose new values are all fixed-width are overwritten
+            in place, other rows are rebuilt and moved if a new value is larger than the old one.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
-   * @return No return value
+   * @return number of updated rows, the block has to be written only if it is greater than 0
 */
-void Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root) {
+int Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root) {
     int head = 0; //counting headers
     int attPlace = 0;//place of attribute which are same
     int del = 1; //if can delete gorup of tuple dicts which are in the same row of table
     int exists_equal_attrib = 0; //if we found at least one header in the list
+    int updated = 0; //number of updated rows
     char entry_data[MAX_VARCHAR_LENGTH]; //entry data when haeader is found in list which is copied to compare with data in block
     AK_PRO;
     struct list_node *new_data = (struct list_node *) AK_malloc(sizeof (struct list_node));
@@ -262,7 +560,10 @@ void Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
         if (exists_equal_attrib == 1 && del == 1)
         {
             int j;
-            for (j = i - attPlace; j < i + head - attPlace; j++)
+            int in_place = AK_update_row_in_place(temp_block, i - attPlace, head, row_root);
+            if (in_place == EXIT_ERROR || in_place > 0)
+                updated++;
+            for (j = i - attPlace; in_place == EXIT_ERROR && j < i + head - attPlace; j++)
             {
                 Ak_DeleteAll_L3(&new_data);
                 int a = temp_block->tuple_dict[j].address;
@@ -295,11 +596,8 @@ void Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
                                 {
                                     Ak_Insert_New_Element_For_Update(temp_block->tuple_dict[k].type, entry_data, some_element->table, temp_block->header[k % head].att_name, new_data, NEW_VALUE);
                                 }
-
-                                temp_block->tuple_dict[k].size = 0;
-                                temp_block->tuple_dict[k].type = 0;
-                                temp_block->tuple_dict[k].address = 0;
                             }
+                            AK_block_release_row(temp_block, i - attPlace, head);
                             // insert new data
                             Ak_insert_row(new_data);
                         }
@@ -317,8 +615,11 @@ void Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
         del = 1;
     }
 
+    if (updated > 0)
+        AK_zone_map_invalidate(temp_block->address);
     AK_free(new_data);
     AK_EPI;
+    return updated;
 }
 
 /**
@@ -326,13 +627,14 @@ void Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
    * @brief Function deletes row from table in given block. Given list of elements is firstly back-upped.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
-   * @return No return value
+   * @return number of deleted rows, the block has to be written only if it is greater than 0
 */
-void Ak_delete_row_from_block(AK_block *temp_block, struct list_node *row_root) {
+int Ak_delete_row_from_block(AK_block *temp_block, struct list_node *row_root) {
     int head = 0; //counting headers
     int attPlace = 0;//place of attribute which are same
     int del = 1; //if can delete gorup of tuple dicts which are in the same row of table
     int exists_equal_attrib = 0; //if we found at least one header in the list
+    int deleted = 0; //number of deleted rows
     char entry_data[MAX_VARCHAR_LENGTH]; //entry data when haeader is found in list which is copied to compare with data in block
     AK_PRO;
     struct list_node *row_root_backup = (struct list_node *) AK_malloc(sizeof (struct list_node));
@@ -384,33 +686,91 @@ void Ak_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
             head++;
         }
         if ((exists_equal_attrib == 1) && (del == 1)) {
-            int j;
-
-            for (j = i -attPlace; j < i+head-attPlace; j++) {//delete one row
-
-                int k = temp_block->tuple_dict[j].address;
-                int l = temp_block->tuple_dict[j].size;
-                memset(temp_block->data + k, '\0', l);
-                Ak_dbg_messg(HIGH, FILE_MAN, "update_delete_row_from_block: from: %d, to: %d\n", k, l + k);
-
-                //clean tuple dict
-                temp_block->tuple_dict[j].size = 0;
-                temp_block->tuple_dict[j].type = 0;
-                temp_block->tuple_dict[j].address = 0;
-            }
+            //delete one row
+            AK_block_release_row(temp_block, i - attPlace, head);
+            deleted++;
         }
         del = 1;
         exists_equal_attrib = 0;
     }
     AK_free(row_root_backup);
     AK_EPI;
+    return deleted;
 }
 
 
+/**
+ * @brief Function resolves the blocks that hold rows matching a search constraint by a bitmap index. The first search
+          constraint on an attribute that has a bitmap index (named table + attribute + "_bmapIndex") is used. Bitmap
+          indexes are not maintained by writes, so the index is used only while it is current (see
+          AK_index_set_current); an index that lists a block outside the table is not used either.
+ * @param table table name
+ * @param addresses extents of the table
+ * @param row_root elements of one row
+ * @param blocks array for one address of every block of the table, filled with sorted block addresses
+ * @return number of resolved blocks, EXIT_ERROR if no index can be used
+ */
+static int AK_get_index_resolved_blocks(char *table, table_addresses *addresses, struct list_node *row_root, int *blocks) {
+    struct list_node *some_element;
+    char index_name[2 * MAX_ATT_NAME + 11];
+    char value[MAX_VARCHAR_LENGTH];
+    int num_blocks = 0, i, j;
+    AK_PRO;
+    for (some_element = (struct list_node *) Ak_First_L2(row_root); some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+        if (some_element->constraint != SEARCH_CONSTRAINT)
+            continue;
+        if (some_element->type == TYPE_INT)
+            sprintf(value, "%d", *((int *) some_element->data));
+        else if (some_element->type == TYPE_VARCHAR)
+            strcpy(value, some_element->data);
+        else
+            continue;
+
+        snprintf(index_name, sizeof (index_name), "%s%s_bmapIndex", table, some_element->attribute_name);
+        if (!AK_index_is_current(index_name))
+            continue;
+        table_addresses *index_addresses = (table_addresses *) AK_get_index_addresses(index_name);
+        int exists = index_addresses->address_from[0] != 0;
+        AK_free(index_addresses);
+        if (!exists)
+            continue;
+
+        list_ad *list = (list_ad *) Ak_get_Attribute(index_name, value);
+        element_ad element;
+        for (element = Ak_Get_First_elementAd(list); element; element = Ak_Get_Next_elementAd(element)) {
+            for (j = 0; j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++) {
+                if (element->add.addBlock >= addresses->address_from[j] && element->add.addBlock < addresses->address_to[j])
+                    break;
+            }
+            if (j == MAX_EXTENTS_IN_SEGMENT || addresses->address_from[j] == 0) {
+                Ak_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: index %s lists block %d outside the table\n", index_name, element->add.addBlock);
+                num_blocks = EXIT_ERROR;
+                break;
+            }
+            //keep blocks sorted and without duplicates, so there are at most as many as blocks of the table
+            for (i = num_blocks - 1; i >= 0 && blocks[i] > element->add.addBlock; i--)
+                ;
+            if (i >= 0 && blocks[i] == element->add.addBlock)
+                continue;
+            memmove(blocks + i + 2, blocks + i + 1, (num_blocks - i - 1) * sizeof (int));
+            blocks[i + 1] = element->add.addBlock;
+            num_blocks++;
+        }
+        Ak_Delete_All_elementsAd(list);
+        AK_free(list);
+        Ak_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: index %s resolved %d blocks\n", index_name, num_blocks);
+        AK_EPI;
+        return num_blocks;
+    }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
 /**
       * @author Matija Novak, updated by Matija Šestak (function now uses caching)
       * @brief Function updates or deletes the whole segment of an table. Addresses for given table atr fetched. For each block
-        in extent row is updated or deleted according to operator del.
+        in extent row is updated or deleted according to operator del. If a search constraint has a current bitmap index,
+        only blocks resolved by the index are visited. Only blocks in which a row was changed are marked dirty.
       * @param row_root elements of one row
       * @param del - DELETE or UPDATE
       * @return EXIT_SUCCESS if success
@@ -428,29 +788,48 @@ int Ak_delete_update_segment(struct list_node *row_root, int del) {
     table_addresses * addresses = (table_addresses *) AK_get_table_addresses(table);
 
     AK_mem_block *mem_block;
-    int startAddress, j, i;
-
-    for (j = 0; j < MAX_EXTENTS_IN_SEGMENT; j++) { //going through extent
-        startAddress = addresses->address_from[j];
-        if (startAddress != 0) {
+    int startAddress, j, i, changed, modified = 0;
+    int num_blocks = 0;
+
+    for (j = 0; j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++)
+        num_blocks += addresses->address_to[j] - addresses->address_from[j];
+    int *blocks = (int *) AK_malloc(num_blocks * sizeof (int));
+    int indexed = AK_get_index_resolved_blocks(table, addresses, row_root, blocks);
+
+    if (indexed == EXIT_ERROR) {
+        num_blocks = 0;
+        for (j = 0; j < MAX_EXTENTS_IN_SEGMENT; j++) { //going through extent
+            startAddress = addresses->address_from[j];
+            if (startAddress == 0)
+                break;
             Ak_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: delete_update extent: %d\n", j);
+            for (i = startAddress; i < addresses->address_to[j]; i++)
+                blocks[num_blocks++] = i;
+        }
+    } else {
+        num_blocks = indexed;
+    }
 
-            for (i = startAddress; i <= addresses->address_to[j]; i++) { //going through blocks
-                Ak_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: delete_update block: %d\n", i);
+    for (i = 0; i < num_blocks; i++) { //going through blocks
+        Ak_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: delete_update block: %d\n", blocks[i]);
 
-                mem_block = (AK_mem_block *) AK_get_block(i);
+        mem_block = (AK_mem_block *) AK_get_block(blocks[i]);
 
-                if(del == DELETE) {
-                    Ak_delete_row_from_block(mem_block->block, row_root);
-                }
-                else {
-                    Ak_update_row_from_block(mem_block->block, row_root);
-                }
-                AK_mem_block_modify(mem_block, BLOCK_DIRTY);
-            }
-        } else
-            break;
+        if(del == DELETE) {
+            changed = Ak_delete_row_from_block(mem_block->block, row_root);
+        }
+        else {
+            changed = Ak_update_row_from_block(mem_block->block, row_root);
+        }
+        if (changed > 0) {
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            modified = 1;
+        }
     }
+    if (modified)
+        AK_table_modified(table);
+    AK_free(blocks);
+    AK_free(addresses);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -523,6 +902,305 @@ int Ak_update_row(struct list_node *row_root) {
 }
 
 
+/**
+ * @brief Function checks whether a RID points to a live row in the given block. A row is stored as num_attr consecutive
+          tuple_dict entries, so the slot has to be aligned to the number of attributes and the entry must be neither
+          AK_free nor deleted.
+ * @param temp_block block the RID points to
+ * @param rid row identifier
+ * @return number of attributes of the row if RID is valid, EXIT_ERROR otherwise
+ */
+int AK_rid_num_attr(AK_block *temp_block, AK_rid rid) {
+    int num_attr = 0;
+    AK_PRO;
+    while (num_attr < MAX_ATTRIBUTES && strcmp(temp_block->header[num_attr].att_name, "\0") != 0)
+        num_attr++;
+
+    if (num_attr == 0 || rid.slot < 0 || rid.slot % num_attr != 0 || rid.slot + num_attr > DATA_BLOCK_SIZE) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (temp_block->tuple_dict[rid.slot].type == FREE_INT || temp_block->tuple_dict[rid.slot].type == 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_EPI;
+    return num_attr;
+}
+
+/**
+ * @brief Function copies the row a RID points to into a list. Every element gets its table and attribute name so the
+          list can be used as a search constraint for reference checks.
+ * @param temp_block block the RID points to
+ * @param rid row identifier
+ * @param num_attr number of attributes of the row
+ * @param table table name
+ * @param constraint NEW_VALUE or SEARCH_CONSTRAINT
+ * @param row_root list to which the row is appended
+ * @return No return value
+ */
+static void AK_rid_row_to_list(AK_block *temp_block, AK_rid rid, int num_attr, char *table, int constraint, struct list_node *row_root) {
+    char data[MAX_VARCHAR_LENGTH];
+    struct list_node *last;
+    int l;
+    AK_PRO;
+    for (l = 0; l < num_attr; l++) {
+        int type = temp_block->tuple_dict[rid.slot + l].type;
+        int size = temp_block->tuple_dict[rid.slot + l].size;
+        int address = temp_block->tuple_dict[rid.slot + l].address;
+        memset(data, '\0', MAX_VARCHAR_LENGTH);
+        memcpy(data, &(temp_block->data[address]), size);
+        Ak_InsertAtEnd_L3(type, data, size, row_root);
+
+        last = (struct list_node *) Ak_End_L2(row_root);
+        strcpy(last->table, table);
+        strcpy(last->attribute_name, temp_block->header[l].att_name);
+        last->constraint = constraint;
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks that a RID points to a block of one of the extents of a table, so a RID of another table or a
+          stale RID of a released extent is not used to read or change rows of the wrong table.
+ * @param rid row identifier
+ * @param table table name
+ * @return EXIT_SUCCESS if block of the RID belongs to the table, EXIT_ERROR otherwise
+ */
+static int AK_rid_in_table(AK_rid rid, char *table) {
+    int i, found = EXIT_ERROR;
+    AK_PRO;
+    if (rid.block <= 0 || rid.block >= db_file_size) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(table);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && found == EXIT_ERROR; i++) {
+        if (rid.block >= addresses->address_from[i] && rid.block < addresses->address_to[i])
+            found = EXIT_SUCCESS;
+    }
+    AK_free(addresses);
+    if (found == EXIT_ERROR)
+        Ak_dbg_messg(HIGH, FILE_MAN, "rid_in_table: block %d is not in table %s\n", rid.block, table);
+    AK_EPI;
+    return found;
+}
+
+/**
+ * @brief Function fetches one row by its RID. Only the block the RID points to is read, no table scan is done.
+ * @param rid row identifier (block address and tuple_dict index of the first attribute)
+ * @param table table name the row belongs to
+ * @return list of row elements, NULL if RID does not point to a live row
+ */
+struct list_node *AK_fetch_by_rid(AK_rid rid, char *table) {
+    AK_PRO;
+    if (AK_rid_in_table(rid, table) == EXIT_ERROR) {
+        AK_EPI;
+        return NULL;
+    }
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(rid.block);
+    int num_attr = AK_rid_num_attr(mem_block->block, rid);
+    if (num_attr == EXIT_ERROR) {
+        Ak_dbg_messg(HIGH, FILE_MAN, "fetch_by_rid: no row in block %d on tuple_dict %d\n", rid.block, rid.slot);
+        AK_EPI;
+        return NULL;
+    }
+
+    struct list_node *row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    Ak_Init_L3(&row_root);
+    AK_rid_row_to_list(mem_block->block, rid, num_attr, table, NEW_VALUE, row_root);
+    AK_EPI;
+    return row_root;
+}
+
+/**
+ * @brief Function updates one row by its RID. New values are written in place, so the RID stays valid. A value that is
+          larger than the old one is appended to the AK_free space of the same block. Only if the block has no room left
+          the row is deleted and inserted again, in which case it gets a new RID. Attributes of new values are checked
+          before reference integrity, so a failed update does not cascade to referencing tables.
+ * @param rid row identifier (block address and tuple_dict index of the first attribute), set to the new RID if the row
+          is moved
+ * @param row_root list of NEW_VALUE elements with table and attribute names
+ * @return EXIT_SUCCESS if success, EXIT_ERROR otherwise
+ */
+int AK_update_by_rid(AK_rid *rid, struct list_node *row_root) {
+    char table[MAX_ATT_NAME];
+    struct list_node *some_element;
+    int num_attr, head, growth = 0;
+    AK_PRO;
+    some_element = (struct list_node *) Ak_First_L2(row_root);
+    if (some_element == NULL || AK_rid_in_table(*rid, some_element->table) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    strcpy(table, some_element->table);
+
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(rid->block);
+    AK_block *temp_block = mem_block->block;
+    num_attr = AK_rid_num_attr(temp_block, *rid);
+    if (num_attr == EXIT_ERROR) {
+        Ak_dbg_messg(HIGH, FILE_MAN, "update_by_rid: no row in block %d on tuple_dict %d\n", rid->block, rid->slot);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (; some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+        if (some_element->constraint != NEW_VALUE)
+            continue;
+        for (head = 0; head < num_attr; head++) {
+            if (strcmp(temp_block->header[head].att_name, some_element->attribute_name) == 0)
+                break;
+        }
+        if (head == num_attr) {
+            printf("update_by_rid: Attribute %s does not exist in table %s\n", some_element->attribute_name, table);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+
+    //old values are search constraints for reference integrity, new values follow them
+    struct list_node *ref_list = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    Ak_Init_L3(&ref_list);
+    AK_rid_row_to_list(temp_block, *rid, num_attr, table, SEARCH_CONSTRAINT, ref_list);
+    for (some_element = (struct list_node *) Ak_First_L2(row_root); some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+        if (some_element->constraint == NEW_VALUE)
+            Ak_Insert_New_Element_For_Update(some_element->type, some_element->data, table, some_element->attribute_name, Ak_End_L2(ref_list), NEW_VALUE);
+    }
+
+    if (AK_reference_check_restricion(ref_list, UPDATE) == EXIT_ERROR) {
+        Ak_dbg_messg(HIGH, FILE_MAN, "Could not update row. Reference integrity violation (restricted).\n");
+        Ak_DeleteAll_L3(&ref_list);
+        AK_free(ref_list);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_reference_check_if_update_needed(ref_list, UPDATE) == EXIT_SUCCESS) {
+        AK_reference_update(ref_list, UPDATE);
+    }
+    Ak_DeleteAll_L3(&ref_list);
+    AK_free(ref_list);
+
+    //reference update may have replaced the cached block
+    mem_block = (AK_mem_block *) AK_get_block(rid->block);
+    temp_block = mem_block->block;
+
+    for (some_element = (struct list_node *) Ak_First_L2(row_root); some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+        if (some_element->constraint != NEW_VALUE)
+            continue;
+        for (head = 0; head < num_attr; head++) {
+            if (strcmp(temp_block->header[head].att_name, some_element->attribute_name) == 0)
+                break;
+        }
+        int new_size = AK_type_size(some_element->type, some_element->data);
+        if (new_size > temp_block->tuple_dict[rid->slot + head].size)
+            growth += new_size;
+    }
+
+    if (temp_block->AK_free_space + growth > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE && temp_block->deleted_space > 0)
+        AK_block_compact(temp_block);
+
+    if (temp_block->AK_free_space + growth > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE) {
+        //no room in this block, row has to move
+        struct list_node *new_data = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+        Ak_Init_L3(&new_data);
+        AK_rid_row_to_list(temp_block, *rid, num_attr, table, NEW_VALUE, new_data);
+        struct list_node *old_value;
+        for (some_element = (struct list_node *) Ak_First_L2(row_root); some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+            if (some_element->constraint != NEW_VALUE)
+                continue;
+            for (old_value = (struct list_node *) Ak_First_L2(new_data); old_value; old_value = (struct list_node *) Ak_Next_L2(old_value)) {
+                if (strcmp(old_value->attribute_name, some_element->attribute_name) == 0) {
+                    old_value->type = some_element->type;
+                    memcpy(old_value->data, some_element->data, MAX_VARCHAR_LENGTH);
+                }
+            }
+        }
+        AK_block_release_row(temp_block, rid->slot, num_attr);
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        AK_table_modified(table);
+        Ak_dbg_messg(HIGH, FILE_MAN, "update_by_rid: row moved out of block %d\n", rid->block);
+        int end = AK_insert_row_rid(new_data, table, rid);
+        Ak_DeleteAll_L3(&new_data);
+        AK_free(new_data);
+        AK_EPI;
+        return end;
+    }
+
+    for (some_element = (struct list_node *) Ak_First_L2(row_root); some_element; some_element = (struct list_node *) Ak_Next_L2(some_element)) {
+        if (some_element->constraint != NEW_VALUE)
+            continue;
+        for (head = 0; head < num_attr; head++) {
+            if (strcmp(temp_block->header[head].att_name, some_element->attribute_name) == 0)
+                break;
+        }
+        AK_tuple_dict *tuple_dict = &temp_block->tuple_dict[rid->slot + head];
+        int new_size = AK_type_size(some_element->type, some_element->data);
+        memset(temp_block->data + tuple_dict->address, '\0', tuple_dict->size);
+        if (new_size > tuple_dict->size) {
+            temp_block->deleted_space += tuple_dict->size;
+            tuple_dict->address = temp_block->AK_free_space;
+            temp_block->AK_free_space += new_size;
+        } else {
+            temp_block->deleted_space += tuple_dict->size - new_size;
+        }
+        memcpy(temp_block->data + tuple_dict->address, some_element->data, new_size);
+        tuple_dict->size = new_size;
+        tuple_dict->type = some_element->type;
+    }
+    AK_zone_map_invalidate(rid->block);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_table_modified(table);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function deletes one row by its RID. Reference integrity is checked the same way as in Ak_delete_row, but
+          only the block the RID points to is touched.
+ * @param rid row identifier (block address and tuple_dict index of the first attribute)
+ * @param table table name the row belongs to
+ * @return EXIT_SUCCESS if success, EXIT_ERROR otherwise
+ */
+int AK_delete_by_rid(AK_rid rid, char *table) {
+    int num_attr;
+    AK_PRO;
+    if (AK_rid_in_table(rid, table) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(rid.block);
+    num_attr = AK_rid_num_attr(mem_block->block, rid);
+    if (num_attr == EXIT_ERROR) {
+        Ak_dbg_messg(HIGH, FILE_MAN, "delete_by_rid: no row in block %d on tuple_dict %d\n", rid.block, rid.slot);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    struct list_node *ref_list = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    Ak_Init_L3(&ref_list);
+    AK_rid_row_to_list(mem_block->block, rid, num_attr, table, SEARCH_CONSTRAINT, ref_list);
+    if (AK_reference_check_restricion(ref_list, DELETE) == EXIT_ERROR) {
+        Ak_dbg_messg(HIGH, FILE_MAN, "Could not delete row. Reference integrity violation (restricted).\n");
+        Ak_DeleteAll_L3(&ref_list);
+        AK_free(ref_list);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_reference_check_if_update_needed(ref_list, DELETE) == EXIT_SUCCESS) {
+        AK_reference_update(ref_list, DELETE);
+    }
+    Ak_DeleteAll_L3(&ref_list);
+    AK_free(ref_list);
+
+    mem_block = (AK_mem_block *) AK_get_block(rid.block);
+    AK_block_release_row(mem_block->block, rid.slot, num_attr);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_table_modified(table);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+
 void Ak_fileio_test() {
     AK_PRO;
     printf("\n\nThis is fileio test!\n");
@@ -621,6 +1299,127 @@ void Ak_fileio_test() {
 
     AK_print_table("testna");
 
+    printf("\nFetch, update and delete by RID:\n");
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses("testna");
+    AK_rid rid;
+    rid.block = addresses->address_from[0];
+    AK_free(addresses);
+
+    //rows deleted or moved by the updates above leave dead slots, take the first live one
+    struct list_node *fetched = NULL;
+    for (rid.slot = 0; rid.slot < DATA_BLOCK_SIZE && fetched == NULL; rid.slot += 3)
+        fetched = AK_fetch_by_rid(rid, "testna");
+    rid.slot -= 3;
+    if (fetched != NULL) {
+        struct list_node *value = (struct list_node *) Ak_First_L2(fetched);
+        printf("Row in block %d on tuple_dict %d: %d ", rid.block, rid.slot, *((int *) value->data));
+        for (value = (struct list_node *) Ak_Next_L2(value); value; value = (struct list_node *) Ak_Next_L2(value))
+            printf("%s ", value->data);
+        printf("\n");
+        Ak_DeleteAll_L3(&fetched);
+        AK_free(fetched);
+    }
+    if (AK_fetch_by_rid(rid, "AK_relation") == NULL && AK_delete_by_rid(rid, "AK_relation") == EXIT_ERROR)
+        printf("RID of table testna is not used for table AK_relation\n");
+
+    Ak_DeleteAll_L3(&row_root);
+    Ak_Insert_New_Element(TYPE_VARCHAR, "NovakVeomaDugackoPrezime", "testna", "Prezime", row_root);
+    if (AK_update_by_rid(&rid, row_root) == EXIT_SUCCESS && (fetched = AK_fetch_by_rid(rid, "testna")) != NULL) {
+        printf("Row after update by RID has Prezime: %s\n", Ak_GetNth_L2(3, fetched)->data);
+        Ak_DeleteAll_L3(&fetched);
+        AK_free(fetched);
+    }
+
+    AK_delete_by_rid(rid, "testna");
+    if (AK_fetch_by_rid(rid, "testna") == NULL)
+        printf("Row in block %d on tuple_dict %d deleted by RID\n", rid.block, rid.slot);
+
+    printf("\nInsert into slot of deleted row and compact block:\n");
+    Ak_DeleteAll_L3(&row_root);
+    broj = 10;
+    Ak_Insert_New_Element(TYPE_INT, &broj, "testna", "Redni_broj", row_root);
+    Ak_Insert_New_Element(TYPE_VARCHAR, "Ivana", "testna", "Ime", row_root);
+    Ak_Insert_New_Element(TYPE_VARCHAR, "Horvat", "testna", "Prezime", row_root);
+    Ak_insert_row(row_root);
+    if ((fetched = AK_fetch_by_rid(rid, "testna")) != NULL) {
+        printf("Inserted row reused tuple_dict %d: %d\n", rid.slot, *((int *) Ak_First_L2(fetched)->data));
+        Ak_DeleteAll_L3(&fetched);
+        AK_free(fetched);
+    }
+
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(rid.block);
+    printf("Block %d uses %d bytes, %d of them deleted\n", rid.block, mem_block->block->AK_free_space, mem_block->block->deleted_space);
+    AK_block_compact(mem_block->block);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    printf("Block %d uses %d bytes after compaction\n", rid.block, mem_block->block->AK_free_space);
+
+    AK_print_table("testna");
+
+    //only the block that holds the deleted row has to be written
+    AK_flush_cache();
+    addresses = (table_addresses *) AK_get_table_addresses("testna");
+    for (i = addresses->address_from[0]; i < addresses->address_to[0]; i++) {
+        if ((mem_block = AK_get_cached_block(i)) != NULL)
+            AK_mem_block_modify(mem_block, BLOCK_CLEAN);
+    }
+    Ak_DeleteAll_L3(&row_root);
+    broj = 10;
+    Ak_Insert_New_Element_For_Update(TYPE_INT, &broj, "testna", "Redni_broj", row_root, SEARCH_CONSTRAINT);
+    Ak_delete_row(row_root);
+    int dirty = 0;
+    for (i = addresses->address_from[0]; i < addresses->address_to[0]; i++) {
+        if ((mem_block = AK_get_cached_block(i)) != NULL && mem_block->dirty == BLOCK_DIRTY)
+            dirty++;
+    }
+    AK_free(addresses);
+    printf("Delete of one row dirtied %d block(s) of table testna\n", dirty);
+
+    //counter-style update is written in place, the row keeps its slot
+    for (rid.slot = 0; rid.slot < DATA_BLOCK_SIZE; rid.slot += 3) {
+        if ((fetched = AK_fetch_by_rid(rid, "testna")) == NULL)
+            continue;
+        broj = *((int *) Ak_First_L2(fetched)->data);
+        Ak_DeleteAll_L3(&fetched);
+        AK_free(fetched);
+        if (broj == 2)
+            break;
+    }
+    int used_space = ((AK_mem_block *) AK_get_block(rid.block))->block->AK_free_space;
+    Ak_DeleteAll_L3(&row_root);
+    Ak_Insert_New_Element_For_Update(TYPE_INT, &broj, "testna", "Redni_broj", row_root, SEARCH_CONSTRAINT);
+    broj = 20;
+    Ak_Insert_New_Element_For_Update(TYPE_INT, &broj, "testna", "Redni_broj", row_root, NEW_VALUE);
+    Ak_update_row(row_root);
+    if ((fetched = AK_fetch_by_rid(rid, "testna")) != NULL) {
+        printf("Row on tuple_dict %d after update in place: %d, data space used before %d, after %d\n", rid.slot,
+                *((int *) Ak_First_L2(fetched)->data), used_space, ((AK_mem_block *) AK_get_block(rid.block))->block->AK_free_space);
+        Ak_DeleteAll_L3(&fetched);
+        AK_free(fetched);
+    }
+
+    //third row of 10 long values does not fit in the block chosen by free space and is written to the next block
+    printf("\nInsert of rows larger than free space of the chosen block:\n");
+    AK_header w_header[MAX_ATTRIBUTES + 1];
+    char w_name[MAX_ATT_NAME], w_value[MAX_VARCHAR_LENGTH];
+    memset(w_header, 0, sizeof (w_header));
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        sprintf(w_name, "Opis%d", i);
+        AK_header *w_temp = (AK_header *) AK_create_header(w_name, TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&w_header[i], w_temp, sizeof (AK_header));
+        AK_free(w_temp);
+    }
+    AK_initialize_new_segment("testna_wide", SEGMENT_TYPE_TABLE, w_header);
+    memset(w_value, 'x', MAX_VARCHAR_LENGTH - 1);
+    w_value[MAX_VARCHAR_LENGTH - 1] = '\0';
+    int inserted = 0;
+    for (broj = 0; broj < 3; broj++) {
+        Ak_DeleteAll_L3(&row_root);
+        for (i = 0; i < MAX_ATTRIBUTES; i++)
+            Ak_Insert_New_Element(TYPE_VARCHAR, w_value, "testna_wide", w_header[i].att_name, row_root);
+        inserted += Ak_insert_row(row_root) == EXIT_SUCCESS;
+    }
+    printf("Inserted %d of 3 rows, table testna_wide has %d rows\n", inserted, AK_get_num_records("testna_wide"));
+
     Ak_DeleteAll_L3(&row_root);
     AK_free(row_root);
     AK_EPI;
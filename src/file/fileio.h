@@ -26,16 +26,37 @@
 #include "files.h"
 #include "../auxi/mempro.h"
 
+/**
+ * @struct AK_rid
+ * @brief Structure that defines a stable row identifier. A row is addressed by the block it lives in and by the
+          tuple_dict index of its first attribute (the same pair that search_result and struct_add hold).
+ */
+typedef struct {
+    /// block address of the row
+    int block;
+    /// tuple_dict index of the first attribute of the row
+    int slot;
+} AK_rid;
+
 void Ak_Insert_New_Element_For_Update(int newtype, void * data, char * table, char * attribute_name, struct list_node * ElementBefore, int newconstraint);
 void Ak_Insert_New_Element(int newtype, void * data, char * table, char * attribute_name, struct list_node * ElementBefore);
+void AK_block_compact(AK_block *temp_block);
+int AK_block_get_slot(AK_block *temp_block, int num_attr);
+void AK_block_release_row(AK_block *temp_block, int slot, int num_attr);
+int AK_block_move_row(AK_block *from, int slot, int num_attr, AK_block *to);
+void AK_table_modified(char *table);
 int Ak_insert_row_to_block(struct list_node *row_root, AK_block *temp_block);
 int Ak_insert_row(struct list_node *row_root);
-void Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root);
-void Ak_delete_row_from_block(AK_block *temp_block, struct list_node *row_root);
+int Ak_update_row_from_block(AK_block *temp_block, struct list_node *row_root);
+int Ak_delete_row_from_block(AK_block *temp_block, struct list_node *row_root);
 int Ak_delete_update_segment(struct list_node *row_root, int del);
 int Ak_delete_row(struct list_node *row_root) ;
 int Ak_update_row(struct list_node *row_root);
 void Ak_fileio_test();
 void Ak_delete_row_by_id(int id, char* tableName);
+int AK_rid_num_attr(AK_block *temp_block, AK_rid rid);
+struct list_node *AK_fetch_by_rid(AK_rid rid, char *table);
+int AK_update_by_rid(AK_rid *rid, struct list_node *row_root);
+int AK_delete_by_rid(AK_rid rid, char *table);
 
 #endif
@@ -17,9 +17,19 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 #include "files.h"
+#include "table.h"
 #include <pthread.h>
 pthread_mutex_t fileMut = PTHREAD_MUTEX_INITIALIZER;
 
+/// names of temporary segments that still exist, in the order they were created
+static char (*AK_temp_segments)[MAX_ATT_NAME] = NULL;
+/// number of temporary segments that still exist
+static int AK_temp_num_segments = 0;
+/// number of names AK_temp_segments can hold
+static int AK_temp_capacity = 0;
+/// number of temporary segments created so far, used to name them
+static int AK_temp_counter = 0;
+
 /**
  * @author Tomislav Fotak, updated by Matija Šestak (function now uses caching)
  * @brief Function initializes new segment and writes its start and finish address in system catalog table. For creting new table, index, temporary table, 	     etc. call this function
@@ -32,7 +42,7 @@ pthread_mutex_t fileMut = PTHREAD_MUTEX_INITIALIZER;
 int AK_initialize_new_segment(char *name, int type, AK_header *header) {
 
     int start_address = -1;
-    int end_address = INITIAL_EXTENT_SIZE;
+    int end_address = type == SEGMENT_TYPE_TEMP ? INITIAL_EXTENT_SIZE_TEMP : INITIAL_EXTENT_SIZE;
     AK_PRO;
     pthread_mutex_lock(&fileMut);
     int objectID = AK_get_id();
@@ -120,6 +130,88 @@ int AK_initialize_new_index_segment(char *name, char *table_id, int attr_id , AK
 }
 
 
+/**
+ * @brief Function starts a scope of temporary segments, for example of one query. Temporary segments created after
+          it are deleted by AK_temp_end with the returned mark, so a query does not leave them behind.
+ * @return mark of the scope
+ */
+int AK_temp_begin() {
+    AK_PRO;
+    int mark;
+
+    pthread_mutex_lock(&fileMut);
+    mark = AK_temp_num_segments;
+    pthread_mutex_unlock(&fileMut);
+    AK_EPI;
+    return mark;
+}
+
+/**
+ * @brief Function creates a temporary segment (SEGMENT_TYPE_TEMP) with a new name. Temporary segments are registered
+          in AK_relation like tables, so table functions (scans, bulk loads) can read and write them, and they start
+          with INITIAL_EXTENT_SIZE_TEMP blocks because many of them (partitions, runs) hold few rows.
+ * @param name array of MAX_ATT_NAME characters the name of the segment is written to
+ * @param header header of the segment
+ * @return start address of the segment, EXIT_ERROR if segment cannot be created
+ */
+int AK_temp_segment_create(char *name, AK_header *header) {
+    AK_PRO;
+    int start_address;
+
+    pthread_mutex_lock(&fileMut);
+    snprintf(name, MAX_ATT_NAME, "TEMP_%06d", ++AK_temp_counter);
+    pthread_mutex_unlock(&fileMut);
+    while (AK_table_exist(name)) {
+        pthread_mutex_lock(&fileMut);
+        snprintf(name, MAX_ATT_NAME, "TEMP_%06d", ++AK_temp_counter);
+        pthread_mutex_unlock(&fileMut);
+    }
+
+    start_address = AK_initialize_new_segment(name, SEGMENT_TYPE_TEMP, header);
+    if (start_address == EXIT_ERROR) {
+        printf("AK_temp_segment_create: ERROR. Temporary segment %s cannot be created.\n", name);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    pthread_mutex_lock(&fileMut);
+    if (AK_temp_num_segments == AK_temp_capacity) {
+        AK_temp_capacity = AK_temp_capacity ? 2 * AK_temp_capacity : 16;
+        AK_temp_segments = AK_realloc(AK_temp_segments, AK_temp_capacity * MAX_ATT_NAME);
+    }
+    strcpy(AK_temp_segments[AK_temp_num_segments++], name);
+    pthread_mutex_unlock(&fileMut);
+    AK_EPI;
+    return start_address;
+}
+
+/**
+ * @brief Function ends a scope of temporary segments: segments created since AK_temp_begin returned the mark are
+          deleted, the last one first
+ * @param mark mark of the scope
+ * @return number of deleted segments
+ */
+int AK_temp_end(int mark) {
+    AK_PRO;
+    char name[MAX_ATT_NAME];
+    int deleted = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&fileMut);
+        if (AK_temp_num_segments <= mark) {
+            pthread_mutex_unlock(&fileMut);
+            break;
+        }
+        strcpy(name, AK_temp_segments[--AK_temp_num_segments]);
+        pthread_mutex_unlock(&fileMut);
+        AK_delete_segment(name, SEGMENT_TYPE_TEMP);
+        deleted++;
+    }
+    Ak_dbg_messg(MIDDLE, FILE_MAN, "AK_temp_end: %d temporary segments deleted\n", deleted);
+    AK_EPI;
+    return deleted;
+}
+
 /**
   * @author Unknown
   * @brief Test function
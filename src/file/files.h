@@ -26,6 +26,9 @@
 
 int AK_initialize_new_segment(char *name, int type, AK_header *header);
 int AK_initialize_new_index_segment(char *name, char *table_id,int attr_id , AK_header *header);
+int AK_temp_begin();
+int AK_temp_segment_create(char *name, AK_header *header);
+int AK_temp_end(int mark);
 
 void Ak_files_test();
 
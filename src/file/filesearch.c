@@ -18,11 +18,165 @@
  */
 #include "filesearch.h"
 
+/**
+ * @struct search_context
+ * @brief Structure that holds a search shared by all scan workers
+ */
+typedef struct {
+    /// search parameters
+    search_params *aspParams;
+    /// number of search parameters
+    int iNum_search_params;
+    /// header of the relation
+    AK_header *header;
+    /// number of attributes of the relation
+    int iNum_tuple_attributes;
+    /// index of attribute of every search parameter
+    int *aiSearch_attributes;
+    /// maximal number of tuples one worker stores, 0 for all tuples
+    int iLimit;
+} search_context;
+
+/**
+ * @struct search_part
+ * @brief Structure that holds tuples found by one scan worker
+ */
+typedef struct {
+    /// tuple_dict indexes of found tuples
+    int *aiTuple_addresses;
+    /// blocks of found tuples
+    int *aiBlocks;
+    /// number of found tuples
+    int iNum_tuple_addresses;
+    /// allocated size of arrays
+    int iCapacity;
+} search_part;
+
+/**
+ * @brief Filters tuples of one block as one batch: values of numeric attributes are gathered into arrays and filtered
+          by kernels from filter.c into a selection bitmap, other values are compared one by one. Called by scan workers.
+ * @param block block read by the worker
+ * @param pContext search (search_context)
+ * @param pResult tuples found by the worker (search_part)
+ * @return EXIT_SUCCESS, SCAN_SATISFIED when the worker has found as many tuples as the search is limited to
+ */
+static int AK_search_block(AK_block *block, void *pContext, void *pResult) {
+    search_context *scSearch = (search_context *) pContext;
+    search_part *spPart = (search_part *) pResult;
+    search_params *aspParams = scSearch->aspParams;
+    int i, j, iNum_rows = 0;
+    int aiRows[DATA_BLOCK_SIZE];
+    int aiValues[DATA_BLOCK_SIZE];
+    double adValues[DATA_BLOCK_SIZE];
+    unsigned char acSelection[FILTER_BITMAP_SIZE(DATA_BLOCK_SIZE)];
+
+    /// collect live tuples of the block, they are filtered as one batch
+    for (i = 0; i < DATA_BLOCK_SIZE && block->tuple_dict[i].type != FREE_INT; i += scSearch->iNum_tuple_attributes) {
+        if (block->tuple_dict[i].type != 0)
+            aiRows[iNum_rows++] = i;
+    }
+    AK_filter_bitmap_fill(acSelection, iNum_rows);
+
+    /// for all required attributes, gather numeric values of the batch and filter them, other values are compared one by one
+    for (j = 0; j < scSearch->iNum_search_params && iNum_rows > 0; j++) {
+        int iAttribute = scSearch->aiSearch_attributes[j];
+        int iType = scSearch->header[iAttribute].type;
+        int iInt_type = iType == TYPE_INT || iType == TYPE_DATE || iType == TYPE_DATETIME || iType == TYPE_TIME;
+        int iReal_type = iType == TYPE_FLOAT || iType == TYPE_NUMBER;
+
+        switch (aspParams[j].iSearchType) {
+            case SEARCH_PARTICULAR:
+            case SEARCH_RANGE:
+                /// null is stored as a varchar, a value of another type than the attribute is not gathered and not selected
+                if (iInt_type) {
+                    for (i = 0; i < iNum_rows; i++) {
+                        AK_tuple_dict *entry = &block->tuple_dict[aiRows[i] + iAttribute];
+                        aiValues[i] = 0;
+                        if (entry->type != iType)
+                            AK_filter_bitmap_clear(acSelection, i);
+                        else
+                            memcpy(&aiValues[i], block->data + entry->address, sizeof (int));
+                    }
+                    AK_filter_int_range(aiValues, iNum_rows, *((int *) aspParams[j].pData_lower),
+                            *((int *) (aspParams[j].iSearchType == SEARCH_RANGE ? aspParams[j].pData_upper : aspParams[j].pData_lower)), acSelection);
+
+                } else if (iReal_type) {
+                    for (i = 0; i < iNum_rows; i++) {
+                        AK_tuple_dict *entry = &block->tuple_dict[aiRows[i] + iAttribute];
+                        adValues[i] = 0;
+                        if (entry->type != iType)
+                            AK_filter_bitmap_clear(acSelection, i);
+                        else
+                            memcpy(&adValues[i], block->data + entry->address, sizeof (double));
+                    }
+                    AK_filter_double_range(adValues, iNum_rows, *((double *) aspParams[j].pData_lower),
+                            *((double *) (aspParams[j].iSearchType == SEARCH_RANGE ? aspParams[j].pData_upper : aspParams[j].pData_lower)), acSelection);
+
+                } else if (aspParams[j].iSearchType == SEARCH_PARTICULAR) {
+                    size_t iSearchAttributeValueSize = AK_type_size(iType, (char *) aspParams[j].pData_lower);
+
+                    for (i = 0; i < iNum_rows; i++) {
+                        AK_tuple_dict *entry = &block->tuple_dict[aiRows[i] + iAttribute];
+                        if (entry->type != iType || entry->size != iSearchAttributeValueSize
+                                || memcmp(block->data + entry->address, aspParams[j].pData_lower, iSearchAttributeValueSize))
+                            AK_filter_bitmap_clear(acSelection, i);
+                    }
+
+                } else { // other types unsupported
+                    memset(acSelection, 0, FILTER_BITMAP_SIZE(iNum_rows));
+                }
+                break;
+
+            case SEARCH_ALL: // all tuples are already selected, no action needed
+                break;
+
+            case SEARCH_NULL:
+                for (i = 0; i < iNum_rows; i++) {
+                    AK_tuple_dict *entry = &block->tuple_dict[aiRows[i] + iAttribute];
+                    if (entry->type != TYPE_VARCHAR || entry->size != strlen("NULL")
+                            || memcmp(block->data + entry->address, "NULL", strlen("NULL")))
+                        AK_filter_bitmap_clear(acSelection, i);
+                }
+                break;
+
+            default:
+                memset(acSelection, 0, FILTER_BITMAP_SIZE(iNum_rows));
+        }
+    }
+
+    /// store matched tuple addresses
+    for (i = 0; i < iNum_rows; i++) {
+        if (!FILTER_BIT(acSelection, i))
+            continue;
+
+        if (spPart->iNum_tuple_addresses == spPart->iCapacity) {
+            spPart->iCapacity = spPart->iCapacity ? 2 * spPart->iCapacity : DATA_BLOCK_SIZE;
+            spPart->aiTuple_addresses = (int *) AK_realloc(spPart->aiTuple_addresses, spPart->iCapacity * sizeof (int));
+            spPart->aiBlocks = (int *) AK_realloc(spPart->aiBlocks, spPart->iCapacity * sizeof (int));
+
+            if (spPart->aiTuple_addresses == NULL || spPart->aiBlocks == NULL) {
+                printf("AK_search_unsorted: ERROR. Cannot AK_reallocate search result, iteration %d.\n", i);
+                exit(EXIT_ERROR);
+            }
+        }
+
+        spPart->aiTuple_addresses[spPart->iNum_tuple_addresses] = aiRows[i];
+        spPart->aiBlocks[spPart->iNum_tuple_addresses] = block->address;
+        spPart->iNum_tuple_addresses++;
+        if (spPart->iNum_tuple_addresses == scSearch->iLimit)
+            return SCAN_SATISFIED;
+    }
+    return EXIT_SUCCESS;
+}
+
 /**
   * @author Miroslav Policki
   
   * @brief Searches through unsorted values of multiple attributes in a segment.
  	   Only tuples that are equal on all given attribute values are returned (A == 1 AND B == 7 AND ...).
+	   Blocks are scanned by a pool of workers (see scan.c), every worker filters tuples of its blocks with
+	   AK_search_block and results of workers are joined in the order of blocks. Blocks whose zone map shows that no
+	   value lies in a searched range, or whose Bloom filter does not hold a searched value, are not read.
 	   SEARCH_RANGE is inclusive. Only one value (or range) per attribute allowed - use search_params.pData_lower for SEARCH_PARTICULAR.
  	   Supported types for SEARCH_RANGE: TYPE_INT, TYPE_FLOAT, TYPE_NUMBER, TYPE_DATE, TYPE_DATETIME, TYPE_TIME.
            Do not provide the wrong data types in the array of search parameters. There is no way to test for that and it could cause a memory access  	violation.
@@ -34,17 +188,37 @@
 
 search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int iNum_search_params) {
     AK_PRO;
-    AK_flush_cache();
-    int iBlock;
-    AK_mem_block *mem_block = NULL, tmp;
-    int i, j, k;
-    int iTupleMatches;
+    search_result srResult = AK_search_unsorted_limit(szRelation, aspParams, iNum_search_params, 0);
+    AK_EPI;
+    return srResult;
+}
+
+/**
+  * @brief Searches like AK_search_unsorted, but returns only the first iLimit tuples in the order of blocks. Every
+           worker stops once it has found iLimit tuples, and so do workers after it, so blocks past the found tuples
+           are not read.
+  * @param szRelation relation name
+  * @param aspParams array of search parameters
+  * @param iNum_search_params number of search parameters
+  * @param iLimit maximal number of returned tuples, 0 for all tuples
+  * @return search_result structure defined in filesearch.h. Use AK_deallocate_search_result to deallocate.
+ */
+search_result AK_search_unsorted_limit(char *szRelation, search_params *aspParams, int iNum_search_params, int iLimit) {
+    AK_PRO;
+    int i, j, iNum_workers;
+    AK_zone_filter zfFilter;
     search_result srResult;
+    search_context scSearch;
+    search_part aspParts[SCAN_MAX_WORKERS];
     table_addresses *taAddresses;
+    AK_header *header;
+    AK_zone_map *zmMap;
 
     srResult.aiTuple_addresses = NULL;
     srResult.iNum_tuple_addresses = 0;
     srResult.aiSearch_attributes = NULL;
+    srResult.iNum_search_attributes = 0;
+    srResult.iNum_tuple_attributes = 0;
     srResult.aiBlocks = NULL;
 
     if (aspParams == NULL || iNum_search_params == 0){
@@ -52,147 +226,121 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int
         return srResult;
     }
 
-    taAddresses = AK_get_table_addresses(szRelation);
+    header = (AK_header *) AK_get_header(szRelation);
+    if (header == NULL) {
+        AK_EPI;
+        return srResult;
+    }
 
-    /// iterate through all the blocks
-    for (k = 0; k < MAX_EXTENTS_IN_SEGMENT && taAddresses->address_from[k] > 0; k++) { // 200 == Novak's magic number :)
-        for (iBlock = taAddresses->address_from[k]; iBlock <= taAddresses->address_to[k]; iBlock++) {
-            //mem_block = AK_get_block(iBlock);
-            mem_block = &tmp;
-            mem_block->block = AK_read_block(iBlock);
-
-            /// count number of attributes in segment/relation
-            srResult.iNum_tuple_attributes = 0;
-            for (i = 0; i < MAX_ATTRIBUTES; i++) {
-                if (mem_block->block->header[i].att_name[0] == FREE_CHAR)
-                    break;
-                srResult.iNum_tuple_attributes++;
-            }
+    /// count number of attributes in segment/relation
+    srResult.iNum_tuple_attributes = AK_num_attr(szRelation);
 
-            srResult.aiSearch_attributes = (int *) AK_malloc(iNum_search_params * sizeof (int));
-            if (srResult.aiSearch_attributes == NULL) {
-                printf("AK_search_unsorted: ERROR. Cannot allocate srResult.aiAttributes_searched.\n");
-                AK_EPI;
-                exit(EXIT_ERROR);
-            }
-            srResult.iNum_search_attributes = 0;
-
-            /// determine index of attributes on which search will be performed
-            for (j = 0; j < iNum_search_params; j++) {
-                for (i = 0; i < MAX_ATTRIBUTES; i++) {
-                    if (!strcmp(mem_block->block->header[i].att_name, aspParams[j].szAttribute)) {
-                        srResult.aiSearch_attributes[j] = i;
-                        srResult.iNum_search_attributes++;
-                        break;
-                    }
-                }
+    srResult.aiSearch_attributes = (int *) AK_malloc(iNum_search_params * sizeof (int));
+    if (srResult.aiSearch_attributes == NULL) {
+        printf("AK_search_unsorted: ERROR. Cannot allocate srResult.aiAttributes_searched.\n");
+        AK_EPI;
+        exit(EXIT_ERROR);
+    }
+
+    /// determine index of attributes on which search will be performed
+    for (j = 0; j < iNum_search_params; j++) {
+        for (i = 0; i < srResult.iNum_tuple_attributes; i++) {
+            if (!strcmp(header[i].att_name, aspParams[j].szAttribute)) {
+                srResult.aiSearch_attributes[j] = i;
+                srResult.iNum_search_attributes++;
+                break;
             }
+        }
+    }
 
-            /// if any of the provided attributes are not found in the relation, return empty result
-            if (srResult.iNum_search_attributes != iNum_search_params)
-                return srResult;
-
-            /// in every tuple, for all required attributes, compare attribute value with searched-for value and store matched tuple addresses
-            for (i = 0; i < DATA_BLOCK_SIZE && mem_block->block->tuple_dict[i].type != FREE_INT; i += srResult.iNum_tuple_attributes) {
-                iTupleMatches = 1;
-
-                for (j = 0; j < iNum_search_params && iTupleMatches; j++) {
-                    switch (aspParams[j].iSearchType) {
-                        case SEARCH_PARTICULAR:
-                        {
-                            size_t iSearchAttributeValueSize = AK_type_size(mem_block->block->header[srResult.aiSearch_attributes[j]].type, (char *) aspParams[j].pData_lower);
-
-                            if (mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].size != iSearchAttributeValueSize
-                                    || memcmp(mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address, aspParams[j].pData_lower, iSearchAttributeValueSize)) {
-                                iTupleMatches = 0;
-                            }
-                        }
-                            break;
-
-                        case SEARCH_RANGE:
-                        {
-
-                            switch (mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].type) {
-                                case TYPE_INT:
-                                case TYPE_DATE:
-                                case TYPE_DATETIME:
-                                case TYPE_TIME:
-                                {
-                                    int iAttributeValue = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address));
-                                    if (iAttributeValue < *((int *) aspParams[j].pData_lower)
-                                            || iAttributeValue > *((int *) aspParams[j].pData_upper)) {
-                                        iTupleMatches = 0;
-                                    }
-                                }
-                                    break;
-
-                                case TYPE_FLOAT:
-                                case TYPE_NUMBER:
-                                    if (*((double *) (mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address)) < *((double *) aspParams[j].pData_lower)
-                                            || *((double *) (mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address)) > *((double *) aspParams[j].pData_upper)) {
-                                        iTupleMatches = 0;
-                                    }
-                                    break;
-
-                                default: // other types unsupported
-                                    iTupleMatches = 0;
-                            }
-                        }
-                            break;
-
-                        case SEARCH_ALL: // iTupleMatches is already == 1, no action needed
-                            break;
-
-                        case SEARCH_NULL:
-                        {
-                            size_t iSearchAttributeValueSize = AK_type_size(mem_block->block->header[srResult.aiSearch_attributes[j]].type, (char *) aspParams[j].pData_lower);
-
-                            if (mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].type != TYPE_VARCHAR
-                                    || iSearchAttributeValueSize != strlen("NULL")
-                                    || memcmp(mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address, "NULL", strlen("NULL")))
-                                iTupleMatches = 0;
-                        }
-                            break;
-
-                        default:
-                            iTupleMatches = 0;
-                    }
-                }
+    /// if any of the provided attributes are not found in the relation, return empty result
+    if (srResult.iNum_search_attributes != iNum_search_params) {
+        AK_free(header);
+        AK_EPI;
+        return srResult;
+    }
 
-                if (iTupleMatches) {
-                    /*if(DEBUG) {
-                        printf("AK_realloc(srResult.aiTuple_addresses = %p, srResult.iNum_tuple_addresses++ * sizeof(int) = %d)\n", srResult.aiTuple_addresses, (srResult.iNum_tuple_addresses + 1) * sizeof(int));
-                        if(srResult.iNum_tuple_addresses == 7)
-                            puts("8");
-                    }*/
-                    srResult.iNum_tuple_addresses++;
-                    srResult.aiTuple_addresses = (int *) AK_realloc(srResult.aiTuple_addresses, srResult.iNum_tuple_addresses * sizeof (int));
-
-                    if (srResult.aiTuple_addresses == NULL) {
-                        printf("AK_search_unsorted: ERROR. Cannot AK_reallocate srResult.aiTuple_addresses, iteration %d.\n", i);
-                        AK_EPI;
-                        exit(EXIT_ERROR);
-                    }
+    /// ranges of numeric attributes and other searched values are checked against zone maps before a block is read
+    AK_zone_filter_init(&zfFilter);
+    for (j = 0; j < iNum_search_params && j < MAX_ATTRIBUTES; j++) {
+        int iType = header[srResult.aiSearch_attributes[j]].type;
+        void *pData_upper = aspParams[j].iSearchType == SEARCH_RANGE ? aspParams[j].pData_upper : aspParams[j].pData_lower;
+
+        if (aspParams[j].iSearchType != SEARCH_PARTICULAR && aspParams[j].iSearchType != SEARCH_RANGE)
+            continue;
+        if (AK_zone_map_tracked(iType)) {
+            zfFilter.range_column[zfFilter.num_ranges] = srResult.aiSearch_attributes[j];
+            zfFilter.lower[zfFilter.num_ranges] = iType == TYPE_NUMBER ? *((double *) aspParams[j].pData_lower) : *((int *) aspParams[j].pData_lower);
+            zfFilter.upper[zfFilter.num_ranges] = iType == TYPE_NUMBER ? *((double *) pData_upper) : *((int *) pData_upper);
+            zfFilter.num_ranges++;
+        } else if (aspParams[j].iSearchType == SEARCH_PARTICULAR && iType != TYPE_FLOAT) {
+            zfFilter.value_column[zfFilter.num_values] = srResult.aiSearch_attributes[j];
+            zfFilter.value[zfFilter.num_values] = (const char *) aspParams[j].pData_lower;
+            zfFilter.value_size[zfFilter.num_values] = AK_type_size(iType, (char *) aspParams[j].pData_lower);
+            zfFilter.num_values++;
+        }
+    }
+    zmMap = AK_zone_map_get(szRelation);
 
-                    /*if(DEBUG)
-                        puts("AK_realloc srResult.aiBlocks");*/
-                    srResult.aiBlocks = (int *) AK_realloc(srResult.aiBlocks, srResult.iNum_tuple_addresses * sizeof (int));
-                    if (srResult.aiBlocks == NULL) {
-                        printf("AK_search_unsorted: ERROR. Cannot AK_reallocate srResult.aiBlocks, iteration %d.\n", i);
-                        AK_EPI;
-                        exit(EXIT_ERROR);
-                    }
+    taAddresses = AK_get_table_addresses(szRelation);
 
-                    srResult.aiTuple_addresses[srResult.iNum_tuple_addresses - 1] = i;
-                    srResult.aiBlocks[srResult.iNum_tuple_addresses - 1] = iBlock;
-                }
-            }
+    /// scan blocks with workers and join their results in the order of blocks
+    scSearch.aspParams = aspParams;
+    scSearch.iNum_search_params = iNum_search_params;
+    scSearch.header = header;
+    scSearch.iNum_tuple_attributes = srResult.iNum_tuple_attributes;
+    scSearch.aiSearch_attributes = srResult.aiSearch_attributes;
+    scSearch.iLimit = iLimit > 0 ? iLimit : 0;
+    memset(aspParts, 0, sizeof (aspParts));
+    AK_filter_level();
+    iNum_workers = AK_scan_parallel(taAddresses, zmMap, &zfFilter, AK_search_block, &scSearch, aspParts, sizeof (search_part));
+
+    /// workers after the first ones that hold iLimit tuples may have found tuples before they stopped, they are dropped
+    for (i = 0; i < iNum_workers; i++) {
+        if (scSearch.iLimit > 0 && srResult.iNum_tuple_addresses + aspParts[i].iNum_tuple_addresses > scSearch.iLimit)
+            aspParts[i].iNum_tuple_addresses = scSearch.iLimit - srResult.iNum_tuple_addresses;
+        srResult.iNum_tuple_addresses += aspParts[i].iNum_tuple_addresses;
+    }
+    if (iNum_workers == 1) {
+        srResult.aiTuple_addresses = aspParts[0].aiTuple_addresses;
+        srResult.aiBlocks = aspParts[0].aiBlocks;
+    } else if (srResult.iNum_tuple_addresses > 0) {
+        srResult.aiTuple_addresses = (int *) AK_malloc(srResult.iNum_tuple_addresses * sizeof (int));
+        srResult.aiBlocks = (int *) AK_malloc(srResult.iNum_tuple_addresses * sizeof (int));
+        for (i = 0, j = 0; i < iNum_workers; j += aspParts[i].iNum_tuple_addresses, i++) {
+            memcpy(srResult.aiTuple_addresses + j, aspParts[i].aiTuple_addresses, aspParts[i].iNum_tuple_addresses * sizeof (int));
+            memcpy(srResult.aiBlocks + j, aspParts[i].aiBlocks, aspParts[i].iNum_tuple_addresses * sizeof (int));
         }
     }
+    for (i = 0; iNum_workers > 1 && i < iNum_workers; i++) {
+        AK_free(aspParts[i].aiTuple_addresses);
+        AK_free(aspParts[i].aiBlocks);
+    }
+
+    AK_free(taAddresses);
+    AK_free(header);
     AK_EPI;
     return srResult;
 }
 
+/**
+  * @brief Checks whether a relation has at least one tuple equal on all given attribute values. The search is limited
+           to one tuple, so the scan ends at the first match.
+  * @param szRelation relation name
+  * @param aspParams array of search parameters (see AK_search_unsorted)
+  * @param iNum_search_params number of search parameters
+  * @return 1 if such tuple exists, 0 otherwise
+ */
+int AK_search_exists(char *szRelation, search_params *aspParams, int iNum_search_params) {
+    AK_PRO;
+    search_result srResult = AK_search_unsorted_limit(szRelation, aspParams, iNum_search_params, 1);
+    int iExists = srResult.iNum_tuple_addresses > 0;
+
+    AK_deallocate_search_result(srResult);
+    AK_EPI;
+    return iExists;
+}
+
 /**
   * @author Miroslav Policki
   * @brief Function deallocates memory used by search result returned by AK_search_unsorted.
@@ -250,6 +398,12 @@ void Ak_filesearch_test() {
         Ak_DeleteAll_L3(&row_root);
     }
 
+    /// numbers of the last row are null, they are stored as varchar and have to be in no searched range
+    Ak_Init_L3(&row_root);
+    Ak_Insert_New_Element(TYPE_VARCHAR, "null text", "filesearch test table", "Varchar column", row_root);
+    Ak_insert_row(row_root);
+    Ak_DeleteAll_L3(&row_root);
+
     AK_free(row_root);
 
     // filesearch usage example starts here
@@ -294,6 +448,78 @@ void Ak_filesearch_test() {
         }
 
         AK_deallocate_search_result(sr);
+
+        /// the same search with scalar filter kernels has to find the same tuples
+        {
+            search_result srScalar;
+            int iLevel = AK_filter_level(), iSame;
+
+            sr = AK_search_unsorted("filesearch test table", sp, 3);
+            AK_filter_set_level(FILTER_SCALAR);
+            srScalar = AK_search_unsorted("filesearch test table", sp, 3);
+            AK_filter_set_level(iLevel);
+
+            iSame = sr.iNum_tuple_addresses == srScalar.iNum_tuple_addresses;
+            for (i = 0; iSame && i < sr.iNum_tuple_addresses; i++)
+                iSame = sr.aiTuple_addresses[i] == srScalar.aiTuple_addresses[i] && sr.aiBlocks[i] == srScalar.aiBlocks[i];
+            printf("Filter level %d and scalar filter found %d and %d tuples: %s\n", iLevel, sr.iNum_tuple_addresses,
+                    srScalar.iNum_tuple_addresses, iSame ? "SUCCESS" : "FAILED");
+
+            AK_deallocate_search_result(sr);
+            AK_deallocate_search_result(srScalar);
+        }
+
+        /// a limited search has to return the first tuples of the full search, an existence check stops at one tuple
+        {
+            search_result srLimit;
+            int iSame, iExists, iMissing, iValue = 5, iAbsent = 100;
+
+            sp[1].pData_lower = &iLower;
+            iLower = -10;
+            iUpper = 10;
+            sr = AK_search_unsorted("filesearch test table", &sp[1], 1);
+            srLimit = AK_search_unsorted_limit("filesearch test table", &sp[1], 1, 3);
+
+            iSame = srLimit.iNum_tuple_addresses == 3 && sr.iNum_tuple_addresses == 20;
+            for (i = 0; iSame && i < srLimit.iNum_tuple_addresses; i++)
+                iSame = sr.aiTuple_addresses[i] == srLimit.aiTuple_addresses[i] && sr.aiBlocks[i] == srLimit.aiBlocks[i];
+
+            sp[1].iSearchType = SEARCH_PARTICULAR;
+            sp[1].pData_lower = &iValue;
+            iExists = AK_search_exists("filesearch test table", &sp[1], 1);
+            sp[1].pData_lower = &iAbsent;
+            iMissing = AK_search_exists("filesearch test table", &sp[1], 1);
+
+            printf("Search limited to 3 of %d tuples found %d, value 5 exists: %d, value 100 exists: %d: %s\n",
+                    sr.iNum_tuple_addresses, srLimit.iNum_tuple_addresses, iExists, iMissing,
+                    iSame && iExists && !iMissing ? "SUCCESS" : "FAILED");
+
+            AK_deallocate_search_result(sr);
+            AK_deallocate_search_result(srLimit);
+        }
+
+        /// null bytes read as a number would fall into a range of all numbers
+        {
+            int iMin = INT_MIN, iMax = INT_MAX;
+            double dMin = -HUGE_VAL, dMax = HUGE_VAL;
+            search_result srDouble;
+
+            sp[1].iSearchType = SEARCH_RANGE;
+            sp[1].pData_lower = &iMin;
+            sp[1].pData_upper = &iMax;
+            sr = AK_search_unsorted("filesearch test table", &sp[1], 1);
+            sp[2].iSearchType = SEARCH_RANGE;
+            sp[2].pData_lower = &dMin;
+            sp[2].pData_upper = &dMax;
+            srDouble = AK_search_unsorted("filesearch test table", &sp[2], 1);
+
+            printf("Range of all numbers found %d int and %d float tuples without the null row: %s\n",
+                    sr.iNum_tuple_addresses, srDouble.iNum_tuple_addresses,
+                    sr.iNum_tuple_addresses == 20 && srDouble.iNum_tuple_addresses == 20 ? "SUCCESS" : "FAILED");
+
+            AK_deallocate_search_result(sr);
+            AK_deallocate_search_result(srDouble);
+        }
     }
     AK_EPI;
 }
@@ -22,6 +22,9 @@
 
 #include "../mm/memoman.h"
 #include "files.h"
+#include "filter.h"
+#include "zonemap.h"
+#include "scan.h"
 #include "../auxi/mempro.h"
 
 #define SEARCH_NULL       0
@@ -68,6 +71,8 @@ typedef struct {
 
 
 search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int iNum_search_params);
+search_result AK_search_unsorted_limit(char *szRelation, search_params *aspParams, int iNum_search_params, int iLimit);
+int AK_search_exists(char *szRelation, search_params *aspParams, int iNum_search_params);
 void AK_deallocate_search_result(search_result srResult);
 void Ak_filesearch_test();
 
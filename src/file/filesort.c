@@ -16,7 +16,9 @@
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
+#include <time.h>
 #include "filesort.h"
+#include "zonemap.h"
 
 /**
  * @author Unknown
@@ -93,95 +95,1304 @@ AK_mem_block *get_next_block(int num) {
     //memcpy(mem_block->block, temp_block, sizeof(AK_block));
     return mem_block;
 }*/
-/*
- * @author Tomislav Bobinac
- * @brief Function sorts segment
- * @return No return value.
+/// bytes of memory for rows of one run set by AK_sort_set_memory, 0 if SORT_MEMORY is used
+static int AK_sort_forced_memory = 0;
+
+/// number of run segments created so far, used to name them
+static int AK_sort_run_counter = 0;
+
+/**
+ * @struct AK_sort_order
+ * @brief Structure that records the known order of rows of one table
  */
-void AK_sort_segment(char *table_name, char *attr) {
-	//initialize variables
-	register int i, j;
-	int blocks_addr[MAX_NUM_OF_BLOCKS];	//array with block addresses
-	int num_blocks = 0;	//number of blocks in segment
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// keys rows are ordered by
+    AK_sort_key keys[MAX_ATTRIBUTES];
+    /// number of keys
+    int num_keys;
+} AK_sort_order;
 
-	AK_PRO;
+/// tables whose rows are known to be ordered (written by a sort or declared by AK_sort_set_order)
+static AK_sort_order *AK_sort_orders = NULL;
+/// number of tables in AK_sort_orders
+static int AK_sort_num_orders = 0;
 
-	//Get number of blocks for given table
-	table_addresses *addresses = (table_addresses *) AK_get_table_addresses(table_name);
-	for (i = 0; addresses->address_from[i] != 0; i++) {
-		for (j = addresses->address_from[i]; j <= addresses->address_to[i]; j++) {
-			blocks_addr[num_blocks] = j;
-			num_blocks++;
-		}
-	}
+/**
+ * @struct AK_sort_state
+ * @brief Structure that holds state of one external sort
+ */
+typedef struct {
+    /// number of attributes of sorted rows
+    int num_attr;
+    /// header of sorted rows
+    AK_header header[MAX_ATTRIBUTES];
+    /// number of keys
+    int num_keys;
+    /// attribute of every key
+    int column[MAX_ATTRIBUTES];
+    /// order of every key, SORT_ASC or SORT_DESC
+    int order[MAX_ATTRIBUTES];
+    /// rows of the run which is being generated
+    AK_iterator_buffer rows;
+    /// rows of the run in sorted order
+    int *index;
+    /// second array for merge sort of the run
+    int *temp;
+    /// number of rows index and temp can hold
+    int capacity_index;
+    /// number of leading keys that are put into normalized keys, 0 if rows are sorted only by comparing values
+    int num_normalized;
+    /// bytes of normalized key of one row
+    int key_width;
+    /// 1 if rows with equal normalized keys can still differ in their sort keys
+    int key_prefix;
+    /// normalized keys of rows of the run, each followed by the index of its row
+    unsigned char *keys;
+    /// second array for radix sort of normalized keys
+    unsigned char *keys_temp;
+    /// number of rows keys and keys_temp can hold
+    int capacity_keys;
+    /// names of run segments in the order they were written
+    char (*runs)[MAX_ATT_NAME];
+    /// number of rows of every run
+    int *run_rows;
+    /// number of runs
+    int num_runs;
+    /// number of runs names can hold
+    int capacity_runs;
+} AK_sort_state;
 
-	//create the new temp segment with size equal to the size of the original segment
-	char temp_segment[MAX_VARCHAR_LENGTH];
-	memset(temp_segment, '\0', MAX_VARCHAR_LENGTH);
-	strcat(temp_segment, "SORT_TEMP_HELP_");
-	strcat(temp_segment, table_name);
+/**
+ * @struct AK_sort_merge
+ * @brief Structure that holds a k-way merge of runs with a tournament (loser) tree. tree[0] is the input with the
+          smallest row, other nodes hold the input that lost the match played in them.
+ */
+typedef struct {
+    /// sort the runs belong to
+    AK_sort_state *sort;
+    /// number of merged runs
+    int num_inputs;
+    /// scan of every merged run
+    AK_iterator *input[SORT_MAX_FAN_IN];
+    /// 1 if a run has no more rows
+    int done[SORT_MAX_FAN_IN];
+    /// loser tree
+    int tree[SORT_MAX_FAN_IN];
+} AK_sort_merge;
 
-	AK_header *head = AK_get_header(table_name);
-	AK_initialize_new_segment(temp_segment, SEGMENT_TYPE_TABLE, head);
+/**
+ * @struct AK_sort_row
+ * @brief Structure that refers to a row of a run of a parallel sort
+ */
+typedef struct {
+    /// worker whose run holds the row
+    int run;
+    /// index of the row in the run
+    int row;
+} AK_sort_row;
 
-	//SORTING ...
-	char x[DATA_ROW_SIZE]; 		//needed data
-	char y[DATA_ROW_SIZE]; 		//data needed for comparison
-	char data[DATA_TUPLE_SIZE]; //data to be copied
+typedef struct AK_sort_worker AK_sort_worker;
 
-	AK_mem_block * real_table = (AK_mem_block*) AK_get_block(blocks_addr[0]);
+/**
+ * @struct AK_sort_worker
+ * @brief Structure that holds state of one worker of a parallel sort
+ */
+struct AK_sort_worker {
+    /// run of the worker
+    AK_sort_state sort;
+    /// 1 if rows of the worker do not fit in its memory
+    int overflow;
+    /// all workers of the sort
+    AK_sort_worker *workers;
+    /// index of the worker
+    int run;
+    /// position of the first row of the run in merged rows
+    int first;
+    /// rows merged by the previous pass
+    AK_sort_row *from;
+    /// rows merged by the current pass
+    AK_sort_row *to;
+    /// positions where merged sequences start, followed by the number of rows
+    int *bounds;
+    /// number of merged sequences
+    int num_bounds;
+    /// first row of a pass written by the worker
+    int merge_from;
+    /// row after the last row of a pass written by the worker
+    int merge_to;
+};
 
-	//get total number of headers and the number of header used to sort segment
-	int num_headers = Ak_get_total_headers(real_table->block);
-	int num_sort_header = Ak_get_header_number(real_table->block, attr);
-	int num_records = AK_get_num_records(table_name);
+/**
+ * @brief Function compares two values of the same attribute by their type: numbers by value, other values byte by
+          byte. A null value (stored as TYPE_VARCHAR in an attribute of another type) is greater than any other value.
+ * @param first first value
+ * @param second second value
+ * @return negative number, 0 or positive number if first value is smaller, equal or greater than the second one
+ */
+int AK_sort_compare_values(AK_iterator_value *first, AK_iterator_value *second) {
+    int int1, int2, size, result;
+    float float1, float2;
+    double double1, double2;
 
-	int type, temp, address, size, temp_field[num_records];
-	for (i = 0; i<num_records; i++) {
-		temp_field[i]=i;
-	}
+    if (first->type != second->type) {
+        if (first->type == TYPE_VARCHAR)
+            return 1;
+        if (second->type == TYPE_VARCHAR)
+            return -1;
+        return first->type < second->type ? -1 : 1;
+    }
 
-	for (i = 0; i < num_records - 1; i++) {
-		for (j = i + 1; j < num_records; j++) {
-			//first data -> x
-			address = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].size;
-			memset(x, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(x, real_table->block->data + address, size);
-			//second data -> y
-			address = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].size;
-			memset(y, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(y, real_table->block->data + address, size);
-
-			//comparison (x > y) ASC
-			if (strcmp(x, y) >= 0) {
-				temp=temp_field[i];
-				temp_field[i]=temp_field[j];
-				temp_field[j]=temp;
-			}//end: if(strcmp(x,y) >= 0)
-		}
-	}
+    switch (first->type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            memcpy(&int1, first->data, sizeof (int));
+            memcpy(&int2, second->data, sizeof (int));
+            return (int1 > int2) - (int1 < int2);
+        case TYPE_FLOAT:
+            memcpy(&float1, first->data, sizeof (float));
+            memcpy(&float2, second->data, sizeof (float));
+            return (float1 > float2) - (float1 < float2);
+        case TYPE_NUMBER:
+            memcpy(&double1, first->data, sizeof (double));
+            memcpy(&double2, second->data, sizeof (double));
+            return (double1 > double2) - (double1 < double2);
+        default:
+            size = first->size < second->size ? first->size : second->size;
+            result = memcmp(first->data, second->data, size);
+            if (result != 0)
+                return result;
+            return (first->size > second->size) - (first->size < second->size);
+    }
+}
 
-	for (i = 0; i<num_records; i++) {
-		//initialize new row
-		struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-		Ak_Init_L3(&row_root);
-		for (j = 0; j < num_headers; j++) {
-			//get data from column 'j' orginal table -> data
-			address = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].address;
-			size = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].size;
-			type = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].type;
-			memset(data, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(data, real_table->block->data + address, size);
-			//add column 'j' data into struct row_root
-			Ak_Insert_New_Element(type, data, temp_segment, real_table->block->header[j].att_name, row_root);
-		}
-		//add row to new sorted table
-		Ak_insert_row(row_root);
-		Ak_DeleteAll_L3(&row_root);
-	}
+/**
+ * @brief Function sets number of bytes of memory for rows of one run, for example to sort a table that fits in memory
+          as an external sort
+ * @param bytes number of bytes, 0 for SORT_MEMORY
+ * @return number of bytes that is used
+ */
+int AK_sort_set_memory(int bytes) {
+    AK_PRO;
+    AK_sort_forced_memory = bytes < 0 ? 0 : bytes;
+    AK_EPI;
+    return AK_sort_forced_memory ? AK_sort_forced_memory : SORT_MEMORY;
+}
+
+/**
+ * @brief Function compares keys of two rows of the run which is being generated
+ * @param sort external sort
+ * @param first index of the first row
+ * @param second index of the second row
+ * @return negative number, 0 or positive number if first row comes before, together with or after the second one
+ */
+static int AK_sort_compare_buffer(AK_sort_state *sort, int first, int second) {
+    AK_iterator_value value1, value2;
+    int i, result, *entry1, *entry2;
+
+    for (i = 0; i < sort->num_keys; i++) {
+        entry1 = sort->rows.entries + (first * sort->num_attr + sort->column[i]) * 3;
+        entry2 = sort->rows.entries + (second * sort->num_attr + sort->column[i]) * 3;
+        value1.type = entry1[0];
+        value1.size = entry1[1];
+        value1.data = sort->rows.data + entry1[2];
+        value2.type = entry2[0];
+        value2.size = entry2[1];
+        value2.data = sort->rows.data + entry2[2];
+        result = AK_sort_compare_values(&value1, &value2);
+        if (result != 0)
+            return sort->order[i] == SORT_DESC ? -result : result;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function compares keys of current rows of two scans
+ * @param sort external sort
+ * @param first first scan
+ * @param second second scan
+ * @return negative number, 0 or positive number if first row comes before, together with or after the second one
+ */
+static int AK_sort_compare_iterators(AK_sort_state *sort, AK_iterator *first, AK_iterator *second) {
+    int i, result;
+
+    for (i = 0; i < sort->num_keys; i++) {
+        result = AK_sort_compare_values(&first->value[sort->column[i]], &second->value[sort->column[i]]);
+        if (result != 0)
+            return sort->order[i] == SORT_DESC ? -result : result;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function sorts indexes of rows of the run which is being generated with a bottom-up merge sort. Rows with
+          equal keys keep their order.
+ * @param sort external sort
+ * @param index indexes of rows
+ * @param temp second array of the same size
+ * @param n number of indexes
+ * @return array that holds sorted indexes, index or temp
+ */
+static int *AK_sort_merge_indexes(AK_sort_state *sort, int *index, int *temp, int n) {
+    int width, low, middle, high, i, j, k;
+    int *from = index, *to = temp, *swap;
+
+    for (width = 1; width < n; width *= 2) {
+        for (low = 0; low < n; low += 2 * width) {
+            middle = low + width < n ? low + width : n;
+            high = low + 2 * width < n ? low + 2 * width : n;
+            for (i = low, j = middle, k = low; k < high; k++)
+                to[k] = i < middle && (j >= high || AK_sort_compare_buffer(sort, from[i], from[j]) <= 0) ? from[i++] : from[j++];
+        }
+        swap = from;
+        from = to;
+        to = swap;
+    }
+    return from;
+}
+
+/**
+ * @brief Function decides which sort keys are put into normalized keys: int, date, datetime and time keys as 4 bytes,
+          varchar keys as their first SORT_KEY_PREFIX bytes. Keys after a varchar key or a key of another type are
+          only compared, because a prefix does not decide order of the rest of the row.
+ * @param sort external sort
+ * @return No return value
+ */
+static void AK_sort_plan_keys(AK_sort_state *sort) {
+    int i;
+
+    sort->num_normalized = 0;
+    sort->key_width = 0;
+    sort->key_prefix = 0;
+    for (i = 0; i < sort->num_keys && !sort->key_prefix; i++) {
+        switch (sort->header[sort->column[i]].type) {
+            case TYPE_INT:
+            case TYPE_DATE:
+            case TYPE_DATETIME:
+            case TYPE_TIME:
+                //null flag and value
+                sort->key_width += 1 + sizeof (int);
+                sort->num_normalized++;
+                break;
+            case TYPE_VARCHAR:
+                sort->key_width += SORT_KEY_PREFIX;
+                sort->num_normalized++;
+                sort->key_prefix = 1;
+                break;
+            default:
+                sort->key_prefix = 1;
+        }
+    }
+    if (sort->num_normalized < sort->num_keys)
+        sort->key_prefix = 1;
+}
+
+/**
+ * @brief Function writes normalized key of one row. Bytes of normalized keys compare (as unsigned numbers, the first
+          byte is the most significant) in the same order as rows: ints are written big endian with the sign bit
+          flipped, a null is written as a set flag so it comes after all values, and descending keys are inverted.
+ * @param sort external sort
+ * @param row index of the row
+ * @param key normalized key
+ * @return No return value
+ */
+static void AK_sort_normalize_row(AK_sort_state *sort, int row, unsigned char *key) {
+    int i, j, width, *entry;
+    unsigned int number;
+    char *data;
+
+    for (i = 0; i < sort->num_normalized; i++) {
+        entry = sort->rows.entries + (row * sort->num_attr + sort->column[i]) * 3;
+        data = sort->rows.data + entry[2];
+        if (sort->header[sort->column[i]].type == TYPE_VARCHAR) {
+            width = SORT_KEY_PREFIX;
+            memset(key, 0, width);
+            memcpy(key, data, entry[1] < width ? entry[1] : width);
+        } else {
+            width = 1 + sizeof (int);
+            if (entry[0] != sort->header[sort->column[i]].type) {
+                memset(key, 0, width);
+                key[0] = 1;
+            } else {
+                memcpy(&number, data, sizeof (int));
+                number ^= 0x80000000u;
+                key[0] = 0;
+                for (j = sizeof (int); j > 0; j--, number >>= 8)
+                    key[j] = number & 0xFF;
+            }
+        }
+        if (sort->order[i] == SORT_DESC) {
+            for (j = 0; j < width; j++)
+                key[j] = ~key[j];
+        }
+        key += width;
+    }
+}
+
+/**
+ * @brief Function sorts rows of the run which is being generated by their normalized keys with an LSD radix sort of
+          (key, row) pairs, one counting pass per byte from the last one. A byte that is the same in all keys is
+          skipped. Rows whose keys are only prefixes are ordered by comparing values within groups of equal keys.
+          Radix sort is stable, so rows with equal keys keep their order.
+ * @param sort external sort
+ * @return No return value
+ */
+static void AK_sort_radix_run(AK_sort_state *sort) {
+    int n = sort->rows.num_rows, width = sort->key_width, size = sort->key_width + sizeof (int);
+    int count[256], byte, i, j, total, *group;
+    unsigned char *from, *to, *swap;
+
+    if (n > sort->capacity_keys) {
+        sort->capacity_keys = n;
+        sort->keys = (unsigned char *) AK_realloc(sort->keys, (size_t) n * size);
+        sort->keys_temp = (unsigned char *) AK_realloc(sort->keys_temp, (size_t) n * size);
+    }
+    from = sort->keys;
+    to = sort->keys_temp;
+    for (i = 0; i < n; i++) {
+        AK_sort_normalize_row(sort, i, from + (size_t) i * size);
+        memcpy(from + (size_t) i * size + width, &i, sizeof (int));
+    }
+
+    for (byte = width - 1; byte >= 0; byte--) {
+        memset(count, 0, sizeof (count));
+        for (i = 0; i < n; i++)
+            count[from[(size_t) i * size + byte]]++;
+        if (count[from[byte]] == n)
+            continue;
+        for (i = 0, total = 0; i < 256; i++) {
+            j = count[i];
+            count[i] = total;
+            total += j;
+        }
+        for (i = 0; i < n; i++)
+            memcpy(to + (size_t) count[from[(size_t) i * size + byte]]++ * size, from + (size_t) i * size, size);
+        swap = from;
+        from = to;
+        to = swap;
+    }
+    for (i = 0; i < n; i++)
+        memcpy(&sort->index[i], from + (size_t) i * size + width, sizeof (int));
+
+    if (!sort->key_prefix)
+        return;
+    for (i = 0; i < n; i = j) {
+        for (j = i + 1; j < n && memcmp(from + (size_t) i * size, from + (size_t) j * size, width) == 0; j++)
+            ;
+        if (j - i > 1) {
+            group = AK_sort_merge_indexes(sort, sort->index + i, sort->temp + i, j - i);
+            if (group != sort->index + i)
+                memcpy(sort->index + i, group, (j - i) * sizeof (int));
+        }
+    }
+}
+
+/**
+ * @brief Function sorts rows of the run which is being generated, by a radix sort of normalized keys if leading sort
+          keys can be normalized and by a merge sort that compares values otherwise. Rows with equal keys keep their
+          order, so the whole sort is stable.
+ * @param sort external sort
+ * @return No return value
+ */
+static void AK_sort_order_run(AK_sort_state *sort) {
+    int *swap, i;
+
+    if (sort->num_normalized > 0) {
+        AK_sort_radix_run(sort);
+        return;
+    }
+    for (i = 0; i < sort->rows.num_rows; i++)
+        sort->index[i] = i;
+    if (AK_sort_merge_indexes(sort, sort->index, sort->temp, sort->rows.num_rows) != sort->index) {
+        swap = sort->index;
+        sort->index = sort->temp;
+        sort->temp = swap;
+    }
+}
+
+/**
+ * @brief Function appends one row to a bulk load
+ * @param loader bulk loader
+ * @param value values of the row
+ * @param num_attr number of values
+ * @param rows_left number of rows that are still to be loaded including this one
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_sort_load_row(AK_bulk_loader *loader, AK_iterator_value *value, int num_attr, int rows_left) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], i;
+    char *data[MAX_ATTRIBUTES];
+
+    for (i = 0; i < num_attr; i++) {
+        type[i] = value[i].type;
+        size[i] = value[i].size;
+        data[i] = value[i].data;
+    }
+    return AK_bulk_add_row(loader, type, data, size, rows_left);
+}
+
+/**
+ * @brief Function writes rows of the run which is being generated to a table in sorted order and empties the run
+ * @param sort external sort
+ * @param table table the rows are written to
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_sort_write_run(AK_sort_state *sort, char *table) {
+    AK_PRO;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    AK_bulk_loader loader;
+    int i, n = sort->rows.num_rows;
+
+    AK_sort_order_run(sort);
+    if (AK_bulk_begin(&loader, table) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < n; i++) {
+        AK_iterator_buffer_get(&sort->rows, sort->index[i], value);
+        AK_sort_load_row(&loader, value, sort->num_attr, n - i);
+    }
+    AK_bulk_end(&loader);
+    sort->rows.num_rows = 0;
+    sort->rows.size = 0;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function creates an empty run segment and appends it to runs of the sort
+ * @param sort external sort
+ * @param num_rows number of rows that will be written to the run
+ * @return index of the run, EXIT_ERROR if segment could not be created
+ */
+static int AK_sort_new_run(AK_sort_state *sort, int num_rows) {
+    AK_PRO;
+    if (sort->num_runs == sort->capacity_runs) {
+        sort->capacity_runs = sort->capacity_runs ? 2 * sort->capacity_runs : 16;
+        sort->runs = AK_realloc(sort->runs, sort->capacity_runs * MAX_ATT_NAME);
+        sort->run_rows = (int *) AK_realloc(sort->run_rows, sort->capacity_runs * sizeof (int));
+    }
+    do {
+        snprintf(sort->runs[sort->num_runs], MAX_ATT_NAME, "SORT_RUN_%06d", ++AK_sort_run_counter);
+    } while (AK_table_exist(sort->runs[sort->num_runs]));
+
+    if (AK_initialize_new_segment(sort->runs[sort->num_runs], SEGMENT_TYPE_TABLE, sort->header) == EXIT_ERROR) {
+        printf("AK_sort_table: ERROR. Run segment %s cannot be created.\n", sort->runs[sort->num_runs]);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    sort->run_rows[sort->num_runs] = num_rows;
+    AK_EPI;
+    return sort->num_runs++;
+}
+
+/**
+ * @brief Function checks whether the current row of one merged run comes before the current row of another one.
+          Index num_inputs stands for a run whose row comes before all rows (used to build the tree), a run without
+          rows comes after all rows, and of two equal rows the one of the earlier run comes first.
+ * @param merge merge
+ * @param first first run
+ * @param second second run
+ * @return 1 if row of the first run comes first, 0 otherwise
+ */
+static int AK_sort_merge_less(AK_sort_merge *merge, int first, int second) {
+    int result;
+
+    if (first == merge->num_inputs)
+        return 1;
+    if (second == merge->num_inputs || merge->done[first])
+        return 0;
+    if (merge->done[second])
+        return 1;
+    result = AK_sort_compare_iterators(merge->sort, merge->input[first], merge->input[second]);
+    return result < 0 || (result == 0 && first < second);
+}
+
+/**
+ * @brief Function replays matches of a run on the path from its leaf to the root of the loser tree, after its row
+          changed. Only log2(num_inputs) rows are compared for every produced row.
+ * @param merge merge
+ * @param winner run whose row changed
+ * @return No return value
+ */
+static void AK_sort_merge_adjust(AK_sort_merge *merge, int winner) {
+    int node, loser;
+
+    for (node = (winner + merge->num_inputs) / 2; node > 0; node /= 2) {
+        if (AK_sort_merge_less(merge, merge->tree[node], winner)) {
+            loser = winner;
+            winner = merge->tree[node];
+            merge->tree[node] = loser;
+        }
+    }
+    merge->tree[0] = winner;
+}
+
+/**
+ * @brief Function merges consecutive runs into a table and deletes their segments
+ * @param sort external sort
+ * @param from first merged run
+ * @param to run after the last merged run
+ * @param table table rows are written to
+ * @return number of written rows, EXIT_ERROR if a run cannot be read
+ */
+static int AK_sort_merge_runs(AK_sort_state *sort, int from, int to, char *table) {
+    AK_PRO;
+    AK_sort_merge merge;
+    AK_bulk_loader loader;
+    int i, winner, rows_left = 0, written = 0, result = EXIT_SUCCESS;
+
+    merge.sort = sort;
+    merge.num_inputs = to - from;
+    for (i = 0; i < merge.num_inputs; i++) {
+        merge.input[i] = AK_iterator_scan(sort->runs[from + i], NULL);
+        if (AK_iterator_open(merge.input[i]) == EXIT_ERROR)
+            result = EXIT_ERROR;
+        merge.done[i] = result == EXIT_ERROR || AK_iterator_next(merge.input[i]) != ITERATOR_ROW;
+        merge.tree[i] = merge.num_inputs;
+        rows_left += sort->run_rows[from + i];
+    }
+    for (i = merge.num_inputs - 1; i >= 0; i--)
+        AK_sort_merge_adjust(&merge, i);
+
+    if (result != EXIT_ERROR && AK_bulk_begin(&loader, table) != EXIT_ERROR) {
+        while (!merge.done[merge.tree[0]]) {
+            winner = merge.tree[0];
+            AK_sort_load_row(&loader, merge.input[winner]->value, sort->num_attr, rows_left - written);
+            written++;
+            merge.done[winner] = AK_iterator_next(merge.input[winner]) != ITERATOR_ROW;
+            AK_sort_merge_adjust(&merge, winner);
+        }
+        AK_bulk_end(&loader);
+    } else {
+        printf("AK_sort_table: ERROR. Runs cannot be merged into %s.\n", table);
+        result = EXIT_ERROR;
+    }
+
+    for (i = 0; i < merge.num_inputs; i++) {
+        AK_iterator_free(merge.input[i]);
+        AK_delete_segment(sort->runs[from + i], SEGMENT_TYPE_TABLE);
+    }
+    AK_EPI;
+    return result == EXIT_ERROR ? EXIT_ERROR : written;
+}
+
+/**
+ * @brief Function frees memory of an external sort and deletes its remaining runs
+ * @param sort external sort
+ * @param first first run that still exists
+ * @return No return value
+ */
+static void AK_sort_free(AK_sort_state *sort, int first) {
+    AK_PRO;
+    int i;
+
+    for (i = first; i < sort->num_runs; i++)
+        AK_delete_segment(sort->runs[i], SEGMENT_TYPE_TABLE);
+    AK_iterator_buffer_free(&sort->rows);
+    AK_free(sort->index);
+    AK_free(sort->temp);
+    AK_free(sort->keys);
+    AK_free(sort->keys_temp);
+    AK_free(sort->runs);
+    AK_free(sort->run_rows);
+    AK_EPI;
+}
+
+/**
+ * @brief Function prepares a sort of rows of a scan by given keys
+ * @param sort sort
+ * @param scan scan of sorted rows
+ * @param keys sort keys, the first one is the most significant
+ * @param num_keys number of keys
+ * @return EXIT_SUCCESS, EXIT_ERROR if a key does not exist
+ */
+static int AK_sort_init(AK_sort_state *sort, AK_iterator *scan, AK_sort_key *keys, int num_keys) {
+    int i, j;
+
+    memset(sort, 0, sizeof (AK_sort_state));
+    sort->num_attr = scan->num_attr;
+    memcpy(sort->header, scan->header, sizeof (sort->header));
+    sort->num_keys = num_keys;
+    for (i = 0; i < num_keys; i++) {
+        for (j = 0; j < sort->num_attr && strcmp(sort->header[j].att_name, keys[i].att_name) != 0; j++)
+            ;
+        if (j == sort->num_attr) {
+            printf("AK_sort_table: ERROR. Attribute %s does not exist.\n", keys[i].att_name);
+            return EXIT_ERROR;
+        }
+        sort->column[i] = j;
+        sort->order[i] = keys[i].order;
+    }
+    AK_sort_plan_keys(sort);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function sorts a table into a new table with an external merge sort. Rows are read into memory until they
+          take the memory set by AK_sort_set_memory; then they are sorted and written to a temporary run segment.
+          Runs are merged with a tournament tree, at most as many at once as there are blocks in the same memory (and
+          SORT_MAX_FAN_IN), so large tables are merged in several passes; the last pass writes the new table. Rows that
+          fit in memory are written to the new table directly. Values are compared by their types (see
+          AK_sort_compare_values), nulls come last in ascending and first in descending order, and rows with equal
+          keys keep their order.
+ * @param srcTable name of the sorted table
+ * @param dstTable name of the new table
+ * @param keys sort keys, the first one is the most significant
+ * @param num_keys number of keys
+ * @return number of runs written to temporary segments (0 if rows were sorted in memory), EXIT_ERROR if table, key or
+           new table cannot be used
+ */
+int AK_sort_table(char *srcTable, char *dstTable, AK_sort_key *keys, int num_keys) {
+    AK_PRO;
+    AK_sort_state sort;
+    AK_iterator *scan;
+    int memory = AK_sort_forced_memory ? AK_sort_forced_memory : SORT_MEMORY;
+    int fan_in = memory / (int) sizeof (AK_block), row_memory, first, next, i, j, spilled;
+
+    if (fan_in > SORT_MAX_FAN_IN)
+        fan_in = SORT_MAX_FAN_IN;
+    if (fan_in < 2)
+        fan_in = 2;
+
+    scan = AK_iterator_scan(srcTable, NULL);
+    if (scan == NULL || num_keys < 1 || num_keys > MAX_ATTRIBUTES) {
+        printf("AK_sort_table: ERROR. Table %s cannot be sorted.\n", srcTable);
+        AK_iterator_free(scan);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (AK_sort_init(&sort, scan, keys, num_keys) == EXIT_ERROR
+            || AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, sort.header) == EXIT_ERROR) {
+        AK_iterator_free(scan);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //run generation: every full buffer of rows is sorted and spilled to a run
+    AK_iterator_buffer_init(&sort.rows, sort.num_attr);
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (sort.rows.num_rows == sort.capacity_index) {
+            sort.capacity_index = sort.capacity_index ? 2 * sort.capacity_index : 1024;
+            sort.index = (int *) AK_realloc(sort.index, sort.capacity_index * sizeof (int));
+            sort.temp = (int *) AK_realloc(sort.temp, sort.capacity_index * sizeof (int));
+        }
+        AK_iterator_buffer_add(&sort.rows, scan->value);
+        row_memory = sort.rows.size + sort.rows.num_rows * ((sort.num_attr * 3 + 2) * (int) sizeof (int)
+                + (sort.num_normalized ? 2 * (sort.key_width + (int) sizeof (int)) : 0));
+        if (row_memory >= memory) {
+            i = AK_sort_new_run(&sort, sort.rows.num_rows);
+            if (i == EXIT_ERROR || AK_sort_write_run(&sort, sort.runs[i]) == EXIT_ERROR) {
+                AK_iterator_free(scan);
+                AK_sort_free(&sort, 0);
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+        }
+    }
+    AK_iterator_free(scan);
+
+    if (sort.num_runs == 0) {
+        i = AK_sort_write_run(&sort, dstTable);
+        if (i != EXIT_ERROR)
+            AK_sort_set_order(dstTable, keys, num_keys);
+        AK_sort_free(&sort, 0);
+        AK_EPI;
+        return i == EXIT_ERROR ? EXIT_ERROR : 0;
+    }
+    if (sort.rows.num_rows > 0) {
+        i = AK_sort_new_run(&sort, sort.rows.num_rows);
+        if (i == EXIT_ERROR || AK_sort_write_run(&sort, sort.runs[i]) == EXIT_ERROR) {
+            AK_sort_free(&sort, 0);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    spilled = sort.num_runs;
+
+    //merge passes: groups of fan_in consecutive runs are merged into new runs until one pass is enough
+    for (first = 0; sort.num_runs - first > fan_in; first = next) {
+        next = sort.num_runs;
+        for (i = first; i < next; i += fan_in) {
+            int to = i + fan_in < next ? i + fan_in : next, rows = 0;
+
+            for (j = i; j < to; j++)
+                rows += sort.run_rows[j];
+            j = AK_sort_new_run(&sort, rows);
+            if (j == EXIT_ERROR || AK_sort_merge_runs(&sort, i, to, sort.runs[j]) == EXIT_ERROR) {
+                AK_sort_free(&sort, j == EXIT_ERROR ? i : to);
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            spilled++;
+        }
+        Ak_dbg_messg(MIDDLE, FILE_MAN, "AK_sort_table: %d runs merged into %d runs\n", next - first, sort.num_runs - next);
+    }
+
+    i = AK_sort_merge_runs(&sort, first, sort.num_runs, dstTable);
+    if (i != EXIT_ERROR)
+        AK_sort_set_order(dstTable, keys, num_keys);
+    AK_sort_free(&sort, sort.num_runs);
+    Ak_dbg_messg(LOW, FILE_MAN, "AK_sort_table: %d rows of %s sorted into %s with %d runs\n", i, srcTable, dstTable, spilled);
+    AK_EPI;
+    return i == EXIT_ERROR ? EXIT_ERROR : spilled;
+}
+
+/**
+ * @brief Function copies rows of one block into the run of a worker of a parallel sort. A worker whose run takes more
+          than its memory stops, so the sort can fall back to AK_sort_table.
+ * @param block block
+ * @param context memory of one worker in bytes
+ * @param result worker (AK_sort_worker)
+ * @return EXIT_SUCCESS, SCAN_SATISFIED if run of the worker does not fit in its memory
+ */
+static int AK_sort_parallel_block(AK_block *block, void *context, void *result) {
+    AK_sort_worker *worker = (AK_sort_worker *) result;
+    AK_sort_state *sort = &worker->sort;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    AK_tuple_dict *entry;
+    int slot, i, row_memory;
+
+    for (slot = 0; slot + sort->num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[slot].type != FREE_INT; slot += sort->num_attr) {
+        if (block->tuple_dict[slot].type == 0)
+            continue;
+        for (i = 0; i < sort->num_attr; i++) {
+            entry = &block->tuple_dict[slot + i];
+            value[i].type = entry->type;
+            value[i].size = entry->size;
+            value[i].data = (char *) block->data + entry->address;
+        }
+        if (sort->rows.num_rows == sort->capacity_index) {
+            sort->capacity_index = sort->capacity_index ? 2 * sort->capacity_index : 1024;
+            sort->index = (int *) AK_realloc(sort->index, sort->capacity_index * sizeof (int));
+            sort->temp = (int *) AK_realloc(sort->temp, sort->capacity_index * sizeof (int));
+        }
+        AK_iterator_buffer_add(&sort->rows, value);
+    }
+    row_memory = sort->rows.size + sort->rows.num_rows * ((sort->num_attr * 3 + 2) * (int) sizeof (int)
+            + (sort->num_normalized ? 2 * (sort->key_width + (int) sizeof (int)) : 0) + 2 * (int) sizeof (AK_sort_row));
+    if (row_memory > *((int *) context)) {
+        worker->overflow = 1;
+        return SCAN_SATISFIED;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function compares keys of two rows of runs of a parallel sort
+ * @param workers workers whose runs hold the rows
+ * @param first first row
+ * @param second second row
+ * @return negative number, 0 or positive number if first row comes before, together with or after the second one
+ */
+static int AK_sort_compare_rows(AK_sort_worker *workers, AK_sort_row *first, AK_sort_row *second) {
+    AK_sort_state *sort1 = &workers[first->run].sort, *sort2 = &workers[second->run].sort;
+    AK_iterator_value value1, value2;
+    int i, result, *entry1, *entry2;
+
+    for (i = 0; i < sort1->num_keys; i++) {
+        entry1 = sort1->rows.entries + (first->row * sort1->num_attr + sort1->column[i]) * 3;
+        entry2 = sort2->rows.entries + (second->row * sort2->num_attr + sort2->column[i]) * 3;
+        value1.type = entry1[0];
+        value1.size = entry1[1];
+        value1.data = sort1->rows.data + entry1[2];
+        value2.type = entry2[0];
+        value2.size = entry2[1];
+        value2.data = sort2->rows.data + entry2[2];
+        result = AK_sort_compare_values(&value1, &value2);
+        if (result != 0)
+            return sort1->order[i] == SORT_DESC ? -result : result;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function finds how many rows of the first of two merged sequences are among the first rows of their merge
+          (the point where a diagonal of the merge path crosses it) by a binary search. Of two equal rows the one of the
+          first sequence comes first.
+ * @param workers workers whose runs hold the rows
+ * @param first first sequence
+ * @param num_first number of rows of the first sequence
+ * @param second second sequence
+ * @param num_second number of rows of the second sequence
+ * @param diagonal number of rows of the merge
+ * @return number of rows of the first sequence
+ */
+static int AK_sort_merge_path(AK_sort_worker *workers, AK_sort_row *first, int num_first, AK_sort_row *second,
+        int num_second, int diagonal) {
+    int low = diagonal > num_second ? diagonal - num_second : 0, high = diagonal < num_first ? diagonal : num_first, i;
 
+    while (low < high) {
+        i = (low + high) / 2;
+        if (AK_sort_compare_rows(workers, &first[i], &second[diagonal - i - 1]) <= 0)
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+
+/**
+ * @brief Function sorts the run of one worker of a parallel sort and writes its rows in sorted order to the merged
+          rows, at the position of the run
+ * @param data worker (AK_sort_worker)
+ * @return NULL
+ */
+static void *AK_sort_parallel_run(void *data) {
+    AK_sort_worker *worker = (AK_sort_worker *) data;
+    int i;
+
+    AK_sort_order_run(&worker->sort);
+    for (i = 0; i < worker->sort.rows.num_rows; i++) {
+        worker->from[worker->first + i].run = worker->run;
+        worker->from[worker->first + i].row = worker->sort.index[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function writes the part of one merge pass of a parallel sort that belongs to a worker. Output of the pass is
+          split into equal ranges of rows, one per worker; for every pair of merged sequences a range overlaps, merge
+          path gives the rows of both sequences the range starts and ends with, so workers merge without waiting for
+          each other.
+ * @param data worker (AK_sort_worker)
+ * @return NULL
+ */
+static void *AK_sort_parallel_merge(void *data) {
+    AK_sort_worker *worker = (AK_sort_worker *) data;
+    AK_sort_row *first, *second, *to;
+    int pair, start, middle, end, from, until, i, j, k, num_first, num_second;
+
+    for (pair = 0; pair < worker->num_bounds; pair += 2) {
+        start = worker->bounds[pair];
+        middle = worker->bounds[pair + 1];
+        end = pair + 2 <= worker->num_bounds ? worker->bounds[pair + 2] : middle;
+        from = worker->merge_from > start ? worker->merge_from : start;
+        until = worker->merge_to < end ? worker->merge_to : end;
+        if (from >= until)
+            continue;
+
+        first = worker->from + start;
+        second = worker->from + middle;
+        num_first = middle - start;
+        num_second = end - middle;
+        i = AK_sort_merge_path(worker->workers, first, num_first, second, num_second, from - start);
+        j = from - start - i;
+        for (to = worker->to + from, k = from; k < until; k++, to++)
+            *to = i < num_first && (j >= num_second || AK_sort_compare_rows(worker->workers, &first[i], &second[j]) <= 0)
+                    ? first[i++] : second[j++];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function runs a function of a parallel sort on all workers, the calling thread is the first worker
+ * @param workers workers
+ * @param num_workers number of workers
+ * @param function function
+ * @return No return value
+ */
+static void AK_sort_parallel_start(AK_sort_worker *workers, int num_workers, void *(*function)(void *)) {
+    pthread_t threads[SCAN_MAX_WORKERS];
+    int i;
+
+    for (i = 1; i < num_workers; i++) {
+        if (pthread_create(&threads[i], NULL, function, &workers[i]) != 0) {
+            function(&workers[i]);
+            threads[i] = 0;
+        }
+    }
+    function(&workers[0]);
+    for (i = 1; i < num_workers; i++) {
+        if (threads[i] != 0)
+            pthread_join(threads[i], NULL);
+    }
+}
+
+/**
+ * @brief Function sorts a table into a new table with a pool of workers (NUMBER_OF_THREADS, see AK_scan_workers).
+          Every worker reads a contiguous range of blocks of the table and sorts its rows into a run in memory, all
+          workers at the same time. Runs are then merged in pairs, every pass by all workers: output of a pass is split
+          into equal ranges and merge path partitioning finds where every range starts in the merged runs. The merged
+          order is written to the new table. Rows are ordered as by AK_sort_table, rows with equal keys keep their
+          order. If rows of a worker do not fit in the memory set by AK_sort_set_memory, the table is sorted by
+          AK_sort_table instead.
+ * @param srcTable name of the sorted table
+ * @param dstTable name of the new table
+ * @param keys sort keys, the first one is the most significant
+ * @param num_keys number of keys
+ * @return number of workers that sorted rows, 0 if table was sorted by AK_sort_table, EXIT_ERROR if table, key or new
+           table cannot be used
+ */
+int AK_sort_table_parallel(char *srcTable, char *dstTable, AK_sort_key *keys, int num_keys) {
+    AK_PRO;
+    AK_sort_state sort;
+    AK_sort_worker *workers;
+    AK_sort_row *swap;
+    AK_iterator *scan;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    AK_bulk_loader loader;
+    table_addresses *addresses;
+    int memory = AK_sort_forced_memory ? AK_sort_forced_memory : SORT_MEMORY;
+    int bounds[SCAN_MAX_WORKERS + 1], num_bounds, num_workers, overflow = 0, n = 0, i;
+
+    scan = AK_iterator_scan(srcTable, NULL);
+    if (scan == NULL || num_keys < 1 || num_keys > MAX_ATTRIBUTES) {
+        printf("AK_sort_table_parallel: ERROR. Table %s cannot be sorted.\n", srcTable);
+        AK_iterator_free(scan);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    i = AK_sort_init(&sort, scan, keys, num_keys);
+    AK_iterator_free(scan);
+    if (i == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //run generation: every worker copies and sorts rows of its blocks
+    workers = (AK_sort_worker *) AK_calloc(SCAN_MAX_WORKERS, sizeof (AK_sort_worker));
+    for (i = 0; i < SCAN_MAX_WORKERS; i++) {
+        memcpy(&workers[i].sort, &sort, sizeof (AK_sort_state));
+        AK_iterator_buffer_init(&workers[i].sort.rows, sort.num_attr);
+    }
+    addresses = AK_get_table_addresses(srcTable);
+    num_workers = AK_scan_parallel(addresses, NULL, NULL, AK_sort_parallel_block, &memory, workers, sizeof (AK_sort_worker));
+    AK_free(addresses);
+    for (i = 0; i < num_workers; i++) {
+        overflow |= workers[i].overflow;
+        bounds[i] = n;
+        n += workers[i].sort.rows.num_rows;
+    }
+    bounds[num_workers] = n;
+
+    if (!overflow) {
+        swap = (AK_sort_row *) AK_malloc((n > 0 ? n : 1) * sizeof (AK_sort_row));
+        for (i = 0; i < num_workers; i++) {
+            workers[i].workers = workers;
+            workers[i].run = i;
+            workers[i].first = bounds[i];
+            workers[i].from = swap;
+            workers[i].merge_from = (int) ((long) n * i / num_workers);
+            workers[i].merge_to = (int) ((long) n * (i + 1) / num_workers);
+        }
+        AK_sort_parallel_start(workers, num_workers, AK_sort_parallel_run);
+
+        //merge passes: pairs of neighbouring sequences are merged until one is left
+        workers[0].to = (AK_sort_row *) AK_malloc((n > 0 ? n : 1) * sizeof (AK_sort_row));
+        for (num_bounds = num_workers; num_bounds > 1; num_bounds = (num_bounds + 1) / 2) {
+            for (i = 0; i < num_workers; i++) {
+                workers[i].from = workers[0].from;
+                workers[i].to = workers[0].to;
+                workers[i].bounds = bounds;
+                workers[i].num_bounds = num_bounds;
+            }
+            AK_sort_parallel_start(workers, num_workers, AK_sort_parallel_merge);
+            for (i = 0; i < num_bounds; i += 2)
+                bounds[i / 2] = bounds[i];
+            bounds[(num_bounds + 1) / 2] = n;
+            swap = workers[0].from;
+            workers[0].from = workers[0].to;
+            workers[0].to = swap;
+        }
+        AK_free(workers[0].to);
+    }
+
+    if (overflow) {
+        Ak_dbg_messg(LOW, FILE_MAN, "AK_sort_table_parallel: rows of %s do not fit in memory of workers\n", srcTable);
+        num_workers = AK_sort_table(srcTable, dstTable, keys, num_keys) == EXIT_ERROR ? EXIT_ERROR : 0;
+    } else if (AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, sort.header) == EXIT_ERROR
+            || AK_bulk_begin(&loader, dstTable) == EXIT_ERROR) {
+        num_workers = EXIT_ERROR;
+    } else {
+        for (i = 0; i < n; i++) {
+            AK_iterator_buffer_get(&workers[workers[0].from[i].run].sort.rows, workers[0].from[i].row, value);
+            AK_sort_load_row(&loader, value, sort.num_attr, n - i);
+        }
+        AK_bulk_end(&loader);
+        AK_sort_set_order(dstTable, keys, num_keys);
+        Ak_dbg_messg(LOW, FILE_MAN, "AK_sort_table_parallel: %d rows of %s sorted into %s by %d workers\n", n, srcTable, dstTable, num_workers);
+    }
+
+    if (!overflow)
+        AK_free(workers[0].from);
+    for (i = 0; i < SCAN_MAX_WORKERS; i++)
+        AK_sort_free(&workers[i].sort, 0);
+    AK_free(workers);
+    AK_EPI;
+    return num_workers;
+}
+
+/**
+ * @brief Function checks whether a row kept by a top-k sort comes after another one. Rows with equal keys are ordered
+          by their position in the input, as in AK_sort_table.
+ * @param sort sort
+ * @param position position in the input of every kept row
+ * @param first first row
+ * @param second second row
+ * @return 1 if the first row comes after the second one, 0 otherwise
+ */
+static int AK_sort_top_after(AK_sort_state *sort, int *position, int first, int second) {
+    int result = AK_sort_compare_buffer(sort, first, second);
+
+    return result > 0 || (result == 0 && position[first] > position[second]);
+}
+
+/**
+ * @brief Function moves a row of a top-k heap down until no row below it comes after it
+ * @param sort sort
+ * @param heap rows of the heap, the row that comes last is at the top
+ * @param position position in the input of every kept row
+ * @param num number of rows in the heap
+ * @param node index of the row in the heap
+ * @return No return value
+ */
+static void AK_sort_top_sift(AK_sort_state *sort, int *heap, int *position, int num, int node) {
+    int child, row = heap[node];
+
+    while ((child = 2 * node + 1) < num) {
+        if (child + 1 < num && AK_sort_top_after(sort, position, heap[child + 1], heap[child]))
+            child++;
+        if (!AK_sort_top_after(sort, position, heap[child], row))
+            break;
+        heap[node] = heap[child];
+        node = child;
+    }
+    heap[node] = row;
+}
+
+/**
+ * @brief Function copies rows of a top-k heap to a new buffer, so rows that were dropped from the heap do not take
+          memory any more
+ * @param sort sort
+ * @param heap rows of the heap
+ * @param position position in the input of every kept row
+ * @param num number of rows in the heap
+ * @return No return value
+ */
+static void AK_sort_top_compact(AK_sort_state *sort, int *heap, int *position, int num) {
+    AK_iterator_buffer rows;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    int i;
+
+    AK_iterator_buffer_init(&rows, sort->num_attr);
+    for (i = 0; i < num; i++) {
+        AK_iterator_buffer_get(&sort->rows, heap[i], value);
+        AK_iterator_buffer_add(&rows, value);
+        sort->temp[i] = position[heap[i]];
+        heap[i] = i;
+    }
+    memcpy(position, sort->temp, num * sizeof (int));
+    AK_iterator_buffer_free(&sort->rows);
+    sort->rows = rows;
+}
+
+/**
+ * @brief Function writes the first limit rows of a table in sort order into a new table (ORDER BY ... LIMIT). The table
+          is read once and only rows that can still be in the result are kept in memory, in a heap whose top is the
+          row that would be dropped first, so a new row either replaces the top or is dropped at once. The result is
+          the same as the first limit rows of AK_sort_table.
+ * @param srcTable name of the sorted table
+ * @param dstTable name of the new table
+ * @param keys sort keys, the first one is the most significant
+ * @param num_keys number of keys
+ * @param limit number of rows
+ * @return number of written rows, EXIT_ERROR if table, key or new table cannot be used
+ */
+int AK_sort_top(char *srcTable, char *dstTable, AK_sort_key *keys, int num_keys, int limit) {
+    AK_PRO;
+    AK_sort_state sort;
+    AK_iterator *scan;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    AK_bulk_loader loader;
+    int *heap, *position, num = 0, read = 0, row, size, i;
+
+    scan = AK_iterator_scan(srcTable, NULL);
+    if (scan == NULL || num_keys < 1 || num_keys > MAX_ATTRIBUTES || limit < 1) {
+        printf("AK_sort_top: ERROR. Table %s cannot be sorted.\n", srcTable);
+        AK_iterator_free(scan);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_sort_init(&sort, scan, keys, num_keys) == EXIT_ERROR
+            || AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, sort.header) == EXIT_ERROR) {
+        AK_iterator_free(scan);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //dropped rows stay in the buffer until it holds twice as many rows as the heap
+    heap = (int *) AK_malloc(limit * sizeof (int));
+    position = (int *) AK_malloc((2 * limit + 1) * sizeof (int));
+    sort.temp = (int *) AK_malloc(limit * sizeof (int));
+    AK_iterator_buffer_init(&sort.rows, sort.num_attr);
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        row = sort.rows.num_rows;
+        size = sort.rows.size;
+        AK_iterator_buffer_add(&sort.rows, scan->value);
+        position[row] = read++;
+        if (num < limit) {
+            heap[num++] = row;
+            if (num == limit) {
+                for (i = num / 2 - 1; i >= 0; i--)
+                    AK_sort_top_sift(&sort, heap, position, num, i);
+            }
+        } else if (AK_sort_top_after(&sort, position, heap[0], row)) {
+            heap[0] = row;
+            AK_sort_top_sift(&sort, heap, position, num, 0);
+            if (sort.rows.num_rows > 2 * limit)
+                AK_sort_top_compact(&sort, heap, position, num);
+        } else {
+            sort.rows.num_rows = row;
+            sort.rows.size = size;
+        }
+    }
+    AK_iterator_free(scan);
+
+    //heap sort: the row that comes last is moved behind the heap until the heap is empty
+    if (num < limit) {
+        for (i = num / 2 - 1; i >= 0; i--)
+            AK_sort_top_sift(&sort, heap, position, num, i);
+    }
+    for (i = num - 1; i > 0; i--) {
+        row = heap[0];
+        heap[0] = heap[i];
+        heap[i] = row;
+        AK_sort_top_sift(&sort, heap, position, i, 0);
+    }
+
+    if (AK_bulk_begin(&loader, dstTable) == EXIT_ERROR) {
+        num = EXIT_ERROR;
+    } else {
+        for (i = 0; i < num; i++) {
+            AK_iterator_buffer_get(&sort.rows, heap[i], value);
+            AK_sort_load_row(&loader, value, sort.num_attr, num - i);
+        }
+        AK_bulk_end(&loader);
+        AK_sort_set_order(dstTable, keys, num_keys);
+    }
+    Ak_dbg_messg(LOW, FILE_MAN, "AK_sort_top: %d of %d rows of %s written into %s\n", num, read, srcTable, dstTable);
+    AK_free(heap);
+    AK_free(position);
+    AK_sort_free(&sort, 0);
+    AK_EPI;
+    return num;
+}
+
+/**
+ * @brief Function records that rows of a table are ordered by keys, so operators that need ordered input (merge join)
+          can use it without sorting. Sorts record the order of tables they write; a table filled in order of a key
+          (for example by increasing ids) can be declared ordered by its creator. Every later write to the table
+          forgets the order (see AK_table_modified).
+ * @param table table name
+ * @param keys keys rows are ordered by, the first one is the most significant
+ * @param num_keys number of keys, 0 to forget the order of the table
+ * @return No return value
+ */
+void AK_sort_set_order(char *table, AK_sort_key *keys, int num_keys) {
+    AK_PRO;
+    int i;
+
+    for (i = 0; i < AK_sort_num_orders && strcmp(AK_sort_orders[i].table, table) != 0; i++)
+        ;
+    if (i == AK_sort_num_orders) {
+        if (num_keys < 1) {
+            AK_EPI;
+            return;
+        }
+        AK_sort_orders = (AK_sort_order *) AK_realloc(AK_sort_orders, (AK_sort_num_orders + 1) * sizeof (AK_sort_order));
+        AK_sort_num_orders++;
+    }
+    memset(&AK_sort_orders[i], 0, sizeof (AK_sort_order));
+    strncpy(AK_sort_orders[i].table, table, MAX_ATT_NAME - 1);
+    AK_sort_orders[i].num_keys = num_keys < MAX_ATTRIBUTES ? num_keys : MAX_ATTRIBUTES;
+    if (num_keys > 0)
+        memcpy(AK_sort_orders[i].keys, keys, AK_sort_orders[i].num_keys * sizeof (AK_sort_key));
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks whether rows of a table are known to be ordered by keys: the table has to be recorded by
+          AK_sort_set_order with the same keys, or with more keys starting with them
+ * @param table table name
+ * @param keys keys
+ * @param num_keys number of keys
+ * @return 1 if rows are known to be ordered by keys, 0 otherwise
+ */
+int AK_sort_is_ordered(char *table, AK_sort_key *keys, int num_keys) {
+    AK_PRO;
+    int i, j;
+
+    for (i = 0; i < AK_sort_num_orders && strcmp(AK_sort_orders[i].table, table) != 0; i++)
+        ;
+    if (i == AK_sort_num_orders || num_keys < 1 || num_keys > AK_sort_orders[i].num_keys) {
+        AK_EPI;
+        return 0;
+    }
+    for (j = 0; j < num_keys; j++) {
+        if (strcmp(AK_sort_orders[i].keys[j].att_name, keys[j].att_name) != 0 || AK_sort_orders[i].keys[j].order != keys[j].order) {
+            AK_EPI;
+            return 0;
+        }
+    }
+    AK_EPI;
+    return 1;
+}
+
+/**
+ * @brief Function reads sort keys from a list of attributes separated by ';', every attribute can be followed by ASC
+          or DESC (for example "value DESC;id")
+ * @param attributes list of attributes
+ * @param keys array of MAX_ATTRIBUTES keys
+ * @return number of keys
+ */
+int AK_sort_parse_keys(char *attributes, AK_sort_key *keys) {
+    AK_PRO;
+    char *start = attributes, *end, *space;
+    int num_keys = 0, length;
+
+    while (*start && num_keys < MAX_ATTRIBUTES) {
+        end = strchr(start, ';');
+        length = end ? end - start : (int) strlen(start);
+        memset(&keys[num_keys], 0, sizeof (AK_sort_key));
+        strncpy(keys[num_keys].att_name, start, length < MAX_ATT_NAME ? length : MAX_ATT_NAME - 1);
+        keys[num_keys].order = SORT_ASC;
+        space = strchr(keys[num_keys].att_name, ' ');
+        if (space) {
+            if (strcmp(space + 1, "DESC") == 0 || strcmp(space + 1, "desc") == 0)
+                keys[num_keys].order = SORT_DESC;
+            *space = '\0';
+        }
+        num_keys++;
+        start = end ? end + 1 : start + length;
+    }
+    AK_EPI;
+    return num_keys;
+}
+
+/*
+ * @author Tomislav Bobinac
+ * @brief Function sorts segment ascending by one attribute into table SORT_TEMP_HELP_<table_name> (see AK_sort_table)
+ * @return No return value.
+ */
+void AK_sort_segment(char *table_name, char *attr) {
+	char temp_segment[MAX_VARCHAR_LENGTH];
+	AK_sort_key key;
+
+	AK_PRO;
+	memset(temp_segment, '\0', MAX_VARCHAR_LENGTH);
+	strcat(temp_segment, "SORT_TEMP_HELP_");
+	strcat(temp_segment, table_name);
+
+	memset(&key, 0, sizeof (AK_sort_key));
+	strncpy(key.att_name, attr, MAX_ATT_NAME - 1);
+	key.order = SORT_ASC;
+	AK_sort_table(table_name, temp_segment, &key, 1);
 	AK_EPI;
 }
 
@@ -490,9 +1701,112 @@ void AK_block_sort(AK_block * iBlock, char * atr_name) {
 
     AK_write_block(cTemp1); //ali mislim da samo ide dirty bit
     AK_write_block(cTemp2);
+    //blocks were written past the cache, their zone maps are built again by the next scan
+    AK_zone_map_invalidate(iBlock->address);
+    AK_zone_map_invalidate(cTemp1->address);
+    AK_zone_map_invalidate(cTemp2->address);
     AK_EPI;
 }
 
+/**
+ * @brief Function checks a sorted table of the filesort test: rows have to be ordered by grp ascending and value
+          descending (nulls first), rows with equal keys by id, and ids have to be a permutation of the source ids
+ * @param table sorted table
+ * @param rows number of rows of the source table
+ * @param buffer buffer the rows are read into
+ * @return 1 if table is sorted, 0 otherwise
+ */
+static int AK_filesort_test_check(char *table, int rows, AK_iterator_buffer *buffer) {
+	AK_iterator *scan = AK_iterator_scan(table, NULL);
+	AK_iterator_value previous[3], current[3];
+	int i, result, id1, id2, sorted = 1;
+	long sum = 0;
+
+	AK_iterator_buffer_init(buffer, 3);
+	AK_iterator_open(scan);
+	while (AK_iterator_next(scan) == ITERATOR_ROW)
+		AK_iterator_buffer_add(buffer, scan->value);
+	AK_iterator_free(scan);
+
+	for (i = 0; i < buffer->num_rows; i++) {
+		AK_iterator_buffer_get(buffer, i, current);
+		memcpy(&id2, current[0].data, sizeof (int));
+		sum += id2;
+		if (i > 0) {
+			result = AK_sort_compare_values(&previous[1], &current[1]);
+			if (result == 0)
+				result = -AK_sort_compare_values(&previous[2], &current[2]);
+			memcpy(&id1, previous[0].data, sizeof (int));
+			sorted &= result < 0 || (result == 0 && id1 < id2);
+		}
+		memcpy(previous, current, sizeof (current));
+	}
+	return sorted && buffer->num_rows == rows && sum == (long) rows * (rows - 1) / 2;
+}
+
+/**
+ * @brief Function sorts rows with random int keys in memory by a radix sort of normalized keys and by a merge sort that
+          compares values
+ * @param rows number of rows
+ * @param seconds time of the radix sort and of the comparison sort
+ * @return 1 if both sorts give the same order and it is ascending, 0 otherwise
+ */
+static int AK_filesort_test_radix(int rows, double *seconds) {
+	AK_sort_state sort;
+	AK_iterator_value value[2];
+	struct timespec start, end;
+	int *radix, i, key, previous, next, result = 1;
+	unsigned int random = 12345;
+
+	memset(&sort, 0, sizeof (AK_sort_state));
+	sort.num_attr = 2;
+	strcpy(sort.header[0].att_name, "key");
+	sort.header[0].type = TYPE_INT;
+	strcpy(sort.header[1].att_name, "id");
+	sort.header[1].type = TYPE_INT;
+	sort.num_keys = 1;
+	sort.column[0] = 0;
+	sort.order[0] = SORT_ASC;
+	AK_sort_plan_keys(&sort);
+
+	AK_iterator_buffer_init(&sort.rows, 2);
+	for (i = 0; i < rows; i++) {
+		random = random * 1103515245 + 12345;
+		key = (int) random;
+		value[0].type = TYPE_INT;
+		value[0].size = sizeof (int);
+		value[0].data = (char *) &key;
+		value[1].type = TYPE_INT;
+		value[1].size = sizeof (int);
+		value[1].data = (char *) &i;
+		AK_iterator_buffer_add(&sort.rows, value);
+	}
+	sort.index = (int *) AK_malloc(rows * sizeof (int));
+	sort.temp = (int *) AK_malloc(rows * sizeof (int));
+	radix = (int *) AK_malloc(rows * sizeof (int));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	AK_sort_order_run(&sort);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds[0] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+	memcpy(radix, sort.index, rows * sizeof (int));
+
+	sort.num_normalized = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	AK_sort_order_run(&sort);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds[1] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	for (i = 0; i < rows; i++) {
+		memcpy(&next, sort.rows.data + sort.rows.entries[radix[i] * 6 + 2], sizeof (int));
+		result &= radix[i] == sort.index[i] && (i == 0 || previous <= next);
+		previous = next;
+	}
+	AK_free(radix);
+	AK_sort_free(&sort, 0);
+	return result;
+}
+
 //extern int address_of_tempBlock = 0;
 /*
  * @author Unknown, updated Tomislav Bobinac
@@ -510,5 +1824,110 @@ void Ak_filesort_test() {
 	//AK_print_table("professor2");
 	//AK_sort_segment("professor2", "firstname");
 	//AK_print_table("SORT_TEMP_HELP_professor2");
+
+	//external sort of a table that does not fit into the sort memory against the same sort in memory
+	char *table = "filesort_test";
+	AK_header header[4], *temp;
+	AK_bulk_loader loader;
+	AK_sort_key keys[2];
+	AK_iterator_buffer external, internal, top, parallel;
+	struct timespec start, end;
+	double seconds[2];
+	int type[3] = {TYPE_INT, TYPE_VARCHAR, TYPE_INT}, size[3];
+	char *data[3], group[MAX_VARCHAR_LENGTH];
+	int id, value, rows = 10000, runs[2], sorted[2], same, radix, num_keys, top_rows, top_same, workers, parallel_same, i;
+
+	printf("\n********** EXTERNAL SORT TEST **********\n\n");
+	temp = (AK_header *) AK_create_header("id", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+	memcpy(&header[0], temp, sizeof (AK_header));
+	AK_free(temp);
+	temp = (AK_header *) AK_create_header("grp", TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+	memcpy(&header[1], temp, sizeof (AK_header));
+	AK_free(temp);
+	temp = (AK_header *) AK_create_header("value", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+	memcpy(&header[2], temp, sizeof (AK_header));
+	AK_free(temp);
+	memset(&header[3], 0, sizeof (AK_header));
+	AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, header);
+
+	AK_bulk_begin(&loader, table);
+	for (id = 0; id < rows; id++) {
+		value = (id * 7919) % 1000;
+		sprintf(group, "group%d", (id * 31) % 17);
+		data[0] = (char *) &id;
+		data[1] = group;
+		//every 997th value is null
+		data[2] = id % 997 == 0 ? NULL : (char *) &value;
+		type[1] = TYPE_VARCHAR;
+		type[2] = TYPE_INT;
+		size[0] = sizeof (int);
+		size[1] = strlen(group);
+		size[2] = sizeof (int);
+		AK_bulk_add_row(&loader, type, data, size, rows - id);
+	}
+	AK_bulk_end(&loader);
+
+	memset(keys, 0, sizeof (keys));
+	strcpy(keys[0].att_name, "grp");
+	keys[0].order = SORT_ASC;
+	strcpy(keys[1].att_name, "value");
+	keys[1].order = SORT_DESC;
+
+	printf("QUERY: SELECT * FROM filesort_test ORDER BY grp ASC, value DESC;\n");
+	for (i = 0; i < 2; i++) {
+		AK_sort_set_memory(i == 0 ? 128 * 1024 : 16 * 1024 * 1024);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		runs[i] = AK_sort_table(table, i == 0 ? "filesort_external" : "filesort_internal", keys, 2);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		seconds[i] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+	}
+	AK_sort_set_memory(0);
+
+	sorted[0] = AK_filesort_test_check("filesort_external", rows, &external);
+	sorted[1] = AK_filesort_test_check("filesort_internal", rows, &internal);
+	same = external.size == internal.size && memcmp(external.data, internal.data, external.size) == 0;
+	printf("128 KiB of memory: %d runs, %.3f s, sorted: %d\n16 MiB of memory: %d runs, %.3f s, sorted: %d\n",
+		runs[0], seconds[0], sorted[0], runs[1], seconds[1], sorted[1]);
+
+	//runs sorted by a pool of workers and merged by merge path against the same sort on one thread
+	printf("\n********** PARALLEL SORT TEST **********\n\n");
+	AK_sort_set_memory(16 * 1024 * 1024);
+	AK_scan_set_workers(4);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	workers = AK_sort_table_parallel(table, "filesort_parallel", keys, 2);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	AK_scan_set_workers(0);
+	AK_sort_set_memory(0);
+	seconds[0] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+	parallel_same = AK_filesort_test_check("filesort_parallel", rows, &parallel) && workers == 4
+		&& parallel.size == internal.size && memcmp(parallel.data, internal.data, parallel.size) == 0;
+	printf("%d workers: %.3f s, one thread: %.3f s, same rows: %d\n", workers, seconds[0], seconds[1], parallel_same);
+	AK_iterator_buffer_free(&parallel);
+
+	//top 50 rows by a bounded heap against the prefix of the whole sorted table
+	printf("\n********** TOP-K SORT TEST **********\n\n");
+	printf("QUERY: SELECT * FROM filesort_test ORDER BY grp ASC, value DESC LIMIT 50;\n");
+	num_keys = AK_sort_parse_keys("grp;value DESC", keys);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	top_rows = AK_sort_top(table, "filesort_top", keys, num_keys, 50);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds[0] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+	AK_filesort_test_check("filesort_top", 0, &top);
+	top_same = num_keys == 2 && keys[1].order == SORT_DESC && top_rows == 50 && top.num_rows == 50
+		&& memcmp(top.entries, internal.entries, 50 * 3 * 3 * sizeof (int)) == 0
+		&& memcmp(top.data, internal.data, top.size) == 0;
+	printf("top-k: %d rows, %.3f s, whole sort: %.3f s, same rows: %d\n", top_rows, seconds[0], seconds[1], top_same);
+	AK_iterator_buffer_free(&top);
+	AK_iterator_buffer_free(&external);
+	AK_iterator_buffer_free(&internal);
+
+
+	//run generation by a radix sort of normalized keys against a merge sort that compares values
+	printf("\n********** RADIX SORT TEST **********\n\n");
+	rows = 1000000;
+	radix = AK_filesort_test_radix(rows, seconds);
+	printf("%d random int keys: radix sort %.3f s, comparison sort %.3f s, same order: %d\n", rows, seconds[0], seconds[1], radix);
+
+	printf("\nTest %s\n", runs[0] > 1 && runs[1] == 0 && sorted[0] && sorted[1] && same && parallel_same && top_same && radix ? "SUCCESS" : "FAILED");
 	AK_EPI;
 }
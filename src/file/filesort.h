@@ -24,6 +24,9 @@
 #include "table.h"
 #include "files.h"
 #include "fileio.h"
+#include "bulkload.h"
+#include "scan.h"
+#include "../rel/iterator.h"
 #include "../auxi/mempro.h"
 /**
   * @def DATA_ROW_SIZE
@@ -38,11 +41,59 @@
 
 #define DATA_TUPLE_SIZE 500
 
+/**
+  * @def SORT_MEMORY
+  * @brief Constant declaring default number of bytes of memory for rows of one sorted run of an external sort
+  */
+#define SORT_MEMORY (1024 * 1024)
+
+/**
+  * @def SORT_MAX_FAN_IN
+  * @brief Constant declaring maximal number of runs merged at once
+  */
+#define SORT_MAX_FAN_IN 64
+
+/**
+  * @def SORT_KEY_PREFIX
+  * @brief Constant declaring number of leading bytes of a varchar sort key that are put into its normalized key
+  */
+#define SORT_KEY_PREFIX 8
+
+/**
+  * @def SORT_ASC
+  * @brief Constant declaring ascending order of a sort key
+  */
+#define SORT_ASC 0
+
+/**
+  * @def SORT_DESC
+  * @brief Constant declaring descending order of a sort key
+  */
+#define SORT_DESC 1
+
+/**
+ * @struct AK_sort_key
+ * @brief Structure that defines one key of a sort
+ */
+typedef struct {
+    /// attribute name
+    char att_name[MAX_ATT_NAME];
+    /// SORT_ASC or SORT_DESC
+    int order;
+} AK_sort_key;
 
 
 int Ak_get_total_headers(AK_block *iBlock);
 int Ak_get_header_number(AK_block *iBlock, char *attribute_name);
 int Ak_get_num_of_tuples(AK_block *iBlock);
+int AK_sort_compare_values(AK_iterator_value *first, AK_iterator_value *second);
+int AK_sort_set_memory(int bytes);
+int AK_sort_table(char *srcTable, char *dstTable, AK_sort_key *keys, int num_keys);
+int AK_sort_table_parallel(char *srcTable, char *dstTable, AK_sort_key *keys, int num_keys);
+int AK_sort_top(char *srcTable, char *dstTable, AK_sort_key *keys, int num_keys, int limit);
+int AK_sort_parse_keys(char *attributes, AK_sort_key *keys);
+void AK_sort_set_order(char *table, AK_sort_key *keys, int num_keys);
+int AK_sort_is_ordered(char *table, AK_sort_key *keys, int num_keys);
 void AK_sort_segment(char *table_name, char *attr);
 void Ak_reset_block(AK_block * block);
 void AK_block_sort(AK_block * iBlock, char * atr_name);
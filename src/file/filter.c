@@ -0,0 +1,386 @@
+/**
+@file filter.c Provides functions for filtering batches of column values into selection bitmaps
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "filter.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FILTER_X86
+#include <immintrin.h>
+#endif
+
+/// highest kernel level supported by the processor, -1 until it is detected
+static int AK_filter_detected = -1;
+/// kernel level used by filter functions
+static int AK_filter_active = FILTER_SCALAR;
+
+/**
+ * @brief Function returns kernel level used for filtering. On first call the processor is checked for SSE2 and AVX2
+          support and the highest supported level is chosen.
+ * @return FILTER_SCALAR, FILTER_SSE2 or FILTER_AVX2
+ */
+int AK_filter_level() {
+    AK_PRO;
+    if (AK_filter_detected == -1) {
+        AK_filter_detected = FILTER_SCALAR;
+#ifdef FILTER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            AK_filter_detected = FILTER_AVX2;
+        else if (__builtin_cpu_supports("sse2"))
+            AK_filter_detected = FILTER_SSE2;
+#endif
+        AK_filter_active = AK_filter_detected;
+    }
+    AK_EPI;
+    return AK_filter_active;
+}
+
+/**
+ * @brief Function sets kernel level used for filtering, for example to compare kernels with the scalar ones
+ * @param level FILTER_SCALAR, FILTER_SSE2 or FILTER_AVX2
+ * @return level that is set, lower than requested if processor does not support it
+ */
+int AK_filter_set_level(int level) {
+    AK_PRO;
+    AK_filter_level();
+    if (level < FILTER_SCALAR)
+        level = FILTER_SCALAR;
+    AK_filter_active = level < AK_filter_detected ? level : AK_filter_detected;
+    AK_EPI;
+    return AK_filter_active;
+}
+
+/**
+ * @brief Function selects all values of a batch in selection bitmap
+ * @param bitmap selection bitmap of FILTER_BITMAP_SIZE(count) bytes
+ * @param count number of values
+ * @return No return value
+ */
+void AK_filter_bitmap_fill(unsigned char *bitmap, int count) {
+    AK_PRO;
+    memset(bitmap, 0xFF, count / 8);
+    if (count % 8)
+        bitmap[count / 8] = (1 << (count % 8)) - 1;
+    AK_EPI;
+}
+
+/**
+ * @brief Function removes one value from selection bitmap
+ * @param bitmap selection bitmap
+ * @param i index of value
+ * @return No return value
+ */
+void AK_filter_bitmap_clear(unsigned char *bitmap, int i) {
+    AK_PRO;
+    bitmap[i >> 3] &= ~(1 << (i & 7));
+    AK_EPI;
+}
+
+/**
+ * @brief Function counts selected values in selection bitmap
+ * @param bitmap selection bitmap
+ * @param count number of values
+ * @return number of selected values
+ */
+int AK_filter_bitmap_count(unsigned char *bitmap, int count) {
+    AK_PRO;
+    int i, selected = 0;
+    unsigned char byte;
+
+    for (i = 0; i < FILTER_BITMAP_SIZE(count); i++) {
+        for (byte = bitmap[i]; byte; byte &= byte - 1)
+            selected++;
+    }
+    AK_EPI;
+    return selected;
+}
+
+/**
+ * @brief Scalar kernel for AK_filter_int_range, also used for values after the last full vector
+ */
+static void AK_filter_int_range_scalar(const int *values, int from, int count, int lower, int upper, unsigned char *bitmap) {
+    int i;
+
+    for (i = from; i < count; i++) {
+        if (values[i] < lower || values[i] > upper)
+            bitmap[i >> 3] &= ~(1 << (i & 7));
+    }
+}
+
+/**
+ * @brief Scalar kernel for AK_filter_double_range, also used for values after the last full vector
+ */
+static void AK_filter_double_range_scalar(const double *values, int from, int count, double lower, double upper, unsigned char *bitmap) {
+    int i;
+
+    for (i = from; i < count; i++) {
+        if (!(values[i] >= lower && values[i] <= upper))
+            bitmap[i >> 3] &= ~(1 << (i & 7));
+    }
+}
+
+#ifdef FILTER_X86
+
+/**
+ * @brief SSE2 kernel for AK_filter_int_range, two vectors of four values give one bitmap byte
+ */
+__attribute__((target("sse2")))
+static void AK_filter_int_range_sse2(const int *values, int count, int lower, int upper, unsigned char *bitmap) {
+    __m128i lo = _mm_set1_epi32(lower), hi = _mm_set1_epi32(upper);
+    __m128i v0, v1, out0, out1;
+    int i, mask;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        v0 = _mm_loadu_si128((const __m128i *) (values + i));
+        v1 = _mm_loadu_si128((const __m128i *) (values + i + 4));
+        out0 = _mm_or_si128(_mm_cmplt_epi32(v0, lo), _mm_cmpgt_epi32(v0, hi));
+        out1 = _mm_or_si128(_mm_cmplt_epi32(v1, lo), _mm_cmpgt_epi32(v1, hi));
+        mask = _mm_movemask_ps(_mm_castsi128_ps(out0)) | (_mm_movemask_ps(_mm_castsi128_ps(out1)) << 4);
+        bitmap[i >> 3] &= ~mask;
+    }
+    AK_filter_int_range_scalar(values, i, count, lower, upper, bitmap);
+}
+
+/**
+ * @brief AVX2 kernel for AK_filter_int_range, one vector of eight values gives one bitmap byte
+ */
+__attribute__((target("avx2")))
+static void AK_filter_int_range_avx2(const int *values, int count, int lower, int upper, unsigned char *bitmap) {
+    __m256i lo = _mm256_set1_epi32(lower), hi = _mm256_set1_epi32(upper);
+    __m256i v, out;
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        v = _mm256_loadu_si256((const __m256i *) (values + i));
+        out = _mm256_or_si256(_mm256_cmpgt_epi32(lo, v), _mm256_cmpgt_epi32(v, hi));
+        bitmap[i >> 3] &= ~_mm256_movemask_ps(_mm256_castsi256_ps(out));
+    }
+    AK_filter_int_range_scalar(values, i, count, lower, upper, bitmap);
+}
+
+/**
+ * @brief SSE2 kernel for AK_filter_double_range, four vectors of two values give one bitmap byte
+ */
+__attribute__((target("sse2")))
+static void AK_filter_double_range_sse2(const double *values, int count, double lower, double upper, unsigned char *bitmap) {
+    __m128d lo = _mm_set1_pd(lower), hi = _mm_set1_pd(upper);
+    __m128d v;
+    int i, j, mask;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        mask = 0;
+        for (j = 0; j < 8; j += 2) {
+            v = _mm_loadu_pd(values + i + j);
+            mask |= _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(v, lo), _mm_cmple_pd(v, hi))) << j;
+        }
+        bitmap[i >> 3] &= mask;
+    }
+    AK_filter_double_range_scalar(values, i, count, lower, upper, bitmap);
+}
+
+/**
+ * @brief AVX2 kernel for AK_filter_double_range, two vectors of four values give one bitmap byte
+ */
+__attribute__((target("avx2")))
+static void AK_filter_double_range_avx2(const double *values, int count, double lower, double upper, unsigned char *bitmap) {
+    __m256d lo = _mm256_set1_pd(lower), hi = _mm256_set1_pd(upper);
+    __m256d v0, v1;
+    int i, mask;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        v0 = _mm256_loadu_pd(values + i);
+        v1 = _mm256_loadu_pd(values + i + 4);
+        mask = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(v0, lo, _CMP_GE_OQ), _mm256_cmp_pd(v0, hi, _CMP_LE_OQ)))
+            | (_mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(v1, lo, _CMP_GE_OQ), _mm256_cmp_pd(v1, hi, _CMP_LE_OQ))) << 4);
+        bitmap[i >> 3] &= mask;
+    }
+    AK_filter_double_range_scalar(values, i, count, lower, upper, bitmap);
+}
+
+#endif
+
+/**
+ * @brief Function filters a batch of int values (also DATE, DATETIME and TIME) by inclusive range. Values outside of
+          [lower, upper] are removed from selection bitmap, so kernels for several predicates can be applied to the
+          same bitmap. Equality predicate is a range with lower == upper.
+ * @param values gathered column values
+ * @param count number of values
+ * @param lower lower bound
+ * @param upper upper bound
+ * @param bitmap selection bitmap, initialized by AK_filter_bitmap_fill
+ * @return No return value
+ */
+void AK_filter_int_range(const int *values, int count, int lower, int upper, unsigned char *bitmap) {
+    AK_PRO;
+    switch (AK_filter_detected == -1 ? AK_filter_level() : AK_filter_active) {
+#ifdef FILTER_X86
+        case FILTER_AVX2:
+            AK_filter_int_range_avx2(values, count, lower, upper, bitmap);
+            break;
+        case FILTER_SSE2:
+            AK_filter_int_range_sse2(values, count, lower, upper, bitmap);
+            break;
+#endif
+        default:
+            AK_filter_int_range_scalar(values, 0, count, lower, upper, bitmap);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function filters a batch of double values (FLOAT and NUMBER columns) by inclusive range. Values outside of
+          [lower, upper] (and NaN) are removed from selection bitmap.
+ * @param values gathered column values
+ * @param count number of values
+ * @param lower lower bound
+ * @param upper upper bound
+ * @param bitmap selection bitmap, initialized by AK_filter_bitmap_fill
+ * @return No return value
+ */
+void AK_filter_double_range(const double *values, int count, double lower, double upper, unsigned char *bitmap) {
+    AK_PRO;
+    switch (AK_filter_detected == -1 ? AK_filter_level() : AK_filter_active) {
+#ifdef FILTER_X86
+        case FILTER_AVX2:
+            AK_filter_double_range_avx2(values, count, lower, upper, bitmap);
+            break;
+        case FILTER_SSE2:
+            AK_filter_double_range_sse2(values, count, lower, upper, bitmap);
+            break;
+#endif
+        default:
+            AK_filter_double_range_scalar(values, 0, count, lower, upper, bitmap);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function measures filter kernels of every supported level against scalar kernels. Values are filtered in
+          batches of FILTER_BATCH_SIZE, like columns gathered from blocks.
+ * @param num_values number of values of each column
+ * @param rounds how many times every column is filtered
+ * @return EXIT_SUCCESS if all levels select the same values, EXIT_ERROR otherwise
+ */
+int AK_filter_benchmark(int num_values, int rounds) {
+    AK_PRO;
+    int *ints = (int *) AK_malloc(num_values * sizeof (int));
+    double *doubles = (double *) AK_malloc(num_values * sizeof (double));
+    unsigned char bitmap[FILTER_BITMAP_SIZE(FILTER_BATCH_SIZE)];
+    const char *names[] = {"scalar", "SSE2", "AVX2"};
+    int selected[FILTER_AVX2 + 1][2];
+    double seconds[FILTER_AVX2 + 1][2];
+    int level, max_level, i, round, batch, result = EXIT_SUCCESS;
+    unsigned int seed = 12345;
+    clock_t t;
+
+    for (i = 0; i < num_values; i++) {
+        seed = seed * 1103515245 + 12345;
+        ints[i] = (int) (seed >> 8) % 100000;
+        doubles[i] = ints[i] / 100.0;
+    }
+
+    max_level = AK_filter_set_level(FILTER_AVX2);
+    for (level = FILTER_SCALAR; level <= max_level; level++) {
+        AK_filter_set_level(level);
+
+        t = clock();
+        for (round = 0; round < rounds; round++) {
+            selected[level][0] = 0;
+            for (i = 0; i < num_values; i += FILTER_BATCH_SIZE) {
+                batch = num_values - i < FILTER_BATCH_SIZE ? num_values - i : FILTER_BATCH_SIZE;
+                AK_filter_bitmap_fill(bitmap, batch);
+                AK_filter_int_range(ints + i, batch, 25000, 74999, bitmap);
+                selected[level][0] += AK_filter_bitmap_count(bitmap, batch);
+            }
+        }
+        seconds[level][0] = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+        t = clock();
+        for (round = 0; round < rounds; round++) {
+            selected[level][1] = 0;
+            for (i = 0; i < num_values; i += FILTER_BATCH_SIZE) {
+                batch = num_values - i < FILTER_BATCH_SIZE ? num_values - i : FILTER_BATCH_SIZE;
+                AK_filter_bitmap_fill(bitmap, batch);
+                AK_filter_double_range(doubles + i, batch, 100.0, 199.99, bitmap);
+                selected[level][1] += AK_filter_bitmap_count(bitmap, batch);
+            }
+        }
+        seconds[level][1] = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+        if (selected[level][0] != selected[FILTER_SCALAR][0] || selected[level][1] != selected[FILTER_SCALAR][1])
+            result = EXIT_ERROR;
+        printf("%-6s int range: %d selected, %f s   double range: %d selected, %f s\n", names[level],
+                selected[level][0], seconds[level][0], selected[level][1], seconds[level][1]);
+    }
+
+    for (level = FILTER_SCALAR + 1; level <= max_level; level++) {
+        printf("%s speedup over scalar: int %.2fx, double %.2fx\n", names[level],
+                seconds[level][0] > 0 ? seconds[FILTER_SCALAR][0] / seconds[level][0] : 0,
+                seconds[level][1] > 0 ? seconds[FILTER_SCALAR][1] / seconds[level][1] : 0);
+    }
+
+    AK_filter_set_level(max_level);
+    AK_free(ints);
+    AK_free(doubles);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function for testing filter kernels
+ * @return No return value
+ */
+void AK_filter_test() {
+    AK_PRO;
+    int values[21], level, max_level, i, passed = 1;
+    double reals[21];
+    unsigned char bitmap[FILTER_BITMAP_SIZE(21)];
+
+    printf("\n********** FILTER TEST **********\n\n");
+
+    for (i = 0; i < 21; i++) {
+        values[i] = i - 10;
+        reals[i] = (i - 10) / 2.0;
+    }
+
+    max_level = AK_filter_set_level(FILTER_AVX2);
+    for (level = FILTER_SCALAR; level <= max_level; level++) {
+        AK_filter_set_level(level);
+
+        //-5 <= value <= 5 AND -2.0 <= real <= 4.0 (-4 <= value <= 8), tail of 5 values is filtered by scalar code
+        AK_filter_bitmap_fill(bitmap, 21);
+        AK_filter_int_range(values, 21, -5, 5, bitmap);
+        AK_filter_double_range(reals, 21, -2.0, 4.0, bitmap);
+        printf("Level %d: %d selected, first %d, last %d\n", level, AK_filter_bitmap_count(bitmap, 21),
+                FILTER_BIT(bitmap, 6) ? values[6] : 0, FILTER_BIT(bitmap, 15) ? values[15] : 0);
+        passed &= AK_filter_bitmap_count(bitmap, 21) == 10 && !FILTER_BIT(bitmap, 5) && FILTER_BIT(bitmap, 6)
+            && FILTER_BIT(bitmap, 15) && !FILTER_BIT(bitmap, 16);
+
+        //equality
+        AK_filter_bitmap_fill(bitmap, 21);
+        AK_filter_int_range(values, 21, 7, 7, bitmap);
+        passed &= AK_filter_bitmap_count(bitmap, 21) == 1 && FILTER_BIT(bitmap, 17);
+    }
+
+    printf("\nBenchmark of filter kernels on 4000000 values:\n");
+    passed &= AK_filter_benchmark(4000000, 5) == EXIT_SUCCESS;
+
+    printf("\nTest %s\n", passed ? "SUCCESS" : "FAILED");
+    AK_EPI;
+}
@@ -0,0 +1,74 @@
+/**
+@file filter.h Header file that provides functions for filtering batches of column values into selection bitmaps
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef FILTER
+#define FILTER
+
+#include <time.h>
+#include "../auxi/constants.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def FILTER_SCALAR
+  * @brief Constant declaring filter kernels which compare one value at a time
+  */
+#define FILTER_SCALAR 0
+
+/**
+  * @def FILTER_SSE2
+  * @brief Constant declaring filter kernels which use 128 bit SSE2 instructions
+  */
+#define FILTER_SSE2 1
+
+/**
+  * @def FILTER_AVX2
+  * @brief Constant declaring filter kernels which use 256 bit AVX2 instructions
+  */
+#define FILTER_AVX2 2
+
+/**
+  * @def FILTER_BATCH_SIZE
+  * @brief Constant declaring number of values filtered in one batch by AK_filter_benchmark, large enough that call
+           overhead does not hide the kernels
+  */
+#define FILTER_BATCH_SIZE 65536
+
+/**
+  * @def FILTER_BITMAP_SIZE
+  * @brief Macro which returns number of bytes of a selection bitmap for count values
+  */
+#define FILTER_BITMAP_SIZE(count) (((count) + 7) / 8)
+
+/**
+  * @def FILTER_BIT
+  * @brief Macro which returns bit of value i in selection bitmap
+  */
+#define FILTER_BIT(bitmap, i) (((bitmap)[(i) >> 3] >> ((i) & 7)) & 1)
+
+int AK_filter_level();
+int AK_filter_set_level(int level);
+void AK_filter_bitmap_fill(unsigned char *bitmap, int count);
+void AK_filter_bitmap_clear(unsigned char *bitmap, int i);
+int AK_filter_bitmap_count(unsigned char *bitmap, int count);
+void AK_filter_int_range(const int *values, int count, int lower, int upper, unsigned char *bitmap);
+void AK_filter_double_range(const double *values, int count, double lower, double upper, unsigned char *bitmap);
+int AK_filter_benchmark(int num_values, int rounds);
+void AK_filter_test();
+
+#endif
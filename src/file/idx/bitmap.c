@@ -210,6 +210,7 @@
                         printf("\nINDEX %s CREATED!\n", indexName);
                         //funtion that fills index with attribute values
                         Ak_create_Index(tblName, indexName, (temp_head + i)->att_name, i, num_attr, t_header);
+                        AK_index_set_current(tblName, indexName);
                     }
 
                     break;
@@ -250,6 +251,7 @@
                     {
                         printf("\nINDEX %s CREATED!\n", indexName);
                         Ak_create_Index(tblName, indexName, (temp_head + i)->att_name, i, num_attr, t_header);
+                        AK_index_set_current(tblName, indexName);
                     }
                     break;
                 }
@@ -450,8 +452,6 @@
                         }
                         break;
                     }
-                    if ((k + 1) % num_attr == 0)
-                        printf("\n");
                 }
             }
         }
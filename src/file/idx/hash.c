@@ -21,28 +21,66 @@
 #include "hash.h"
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function for computing a hash value from varchar or integer
-  * @param elem element of row for wich value is to be computed
-  * @return hash value
- 
+ * @brief Function reads a block of a hash index or its table through the cache. Blocks are read and written through
+          the cache, since free space of index blocks is looked up in the cache (AK_find_AK_free_space) and rows
+          inserted into tables may not be written to disk yet.
+ * @param address address of the block
+ * @return copy of the block
  */
-int AK_elem_hash_value(struct list_node *elem) {
-    int type = elem->type, value = 0, i = 0;
-    char temp_char[MAX_VARCHAR_LENGTH];
-    AK_PRO;
+static AK_block *AK_hash_read_block(int address) {
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+
+    memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+    return block;
+}
+
+/**
+ * @brief Function writes a block of a hash index to the cache
+ * @param block block read by AK_hash_read_block
+ * @return No return value
+ */
+static void AK_hash_write_block(AK_block *block) {
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(block->address);
+
+    memcpy(mem_block->block, block, sizeof (AK_block));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @brief Function computes a hash value of a varchar or integer value
+ * @param type type of value (TYPE_INT or TYPE_VARCHAR)
+ * @param data value
+ * @param size size of value
+ * @return hash value, 0 for other types
+ */
+int AK_hash_value(int type, char *data, int size) {
+    int value = 0, i = 0;
+
     switch (type) {
         case TYPE_INT:
-            memcpy(&value, elem->data, elem->size);
+            memcpy(&value, data, size);
             break;
         case TYPE_VARCHAR:
-            memcpy(temp_char, elem->data, elem->size);
-            temp_char[ elem->size ] = '\0';
             do {
-                value += (int) temp_char[i++];
-            } while (temp_char[i]);
+                value += i < size ? (int) data[i] : 0;
+                i++;
+            } while (i < size);
             break;
     }
+    return value;
+}
+
+/**
+  * @author Mislav Čakarić
+  * @brief Function for computing a hash value from varchar or integer
+  * @param elem element of row for wich value is to be computed
+  * @return hash value
+ 
+ */
+int AK_elem_hash_value(struct list_node *elem) {
+    int value;
+    AK_PRO;
+    value = AK_hash_value(elem->type, elem->data, elem->size);
     AK_EPI;
     return value;
 }
@@ -70,7 +108,7 @@ struct_add* Ak_insert_bucket_to_block(char *indexName, char *data, int type) {
         return add;
     }
 
-    AK_block *block = (AK_block*) AK_read_block(adr_to_write);
+    AK_block *block = (AK_block*) AK_hash_read_block(adr_to_write);
 
     Ak_dbg_messg(HIGH, INDICES, "insert_bucket_to_block: Position to write (tuple_dict_index) %d\n", adr_to_write);
 
@@ -89,7 +127,7 @@ struct_add* Ak_insert_bucket_to_block(char *indexName, char *data, int type) {
     block->tuple_dict[id].type = type;
     block->tuple_dict[id].size = size;
     block->last_tuple_dict_id = id;
-    AK_write_block(block);
+    AK_hash_write_block(block);
 
     add->addBlock = adr_to_write;
     add->indexTd = id;
@@ -106,11 +144,11 @@ struct_add* Ak_insert_bucket_to_block(char *indexName, char *data, int type) {
  */
 void Ak_update_bucket_in_block(struct_add *add, char *data) {
     AK_PRO;
-    AK_block *block = (AK_block*) AK_read_block(add->addBlock);
+    AK_block *block = (AK_block*) AK_hash_read_block(add->addBlock);
     int address = block->tuple_dict[add->indexTd].address;
     int size = block->tuple_dict[add->indexTd].size;
     memcpy(&block->data[address], data, size);
-    AK_write_block(block);
+    AK_hash_write_block(block);
     AK_EPI;
 }
 
@@ -130,7 +168,7 @@ void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int h
     if (block_add == 0) {
         printf("Hash index does not exist!\n");
     }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
+    AK_block *block = (AK_block*) AK_hash_read_block(block_add);
     hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
     info->modulo = modulo;
     info->main_bucket_num = main_bucket_num;
@@ -140,7 +178,7 @@ void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int h
     block->tuple_dict[0].address = 0;
     block->tuple_dict[0].type = INFO_BUCKET;
     block->tuple_dict[0].size = sizeof (hash_info);
-    AK_write_block(block);
+    AK_hash_write_block(block);
     AK_EPI;
 }
 
@@ -161,7 +199,7 @@ hash_info* AK_get_hash_info(char *indexName) {
 	AK_EPI;
         return info;
     }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
+    AK_block *block = (AK_block*) AK_hash_read_block(block_add);
     memcpy(info, block->data, sizeof (hash_info));
     AK_EPI;
     return info;
@@ -183,10 +221,9 @@ struct_add* Ak_get_nth_main_bucket_add(char *indexName, int n) {
     table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
     while (addresses->address_from[i]) {
         for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
+            AK_block *temp = (AK_block*) AK_hash_read_block(j);
+            //buckets of blocks other than the first start at tuple_dict 1 (see Ak_insert_bucket_to_block)
+            for (k = 0; k <= temp->last_tuple_dict_id && k < DATA_BLOCK_SIZE; k++) {
                 if (temp->tuple_dict[k].type == MAIN_BUCKET) {
                     if (n == counter) {
                         add->addBlock = j;
@@ -197,6 +234,7 @@ struct_add* Ak_get_nth_main_bucket_add(char *indexName, int n) {
                     counter++;
                 }
             }
+            AK_free(temp);
             if (end) break;
         }
         i++;
@@ -252,12 +290,13 @@ void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
             Ak_update_bucket_in_block(main_add, data);
             AK_change_hash_info(indexName, MAIN_BUCKET_SIZE, 1, MAIN_BUCKET_SIZE);
         }
-        int hash_bucket_id = hashValue % info->modulo;
+        //hash values are unsigned, so negative sums of values get a bucket too
+        int hash_bucket_id = (unsigned int) hashValue % info->modulo;
         int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
 
         main_add = Ak_get_nth_main_bucket_add(indexName, main_bucket_id);
         //printf("2. Block broj:%d, indexTd:%d\n", main_add->addBlock, main_add->indexTd);
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
+        AK_block *temp_block = (AK_block*) AK_hash_read_block(main_add->addBlock);
         address = temp_block->tuple_dict[main_add->indexTd].address;
         size = temp_block->tuple_dict[main_add->indexTd].size;
         memcpy(temp_main_bucket, &temp_block->data[address], size);
@@ -265,7 +304,7 @@ void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
         memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
         //printf("3. Block broj:%d, indexTd:%d\n", hash_add->addBlock, hash_add->indexTd);
 
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
+        temp_block = (AK_block*) AK_hash_read_block(hash_add->addBlock);
         address = temp_block->tuple_dict[hash_add->indexTd].address;
         size = temp_block->tuple_dict[hash_add->indexTd].size;
         memcpy(temp_hash_bucket, &temp_block->data[address], size);
@@ -285,7 +324,7 @@ void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
                 //adding new main buckets
                 for (i = 0; i < info->main_bucket_num; i++) {
                     main_add = Ak_get_nth_main_bucket_add(indexName, i);
-                    AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
+                    AK_block *temp_block = (AK_block*) AK_hash_read_block(main_add->addBlock);
                     address = temp_block->tuple_dict[main_add->indexTd].address;
                     size = temp_block->tuple_dict[main_add->indexTd].size;
                     memcpy(data, &temp_block->data[address], size);
@@ -317,7 +356,7 @@ void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
             Ak_update_bucket_in_block(hash_add, data);
 
             main_add = Ak_get_nth_main_bucket_add(indexName, main_bucket_id2);
-            temp_block = (AK_block*) AK_read_block(main_add->addBlock);
+            temp_block = (AK_block*) AK_hash_read_block(main_add->addBlock);
             address = temp_block->tuple_dict[main_add->indexTd].address;
             size = temp_block->tuple_dict[main_add->indexTd].size;
             memcpy(temp_main_bucket, &temp_block->data[address], size);
@@ -373,24 +412,25 @@ struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *valu
         memset(data, 0, 255);
         hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
         info = AK_get_hash_info(indexName);
-        int hash_bucket_id = hashValue % info->modulo;
+        //hash values are unsigned, so negative sums of values get a bucket too
+        int hash_bucket_id = (unsigned int) hashValue % info->modulo;
         int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
 
         main_add = Ak_get_nth_main_bucket_add(indexName, main_bucket_id);
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
+        AK_block *temp_block = (AK_block*) AK_hash_read_block(main_add->addBlock);
         address = temp_block->tuple_dict[main_add->indexTd].address;
         size = temp_block->tuple_dict[main_add->indexTd].size;
         memcpy(temp_main_bucket, &temp_block->data[address], size);
 
         memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
 
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
+        temp_block = (AK_block*) AK_hash_read_block(hash_add->addBlock);
         address = temp_block->tuple_dict[hash_add->indexTd].address;
         size = temp_block->tuple_dict[hash_add->indexTd].size;
         memcpy(temp_hash_bucket, &temp_block->data[address], size);
         for (i = 0; i < HASH_BUCKET_SIZE; i++) {
             if (temp_hash_bucket->element[i].value == hashValue) {
-                AK_block *temp_table_block = (AK_block*) AK_read_block(temp_hash_bucket->element[i].add.addBlock);
+                AK_block *temp_table_block = (AK_block*) AK_hash_read_block(temp_hash_bucket->element[i].add.addBlock);
                 j = 0;
                 while (strcmp(temp_block->header[j].att_name, "\0")) {
                     k = 0;
@@ -512,11 +552,12 @@ int AK_create_hash_index(char *tblName, struct list_node *attributes, char *inde
     }
     memset(i_header + n, 0, MAX_ATTRIBUTES - n);
 
-    int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
+    //hash index functions find the index in AK_index, so it is registered there and not with tables in AK_relation
+    int startAddress = AK_initialize_new_index_segment(indexName, tblName, AK_get_attr_index(tblName, Ak_First_L2(attributes)->data), i_header);
     if (startAddress != EXIT_ERROR)
         printf("\nINDEX %s CREATED!\n", indexName);
 
-    AK_block *block = (AK_block*) AK_read_block(startAddress);
+    AK_block *block = (AK_block*) AK_hash_read_block(startAddress);
     hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
     info->modulo = 4;
     info->main_bucket_num = 0;
@@ -527,7 +568,7 @@ int AK_create_hash_index(char *tblName, struct list_node *attributes, char *inde
     block->tuple_dict[0].size = sizeof (hash_info);
     block->AK_free_space += sizeof (hash_info);
     block->last_tuple_dict_id = 0;
-    AK_write_block(block);
+    AK_hash_write_block(block);
 
     struct list_node *temp_elem;
 
@@ -538,7 +579,7 @@ int AK_create_hash_index(char *tblName, struct list_node *attributes, char *inde
     n = 0;
     while (addresses->address_from[ i ]) {
         for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
+            AK_block *temp = (AK_block*) AK_hash_read_block(j);
             for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
                 n++;
                 if (temp->tuple_dict[k].type == FREE_INT)
@@ -560,7 +601,8 @@ int AK_create_hash_index(char *tblName, struct list_node *attributes, char *inde
                         if (strcmp((table_header + l)->att_name, attribute->data) == 0)
                             break;
                     }
-                    temp_elem = Ak_GetNth_L2(l, row);
+                    //positions of list elements start with 1
+                    temp_elem = Ak_GetNth_L2(l + 1, row);
                     hashValue += AK_elem_hash_value(temp_elem);
 
                     attribute = attribute->next;
@@ -576,10 +618,103 @@ int AK_create_hash_index(char *tblName, struct list_node *attributes, char *inde
         }
         i++;
     }
+    AK_index_set_current(tblName, indexName);
     AK_EPI;
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Function writes the name of the hash index of a table on attributes: table name followed by attribute names
+          and "_hashIndex" (as bitmap indexes are named table + attribute + "_bmapIndex"). Operators that can use a
+          hash index (index nested-loop join) look for it by this name.
+ * @param tblName table name
+ * @param attributes indexed attributes
+ * @param indexName array of MAX_VARCHAR_LENGTH characters the name is written to
+ * @return No return value
+ */
+void AK_hash_index_name(char *tblName, struct list_node *attributes, char *indexName) {
+    AK_PRO;
+    struct list_node *attribute;
+
+    snprintf(indexName, MAX_VARCHAR_LENGTH, "%s", tblName);
+    for (attribute = (struct list_node *) Ak_First_L2(attributes); attribute != NULL; attribute = attribute->next)
+        snprintf(indexName + strlen(indexName), MAX_VARCHAR_LENGTH - strlen(indexName), "%s", attribute->data);
+    snprintf(indexName + strlen(indexName), MAX_VARCHAR_LENGTH - strlen(indexName), "_hashIndex");
+    AK_EPI;
+}
+
+/**
+ * @brief Function reads addresses of all hash buckets of a hash index at once, so a lookup of many values (index
+          nested-loop join) reads only one hash bucket per value instead of searching main buckets every time
+ * @param indexName name of index
+ * @param modulo number of hash buckets (modulo of the hash function) is written to it
+ * @return array of modulo addresses of hash buckets, NULL if index does not exist or is empty
+ */
+struct_add *AK_get_hash_buckets(char *indexName, int *modulo) {
+    AK_PRO;
+    table_addresses *addresses = (table_addresses *) AK_get_index_addresses(indexName);
+    hash_info *info;
+    main_bucket bucket;
+    struct_add *buckets = NULL;
+    AK_block *block;
+    int i, j, k, l, n = 0;
+
+    *modulo = 0;
+    if (addresses->address_from[0] == 0) {
+        AK_free(addresses);
+        AK_EPI;
+        return NULL;
+    }
+    info = AK_get_hash_info(indexName);
+    if (info->main_bucket_num > 0) {
+        *modulo = info->modulo;
+        buckets = (struct_add *) AK_calloc(info->main_bucket_num * MAIN_BUCKET_SIZE, sizeof (struct_add));
+        //main buckets are stored in the order of their numbers
+        for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] && n < info->main_bucket_num; i++) {
+            for (j = addresses->address_from[i]; j < addresses->address_to[i] && n < info->main_bucket_num; j++) {
+                block = (AK_block *) AK_hash_read_block(j);
+                for (k = 0; k <= block->last_tuple_dict_id && k < DATA_BLOCK_SIZE && n < info->main_bucket_num; k++) {
+                    if (block->tuple_dict[k].type != MAIN_BUCKET)
+                        continue;
+                    memcpy(&bucket, &block->data[block->tuple_dict[k].address], sizeof (main_bucket));
+                    for (l = 0; l < MAIN_BUCKET_SIZE; l++)
+                        memcpy(&buckets[n * MAIN_BUCKET_SIZE + l], &bucket.element[l].add, sizeof (struct_add));
+                    n++;
+                }
+                AK_free(block);
+            }
+        }
+    }
+    AK_free(info);
+    AK_free(addresses);
+    AK_EPI;
+    return buckets;
+}
+
+/**
+ * @brief Function finds addresses of rows with a hash value in a hash bucket. Different values can have the same hash
+          value, so values of the rows have to be compared with the searched values.
+ * @param bucket address of the hash bucket (see AK_get_hash_buckets)
+ * @param hashValue hash value
+ * @param adds array of HASH_BUCKET_SIZE addresses the addresses of rows are written to
+ * @return number of rows
+ */
+int AK_find_in_hash_bucket(struct_add *bucket, int hashValue, struct_add *adds) {
+    AK_PRO;
+    AK_block *block = (AK_block *) AK_hash_read_block(bucket->addBlock);
+    hash_bucket temp_hash_bucket;
+    int i, num = 0;
+
+    memcpy(&temp_hash_bucket, &block->data[block->tuple_dict[bucket->indexTd].address], sizeof (hash_bucket));
+    for (i = 0; i < HASH_BUCKET_SIZE; i++) {
+        if (temp_hash_bucket.element[i].value == (unsigned int) hashValue)
+            memcpy(&adds[num++], &temp_hash_bucket.element[i].add, sizeof (struct_add));
+    }
+    AK_free(block);
+    AK_EPI;
+    return num;
+}
+
 void AK_delete_hash_index(char *indexName) {
     AK_PRO;
     AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
@@ -623,14 +758,25 @@ void Ak_hash_test() {
     int i, num_rec = AK_get_num_records(tblName);
     for (i = 0; i < num_rec; i++) {
         row = AK_get_row(i, tblName);
-        struct list_node *value = Ak_GetNth_L2(0, row);
+        struct list_node *value = Ak_GetNth_L2(1, row);
         Ak_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        value = Ak_GetNth_L2(1, row);
+        value = Ak_GetNth_L2(2, row);
         Ak_InsertAtEnd_L3(value->type, value->data, value->size, values);
         struct_add *add = AK_find_in_hash_index(indexName, values);
         Ak_DeleteAll_L3(&values);
-        if (add->addBlock && add->indexTd)
+        if (add->addBlock && add->indexTd) {
             printf("Record found in table block %d and TupleDict ID %d\n", add->addBlock, add->indexTd);
+            AK_rid rid;
+            rid.block = add->addBlock;
+            rid.slot = add->indexTd;
+            struct list_node *fetched = AK_fetch_by_rid(rid, tblName);
+            if (fetched != NULL) {
+                printf("Fetched by RID: %d %s\n", *((int *) Ak_GetNth_L2(1, fetched)->data), Ak_GetNth_L2(2, fetched)->data);
+                Ak_DeleteAll_L3(&fetched);
+                AK_free(fetched);
+            }
+        }
+        AK_free(add);
     }
     printf("hash_test: Present!\n");
     AK_EPI;
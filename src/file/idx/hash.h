@@ -75,6 +75,7 @@ typedef struct {
     bucket_elem element[HASH_BUCKET_SIZE];
 } hash_bucket;
 
+int AK_hash_value(int type, char *data, int size);
 int AK_elem_hash_value(struct list_node *elem);
 struct_add* Ak_insert_bucket_to_block(char *indexName, char *data, int type);
 void Ak_update_bucket_in_block(struct_add *add, char *data);
@@ -87,6 +88,9 @@ struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values);
 void AK_delete_in_hash_index(char *indexName, struct list_node *values);
 int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName);
 void AK_delete_hash_index(char *indexName) ;
+void AK_hash_index_name(char *tblName, struct list_node *attributes, char *indexName);
+struct_add *AK_get_hash_buckets(char *indexName, int *modulo);
+int AK_find_in_hash_bucket(struct_add *bucket, int hashValue, struct_add *adds);
 void Ak_hash_test();
 
 #endif
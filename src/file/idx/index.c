@@ -397,6 +397,82 @@ AK_header *AK_get_index_header(char *indexTblName) {
     return head;
 }
 
+/// indexes which hold every row of their table, see AK_index_set_current
+static char AK_current_index[MAX_CURRENT_INDEXES][MAX_VARCHAR_LENGTH];
+/// tables of indexes in AK_current_index
+static char AK_current_index_table[MAX_CURRENT_INDEXES][MAX_ATT_NAME];
+
+/**
+ * @brief Function records that an index holds every row of its table, it is called when the index is built. Indexes
+          are not maintained by inserts, updates and deletes, so every write to the table forgets it again (see
+          AK_index_invalidate). Records are kept in memory, so an index is not current in a new session until it is
+          built again; an index that is not current must not be used to find rows.
+ * @param tblName table name
+ * @param indexTblName index name
+ * @return No return value
+ */
+void AK_index_set_current(char *tblName, char *indexTblName) {
+    AK_PRO;
+    int i, free_entry = -1;
+
+    if (strlen(tblName) >= MAX_ATT_NAME || strlen(indexTblName) >= MAX_VARCHAR_LENGTH) {
+        AK_EPI;
+        return;
+    }
+    for (i = 0; i < MAX_CURRENT_INDEXES; i++) {
+        if (strcmp(AK_current_index[i], indexTblName) == 0)
+            break;
+        if (free_entry == -1 && AK_current_index[i][0] == '\0')
+            free_entry = i;
+    }
+    //when all entries are used the index is not recorded, so it is just not used
+    if (i == MAX_CURRENT_INDEXES)
+        i = free_entry;
+    if (i != -1) {
+        strcpy(AK_current_index[i], indexTblName);
+        strcpy(AK_current_index_table[i], tblName);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks whether an index holds every row of its table (see AK_index_set_current)
+ * @param indexTblName index name
+ * @return 1 if the index is current, 0 otherwise
+ */
+int AK_index_is_current(char *indexTblName) {
+    AK_PRO;
+    int i;
+
+    for (i = 0; i < MAX_CURRENT_INDEXES; i++) {
+        if (AK_current_index[i][0] != '\0' && strcmp(AK_current_index[i], indexTblName) == 0) {
+            AK_EPI;
+            return 1;
+        }
+    }
+    AK_EPI;
+    return 0;
+}
+
+/**
+ * @brief Function forgets current indexes of a table after a write to the table, or an index itself when it is
+          written or dropped
+ * @param name table or index name
+ * @return No return value
+ */
+void AK_index_invalidate(char *name) {
+    AK_PRO;
+    int i;
+
+    for (i = 0; i < MAX_CURRENT_INDEXES; i++) {
+        if (strcmp(AK_current_index_table[i], name) == 0 || strcmp(AK_current_index[i], name) == 0) {
+            AK_current_index[i][0] = '\0';
+            AK_current_index_table[i][0] = '\0';
+        }
+    }
+    AK_EPI;
+}
+
 
 
 /**
@@ -53,12 +53,22 @@ typedef struct list_structure_ad {
 typedef list_structure_ad *element_ad;
 typedef list_structure_ad list_ad;
 
+/**
+  * @def MAX_CURRENT_INDEXES
+  * @brief Constant declaring number of indexes which are known to hold every row of their table
+  */
+#define MAX_CURRENT_INDEXES 32
+
 //printing index table
 int AK_index_table_exist(char *indexTblName);
 void AK_print_index_table(char *indexTblName);
 struct list_node *AK_get_index_tuple(int row, int column, char *indexTblName);
 int AK_get_index_num_records(char *indexTblName);
 int AK_num_index_attr(char *indexTblName);
+AK_header *AK_get_index_header(char *indexTblName);
+void AK_index_set_current(char *tblName, char *indexTblName);
+int AK_index_is_current(char *indexTblName);
+void AK_index_invalidate(char *name);
 
 struct list_node *AK_get_index_tuple(int row, int column, char *indexTblName);
 
@@ -0,0 +1,429 @@
+/**
+@file scan.c Provides functions for scanning blocks of a segment with a pool of worker threads
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <time.h>
+#include "scan.h"
+#include "filesearch.h"
+#include "bulkload.h"
+#include "table.h"
+
+/// number of workers set by AK_scan_set_workers, 0 if it follows configuration
+static int AK_scan_forced_workers = 0;
+
+/**
+ * @struct AK_scan_worker
+ * @brief Structure that holds the part of a scan done by one worker thread
+ */
+typedef struct {
+    /// extents of the segment
+    table_addresses *addresses;
+    /// position of the first block of the worker in the order of extents
+    int from;
+    /// position after the last block of the worker
+    int to;
+    /// zone map of the segment, can be NULL
+    AK_zone_map *map;
+    /// conditions checked against zone map, can be NULL
+    AK_zone_filter *filter;
+    /// function called for every block
+    AK_scan_function function;
+    /// context shared by all workers
+    void *context;
+    /// result of the worker
+    void *result;
+    /// 1 if blocks are read through the cache, only when the scan has one worker
+    int cached;
+    /// index of the worker in the order of blocks
+    int index;
+    /// lowest index of a worker whose result is complete, shared by all workers
+    int *satisfied;
+    /// lock of satisfied
+    pthread_mutex_t *lock;
+} AK_scan_worker;
+
+/**
+ * @brief Function returns number of workers used to scan a segment. It is NUMBER_OF_THREADS from configuration,
+          limited to number of processors and to one worker per SCAN_MIN_BLOCKS blocks.
+ * @param num_blocks number of blocks of the segment
+ * @return number of workers, at least 1
+ */
+int AK_scan_workers(int num_blocks) {
+    AK_PRO;
+    int workers = AK_scan_forced_workers, processors = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (workers == 0) {
+        workers = NUMBER_OF_THREADS;
+        if (processors > 0 && workers > processors)
+            workers = processors;
+    }
+    if (workers > num_blocks / SCAN_MIN_BLOCKS)
+        workers = num_blocks / SCAN_MIN_BLOCKS;
+    if (workers > SCAN_MAX_WORKERS)
+        workers = SCAN_MAX_WORKERS;
+    if (workers < 1)
+        workers = 1;
+    AK_EPI;
+    return workers;
+}
+
+/**
+ * @brief Function sets number of workers of all scans, for example to compare them with a scan on one thread
+ * @param workers number of workers, 0 to follow configuration and number of processors
+ * @return number of workers that is set
+ */
+int AK_scan_set_workers(int workers) {
+    AK_PRO;
+    AK_scan_forced_workers = workers < 0 ? 0 : workers > SCAN_MAX_WORKERS ? SCAN_MAX_WORKERS : workers;
+    AK_EPI;
+    return AK_scan_forced_workers;
+}
+
+/**
+ * @brief Function returns address of a block from its position in the order of extents
+ * @param addresses extents of the segment
+ * @param position position of the block
+ * @return block address
+ */
+static int AK_scan_address(table_addresses *addresses, int position) {
+    int i;
+
+    for (i = 0; position >= addresses->address_to[i] - addresses->address_from[i]; i++)
+        position -= addresses->address_to[i] - addresses->address_from[i];
+    return addresses->address_from[i] + position;
+}
+
+/**
+ * @brief Function checks whether a worker before the given one (or the worker itself) already has a complete result
+ * @param worker scan worker
+ * @return 1 if the worker can stop, 0 otherwise
+ */
+static int AK_scan_stopped(AK_scan_worker *worker) {
+    int stopped;
+
+    pthread_mutex_lock(worker->lock);
+    stopped = *worker->satisfied <= worker->index;
+    pthread_mutex_unlock(worker->lock);
+    return stopped;
+}
+
+/**
+ * @brief Function scans blocks of one worker. It stops before reading a block once a worker before it in the order of
+          blocks reports that its result is complete, since rows of later blocks are not needed any more.
+ * @param data worker (AK_scan_worker)
+ * @return NULL
+ */
+static void *AK_scan_run(void *data) {
+    AK_scan_worker *worker = (AK_scan_worker *) data;
+    AK_block *block;
+    int position, address, end = EXIT_SUCCESS;
+
+    for (position = worker->from; position < worker->to && end == EXIT_SUCCESS; position++) {
+        if (AK_scan_stopped(worker))
+            break;
+        address = AK_scan_address(worker->addresses, position);
+        if (AK_zone_map_check(worker->map, address, worker->filter) != ZONE_MAP_READ)
+            continue;
+        if (worker->cached) {
+            block = ((AK_mem_block *) AK_get_block(address))->block;
+        } else {
+            block = (AK_block *) AK_read_block(address);
+        }
+        AK_zone_map_refresh(worker->map, block);
+        end = worker->function(block, worker->context, worker->result);
+        if (!worker->cached)
+            AK_free(block);
+    }
+    if (end == SCAN_SATISFIED) {
+        pthread_mutex_lock(worker->lock);
+        if (*worker->satisfied > worker->index)
+            *worker->satisfied = worker->index;
+        pthread_mutex_unlock(worker->lock);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function scans all blocks of a segment with a pool of workers. Blocks (in the order of extents) are split
+          into as many contiguous ranges as there are workers, so merging results in the order of workers keeps the
+          order of blocks. The cache is not thread-safe, so workers read blocks from disk after dirty cached blocks of
+          the segment are written; a scan with one worker reads through the cache instead. Blocks which zone map rules
+          out are not read. When a function returns SCAN_SATISFIED its worker and all workers after it stop reading
+          blocks, so a scan for the first rows of a segment ends as soon as the consumer has them.
+ * @param addresses extents of the segment
+ * @param map zone map of the segment, can be NULL
+ * @param filter conditions checked against zone map, can be NULL
+ * @param function function called for every block
+ * @param context context shared by all workers
+ * @param results array of SCAN_MAX_WORKERS results of result_size bytes, result of worker i is at i * result_size
+ * @param result_size size of one result
+ * @return number of workers that were used
+ */
+int AK_scan_parallel(table_addresses *addresses, AK_zone_map *map, AK_zone_filter *filter, AK_scan_function function,
+        void *context, void *results, size_t result_size) {
+    AK_PRO;
+    AK_scan_worker workers[SCAN_MAX_WORKERS];
+    pthread_t threads[SCAN_MAX_WORKERS];
+    pthread_mutex_t lock;
+    int num_blocks = 0, num_workers, satisfied, i;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        num_blocks += addresses->address_to[i] - addresses->address_from[i];
+    num_workers = AK_scan_workers(num_blocks);
+    if (num_workers > 1)
+        AK_flush_cache_addresses(addresses);
+    satisfied = num_workers;
+    pthread_mutex_init(&lock, NULL);
+
+    for (i = 0; i < num_workers; i++) {
+        workers[i].addresses = addresses;
+        workers[i].from = (int) ((long) num_blocks * i / num_workers);
+        workers[i].to = (int) ((long) num_blocks * (i + 1) / num_workers);
+        workers[i].map = map;
+        workers[i].filter = filter;
+        workers[i].function = function;
+        workers[i].context = context;
+        workers[i].result = (char *) results + i * result_size;
+        workers[i].cached = num_workers == 1;
+        workers[i].index = i;
+        workers[i].satisfied = &satisfied;
+        workers[i].lock = &lock;
+    }
+
+    //the calling thread is the first worker
+    for (i = 1; i < num_workers; i++) {
+        if (pthread_create(&threads[i], NULL, AK_scan_run, &workers[i]) != 0) {
+            Ak_dbg_messg(LOW, FILE_MAN, "AK_scan_parallel: worker %d runs on the calling thread\n", i);
+            AK_scan_run(&workers[i]);
+            threads[i] = 0;
+        }
+    }
+    AK_scan_run(&workers[0]);
+    for (i = 1; i < num_workers; i++) {
+        if (threads[i] != 0)
+            pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&lock);
+
+    Ak_dbg_messg(MIDDLE, FILE_MAN, "AK_scan_parallel: %d blocks scanned by %d workers\n", num_blocks, num_workers);
+    AK_EPI;
+    return num_workers;
+}
+
+/**
+ * @brief Function copies values of a row to rows of a scan worker
+ * @param rows rows of the worker
+ * @param block block of the row
+ * @param slot tuple_dict index of the first attribute of the row
+ * @param columns attribute indexes of copied values, in the order they are copied
+ * @param num_columns number of copied values
+ * @return No return value
+ */
+void AK_scan_rows_add(AK_scan_rows *rows, AK_block *block, int slot, int *columns, int num_columns) {
+    int i, size = sizeof (int);
+    AK_tuple_dict *entry;
+
+    for (i = 0; i < num_columns; i++)
+        size += 3 * sizeof (int) + block->tuple_dict[slot + columns[i]].size;
+    if (rows->size + size > rows->capacity) {
+        rows->capacity = rows->size + size > 2 * rows->capacity ? rows->size + size : 2 * rows->capacity;
+        rows->data = (char *) AK_realloc(rows->data, rows->capacity);
+    }
+
+    memcpy(rows->data + rows->size, &num_columns, sizeof (int));
+    rows->size += sizeof (int);
+    for (i = 0; i < num_columns; i++) {
+        entry = &block->tuple_dict[slot + columns[i]];
+        memcpy(rows->data + rows->size, &columns[i], sizeof (int));
+        memcpy(rows->data + rows->size + sizeof (int), &entry->type, sizeof (int));
+        memcpy(rows->data + rows->size + 2 * sizeof (int), &entry->size, sizeof (int));
+        memcpy(rows->data + rows->size + 3 * sizeof (int), block->data + entry->address, entry->size);
+        rows->size += 3 * sizeof (int) + entry->size;
+    }
+    rows->num_rows++;
+}
+
+/**
+ * @brief Function puts the next row copied by a scan worker into a list, ready for Ak_insert_row
+ * @param rows rows of the worker
+ * @param offset position of the next row, 0 for the first row
+ * @param table table name written to list elements
+ * @param header header giving attribute names of values
+ * @param row_root empty list the row is put into
+ * @return 1 if a row was put into the list, 0 if there are no more rows
+ */
+int AK_scan_rows_next(AK_scan_rows *rows, int *offset, char *table, AK_header *header, struct list_node *row_root) {
+    AK_PRO;
+    int num_values, column, type, size, i;
+    char data[MAX_VARCHAR_LENGTH];
+
+    if (*offset >= rows->size) {
+        AK_EPI;
+        return 0;
+    }
+
+    memcpy(&num_values, rows->data + *offset, sizeof (int));
+    *offset += sizeof (int);
+    for (i = 0; i < num_values; i++) {
+        memcpy(&column, rows->data + *offset, sizeof (int));
+        memcpy(&type, rows->data + *offset + sizeof (int), sizeof (int));
+        memcpy(&size, rows->data + *offset + 2 * sizeof (int), sizeof (int));
+        memcpy(data, rows->data + *offset + 3 * sizeof (int), size);
+        data[size] = '\0';
+        *offset += 3 * sizeof (int) + size;
+        Ak_Insert_New_Element(type, data, table, header[column].att_name, row_root);
+    }
+    AK_EPI;
+    return 1;
+}
+
+/**
+ * @brief Function frees rows of a scan worker
+ * @param rows rows of the worker
+ * @return No return value
+ */
+void AK_scan_rows_free(AK_scan_rows *rows) {
+    AK_PRO;
+    AK_free(rows->data);
+    memset(rows, 0, sizeof (AK_scan_rows));
+    AK_EPI;
+}
+
+/**
+ * @brief Function counts rows of a block for the scan test
+ * @param block block
+ * @param context number of attributes of the table
+ * @param result number of rows counted by the worker
+ * @return EXIT_SUCCESS
+ */
+static int AK_scan_count_block(AK_block *block, void *context, void *result) {
+    int slot, num_attr = *((int *) context);
+
+    for (slot = 0; slot + num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[slot].type != FREE_INT; slot += num_attr) {
+        if (block->tuple_dict[slot].type != 0)
+            (*((int *) result))++;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function for testing parallel scans. A table is scanned on one thread and by a pool of workers; row counts,
+          search results and times are compared.
+ * @return No return value
+ */
+void AK_scan_test() {
+    AK_PRO;
+    char *table = "scan_test";
+    AK_header header[3];
+    AK_header *temp;
+    AK_bulk_loader loader;
+    table_addresses *addresses;
+    search_params params[1];
+    search_result result[3], limited[3];
+    int type[2] = {TYPE_INT, TYPE_INT};
+    int size[2] = {sizeof (int), sizeof (int)};
+    char *data[2];
+    int counts[3][SCAN_MAX_WORKERS];
+    int forced[3] = {1, 4, 8};
+    int id, value, lower = 100, upper = 199, num_attr = 2, passed = 1, i, j, run, workers[3], rows[3];
+    struct timespec start, end;
+    double seconds[3];
+
+    printf("\n********** PARALLEL SCAN TEST **********\n\n");
+
+    temp = (AK_header *) AK_create_header("id", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[0], temp, sizeof (AK_header));
+    AK_free(temp);
+    temp = (AK_header *) AK_create_header("value", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[1], temp, sizeof (AK_header));
+    AK_free(temp);
+    memset(&header[2], 0, sizeof (AK_header));
+    AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, header);
+
+    AK_bulk_begin(&loader, table);
+    data[0] = (char *) &id;
+    data[1] = (char *) &value;
+    for (i = 0; i < 30000; i++) {
+        id = i;
+        value = (i * 7919) % 1000;
+        AK_bulk_add_row(&loader, type, data, size, 30000 - i);
+    }
+    AK_bulk_end(&loader);
+
+    addresses = (table_addresses *) AK_get_table_addresses(table);
+    params[0].szAttribute = "value";
+    params[0].iSearchType = SEARCH_RANGE;
+    params[0].pData_lower = &lower;
+    params[0].pData_upper = &upper;
+
+    //the first run is on one thread, the others on four and eight workers even on a machine with fewer processors
+    for (run = 0; run < 3; run++) {
+        AK_scan_set_workers(forced[run]);
+        memset(counts[run], 0, sizeof (counts[run]));
+        //wall time, processor time of all workers is summed by clock()
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        workers[run] = AK_scan_parallel(addresses, NULL, NULL, AK_scan_count_block, &num_attr, counts[run], sizeof (int));
+        result[run] = AK_search_unsorted(table, params, 1);
+        limited[run] = AK_search_unsorted_limit(table, params, 1, 10);
+        rows[run] = AK_get_num_records(table);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds[run] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+        for (i = 1; i < workers[run]; i++)
+            counts[run][0] += counts[run][i];
+        printf("%d workers: %d rows counted, %d rows found, %d records, %.3f s\n", workers[run],
+                counts[run][0], result[run].iNum_tuple_addresses, rows[run], seconds[run]);
+    }
+    AK_scan_set_workers(0);
+
+    for (run = 0; run < 3; run++) {
+        passed &= workers[run] == forced[run] && counts[run][0] == 30000 && rows[run] == 30000;
+        passed &= result[run].iNum_tuple_addresses == 3000 && limited[run].iNum_tuple_addresses == 10;
+        //results of workers are merged in the order of blocks
+        for (j = 0; passed && j < result[0].iNum_tuple_addresses; j++) {
+            passed &= result[0].aiBlocks[j] == result[run].aiBlocks[j] && result[0].aiTuple_addresses[j] == result[run].aiTuple_addresses[j];
+        }
+        //a limited search returns the first rows of the full search, workers after the first one stop early
+        for (j = 0; passed && j < limited[run].iNum_tuple_addresses; j++)
+            passed &= limited[run].aiBlocks[j] == result[0].aiBlocks[j] && limited[run].aiTuple_addresses[j] == result[0].aiTuple_addresses[j];
+    }
+    printf("Search limited to 10 rows: %d, %d and %d rows found\n", limited[0].iNum_tuple_addresses,
+            limited[1].iNum_tuple_addresses, limited[2].iNum_tuple_addresses);
+    printf("Workers used with configuration: %d\n", AK_scan_workers(10000));
+
+    //a scan with workers writes dirty blocks of its own segment only, the system catalog block stays dirty
+    AK_mem_block *catalog = (AK_mem_block *) AK_get_block(0);
+    AK_mem_block *first = (AK_mem_block *) AK_get_block(addresses->address_from[0]);
+    AK_mem_block_modify(catalog, BLOCK_DIRTY);
+    AK_mem_block_modify(first, BLOCK_DIRTY);
+    AK_scan_set_workers(4);
+    memset(counts[0], 0, sizeof (counts[0]));
+    AK_scan_parallel(addresses, NULL, NULL, AK_scan_count_block, &num_attr, counts[0], sizeof (int));
+    AK_scan_set_workers(0);
+    printf("Dirty blocks after the scan: catalog %d, scanned segment %d\n", catalog->dirty == BLOCK_DIRTY,
+            first->dirty == BLOCK_DIRTY);
+    passed &= catalog->dirty == BLOCK_DIRTY && first->dirty == BLOCK_CLEAN;
+    AK_flush_cache();
+
+    for (run = 0; run < 3; run++) {
+        AK_deallocate_search_result(result[run]);
+        AK_deallocate_search_result(limited[run]);
+    }
+    AK_free(addresses);
+    printf("\nTest %s\n", passed ? "SUCCESS" : "FAILED");
+    AK_EPI;
+}
@@ -0,0 +1,84 @@
+/**
+@file scan.h Header file that provides functions for scanning blocks of a segment with a pool of worker threads
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SCAN
+#define SCAN
+
+#include <pthread.h>
+#include <unistd.h>
+#include "../auxi/configuration.h"
+#include "../mm/memoman.h"
+#include "zonemap.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def SCAN_MAX_WORKERS
+  * @brief Constant declaring maximal number of worker threads of one scan
+  */
+#define SCAN_MAX_WORKERS 64
+
+/**
+  * @def SCAN_MIN_BLOCKS
+  * @brief Constant declaring minimal number of blocks scanned by one worker, smaller tables use fewer workers
+  */
+#define SCAN_MIN_BLOCKS 8
+
+/**
+  * @def SCAN_SATISFIED
+  * @brief Result of a scan function: result of the worker is complete (for example it holds as many rows as the
+           consumer asked for), so the worker stops and workers after it in the order of blocks stop too
+  */
+#define SCAN_SATISFIED 1
+
+/**
+ * @brief Function called by scan workers for every block that is read. Blocks of one worker are passed in the order
+          of extents. Function gets the block read from disk (it is freed after the call), context shared by all
+          workers and result of its worker; it must not use the cache or write blocks.
+ * @return EXIT_SUCCESS to continue, SCAN_SATISFIED to stop the worker and all workers after it, anything else stops
+           the worker
+ */
+typedef int (*AK_scan_function)(AK_block *block, void *context, void *result);
+
+/**
+ * @struct AK_scan_rows
+ * @brief Structure that holds rows copied out of blocks by a scan worker, to be inserted into a table by the thread
+          that started the scan. Every row is stored as number of values followed by attribute index, type, size and
+          data of every value.
+ */
+typedef struct {
+    /// row data
+    char *data;
+    /// used bytes of data
+    int size;
+    /// allocated bytes of data
+    int capacity;
+    /// number of rows
+    int num_rows;
+} AK_scan_rows;
+
+int AK_scan_workers(int num_blocks);
+int AK_scan_set_workers(int workers);
+int AK_scan_parallel(table_addresses *addresses, AK_zone_map *map, AK_zone_filter *filter, AK_scan_function function,
+        void *context, void *results, size_t result_size);
+void AK_scan_rows_add(AK_scan_rows *rows, AK_block *block, int slot, int *columns, int num_columns);
+int AK_scan_rows_next(AK_scan_rows *rows, int *offset, char *table, AK_header *header, struct list_node *row_root);
+void AK_scan_rows_free(AK_scan_rows *rows);
+void AK_scan_test();
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include "../file/table.h"
+#include "../file/scan.h"
 
 AK_create_table_parameter* AK_create_create_table_parameter(int type, char* name) {
     AK_PRO;
@@ -84,17 +85,31 @@ int AK_num_attr(char * tblName) {
     return num_attr;
 }
 
+/**
+ * @brief  Function counts values of a block for AK_get_num_records, called by scan workers
+ * @param block block read by the worker
+ * @param context not used
+ * @param result number of values counted by the worker
+ * @return EXIT_SUCCESS
+ */
+static int AK_count_block_values(AK_block *block, void *context, void *result) {
+    int k;
+
+    for (k = 0; k < DATA_BLOCK_SIZE; k++) {
+        if (block->tuple_dict[k].size > 0)
+            (*((int *) result))++;
+    }
+    return EXIT_SUCCESS;
+}
+
 /**
  * @author Matija Šestak.
  * @brief  Determine number of rows in the table
  * <ol>
  * <li>Read addresses of extents</li>
  * <li>If there is no extents in the table, return -1</li>
- * <li>For each extent from table</li>
- * <li>For each block in the extent</li>
- * <li>Get a block</li>
- * <li>Exit if there is no records in block</li>
- * <li>Count tuples in block</li>
+ * <li>Scan blocks of all extents with a pool of workers (see scan.c)</li>
+ * <li>Count tuples in every block</li>
  * <li>Return the number of tuples divided by number of attributes</li>
  * </ol>
  * @param *tableName table name
@@ -105,26 +120,20 @@ int AK_get_num_records(char *tblName) {
     AK_PRO;
     table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
     if (addresses->address_from[0] == 0){
+        AK_free(addresses);
         AK_EPI;
         return -1;
     }
-    int i = 0, j, k;
-    AK_mem_block *temp = (AK_mem_block*) AK_get_block(addresses->address_from[0]);
-    while (addresses->address_from[ i ] != 0) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            temp = (AK_mem_block*) AK_get_block(j);
-            if (temp->block->last_tuple_dict_id == 0)
-                break;
-            for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-                if (temp->block->tuple_dict[ k ].size > 0) {
-                    num_rec++;
-                }
-            }
-        }
-        i++;
-    }
+    int i, num_workers;
+    int counts[SCAN_MAX_WORKERS];
 
-AK_free(addresses);
+    //blocks are counted by a pool of workers, empty blocks count 0 rows
+    memset(counts, 0, sizeof (counts));
+    num_workers = AK_scan_parallel(addresses, NULL, NULL, AK_count_block_values, NULL, counts, sizeof (int));
+    for (i = 0; i < num_workers; i++)
+        num_rec += counts[i];
+
+    AK_free(addresses);
     int num_head = AK_num_attr(tblName);
     AK_EPI;
     return num_rec / num_head;
@@ -884,9 +893,12 @@ int AK_get_table_obj_id(char *table) {
     i = 0;
     AK_PRO;
     while ((row = AK_get_row(i, "AK_relation")) != NULL) {
+        //rows of extents added by AK_init_new_extent_size have obj_id 0 and may come before the row of the segment
         if (strcmp(row->next->next->data, table) == 0) {
             memcpy(&table_id, row->next->data, sizeof (int));
-            break;
+            if (table_id != 0)
+                break;
+            table_id = -1;
         }
         i++;
     }
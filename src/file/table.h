@@ -56,6 +56,7 @@ void AK_print_row_spacer_to_file(int col_len[], int length);
 void AK_print_row_to_file(int col_len[], struct list_node *row);
 void AK_print_table_to_file(char *tblName);
 int AK_table_empty(char *tblName);
+int AK_table_exist(char *tblName);
 int AK_get_table_obj_id(char *table);
 int AK_check_tables_scheme(AK_mem_block *tbl1_temp_block, AK_mem_block *tbl2_temp_block, char *operator_name);
 
@@ -0,0 +1,476 @@
+/**
+@file tuple.c Provides functions for compact tuples allocated from a per-query arena
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "tuple.h"
+
+/**
+ * @brief Function initializes an empty arena. No memory is taken until the first allocation.
+ * @param arena arena to initialize
+ * @param chunk_size size of chunks, ARENA_CHUNK_SIZE is used if it is not positive
+ * @return No return value
+ */
+void AK_arena_init(AK_arena *arena, int chunk_size) {
+    AK_PRO;
+    arena->head = NULL;
+    arena->chunk_size = chunk_size > 0 ? chunk_size : ARENA_CHUNK_SIZE;
+    AK_EPI;
+}
+
+/**
+ * @brief Function hands out memory from the current arena chunk. When the chunk is full a new one is allocated, requests
+          larger than the chunk size get a chunk of their own.
+ * @param arena arena to allocate from
+ * @param size number of bytes
+ * @return pointer to allocated memory aligned to TUPLE_SLOT_ALIGN
+ */
+void *AK_arena_alloc(AK_arena *arena, int size) {
+    AK_arena_chunk *chunk;
+    void *mem;
+    AK_PRO;
+    size = (size + TUPLE_SLOT_ALIGN - 1) & ~(TUPLE_SLOT_ALIGN - 1);
+
+    if (arena->head == NULL || arena->head->used + size > arena->head->size) {
+        int chunk_size = size > arena->chunk_size ? size : arena->chunk_size;
+        chunk = (AK_arena_chunk *) AK_malloc(sizeof (AK_arena_chunk) + chunk_size);
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
+    mem = arena->head->data + arena->head->used;
+    arena->head->used += size;
+    AK_EPI;
+    return mem;
+}
+
+/**
+ * @brief Function releases all memory of an arena at once. Tuples and schemas allocated from it are no longer valid.
+ * @param arena arena to release
+ * @return No return value
+ */
+void AK_arena_free(AK_arena *arena) {
+    AK_arena_chunk *chunk;
+    AK_PRO;
+    while (arena->head != NULL) {
+        chunk = arena->head;
+        arena->head = chunk->next;
+        AK_free(chunk);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function returns width of a fixed-width slot for given type
+ * @param type data type
+ * @return slot width in bytes, 0 for variable length types
+ */
+int AK_tuple_type_width(int type) {
+    AK_PRO;
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            AK_EPI;
+            return sizeof (int);
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            AK_EPI;
+            return sizeof (double);
+        case TYPE_BLOB:
+            AK_EPI;
+            return sizeof (void *);
+        case TYPE_BOOL:
+            AK_EPI;
+            return 1;
+        default:
+            AK_EPI;
+            return 0;
+    }
+}
+
+/**
+ * @brief Function builds a tuple layout from table header. Every attribute gets an aligned slot in the fixed area;
+          variable length attributes keep an AK_tuple_varlen there.
+ * @param arena arena to allocate from
+ * @param header table header (for example block header)
+ * @param table table name
+ * @return tuple schema
+ */
+AK_tuple_schema *AK_tuple_schema_from_header(AK_arena *arena, AK_header *header, char *table) {
+    int i, slot;
+    AK_PRO;
+    AK_tuple_schema *schema = (AK_tuple_schema *) AK_arena_alloc(arena, sizeof (AK_tuple_schema));
+    memset(schema, 0, sizeof (AK_tuple_schema));
+    strncpy(schema->table, table, MAX_ATT_NAME - 1);
+
+    for (i = 0; i < MAX_ATTRIBUTES && strcmp(header[i].att_name, "\0") != 0; i++) {
+        strcpy(schema->att_name[i], header[i].att_name);
+        schema->type[i] = header[i].type;
+        schema->width[i] = AK_tuple_type_width(header[i].type);
+        slot = schema->width[i] ? schema->width[i] : sizeof (AK_tuple_varlen);
+        schema->offset[i] = schema->fixed_size;
+        schema->fixed_size += (slot + TUPLE_SLOT_ALIGN - 1) & ~(TUPLE_SLOT_ALIGN - 1);
+    }
+    schema->num_attr = i;
+    AK_EPI;
+    return schema;
+}
+
+/**
+ * @brief Function builds a tuple layout for a table from the system catalog
+ * @param arena arena to allocate from
+ * @param table table name
+ * @return tuple schema, NULL if table does not exist
+ */
+AK_tuple_schema *AK_tuple_schema_create(AK_arena *arena, char *table) {
+    AK_PRO;
+    AK_header *header = (AK_header *) AK_get_header(table);
+    if (header == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    int num_attr = AK_num_attr(table);
+    AK_header *terminated = (AK_header *) AK_calloc(MAX_ATTRIBUTES, sizeof (AK_header));
+    memcpy(terminated, header, (num_attr < MAX_ATTRIBUTES ? num_attr : MAX_ATTRIBUTES) * sizeof (AK_header));
+    AK_tuple_schema *schema = AK_tuple_schema_from_header(arena, terminated, table);
+    AK_free(terminated);
+    AK_free(header);
+    AK_EPI;
+    return schema;
+}
+
+/**
+ * @brief Function returns position of attribute in tuple schema
+ * @param schema tuple schema
+ * @param attribute_name attribute name
+ * @return attribute index, EXIT_ERROR if there is no such attribute
+ */
+int AK_tuple_attr_index(AK_tuple_schema *schema, char *attribute_name) {
+    int i;
+    AK_PRO;
+    for (i = 0; i < schema->num_attr; i++) {
+        if (strcmp(schema->att_name[i], attribute_name) == 0) {
+            AK_EPI;
+            return i;
+        }
+    }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @brief Function checks null bitmap of a tuple
+ * @param tuple tuple
+ * @param attr attribute index
+ * @return 1 if value is null, 0 otherwise
+ */
+int AK_tuple_is_null(AK_tuple *tuple, int attr) {
+    AK_PRO;
+    int is_null = (tuple->null_bitmap[attr / 8] >> (attr % 8)) & 1;
+    AK_EPI;
+    return is_null;
+}
+
+/**
+ * @brief Function returns pointer to attribute value inside a tuple. Nothing is copied.
+ * @param tuple tuple
+ * @param attr attribute index
+ * @param size if not NULL, size of the value is written here
+ * @return pointer to value, NULL if value is null
+ */
+char *AK_tuple_get(AK_tuple *tuple, int attr, int *size) {
+    AK_tuple_varlen *varlen;
+    AK_PRO;
+    if (AK_tuple_is_null(tuple, attr)) {
+        if (size)
+            *size = 0;
+        AK_EPI;
+        return NULL;
+    }
+    if (tuple->schema->width[attr]) {
+        if (size)
+            *size = tuple->schema->width[attr];
+        AK_EPI;
+        return tuple->fixed + tuple->schema->offset[attr];
+    }
+    varlen = (AK_tuple_varlen *) (tuple->fixed + tuple->schema->offset[attr]);
+    if (size)
+        *size = varlen->size;
+    AK_EPI;
+    return tuple->varlen + varlen->offset;
+}
+
+/**
+ * @brief Function allocates an empty tuple (all values not null and zeroed) with room for varlen values
+ * @param arena arena to allocate from
+ * @param schema tuple schema
+ * @param varlen_size size of varlen area
+ * @return tuple
+ */
+static AK_tuple *AK_tuple_alloc(AK_arena *arena, AK_tuple_schema *schema, int varlen_size) {
+    AK_PRO;
+    AK_tuple *tuple = (AK_tuple *) AK_arena_alloc(arena, sizeof (AK_tuple) + schema->fixed_size + varlen_size);
+    memset(tuple, 0, sizeof (AK_tuple) + schema->fixed_size);
+    tuple->schema = schema;
+    tuple->fixed = (char *) (tuple + 1);
+    tuple->varlen = tuple->fixed + schema->fixed_size;
+    AK_EPI;
+    return tuple;
+}
+
+/**
+ * @brief Function stores one value into a tuple. Variable length values are appended to varlen area, fixed-width
+          values are copied into their slot.
+ * @param tuple tuple
+ * @param attr attribute index
+ * @param data value
+ * @param size value size
+ * @return No return value
+ */
+static void AK_tuple_set(AK_tuple *tuple, int attr, char *data, int size) {
+    AK_PRO;
+    if (tuple->schema->width[attr]) {
+        memcpy(tuple->fixed + tuple->schema->offset[attr], data, size < tuple->schema->width[attr] ? size : tuple->schema->width[attr]);
+    } else {
+        AK_tuple_varlen *varlen = (AK_tuple_varlen *) (tuple->fixed + tuple->schema->offset[attr]);
+        varlen->offset = tuple->varlen_size;
+        varlen->size = size;
+        memcpy(tuple->varlen + tuple->varlen_size, data, size);
+        tuple->varlen_size += size;
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks whether a stored value is null. Ak_insert_row_to_block stores missing values as varchar
+          "null", so for varchar attributes the string can not be told apart from a real value.
+ * @param schema_type type of attribute in schema
+ * @param type type of stored value
+ * @param data stored value
+ * @param size size of stored value
+ * @return 1 if value is null, 0 otherwise
+ */
+static int AK_tuple_value_is_null(int schema_type, int type, char *data, int size) {
+    AK_PRO;
+    int is_null = type == FREE_CHAR
+            || (type == TYPE_VARCHAR && schema_type != TYPE_VARCHAR && size == 4 && memcmp(data, "null", 4) == 0);
+    AK_EPI;
+    return is_null;
+}
+
+/**
+ * @brief Function builds a tuple directly from a row stored in a block, without going through list_node
+ * @param arena arena to allocate from
+ * @param schema tuple schema
+ * @param temp_block block with the row
+ * @param slot tuple_dict index of the first attribute of the row
+ * @return tuple
+ */
+AK_tuple *AK_tuple_from_block(AK_arena *arena, AK_tuple_schema *schema, AK_block *temp_block, int slot) {
+    int i, varlen_size = 0;
+    AK_tuple_dict *tuple_dict = &temp_block->tuple_dict[slot];
+    AK_PRO;
+    for (i = 0; i < schema->num_attr; i++) {
+        if (schema->width[i] == 0)
+            varlen_size += tuple_dict[i].size;
+    }
+
+    AK_tuple *tuple = AK_tuple_alloc(arena, schema, varlen_size);
+    for (i = 0; i < schema->num_attr; i++) {
+        char *data = (char *) temp_block->data + tuple_dict[i].address;
+        if (AK_tuple_value_is_null(schema->type[i], tuple_dict[i].type, data, tuple_dict[i].size))
+            tuple->null_bitmap[i / 8] |= 1 << (i % 8);
+        else
+            AK_tuple_set(tuple, i, data, tuple_dict[i].size);
+    }
+    AK_EPI;
+    return tuple;
+}
+
+/**
+ * @brief Function builds a tuple from list elements already matched to schema attributes
+ * @param arena arena to allocate from
+ * @param schema tuple schema
+ * @param value list element of each attribute, NULL for missing values
+ * @return tuple
+ */
+static AK_tuple *AK_tuple_from_values(AK_arena *arena, AK_tuple_schema *schema, struct list_node **value) {
+    int i, varlen_size = 0;
+    AK_PRO;
+    for (i = 0; i < schema->num_attr; i++) {
+        if (value[i] != NULL && schema->width[i] == 0)
+            varlen_size += AK_type_size(value[i]->type, value[i]->data);
+    }
+
+    AK_tuple *tuple = AK_tuple_alloc(arena, schema, varlen_size);
+    for (i = 0; i < schema->num_attr; i++) {
+        int size = value[i] ? AK_type_size(value[i]->type, value[i]->data) : 0;
+        if (value[i] == NULL || AK_tuple_value_is_null(schema->type[i], value[i]->type, value[i]->data, size))
+            tuple->null_bitmap[i / 8] |= 1 << (i % 8);
+        else
+            AK_tuple_set(tuple, i, value[i]->data, size);
+    }
+    AK_EPI;
+    return tuple;
+}
+
+/**
+ * @brief Conversion shim from list_node rows whose elements follow table attribute order (rows from AK_get_row)
+ * @param arena arena to allocate from
+ * @param schema tuple schema
+ * @param row_root row as list of elements
+ * @return tuple
+ */
+AK_tuple *AK_tuple_from_list(AK_arena *arena, AK_tuple_schema *schema, struct list_node *row_root) {
+    struct list_node *value[MAX_ATTRIBUTES];
+    struct list_node *el;
+    int i;
+    AK_PRO;
+    memset(value, 0, sizeof (value));
+    el = (struct list_node *) Ak_First_L2(row_root);
+    for (i = 0; el != NULL && i < schema->num_attr; el = (struct list_node *) Ak_Next_L2(el), i++)
+        value[i] = el;
+
+    AK_tuple *tuple = AK_tuple_from_values(arena, schema, value);
+    AK_EPI;
+    return tuple;
+}
+
+/**
+ * @brief Conversion shim from list_node rows built with Ak_Insert_New_Element. NEW_VALUE elements are matched to
+          attributes by name, attributes without an element are null.
+ * @param arena arena to allocate from
+ * @param schema tuple schema
+ * @param row_root row as list of elements
+ * @return tuple
+ */
+AK_tuple *AK_tuple_from_named_list(AK_arena *arena, AK_tuple_schema *schema, struct list_node *row_root) {
+    struct list_node *value[MAX_ATTRIBUTES];
+    struct list_node *el;
+    int attr;
+    AK_PRO;
+    memset(value, 0, sizeof (value));
+    for (el = (struct list_node *) Ak_First_L2(row_root); el != NULL; el = (struct list_node *) Ak_Next_L2(el)) {
+        attr = AK_tuple_attr_index(schema, el->attribute_name);
+        if (attr != EXIT_ERROR && el->constraint == NEW_VALUE)
+            value[attr] = el;
+    }
+
+    AK_tuple *tuple = AK_tuple_from_values(arena, schema, value);
+    AK_EPI;
+    return tuple;
+}
+
+/**
+ * @brief Conversion shim to list_node rows, so tuples can be passed to functions that still take lists. Null values
+          are written the way Ak_insert_row_to_block stores them.
+ * @param tuple tuple
+ * @return row as list of elements with table and attribute names
+ */
+struct list_node *AK_tuple_to_list(AK_tuple *tuple) {
+    char data[MAX_VARCHAR_LENGTH];
+    struct list_node *last;
+    int i, size;
+    AK_PRO;
+    struct list_node *row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    Ak_Init_L3(&row_root);
+
+    for (i = 0; i < tuple->schema->num_attr; i++) {
+        char *value = AK_tuple_get(tuple, i, &size);
+        memset(data, '\0', MAX_VARCHAR_LENGTH);
+        if (value == NULL) {
+            memcpy(data, "null", 4);
+            Ak_InsertAtEnd_L3(TYPE_VARCHAR, data, 4, row_root);
+        } else {
+            memcpy(data, value, size < MAX_VARCHAR_LENGTH ? size : MAX_VARCHAR_LENGTH - 1);
+            Ak_InsertAtEnd_L3(tuple->schema->type[i], data, size, row_root);
+        }
+        last = (struct list_node *) Ak_End_L2(row_root);
+        strcpy(last->table, tuple->schema->table);
+        strcpy(last->attribute_name, tuple->schema->att_name[i]);
+        last->constraint = NEW_VALUE;
+    }
+    AK_EPI;
+    return row_root;
+}
+
+/**
+ * @brief Function for testing compact tuples. Rows of table student are converted from lists and from blocks into
+          tuples and back, and the result is compared with the original rows.
+ * @return No return value
+ */
+void AK_tuple_test() {
+    AK_arena arena;
+    int i, j, size, num_rec, failed = 0;
+    AK_PRO;
+    printf("\n\nThis is tuple test!\n");
+
+    AK_arena_init(&arena, 0);
+    AK_tuple_schema *schema = AK_tuple_schema_create(&arena, "student");
+    printf("Schema of student: %d attributes, fixed area %d bytes\n", schema->num_attr, schema->fixed_size);
+
+    num_rec = AK_get_num_records("student");
+    for (i = 0; i < num_rec; i++) {
+        struct list_node *row = AK_get_row(i, "student");
+        AK_tuple *tuple = AK_tuple_from_list(&arena, schema, row);
+        struct list_node *back = AK_tuple_to_list(tuple);
+
+        struct list_node *a = (struct list_node *) Ak_First_L2(row);
+        struct list_node *b = (struct list_node *) Ak_First_L2(back);
+        for (j = 0; a != NULL && b != NULL; j++) {
+            if (a->type != b->type || memcmp(a->data, b->data, AK_type_size(a->type, a->data)) != 0) {
+                printf("Row %d, attribute %s differs after conversion\n", i, schema->att_name[j]);
+                failed++;
+            }
+            a = (struct list_node *) Ak_Next_L2(a);
+            b = (struct list_node *) Ak_Next_L2(b);
+        }
+        if (i < 3) {
+            char *value = AK_tuple_get(tuple, AK_tuple_attr_index(schema, "firstname"), &size);
+            printf("mbr: %d firstname: %.*s\n", *((int *) AK_tuple_get(tuple, 0, NULL)), size, value);
+        }
+        //back carries attribute names, so it has to give the same tuple again
+        AK_tuple *named = AK_tuple_from_named_list(&arena, schema, back);
+        if (named->varlen_size != tuple->varlen_size || memcmp(named->fixed, tuple->fixed, schema->fixed_size + tuple->varlen_size) != 0) {
+            printf("Row %d differs after conversion by attribute names\n", i);
+            failed++;
+        }
+        Ak_DeleteAll_L3(&row);
+        AK_free(row);
+        Ak_DeleteAll_L3(&back);
+        AK_free(back);
+    }
+
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses("student");
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(addresses->address_from[0]);
+    AK_tuple *first = AK_tuple_from_block(&arena, schema, mem_block->block, 0);
+    struct list_node *first_row = AK_get_row(0, "student");
+    if (memcmp(AK_tuple_get(first, 0, NULL), Ak_First_L2(first_row)->data, sizeof (int)) != 0) {
+        printf("Tuple built from block differs from first row\n");
+        failed++;
+    }
+    Ak_DeleteAll_L3(&first_row);
+    AK_free(first_row);
+    AK_free(addresses);
+
+    printf("%d rows converted, %s\n", num_rec, failed ? "FAILED" : "all rows match");
+    AK_arena_free(&arena);
+    AK_EPI;
+}
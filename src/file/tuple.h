@@ -0,0 +1,132 @@
+/**
+@file tuple.h Header file that provides data structures for compact tuples allocated from an arena
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef TUPLE
+#define TUPLE
+
+#include "../mm/memoman.h"
+#include "table.h"
+#include "fileio.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def ARENA_CHUNK_SIZE
+  * @brief Constant declaring default size of one arena chunk in bytes
+  */
+#define ARENA_CHUNK_SIZE 65536
+
+/**
+  * @def TUPLE_SLOT_ALIGN
+  * @brief Constant declaring alignment of fixed-width tuple slots
+  */
+#define TUPLE_SLOT_ALIGN 8
+
+/**
+ * @struct AK_arena_chunk
+ * @brief Structure that defines one chunk of memory in an arena
+ */
+typedef struct AK_arena_chunk {
+    /// next (previously filled) chunk
+    struct AK_arena_chunk *next;
+    /// usable size of the chunk
+    int size;
+    /// bytes already handed out
+    int used;
+    /// chunk memory
+    char data[];
+} AK_arena_chunk;
+
+/**
+ * @struct AK_arena
+ * @brief Structure that defines a per-query arena. Memory is handed out from large chunks and released all at once.
+ */
+typedef struct {
+    /// chunk currently being filled
+    AK_arena_chunk *head;
+    /// size of newly allocated chunks
+    int chunk_size;
+} AK_arena;
+
+/**
+ * @struct AK_tuple_schema
+ * @brief Structure that defines the layout of compact tuples of one table. It is built once per query and shared by
+          all tuples of that table.
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// number of attributes
+    int num_attr;
+    /// attribute names
+    char att_name[MAX_ATTRIBUTES][MAX_ATT_NAME];
+    /// attribute types
+    int type[MAX_ATTRIBUTES];
+    /// offset of attribute slot in fixed area
+    int offset[MAX_ATTRIBUTES];
+    /// width of attribute slot, 0 for variable length attributes
+    int width[MAX_ATTRIBUTES];
+    /// size of fixed area
+    int fixed_size;
+} AK_tuple_schema;
+
+/**
+ * @struct AK_tuple_varlen
+ * @brief Structure that defines a fixed slot of a variable length attribute (position of value in varlen area)
+ */
+typedef struct {
+    /// offset in varlen area
+    int offset;
+    /// value size
+    int size;
+} AK_tuple_varlen;
+
+/**
+ * @struct AK_tuple
+ * @brief Structure that defines a compact tuple: schema pointer, null bitmap, fixed-width slots and varlen area. Fixed
+          and varlen areas follow the structure in the same allocation.
+ */
+typedef struct {
+    /// tuple layout
+    AK_tuple_schema *schema;
+    /// bit i is set if attribute i is null
+    unsigned char null_bitmap[(MAX_ATTRIBUTES + 7) / 8];
+    /// size of varlen area
+    int varlen_size;
+    /// fixed-width slots
+    char *fixed;
+    /// variable length values
+    char *varlen;
+} AK_tuple;
+
+void AK_arena_init(AK_arena *arena, int chunk_size);
+void *AK_arena_alloc(AK_arena *arena, int size);
+void AK_arena_free(AK_arena *arena);
+int AK_tuple_type_width(int type);
+AK_tuple_schema *AK_tuple_schema_from_header(AK_arena *arena, AK_header *header, char *table);
+AK_tuple_schema *AK_tuple_schema_create(AK_arena *arena, char *table);
+int AK_tuple_attr_index(AK_tuple_schema *schema, char *attribute_name);
+int AK_tuple_is_null(AK_tuple *tuple, int attr);
+char *AK_tuple_get(AK_tuple *tuple, int attr, int *size);
+AK_tuple *AK_tuple_from_block(AK_arena *arena, AK_tuple_schema *schema, AK_block *temp_block, int slot);
+AK_tuple *AK_tuple_from_list(AK_arena *arena, AK_tuple_schema *schema, struct list_node *row_root);
+AK_tuple *AK_tuple_from_named_list(AK_arena *arena, AK_tuple_schema *schema, struct list_node *row_root);
+struct list_node *AK_tuple_to_list(AK_tuple *tuple);
+void AK_tuple_test();
+
+#endif
@@ -0,0 +1,453 @@
+/**
+@file vacuum.c Provides functions for online vacuum of table segments
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "vacuum.h"
+
+/**
+ * @brief Function returns address of the block on given position in the segment. Blocks are numbered in the order of
+          extents.
+ * @param state vacuum state
+ * @param position position of the block
+ * @return block address, 0 if there is no block on that position
+ */
+static int AK_vacuum_block_address(AK_vacuum_state *state, int position) {
+    int i;
+    AK_PRO;
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && state->addresses.address_from[i] != 0; i++) {
+        int size = state->addresses.address_to[i] - state->addresses.address_from[i];
+        if (position < size) {
+            AK_EPI;
+            return state->addresses.address_from[i] + position;
+        }
+        position -= size;
+    }
+    AK_EPI;
+    return 0;
+}
+
+/**
+ * @brief Function checks whether rows may still be moved to a block. The same limits as in AK_find_AK_free_space are
+          used, so the vacuum leaves the same headroom in a block as inserts do.
+ * @param temp_block block to check
+ * @return 1 if the block has room, 0 otherwise
+ */
+static int AK_vacuum_has_room(AK_block *temp_block) {
+    AK_PRO;
+    int room = (temp_block->AK_free_space - temp_block->deleted_space < MAX_FREE_SPACE_SIZE) &&
+            (temp_block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE || temp_block->free_slot != FREE_INT);
+    AK_EPI;
+    return room;
+}
+
+/**
+ * @brief Function checks whether a block holds any live row
+ * @param temp_block block to check
+ * @param num_attr number of attributes of the table
+ * @return 1 if the block is empty, 0 otherwise
+ */
+static int AK_vacuum_is_empty(AK_block *temp_block, int num_attr) {
+    int slot;
+    AK_PRO;
+    for (slot = 0; slot + num_attr <= DATA_BLOCK_SIZE; slot += num_attr) {
+        if (temp_block->tuple_dict[slot].type != 0 && temp_block->tuple_dict[slot].type != FREE_INT) {
+            AK_EPI;
+            return 0;
+        }
+    }
+    AK_EPI;
+    return 1;
+}
+
+/**
+ * @brief Function clears an emptied block, so it looks like a block of a newly allocated extent. Table scans stop at
+          such a block instead of walking its deleted rows.
+ * @param temp_block block to clear
+ * @return No return value
+ */
+static void AK_vacuum_reset_block(AK_block *temp_block) {
+    int i;
+    AK_PRO;
+    for (i = 0; i < DATA_BLOCK_SIZE; i++) {
+        temp_block->tuple_dict[i].type = FREE_INT;
+        temp_block->tuple_dict[i].address = FREE_INT;
+        temp_block->tuple_dict[i].size = FREE_INT;
+    }
+    memset(temp_block->data, FREE_CHAR, DATA_BLOCK_SIZE * DATA_ENTRY_SIZE);
+    temp_block->AK_free_space = 0;
+    temp_block->last_tuple_dict_id = 0;
+    temp_block->free_slot = FREE_INT;
+    temp_block->deleted_space = 0;
+    AK_EPI;
+}
+
+/**
+ * @brief Function removes the row of an extent from the AK_relation system table
+ * @param table table name
+ * @param start_address first block of the extent
+ * @return EXIT_SUCCESS if the row was removed, EXIT_ERROR otherwise
+ */
+static int AK_vacuum_remove_extent_entry(char *table, int start_address) {
+    table_addresses *catalog = (table_addresses *) AK_get_table_addresses("AK_relation");
+    int num_attr = AK_num_attr("AK_relation");
+    int i, address, slot;
+    AK_PRO;
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && catalog->address_from[i] != 0; i++) {
+        for (address = catalog->address_from[i]; address < catalog->address_to[i]; address++) {
+            AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+            AK_block *temp_block = mem_block->block;
+            for (slot = 0; slot + num_attr <= DATA_BLOCK_SIZE; slot += num_attr) {
+                AK_tuple_dict *name = &temp_block->tuple_dict[slot + 1];
+                AK_tuple_dict *start = &temp_block->tuple_dict[slot + 2];
+                if (temp_block->tuple_dict[slot].type == FREE_INT)
+                    break;
+                if (temp_block->tuple_dict[slot].type == 0)
+                    continue;
+                if (name->size == strlen(table) && memcmp(temp_block->data + name->address, table, name->size) == 0
+                        && memcmp(temp_block->data + start->address, &start_address, sizeof (int)) == 0) {
+                    AK_block_release_row(temp_block, slot, num_attr);
+                    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                    AK_free(catalog);
+                    AK_EPI;
+                    return EXIT_SUCCESS;
+                }
+            }
+        }
+    }
+    AK_free(catalog);
+    printf("AK_vacuum: Extent %d of table %s is not in AK_relation\n", start_address, table);
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @brief Function releases an extent of the table. Its row in AK_relation is removed, blocks are given back to the
+          allocation table with AK_delete_extent (which also removes them from zone maps) and cached copies of the
+          blocks are read again.
+ * @param state vacuum state
+ * @param extent index of the extent in state->addresses
+ * @return EXIT_SUCCESS if the extent was released, EXIT_ERROR otherwise
+ */
+static int AK_vacuum_release_extent(AK_vacuum_state *state, int extent) {
+    int from = state->addresses.address_from[extent];
+    int to = state->addresses.address_to[extent];
+    int address;
+    AK_mem_block *mem_block;
+    AK_PRO;
+    if (AK_vacuum_remove_extent_entry(state->table, from) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    //cached copies must not be written over the released blocks
+    for (address = from; address < to; address++) {
+        if ((mem_block = AK_get_cached_block(address)) != NULL)
+            mem_block->dirty = BLOCK_CLEAN;
+    }
+    if (AK_delete_extent(from, to - 1) == EXIT_ERROR) {
+        printf("AK_vacuum: Could not release extent %d - %d of table %s\n", from, to, state->table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (address = from; address < to; address++) {
+        if ((mem_block = AK_get_cached_block(address)) != NULL)
+            AK_cache_block(address, mem_block);
+    }
+    Ak_dbg_messg(HIGH, FILE_MAN, "vacuum: released extent %d - %d of table %s\n", from, to, state->table);
+
+    state->addresses.address_from[extent] = 0;
+    state->addresses.address_to[extent] = 0;
+    state->num_blocks -= to - from;
+    state->extents_released++;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function reads extents of the table from the catalog again, rows may have been inserted to new extents since
+          the last step. If the extents read at the last step are still the first extents of the table, compaction
+          goes on from the last block of the table; otherwise it starts again from the first block.
+ * @param state vacuum state
+ * @return No return value
+ */
+static void AK_vacuum_refresh_extents(AK_vacuum_state *state) {
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(state->table);
+    int i, num_blocks = 0, prefix = 1;
+    AK_PRO;
+    if (memcmp(&state->addresses, addresses, sizeof (table_addresses)) == 0) {
+        AK_free(addresses);
+        AK_EPI;
+        return;
+    }
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && state->addresses.address_from[i] != 0; i++) {
+        if (state->addresses.address_from[i] != addresses->address_from[i]
+                || state->addresses.address_to[i] != addresses->address_to[i])
+            prefix = 0;
+    }
+    memcpy(&state->addresses, addresses, sizeof (table_addresses));
+    AK_free(addresses);
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && state->addresses.address_from[i] != 0; i++)
+        num_blocks += state->addresses.address_to[i] - state->addresses.address_from[i];
+    state->num_blocks = num_blocks;
+    state->extent = i - 1;
+    //table was dropped
+    if (num_blocks == 0)
+        state->phase = VACUUM_DONE;
+    if (state->phase != VACUUM_DONE) {
+        if (!prefix)
+            state->dest = 0;
+        state->source = num_blocks - 1;
+        state->phase = VACUUM_COMPACT;
+    }
+    Ak_dbg_messg(HIGH, FILE_MAN, "vacuum: extents of table %s changed, %d blocks\n", state->table, num_blocks);
+    AK_EPI;
+}
+
+/**
+ * @brief Function starts vacuum of a table. Extents of the table are read from the catalog, nothing is changed yet.
+ * @param state vacuum state to initialize
+ * @param table table name
+ * @return EXIT_SUCCESS if vacuum can start, EXIT_ERROR if the table does not exist
+ */
+int AK_vacuum_begin(AK_vacuum_state *state, char *table) {
+    int i;
+    AK_PRO;
+    memset(state, 0, sizeof (AK_vacuum_state));
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(table);
+    if (addresses->address_from[0] == 0) {
+        printf("AK_vacuum_begin: Table %s does not exist\n", table);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    strcpy(state->table, table);
+    memcpy(&state->addresses, addresses, sizeof (table_addresses));
+    AK_free(addresses);
+
+    state->num_attr = AK_num_attr(table);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && state->addresses.address_from[i] != 0; i++)
+        state->num_blocks += state->addresses.address_to[i] - state->addresses.address_from[i];
+    state->extent = i - 1;
+    state->dest = 0;
+    state->source = state->num_blocks - 1;
+    state->phase = VACUUM_COMPACT;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function does one step of vacuum. Rows are moved from the last blocks of the table to the first blocks that have
+          room, and emptied blocks are cleared. When the two meet, trailing extents that hold no rows are released (the
+          first extent is always kept). A step reads or writes about io_budget blocks (an extent is always checked as a
+          whole), so vacuum can run between other work; rows may be inserted, updated or deleted between steps, and
+          extents added between steps are compacted too. Moved rows get new RIDs, so indexes of the table have to be
+          rebuilt after vacuum.
+ * @param state vacuum state
+ * @param io_budget maximum number of blocks the step may read or write
+ * @return EXIT_SUCCESS if success, EXIT_ERROR otherwise
+ */
+int AK_vacuum_step(AK_vacuum_state *state, int io_budget) {
+    AK_block *source_block;
+    AK_mem_block *mem_block;
+    int touched = 0, dest_address = 0, slot, address, i;
+    AK_PRO;
+    source_block = (AK_block *) AK_malloc(sizeof (AK_block));
+    AK_vacuum_refresh_extents(state);
+
+    while (state->phase == VACUUM_COMPACT && touched < io_budget) {
+        if (state->dest >= state->source) {
+            state->phase = VACUUM_RELEASE;
+            break;
+        }
+        //rows are moved from a private copy, the cached block may be replaced while target blocks are read
+        address = AK_vacuum_block_address(state, state->source);
+        memcpy(source_block, AK_get_block(address)->block, sizeof (AK_block));
+        touched++;
+        int used = source_block->last_tuple_dict_id != 0;
+        int moved = 0, stop = 0;
+
+        for (slot = 0; slot + state->num_attr <= DATA_BLOCK_SIZE && !stop; slot += state->num_attr) {
+            if (source_block->tuple_dict[slot].type == 0 || source_block->tuple_dict[slot].type == FREE_INT)
+                continue;
+            while (1) {
+                if (state->dest >= state->source || touched >= io_budget) {
+                    stop = 1;
+                    break;
+                }
+                mem_block = (AK_mem_block *) AK_get_block(AK_vacuum_block_address(state, state->dest));
+                if (mem_block->block->address != dest_address) {
+                    dest_address = mem_block->block->address;
+                    touched++;
+                }
+                if (AK_vacuum_has_room(mem_block->block)
+                        && AK_block_move_row(source_block, slot, state->num_attr, mem_block->block) != EXIT_ERROR) {
+                    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                    moved++;
+                    break;
+                }
+                state->dest++;
+            }
+        }
+
+        if (AK_vacuum_is_empty(source_block, state->num_attr)) {
+            AK_vacuum_reset_block(source_block);
+            if (used)
+                state->blocks_emptied++;
+            state->source--;
+        }
+        if (moved > 0 || used) {
+            mem_block = (AK_mem_block *) AK_get_block(address);
+            memcpy(mem_block->block, source_block, sizeof (AK_block));
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        }
+        state->rows_moved += moved;
+        if (moved > 0)
+            AK_table_modified(state->table);
+    }
+
+    while (state->phase == VACUUM_RELEASE) {
+        int from = state->addresses.address_from[state->extent];
+        int to = state->addresses.address_to[state->extent];
+        int empty = 1;
+        if (state->extent <= 0) {
+            state->phase = VACUUM_DONE;
+            break;
+        }
+        if (touched > 0 && touched + to - from > io_budget)
+            break;
+        for (i = from; i < to && empty; i++) {
+            mem_block = (AK_mem_block *) AK_get_block(i);
+            empty = AK_vacuum_is_empty(mem_block->block, state->num_attr);
+            touched++;
+        }
+        if (!empty) {
+            state->phase = VACUUM_DONE;
+            break;
+        }
+        if (AK_vacuum_release_extent(state, state->extent) == EXIT_ERROR) {
+            state->blocks_touched += touched;
+            AK_free(source_block);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        state->extent--;
+    }
+
+    state->blocks_touched += touched;
+    AK_free(source_block);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function vacuums a table to the end, in steps of VACUUM_IO_BUDGET blocks
+ * @param table table name
+ * @return EXIT_SUCCESS if success, EXIT_ERROR otherwise
+ */
+int AK_vacuum_table(char *table) {
+    AK_vacuum_state state;
+    AK_PRO;
+    if (AK_vacuum_begin(&state, table) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    while (state.phase != VACUUM_DONE) {
+        if (AK_vacuum_step(&state, VACUUM_IO_BUDGET) == EXIT_ERROR) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    Ak_dbg_messg(LOW, FILE_MAN, "vacuum: table %s, %d rows moved, %d blocks emptied, %d extents released\n",
+            table, state.rows_moved, state.blocks_emptied, state.extents_released);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+void AK_vacuum_test() {
+    char *tblName = "vacuum_student";
+    char *fileName = "vacuum_student.csv";
+    AK_header t_header[MAX_ATTRIBUTES];
+    AK_header *temp;
+    AK_vacuum_state state;
+    table_addresses *addresses;
+    AK_rid rid;
+    int i, mbr, steps = 0, extents_before = 0, extents_after = 0;
+    AK_PRO;
+    printf("\n\nThis is vacuum test!\n");
+
+    memset(t_header, 0, sizeof (t_header));
+    temp = (AK_header *) AK_create_header("mbr", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header, temp, sizeof (AK_header));
+    temp = (AK_header *) AK_create_header("firstname", TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header + 1, temp, sizeof (AK_header));
+    temp = (AK_header *) AK_create_header("weight", TYPE_FLOAT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(t_header + 2, temp, sizeof (AK_header));
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header);
+
+    FILE *fp = fopen(fileName, "w");
+    for (i = 1; i <= 4000; i++)
+        fprintf(fp, "%d;Student%d;%d.5\n", i, i, 50 + i % 40);
+    fclose(fp);
+    AK_bulk_load_file(tblName, fileName, ';', 0);
+    remove(fileName);
+
+    //keep every tenth row
+    addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        extents_before++;
+        for (rid.block = addresses->address_from[i]; rid.block < addresses->address_to[i]; rid.block++) {
+            for (rid.slot = 0; rid.slot + 3 <= DATA_BLOCK_SIZE; rid.slot += 3) {
+                AK_block *temp_block = ((AK_mem_block *) AK_get_block(rid.block))->block;
+                if (temp_block->tuple_dict[rid.slot].type != TYPE_INT)
+                    continue;
+                memcpy(&mbr, temp_block->data + temp_block->tuple_dict[rid.slot].address, sizeof (int));
+                if (mbr % 10 != 0)
+                    AK_delete_by_rid(rid, tblName);
+            }
+        }
+    }
+    AK_free(addresses);
+    int rows_before = AK_get_num_records(tblName);
+    printf("Table %s has %d rows in %d extents before vacuum\n", tblName, rows_before, extents_before);
+
+    AK_vacuum_begin(&state, tblName);
+    while (state.phase != VACUUM_DONE && AK_vacuum_step(&state, 8) == EXIT_SUCCESS) {
+        //an extent added during vacuum is released with the other empty extents
+        if (++steps == 1)
+            AK_init_new_extent(tblName, SEGMENT_TYPE_TABLE);
+    }
+    printf("Vacuum in %d steps: %d rows moved, %d blocks emptied, %d extents released, %d blocks touched\n",
+            steps, state.rows_moved, state.blocks_emptied, state.extents_released, state.blocks_touched);
+
+    addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        printf("Extent %d: blocks %d - %d\n", i, addresses->address_from[i], addresses->address_to[i]);
+        extents_after++;
+    }
+    AK_free(addresses);
+
+    int rows_after = AK_get_num_records(tblName);
+    struct list_node *last = AK_get_row(rows_after - 1, tblName);
+    printf("Table %s has %d rows in %d extents after vacuum, last row: %d %s\n", tblName, rows_after, extents_after,
+            *((int *) Ak_GetNth_L2(1, last)->data), Ak_GetNth_L2(2, last)->data);
+    Ak_DeleteAll_L3(&last);
+    AK_free(last);
+
+    printf("vacuum_test: %s\n", (rows_after == rows_before && extents_after < extents_before) ? "SUCCESS" : "FAILED");
+    AK_EPI;
+}
@@ -0,0 +1,85 @@
+/**
+@file vacuum.h Header file that provides data structures and functions for online vacuum of table segments
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef VACUUM
+#define VACUUM
+
+#include "../mm/memoman.h"
+#include "table.h"
+#include "fileio.h"
+#include "zonemap.h"
+#include "bulkload.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def VACUUM_COMPACT
+  * @brief Constant declaring vacuum phase in which rows are moved from the end of the segment to its beginning
+  */
+#define VACUUM_COMPACT 0
+
+/**
+  * @def VACUUM_RELEASE
+  * @brief Constant declaring vacuum phase in which empty trailing extents are released
+  */
+#define VACUUM_RELEASE 1
+
+/**
+  * @def VACUUM_DONE
+  * @brief Constant declaring finished vacuum
+  */
+#define VACUUM_DONE 2
+
+/**
+ * @struct AK_vacuum_state
+ * @brief Structure that holds state of an incremental vacuum of one table. Blocks of all extents are numbered in the
+          order of extents, rows are moved from the block at position source to the block at position dest.
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// number of attributes
+    int num_attr;
+    /// extents of the table at the last step
+    table_addresses addresses;
+    /// number of blocks in all extents
+    int num_blocks;
+    /// position of block rows are moved to
+    int dest;
+    /// position of block rows are moved from
+    int source;
+    /// VACUUM_COMPACT, VACUUM_RELEASE or VACUUM_DONE
+    int phase;
+    /// index of extent checked in release phase
+    int extent;
+    /// number of blocks read or written
+    int blocks_touched;
+    /// number of moved rows
+    int rows_moved;
+    /// number of emptied blocks
+    int blocks_emptied;
+    /// number of released extents
+    int extents_released;
+} AK_vacuum_state;
+
+int AK_vacuum_begin(AK_vacuum_state *state, char *table);
+int AK_vacuum_step(AK_vacuum_state *state, int io_budget);
+int AK_vacuum_table(char *table);
+void AK_vacuum_test();
+
+#endif
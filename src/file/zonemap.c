@@ -0,0 +1,813 @@
+/**
+@file zonemap.c Provides functions for block zone maps (min/max summaries) used to skip blocks in scans
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "zonemap.h"
+#include "filesearch.h"
+#include "bulkload.h"
+
+/// zone maps of segments
+static AK_zone_map *AK_zone_maps[ZONE_MAP_SEGMENTS];
+/// next zone map to be replaced
+static int AK_zone_map_next_replace = 0;
+
+/**
+ * @brief Function checks whether zone maps are kept for a data type. FLOAT values are written both as float and as
+          double by different modules, so they are not summarized.
+ * @param type data type
+ * @return 1 if type is summarized, 0 otherwise
+ */
+int AK_zone_map_tracked(int type) {
+    AK_PRO;
+    int tracked = type == TYPE_INT || type == TYPE_NUMBER || type == TYPE_DATE || type == TYPE_DATETIME || type == TYPE_TIME;
+    AK_EPI;
+    return tracked;
+}
+
+/**
+ * @brief Function returns position of a block in a segment
+ * @param addresses extents of the segment
+ * @param address block address
+ * @return position of the block in the order of extents, EXIT_ERROR if block is not in the segment
+ */
+static int AK_zone_map_index(table_addresses *addresses, int address) {
+    int i, index = 0;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (address >= addresses->address_from[i] && address < addresses->address_to[i])
+            return index + address - addresses->address_from[i];
+        index += addresses->address_to[i] - addresses->address_from[i];
+    }
+    return EXIT_ERROR;
+}
+
+/**
+ * @brief Function finds the zone map of the segment a block belongs to. Released blocks and zone maps of dropped
+          tables are removed (see AK_zone_map_release_extent and AK_zone_map_drop), so no two zone maps hold a block.
+ * @param address block address
+ * @param index pointer to position of the block in the segment
+ * @return zone map, NULL if no zone map holds the block
+ */
+static AK_zone_map *AK_zone_map_find(int address, int *index) {
+    int i;
+
+    for (i = 0; i < ZONE_MAP_SEGMENTS; i++) {
+        if (AK_zone_maps[i] != NULL && (*index = AK_zone_map_index(&AK_zone_maps[i]->addresses, address)) != EXIT_ERROR)
+            return AK_zone_maps[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function frees a zone map
+ * @param map zone map
+ * @return No return value
+ */
+static void AK_zone_map_free(AK_zone_map *map) {
+    AK_PRO;
+    int i;
+
+    for (i = 0; i < map->num_attr; i++)
+        AK_free(map->bloom[i]);
+    AK_free(map->state);
+    AK_free(map->rows);
+    AK_free(map->zones);
+    AK_free(map);
+    AK_EPI;
+}
+
+/**
+ * @brief Function removes a zone map from zone maps in memory. A zone map that open scans use is freed when the
+          last of them closes (see AK_zone_map_close), other zone maps are freed at once.
+ * @param i index of the zone map in AK_zone_maps
+ * @return No return value
+ */
+static void AK_zone_map_remove(int i) {
+    AK_PRO;
+    if (AK_zone_maps[i]->pins == 0)
+        AK_zone_map_free(AK_zone_maps[i]);
+    AK_zone_maps[i] = NULL;
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks whether any attribute of a zone map has a Bloom filter
+ * @param map zone map
+ * @return 1 if some attribute has a Bloom filter, 0 otherwise
+ */
+static int AK_zone_map_has_bloom(AK_zone_map *map) {
+    int i;
+
+    for (i = 0; i < map->num_attr; i++) {
+        if (map->bloom_size[i] > 0)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function hashes a value for Bloom filters. Numeric values are hashed as decoded numbers, so equal values
+          stored in different ways (0 and -0) get the same hash; VARCHAR values are hashed without trailing zeros.
+ * @param type data type of the attribute
+ * @param data value data
+ * @param size value size
+ * @return 64 bit hash of the value
+ */
+static unsigned long long AK_zone_map_hash(int type, const char *data, int size) {
+    unsigned long long hash = 14695981039346656037ULL;
+    double number;
+    int integer, i;
+
+    if (AK_zone_map_tracked(type)) {
+        if (type == TYPE_NUMBER) {
+            memcpy(&number, data, sizeof (double));
+        } else {
+            memcpy(&integer, data, sizeof (int));
+            number = integer;
+        }
+        number += 0.0;
+        data = (const char *) &number;
+        size = sizeof (double);
+    } else if (type == TYPE_VARCHAR) {
+        size = strnlen(data, size);
+    }
+
+    for (i = 0; i < size; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= 1099511628211ULL;
+    }
+    //FNV-1a spreads the last bytes badly, mix all bits before the hash is split in two
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * @brief Function adds a hash to Bloom filter of a block, or tests whether it may be there. Bit positions are derived
+          from two halves of the hash (h1 + i * h2).
+ * @param bloom Bloom filter of the block
+ * @param size size of Bloom filter in bytes
+ * @param hashes number of hash functions
+ * @param hash hash of the value
+ * @param add 1 to add the hash, 0 to test it
+ * @return 1 if value may be in the block, 0 if it is not there
+ */
+static int AK_zone_map_bloom(unsigned char *bloom, int size, int hashes, unsigned long long hash, int add) {
+    unsigned int h1 = (unsigned int) hash, h2 = (unsigned int) (hash >> 32) | 1, bit;
+    int i;
+
+    for (i = 0; i < hashes; i++) {
+        bit = (h1 + i * h2) % (unsigned int) (size * 8);
+        if (add)
+            bloom[bit >> 3] |= 1 << (bit & 7);
+        else if (!(bloom[bit >> 3] & (1 << (bit & 7))))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Function adjusts zone map to current extents of the segment. Zone maps of blocks which stayed in the segment
+          are kept, new blocks are unknown.
+ * @param map zone map
+ * @param addresses current extents of the segment
+ * @return No return value
+ */
+static void AK_zone_map_remap(AK_zone_map *map, table_addresses *addresses) {
+    AK_PRO;
+    int i, j, address, index = 0, old_index, num_blocks = 0;
+    int *state, *rows;
+    unsigned char *bloom[MAX_ATTRIBUTES];
+    AK_zone *zones;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        num_blocks += addresses->address_to[i] - addresses->address_from[i];
+
+    state = (int *) AK_calloc(num_blocks + 1, sizeof (int));
+    rows = (int *) AK_calloc(num_blocks + 1, sizeof (int));
+    zones = (AK_zone *) AK_calloc((num_blocks + 1) * map->num_attr, sizeof (AK_zone));
+    for (j = 0; j < map->num_attr; j++)
+        bloom[j] = map->bloom_size[j] > 0 ? (unsigned char *) AK_calloc(num_blocks + 1, map->bloom_size[j]) : NULL;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (address = addresses->address_from[i]; address < addresses->address_to[i]; address++, index++) {
+            old_index = map->state != NULL ? AK_zone_map_index(&map->addresses, address) : EXIT_ERROR;
+            if (old_index == EXIT_ERROR)
+                continue;
+            state[index] = map->state[old_index];
+            rows[index] = map->rows[old_index];
+            memcpy(&zones[index * map->num_attr], &map->zones[old_index * map->num_attr], map->num_attr * sizeof (AK_zone));
+            for (j = 0; j < map->num_attr; j++) {
+                if (bloom[j] != NULL)
+                    memcpy(bloom[j] + index * map->bloom_size[j], map->bloom[j] + old_index * map->bloom_size[j], map->bloom_size[j]);
+            }
+        }
+    }
+
+    for (j = 0; j < map->num_attr; j++) {
+        AK_free(map->bloom[j]);
+        map->bloom[j] = bloom[j];
+    }
+    AK_free(map->state);
+    AK_free(map->rows);
+    AK_free(map->zones);
+    map->state = state;
+    map->rows = rows;
+    map->zones = zones;
+    map->num_blocks = num_blocks;
+    memcpy(&map->addresses, addresses, sizeof (table_addresses));
+    AK_EPI;
+}
+
+/**
+ * @brief Function returns zone map of a table. Zone map is created if the table has none; if extents of the table
+          changed since the last call, zone maps of blocks that are still in the table are kept.
+ * @param table table name
+ * @return zone map, NULL if table does not exist
+ */
+AK_zone_map *AK_zone_map_get(char *table) {
+    AK_PRO;
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(table);
+    AK_header *header;
+    AK_zone_map *map = NULL;
+    int i, j, k, num_attr;
+
+    if (addresses->address_from[0] == 0) {
+        AK_free(addresses);
+        AK_EPI;
+        return NULL;
+    }
+
+    num_attr = AK_num_attr(table);
+    header = (AK_header *) AK_get_header(table);
+
+    for (i = 0; i < ZONE_MAP_SEGMENTS; i++) {
+        if (AK_zone_maps[i] != NULL && strcmp(AK_zone_maps[i]->table, table) == 0) {
+            map = AK_zone_maps[i];
+            break;
+        }
+    }
+
+    //table was dropped and created again with other attributes
+    if (map != NULL && map->num_attr != num_attr) {
+        AK_zone_map_remove(i);
+        map = NULL;
+    }
+    for (i = 0; map != NULL && i < num_attr; i++) {
+        if (map->type[i] != header[i].type) {
+            memset(map->state, 0, (map->num_blocks + 1) * sizeof (int));
+            map->type[i] = header[i].type;
+        }
+    }
+
+    if (map == NULL) {
+        map = (AK_zone_map *) AK_calloc(1, sizeof (AK_zone_map));
+        strncpy(map->table, table, MAX_ATT_NAME - 1);
+        map->num_attr = num_attr;
+        for (i = 0; i < num_attr; i++)
+            map->type[i] = header[i].type;
+
+        for (i = 0; i < ZONE_MAP_SEGMENTS && AK_zone_maps[i] != NULL; i++);
+        //zone maps of tables with Bloom filters hold their settings and zone maps of open scans are in use, they are
+        //replaced only if all zone maps are such
+        for (j = 0; i == ZONE_MAP_SEGMENTS && j < ZONE_MAP_SEGMENTS; j++) {
+            k = (AK_zone_map_next_replace + j) % ZONE_MAP_SEGMENTS;
+            if ((!AK_zone_map_has_bloom(AK_zone_maps[k]) && AK_zone_maps[k]->pins == 0) || j == ZONE_MAP_SEGMENTS - 1)
+                i = k;
+        }
+        if (AK_zone_maps[i] != NULL) {
+            AK_zone_map_next_replace = (i + 1) % ZONE_MAP_SEGMENTS;
+            AK_zone_map_remove(i);
+        }
+        AK_zone_maps[i] = map;
+    }
+
+    if (map->state == NULL || memcmp(&map->addresses, addresses, sizeof (table_addresses)) != 0)
+        AK_zone_map_remap(map, addresses);
+
+    AK_free(header);
+    AK_free(addresses);
+    AK_EPI;
+    return map;
+}
+
+/**
+ * @brief Function returns a zone map of a table for a scan (see AK_zone_map_get). The zone map stays in memory until
+          the scan closes it with AK_zone_map_close, even if zone maps of other tables replace it in the meantime.
+ * @param table table name
+ * @return zone map, NULL if table does not exist
+ */
+AK_zone_map *AK_zone_map_open(char *table) {
+    AK_PRO;
+    AK_zone_map *map = AK_zone_map_get(table);
+
+    if (map != NULL)
+        map->pins++;
+    AK_EPI;
+    return map;
+}
+
+/**
+ * @brief Function closes a zone map of a scan opened by AK_zone_map_open, a zone map that was replaced while the
+          scan was open is freed when its last scan closes
+ * @param map zone map, NULL is ignored
+ * @return No return value
+ */
+void AK_zone_map_close(AK_zone_map *map) {
+    AK_PRO;
+    int i;
+
+    if (map == NULL || --map->pins > 0) {
+        AK_EPI;
+        return;
+    }
+    for (i = 0; i < ZONE_MAP_SEGMENTS && AK_zone_maps[i] != map; i++);
+    if (i == ZONE_MAP_SEGMENTS)
+        AK_zone_map_free(map);
+    AK_EPI;
+}
+
+/**
+ * @brief Function prepares an empty scan filter, conditions are added by filling its arrays
+ * @param filter scan filter
+ * @return No return value
+ */
+void AK_zone_filter_init(AK_zone_filter *filter) {
+    AK_PRO;
+    filter->num_ranges = 0;
+    filter->num_values = 0;
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks zone map of a block against conditions of a scan. A range skips the block if zone of its
+          attribute lies outside of it; an equality skips it if Bloom filter of its attribute does not hold the value.
+          Ranges of one value (A in [7, 7]) are equalities too. Parallel scan workers call it for their own blocks.
+ * @param map zone map of the segment, can be NULL
+ * @param address block address
+ * @param filter scan conditions, can be NULL
+ * @return ZONE_MAP_READ if block has to be read, ZONE_MAP_SKIP if no row can match, ZONE_MAP_EMPTY if block has no rows
+ */
+int AK_zone_map_check(AK_zone_map *map, int address, AK_zone_filter *filter) {
+    AK_PRO;
+    int i, index, column, probe;
+    AK_zone *zone;
+    unsigned long long hash;
+
+    if (map == NULL || (index = AK_zone_map_index(&map->addresses, address)) == EXIT_ERROR
+            || map->state[index] != ZONE_MAP_VALID) {
+        if (map != NULL)
+            __sync_fetch_and_add(&map->blocks_read, 1);
+        AK_EPI;
+        return ZONE_MAP_READ;
+    }
+    if (map->rows[index] == 0) {
+        __sync_fetch_and_add(&map->blocks_skipped, 1);
+        AK_EPI;
+        return ZONE_MAP_EMPTY;
+    }
+
+    for (i = 0; filter != NULL && i < filter->num_ranges; i++) {
+        column = filter->range_column[i];
+        if (!AK_zone_map_tracked(map->type[column]))
+            continue;
+        zone = &map->zones[index * map->num_attr + column];
+        if (filter->lower[i] > filter->upper[i]) {
+            __sync_fetch_and_add(&map->blocks_skipped, 1);
+            AK_EPI;
+            return ZONE_MAP_SKIP;
+        }
+        //numeric values are hashed as decoded numbers, so the bound is hashed as a NUMBER
+        probe = filter->lower[i] == filter->upper[i] && map->bloom_size[column] > 0;
+        if (probe)
+            hash = AK_zone_map_hash(TYPE_NUMBER, (const char *) &filter->lower[i], sizeof (double));
+        if (zone->max < filter->lower[i] || zone->min > filter->upper[i]
+                || (probe && !AK_zone_map_bloom(map->bloom[column] + index * map->bloom_size[column],
+                map->bloom_size[column], map->bloom_hashes[column], hash, 0))) {
+            __sync_fetch_and_add(&map->blocks_skipped, 1);
+            AK_EPI;
+            return ZONE_MAP_SKIP;
+        }
+    }
+
+    for (i = 0; filter != NULL && i < filter->num_values; i++) {
+        column = filter->value_column[i];
+        if (map->bloom_size[column] == 0 || AK_zone_map_tracked(map->type[column]))
+            continue;
+        hash = AK_zone_map_hash(map->type[column], filter->value[i], filter->value_size[i]);
+        if (!AK_zone_map_bloom(map->bloom[column] + index * map->bloom_size[column], map->bloom_size[column],
+                map->bloom_hashes[column], hash, 0)) {
+            __sync_fetch_and_add(&map->blocks_skipped, 1);
+            AK_EPI;
+            return ZONE_MAP_SKIP;
+        }
+    }
+    __sync_fetch_and_add(&map->blocks_read, 1);
+    AK_EPI;
+    return ZONE_MAP_READ;
+}
+
+/**
+ * @brief Function adds values of one row to zone map and Bloom filters of a block. Null values (stored with type other
+          than the type of the attribute) only mark the zone.
+ * @param map zone map
+ * @param index position of the block in the segment
+ * @param block block
+ * @param slot tuple_dict index of the first attribute of the row
+ * @return No return value
+ */
+static void AK_zone_map_add_row(AK_zone_map *map, int index, AK_block *block, int slot) {
+    int i, integer;
+    double value;
+    AK_zone *zone;
+    AK_tuple_dict *entry;
+
+    map->rows[index]++;
+    for (i = 0; i < map->num_attr; i++) {
+        zone = &map->zones[index * map->num_attr + i];
+        entry = &block->tuple_dict[slot + i];
+        if (entry->type != map->type[i]) {
+            zone->has_null = 1;
+            continue;
+        }
+        if (map->bloom_size[i] > 0)
+            AK_zone_map_bloom(map->bloom[i] + index * map->bloom_size[i], map->bloom_size[i], map->bloom_hashes[i],
+                    AK_zone_map_hash(map->type[i], (const char *) block->data + entry->address, entry->size), 1);
+        if (!AK_zone_map_tracked(map->type[i]))
+            continue;
+        if (map->type[i] == TYPE_NUMBER) {
+            memcpy(&value, block->data + entry->address, sizeof (double));
+        } else {
+            memcpy(&integer, block->data + entry->address, sizeof (int));
+            value = integer;
+        }
+        if (value < zone->min)
+            zone->min = value;
+        if (value > zone->max)
+            zone->max = value;
+    }
+}
+
+/**
+ * @brief Function adds all rows of a block to its zone map
+ * @param map zone map
+ * @param index position of the block in the segment
+ * @param block block
+ * @return No return value
+ */
+static void AK_zone_map_add_block(AK_zone_map *map, int index, AK_block *block) {
+    int slot;
+
+    for (slot = 0; slot + map->num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[slot].type != FREE_INT; slot += map->num_attr) {
+        if (block->tuple_dict[slot].type != 0)
+            AK_zone_map_add_row(map, index, block, slot);
+    }
+}
+
+/**
+ * @brief Function builds zone map of a block from its data. Scans read blocks either from disk or from cache, so rows
+          of a dirty cached copy are summarized too and the zone map covers both versions.
+ * @param map zone map
+ * @param index position of the block in the segment
+ * @param block block
+ * @return No return value
+ */
+static void AK_zone_map_build(AK_zone_map *map, int index, AK_block *block) {
+    int i;
+    AK_mem_block *cached = AK_get_cached_block(block->address);
+
+    map->rows[index] = 0;
+    for (i = 0; i < map->num_attr; i++) {
+        map->zones[index * map->num_attr + i].min = HUGE_VAL;
+        map->zones[index * map->num_attr + i].max = -HUGE_VAL;
+        map->zones[index * map->num_attr + i].has_null = 0;
+        if (map->bloom_size[i] > 0)
+            memset(map->bloom[i] + index * map->bloom_size[i], 0, map->bloom_size[i]);
+    }
+
+    AK_zone_map_add_block(map, index, block);
+    if (cached != NULL && cached->block != block && cached->dirty == BLOCK_DIRTY)
+        AK_zone_map_add_block(map, index, cached->block);
+    map->state[index] = ZONE_MAP_VALID;
+}
+
+/**
+ * @brief Function builds zone map of a block that a scan has read, if the block has no valid zone map
+ * @param map zone map of the segment, can be NULL
+ * @param block block read by the scan
+ * @return No return value
+ */
+void AK_zone_map_refresh(AK_zone_map *map, AK_block *block) {
+    AK_PRO;
+    int index;
+
+    if (map != NULL && (index = AK_zone_map_index(&map->addresses, block->address)) != EXIT_ERROR
+            && map->state[index] != ZONE_MAP_VALID)
+        AK_zone_map_build(map, index, block);
+    AK_EPI;
+}
+
+/**
+ * @brief Function builds zone map of a block again from its data, used when a whole block is written at once
+ * @param block block
+ * @return No return value
+ */
+void AK_zone_map_update_block(AK_block *block) {
+    AK_PRO;
+    int index;
+    AK_zone_map *map = AK_zone_map_find(block->address, &index);
+
+    if (map != NULL)
+        AK_zone_map_build(map, index, block);
+    AK_EPI;
+}
+
+/**
+ * @brief Function widens zone map of a block by an inserted row
+ * @param block block the row was inserted to
+ * @param slot tuple_dict index of the first attribute of the row
+ * @return No return value
+ */
+void AK_zone_map_insert_row(AK_block *block, int slot) {
+    AK_PRO;
+    int index;
+    AK_zone_map *map = AK_zone_map_find(block->address, &index);
+
+    if (map != NULL && map->state[index] == ZONE_MAP_VALID)
+        AK_zone_map_add_row(map, index, block, slot);
+    AK_EPI;
+}
+
+/**
+ * @brief Function invalidates zone map of a block after its rows were updated or deleted. The block is read by the
+          next scan, which builds its zone map again.
+ * @param address block address
+ * @return No return value
+ */
+void AK_zone_map_invalidate(int address) {
+    AK_PRO;
+    int index;
+    AK_zone_map *map = AK_zone_map_find(address, &index);
+
+    if (map != NULL)
+        map->state[index] = ZONE_MAP_UNKNOWN;
+    AK_EPI;
+}
+
+/**
+ * @brief Function removes blocks of a released extent from zone maps, it is called by AK_delete_extent. The blocks may
+          be given to another segment, so no zone map may hold them anymore; a zone map left without blocks is
+          removed.
+ * @param begin address of extent's first block
+ * @param end address of the first block after the extent
+ * @return No return value
+ */
+void AK_zone_map_release_extent(int begin, int end) {
+    AK_PRO;
+    table_addresses addresses;
+    int i, j, k;
+
+    for (i = 0; i < ZONE_MAP_SEGMENTS; i++) {
+        if (AK_zone_maps[i] == NULL)
+            continue;
+        memset(&addresses, 0, sizeof (table_addresses));
+        for (j = k = 0; j < MAX_EXTENTS_IN_SEGMENT && AK_zone_maps[i]->addresses.address_from[j] != 0; j++) {
+            if (AK_zone_maps[i]->addresses.address_to[j] <= begin || AK_zone_maps[i]->addresses.address_from[j] >= end) {
+                addresses.address_from[k] = AK_zone_maps[i]->addresses.address_from[j];
+                addresses.address_to[k++] = AK_zone_maps[i]->addresses.address_to[j];
+            }
+        }
+        if (k == 0 && j > 0)
+            AK_zone_map_remove(i);
+        else if (k != j)
+            AK_zone_map_remap(AK_zone_maps[i], &addresses);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function removes zone map of a dropped table
+ * @param table table name
+ * @return No return value
+ */
+void AK_zone_map_drop(char *table) {
+    AK_PRO;
+    int i;
+
+    for (i = 0; i < ZONE_MAP_SEGMENTS; i++) {
+        if (AK_zone_maps[i] != NULL && strcmp(AK_zone_maps[i]->table, table) == 0)
+            AK_zone_map_remove(i);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function sets Bloom filter of an attribute of a table. Filter of every block is sized for the largest number
+          of rows a block can hold and the wanted false positive rate, but never larger than max_size bytes, in which
+          case the false positive rate is higher. Filters are built by scans, inserts and bulk load like zone maps.
+          Settings are kept with the zone map of the table in memory only, so they last for the current session: they
+          are not written to the database, and they are lost if the table is dropped or if its zone map is replaced
+          because every zone map in memory has a Bloom filter. They have to be set again in such a case.
+ * @param table table name
+ * @param attribute attribute name, must not be TYPE_FLOAT
+ * @param false_positive_rate wanted rate of blocks read although they do not hold the value, between 0 and 1
+ * @param max_size largest size of Bloom filter of one block in bytes, 0 removes the Bloom filter
+ * @return EXIT_SUCCESS if success, EXIT_ERROR otherwise
+ */
+int AK_zone_map_set_bloom(char *table, char *attribute, double false_positive_rate, int max_size) {
+    AK_PRO;
+    AK_zone_map *map = AK_zone_map_get(table);
+    AK_header *header;
+    int i, rows, bits, size = 0, hashes = 0;
+    double rate;
+
+    if (map == NULL || max_size < 0 || (max_size > 0 && (false_positive_rate <= 0 || false_positive_rate >= 1))) {
+        printf("AK_zone_map_set_bloom: ERROR. Wrong table %s or Bloom filter settings.\n", table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    header = (AK_header *) AK_get_header(table);
+    for (i = 0; i < map->num_attr && strcmp(header[i].att_name, attribute) != 0; i++);
+    AK_free(header);
+    if (i == map->num_attr || map->type[i] == TYPE_FLOAT) {
+        printf("AK_zone_map_set_bloom: ERROR. Attribute %s of table %s can not have Bloom filter.\n", attribute, table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (max_size > 0) {
+        //with the best number of hashes (bits per value * ln 2) every bit per value lowers the rate by 0.6185 times
+        for (bits = 1, rate = 0.6185; rate > false_positive_rate; bits++)
+            rate *= 0.6185;
+        rows = DATA_BLOCK_SIZE / map->num_attr;
+        size = (bits * rows + 7) / 8;
+        if (size > max_size)
+            size = max_size;
+        hashes = (int) (size * 8.0 / rows * 0.6931 + 0.5);
+        hashes = hashes < 1 ? 1 : hashes > ZONE_MAP_BLOOM_MAX_HASHES ? ZONE_MAP_BLOOM_MAX_HASHES : hashes;
+    }
+
+    AK_free(map->bloom[i]);
+    map->bloom[i] = size > 0 ? (unsigned char *) AK_calloc(map->num_blocks + 1, size) : NULL;
+    map->bloom_size[i] = size;
+    map->bloom_hashes[i] = hashes;
+    //filters of existing blocks are built by the next scan
+    memset(map->state, 0, (map->num_blocks + 1) * sizeof (int));
+
+    Ak_dbg_messg(LOW, FILE_MAN, "AK_zone_map_set_bloom: %s.%s has %d bytes and %d hashes per block\n", table, attribute, size, hashes);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function for testing zone maps. A table ordered by date is bulk loaded and searched by date range, then by
+          codes which are not ordered, so only Bloom filters can skip blocks.
+ * @return No return value
+ */
+void AK_zone_map_test() {
+    AK_PRO;
+    char *table = "zone_map_test";
+    AK_header header[4];
+    AK_header *temp;
+    AK_bulk_loader loader;
+    AK_zone_map *map;
+    search_params params[1];
+    search_result result;
+    int type[3] = {TYPE_DATE, TYPE_INT, TYPE_VARCHAR};
+    int size[3] = {sizeof (int), sizeof (int), 0};
+    char *data[3];
+    char code[MAX_VARCHAR_LENGTH];
+    int day, value, lower = 20300, upper = 20399, passed = 1, i, read = 0, address;
+    struct list_node *row_root;
+
+    printf("\n********** ZONE MAP TEST **********\n\n");
+
+    temp = (AK_header *) AK_create_header("day", TYPE_DATE, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[0], temp, sizeof (AK_header));
+    AK_free(temp);
+    temp = (AK_header *) AK_create_header("value", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[1], temp, sizeof (AK_header));
+    AK_free(temp);
+    temp = (AK_header *) AK_create_header("code", TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[2], temp, sizeof (AK_header));
+    AK_free(temp);
+    memset(&header[3], 0, sizeof (AK_header));
+    AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, header);
+
+    passed &= AK_zone_map_set_bloom(table, "code", 0.01, 256) == EXIT_SUCCESS;
+    passed &= AK_zone_map_set_bloom(table, "day", 0.01, 256) == EXIT_SUCCESS;
+    passed &= AK_zone_map_set_bloom(table, "nonexistent", 0.01, 256) == EXIT_ERROR;
+
+    //rows are appended in order of day, like a time series, codes are scattered
+    AK_bulk_begin(&loader, table);
+    data[0] = (char *) &day;
+    data[1] = (char *) &value;
+    data[2] = code;
+    for (i = 0; i < 20000; i++) {
+        day = 20000 + i / 10;
+        value = i;
+        sprintf(code, "code%05d", (i * 7919) % 20000);
+        size[2] = strlen(code);
+        AK_bulk_add_row(&loader, type, data, size, 20000 - i);
+    }
+    AK_bulk_end(&loader);
+
+    map = AK_zone_map_get(table);
+    printf("Bloom filter of code: %d bytes, %d hashes per block\n", map->bloom_size[2], map->bloom_hashes[2]);
+
+    //zone maps were built by bulk load
+    params[0].szAttribute = "day";
+    params[0].iSearchType = SEARCH_RANGE;
+    params[0].pData_lower = &lower;
+    params[0].pData_upper = &upper;
+    map->blocks_read = map->blocks_skipped = 0;
+    result = AK_search_unsorted(table, params, 1);
+    printf("Range search: %d rows, %d blocks read, %d blocks skipped\n", result.iNum_tuple_addresses, map->blocks_read, map->blocks_skipped);
+    passed &= result.iNum_tuple_addresses == 1000 && map->blocks_skipped > 10 * map->blocks_read;
+    AK_deallocate_search_result(result);
+
+    //an inserted row widens zone map of the block it is written to
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&row_root);
+    day = 20350;
+    value = -1;
+    Ak_Insert_New_Element(TYPE_DATE, &day, table, "day", row_root);
+    Ak_Insert_New_Element(TYPE_INT, &value, table, "value", row_root);
+    Ak_Insert_New_Element(TYPE_VARCHAR, "inserted", table, "code", row_root);
+    Ak_insert_row(row_root);
+    Ak_DeleteAll_L3(&row_root);
+
+    //a deleted row invalidates zone map of its block
+    value = 3000;
+    Ak_Insert_New_Element_For_Update(TYPE_INT, &value, table, "value", row_root, SEARCH_CONSTRAINT);
+    Ak_delete_row(row_root);
+    Ak_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+
+    map = AK_zone_map_get(table);
+    map->blocks_read = map->blocks_skipped = 0;
+    result = AK_search_unsorted(table, params, 1);
+    printf("Range search after insert and delete: %d rows, %d blocks read, %d blocks skipped\n", result.iNum_tuple_addresses, map->blocks_read, map->blocks_skipped);
+    passed &= result.iNum_tuple_addresses == 1000;
+    AK_deallocate_search_result(result);
+
+    //equality on a day is checked by zone map and Bloom filter
+    params[0].iSearchType = SEARCH_PARTICULAR;
+    params[0].pData_lower = &day;
+    params[0].szAttribute = "day";
+    day = 20350;
+    result = AK_search_unsorted(table, params, 1);
+    printf("Day search: %d rows\n", result.iNum_tuple_addresses);
+    passed &= result.iNum_tuple_addresses == 11;
+    AK_deallocate_search_result(result);
+
+    params[0].szAttribute = "code";
+    params[0].pData_lower = code;
+    for (i = 0; i < 3; i++) {
+        //code17000 belonged to the deleted row
+        strcpy(code, i == 0 ? "code12345" : i == 1 ? "inserted" : "code17000");
+        map->blocks_read = map->blocks_skipped = 0;
+        result = AK_search_unsorted(table, params, 1);
+        printf("Code search %s: %d rows, %d blocks read, %d blocks skipped\n", code, result.iNum_tuple_addresses, map->blocks_read, map->blocks_skipped);
+        passed &= result.iNum_tuple_addresses == (i < 2) && map->blocks_read <= 5;
+        AK_deallocate_search_result(result);
+    }
+
+    //codes that are not in the table show the false positive rate
+    for (i = 0; i < 100; i++) {
+        sprintf(code, "missing%03d", i);
+        map->blocks_read = map->blocks_skipped = 0;
+        result = AK_search_unsorted(table, params, 1);
+        read += map->blocks_read;
+        passed &= result.iNum_tuple_addresses == 0;
+        AK_deallocate_search_result(result);
+    }
+    printf("Missing codes: %.2f%% of blocks read\n", 100.0 * read / (100 * map->num_blocks));
+    passed &= read < 5 * map->num_blocks;
+
+    //no zone map keeps blocks of a deleted table
+    address = map->addresses.address_from[0];
+    AK_delete_segment(table, SEGMENT_TYPE_TABLE);
+    printf("Zone map of block %d after the table was deleted: %s\n", address, AK_zone_map_find(address, &i) == NULL ? "none" : "kept");
+    passed &= AK_zone_map_find(address, &i) == NULL;
+
+    printf("\nTest %s\n", passed ? "SUCCESS" : "FAILED");
+    AK_EPI;
+}
@@ -0,0 +1,162 @@
+/**
+@file zonemap.h Header file that provides data structures and functions for block zone maps (min/max summaries)
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef ZONEMAP
+#define ZONEMAP
+
+#include <math.h>
+#include "../mm/memoman.h"
+#include "table.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def ZONE_MAP_SEGMENTS
+  * @brief Constant declaring number of segments which have a zone map in memory
+  */
+#define ZONE_MAP_SEGMENTS 32
+
+/**
+  * @def ZONE_MAP_UNKNOWN
+  * @brief Constant declaring block whose zone map has to be built from block data
+  */
+#define ZONE_MAP_UNKNOWN 0
+
+/**
+  * @def ZONE_MAP_VALID
+  * @brief Constant declaring block whose zone map covers all of its values
+  */
+#define ZONE_MAP_VALID 1
+
+/**
+  * @def ZONE_MAP_READ
+  * @brief Result of AK_zone_map_check: block may hold matching rows and has to be read
+  */
+#define ZONE_MAP_READ 0
+
+/**
+  * @def ZONE_MAP_SKIP
+  * @brief Result of AK_zone_map_check: block has rows but none of them can match
+  */
+#define ZONE_MAP_SKIP 1
+
+/**
+  * @def ZONE_MAP_EMPTY
+  * @brief Result of AK_zone_map_check: block has no rows
+  */
+#define ZONE_MAP_EMPTY 2
+
+/**
+  * @def ZONE_MAP_BLOOM_MAX_HASHES
+  * @brief Constant declaring maximal number of hash functions of a Bloom filter
+  */
+#define ZONE_MAP_BLOOM_MAX_HASHES 16
+
+/**
+ * @struct AK_zone
+ * @brief Structure that holds summary of values of one attribute in one block
+ */
+typedef struct {
+    /// smallest value, HUGE_VAL if block has no value
+    double min;
+    /// largest value, -HUGE_VAL if block has no value
+    double max;
+    /// 1 if some row of the block has null, null satisfies no range or equality so it does not keep the block from
+    /// being skipped
+    int has_null;
+} AK_zone;
+
+/**
+ * @struct AK_zone_filter
+ * @brief Structure that holds conditions of a scan which zone maps can prove false for a whole block: inclusive ranges
+          of numeric attributes and equalities of other attributes. All of them have to hold.
+ */
+typedef struct {
+    /// number of ranges
+    int num_ranges;
+    /// attribute index of every range
+    int range_column[MAX_ATTRIBUTES];
+    /// lower bound of every range
+    double lower[MAX_ATTRIBUTES];
+    /// upper bound of every range
+    double upper[MAX_ATTRIBUTES];
+    /// number of equalities
+    int num_values;
+    /// attribute index of every equality
+    int value_column[MAX_ATTRIBUTES];
+    /// value data of every equality
+    const char *value[MAX_ATTRIBUTES];
+    /// value size of every equality
+    int value_size[MAX_ATTRIBUTES];
+} AK_zone_filter;
+
+/**
+ * @struct AK_zone_map
+ * @brief Structure that holds zone maps of all blocks of one segment. Zone maps are kept only in memory and built
+          from blocks that scans read anyway. Inserts widen them, updates and deletes invalidate them, so a valid zone
+          map always covers every value of its block. Attributes chosen by AK_zone_map_set_bloom also get a Bloom
+          filter per block, so equality conditions can skip blocks on attributes without an index. Like zone maps,
+          Bloom filter settings are per session.
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// number of attributes
+    int num_attr;
+    /// types of attributes
+    int type[MAX_ATTRIBUTES];
+    /// extents the zone maps were built for
+    table_addresses addresses;
+    /// number of blocks in all extents
+    int num_blocks;
+    /// ZONE_MAP_UNKNOWN or ZONE_MAP_VALID for every block
+    int *state;
+    /// number of rows of every block
+    int *rows;
+    /// num_attr zones for every block
+    AK_zone *zones;
+    /// size of Bloom filter of one block in bytes for every attribute, 0 if attribute has no Bloom filter
+    int bloom_size[MAX_ATTRIBUTES];
+    /// number of hash functions of Bloom filters of every attribute
+    int bloom_hashes[MAX_ATTRIBUTES];
+    /// Bloom filters of all blocks for every attribute
+    unsigned char *bloom[MAX_ATTRIBUTES];
+    /// number of open scans that use the zone map, it is not freed while they are open
+    int pins;
+    /// number of blocks skipped by scans
+    int blocks_skipped;
+    /// number of blocks scans had to read
+    int blocks_read;
+} AK_zone_map;
+
+int AK_zone_map_tracked(int type);
+AK_zone_map *AK_zone_map_get(char *table);
+AK_zone_map *AK_zone_map_open(char *table);
+void AK_zone_map_close(AK_zone_map *map);
+int AK_zone_map_set_bloom(char *table, char *attribute, double false_positive_rate, int max_size);
+void AK_zone_filter_init(AK_zone_filter *filter);
+int AK_zone_map_check(AK_zone_map *map, int address, AK_zone_filter *filter);
+void AK_zone_map_refresh(AK_zone_map *map, AK_block *block);
+void AK_zone_map_update_block(AK_block *block);
+void AK_zone_map_insert_row(AK_block *block, int slot);
+void AK_zone_map_invalidate(int address);
+void AK_zone_map_release_extent(int begin, int end);
+void AK_zone_map_drop(char *table);
+void AK_zone_map_test();
+
+#endif
@@ -33,7 +33,13 @@
 #include "mm/memoman.h"
 // File management
 #include "file/fileio.h"
+#include "file/tuple.h"
+#include "file/bulkload.h"
+#include "file/vacuum.h"
 #include "file/files.h"
+#include "file/filter.h"
+#include "file/zonemap.h"
+#include "file/scan.h"
 #include "file/filesearch.h"
 #include "file/filesort.h"
 #include "file/table.h"
@@ -67,6 +73,9 @@
 #include "sql/cs/nnull.h"
 #include "sql/cs/unique.h"
 #include "rel/expression_check.h"
+#include "rel/iterator.h"
+#include "rel/batch.h"
+#include "rel/set_op.h"
 #include "sql/drop.h"
 #include "sql/cs/check_constraint.h"
 //Other
@@ -104,9 +113,15 @@ function fun[] = {
 {"file: AK_lo", &AK_lo_test}, //file/blobs.c
 {"file: Ak_files_test", &Ak_files_test}, //file/files.c
 {"file: Ak_fileio_test", &Ak_fileio_test}, //file/fileio.c
+{"file: AK_tuple", &AK_tuple_test}, //file/tuple.c
+{"file: AK_bulk_load", &AK_bulk_load_test}, //file/bulkload.c
+{"file: AK_vacuum", &AK_vacuum_test}, //file/vacuum.c
 {"file: AK_op_rename", &AK_op_rename_test}, //file/table.c
 {"file: Ak_filesort", &Ak_filesort_test}, //file/filesort.c
 {"file: Ak_filesearch", &Ak_filesearch_test}, //file/filesearch.c
+{"file: AK_filter", &AK_filter_test}, //file/filter.c
+{"file: AK_zone_map", &AK_zone_map_test}, //file/zonemap.c
+{"file: AK_scan", &AK_scan_test}, //file/scan.c
 //file/idx:
 //-------------
 {"idx: Ak_bitmap", &Ak_bitmap_test}, //file/idx/bitmap.c
@@ -136,6 +151,10 @@ function fun[] = {
 {"rel: AK_op_projection", &AK_op_projection_test}, //rel/projection.c
 {"rel: AK_op_theta_join", &AK_op_theta_join_test}, //rel/theta_join.c
 {"rel: AK_op_selection_test_redolog", &AK_op_selection_test_redolog}, //rel/selection.c
+{"rel: Ak_expression_check", &Ak_expression_check_test}, //rel/expression_check.c
+{"rel: AK_iterator", &AK_iterator_test}, //rel/iterator.c
+{"rel: AK_batch", &AK_batch_test}, //rel/batch.c
+{"rel: AK_set_op", &AK_set_op_test}, //rel/set_op.c
 //sql:
 //--------
 {"sql: AK_drop", &AK_drop_test}, //sql/drop.c
@@ -444,6 +444,27 @@ void AK_mem_block_modify(AK_mem_block* mem_block, int dirty)
     AK_EPI;
 }
 
+/**
+ * @brief Function looks for a block in cache without reading it from disk
+ * @param num block number (address)
+ * @return cached block, NULL if block is not in cache
+ */
+AK_mem_block *AK_get_cached_block(int num)
+{
+    int i;
+    AK_PRO;
+    for (i = 0; i < MAX_CACHE_MEMORY; i++)
+    {
+        if (db_cache->cache[i]->timestamp_read != -1 && db_cache->cache[i]->block->address == num)
+        {
+            AK_EPI;
+            return db_cache->cache[i];
+        }
+    }
+    AK_EPI;
+    return NULL;
+}
+
 /**
  * @author Matija Šestak.
  * @brief  Function re-read all the blocks from disk
@@ -620,7 +641,7 @@ table_addresses *AK_get_segment_addresses(char * segmentName)
     char name[MAX_VARCHAR_LENGTH];
     int address_from;
     int address_to;
-    int j = 0;
+    int j = 0, k;
     for (i = 0; i < DATA_BLOCK_SIZE; i++)
     {
         if (mem_block->block->tuple_dict[i].type == FREE_INT)
@@ -637,8 +658,15 @@ table_addresses *AK_get_segment_addresses(char * segmentName)
 //if found the table that addresses we need
         if (strcmp(name, segmentName) == 0)
         {
-            addresses->address_from[j] = address_from;
-            addresses->address_to[j] = address_to;
+            //rows may reuse deleted slots of AK_relation, so extents are put in the order of their start addresses, which
+            //does not change when extents are added or released
+            for (k = j; k > 0 && addresses->address_from[k - 1] > address_from; k--)
+            {
+                addresses->address_from[k] = addresses->address_from[k - 1];
+                addresses->address_to[k] = addresses->address_to[k - 1];
+            }
+            addresses->address_from[k] = address_from;
+            addresses->address_to[k] = address_to;
             j++;
             Ak_dbg_messg(HIGH, MEMO_MAN, "get_segment_addresses(%s): Found addresses of searching segment: %d , %d \n", name, address_from, address_to);
         }
@@ -709,8 +737,9 @@ int AK_find_AK_free_space(table_addresses * addresses)
 
                 Ak_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: FREE SPACE %d\n", mem_block->block->AK_free_space);
 
-                if ((AK_free_space_on < MAX_FREE_SPACE_SIZE) &&
-                        (mem_block->block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE))  //found AK_free block to write
+                //space of deleted values and slots of deleted rows are reused by insert
+                if ((AK_free_space_on < MAX_FREE_SPACE_SIZE || AK_free_space_on - mem_block->block->deleted_space < MAX_FREE_SPACE_SIZE) &&
+                        (mem_block->block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE || mem_block->block->free_slot != FREE_INT))  //found AK_free block to write
                 {
                     AK_EPI;
                     return i;
@@ -738,10 +767,11 @@ int AK_find_AK_free_space(table_addresses * addresses)
         SEGMENT_TYPE_INDEX,
         SEGMENT_TYPE_TRANSACTION,
         SEGMENT_TYPE_TEMP
+  * @param min_size minimal number of blocks in new extent, 0 to just grow the largest extent by its resize factor
   * @return address of new extent, otherwise EXIT_ERROR
 
  */
-int AK_init_new_extent(char *table_name, int extent_type)
+int AK_init_new_extent_size(char *table_name, int extent_type, int min_size)
 {
     char *sys_table;
 
@@ -774,14 +804,6 @@ int AK_init_new_extent(char *table_name, int extent_type)
 
     old_size++;
 
-    if ((start_address = AK_new_extent(1, old_size, extent_type, mem_block->block->header)) == EXIT_ERROR)
-    {
-        printf("AK_init_new_extent: Could not allocate the new extent\n");
-        AK_EPI;
-        return EXIT_ERROR;
-    }
-    Ak_dbg_messg(HIGH, MEMO_MAN, "AK_init_new_extent: start_address=%i, old_size=%i, extent_type=%i\n", start_address, old_size, extent_type);
-
     switch (extent_type)
     {
     case SEGMENT_TYPE_TABLE:
@@ -798,10 +820,22 @@ int AK_init_new_extent(char *table_name, int extent_type)
         break;
     case SEGMENT_TYPE_TEMP:
         RESIZE_FACTOR = EXTENT_GROWTH_TEMP;
-        printf("Not implemented yet!\n");
+        sys_table = "AK_relation";
         break;
     }
 
+    //AK_new_extent allocates old_size grown by the resize factor
+    if (min_size > 0 && old_size + old_size * RESIZE_FACTOR < min_size)
+        old_size = (int) (min_size / (1 + RESIZE_FACTOR)) + 1;
+
+    if ((start_address = AK_new_extent(1, old_size, extent_type, mem_block->block->header)) == EXIT_ERROR)
+    {
+        printf("AK_init_new_extent: Could not allocate the new extent\n");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    Ak_dbg_messg(HIGH, MEMO_MAN, "AK_init_new_extent: start_address=%i, old_size=%i, extent_type=%i\n", start_address, old_size, extent_type);
+
     end_address = start_address + (old_size + old_size * RESIZE_FACTOR);
     //mem_block = (AK_mem_block *) AK_get_block(0);
 
@@ -817,6 +851,20 @@ int AK_init_new_extent(char *table_name, int extent_type)
     return start_address;
 }
 
+/**
+ * @brief Function that extends the segment by growing its largest extent
+ * @param table_name name of segment to extent
+ * @param extent_type type of extent
+ * @return address of new extent, otherwise EXIT_ERROR
+ */
+int AK_init_new_extent(char *table_name, int extent_type)
+{
+    AK_PRO;
+    int start_address = AK_init_new_extent_size(table_name, extent_type, 0);
+    AK_EPI;
+    return start_address;
+}
+
 /**
  * @author Matija Šestak
  * @brief Function that flushes memory blocks to disk file
@@ -840,6 +888,7 @@ int AK_flush_cache()
                 AK_EPI;
                 exit(EXIT_ERROR);
             }
+            db_cache->cache[i]->dirty = BLOCK_CLEAN;
         }
         i++;
     }
@@ -847,6 +896,40 @@ int AK_flush_cache()
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Function that flushes dirty memory blocks of the given extents to disk file, blocks of other segments stay
+          dirty in the cache
+ * @param addresses extents whose blocks are written
+ * @return EXIT_SUCCESS
+ */
+int AK_flush_cache_addresses(table_addresses *addresses)
+{
+    int i, j, address;
+    AK_PRO;
+    for (i = 0; i < MAX_CACHE_MEMORY; i++)
+    {
+        if (db_cache->cache[i]->dirty != BLOCK_DIRTY)
+            continue;
+        address = db_cache->cache[i]->block->address;
+        for (j = 0; j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++)
+        {
+            if (address >= addresses->address_from[j] && address < addresses->address_to[j])
+                break;
+        }
+        if (j == MAX_EXTENTS_IN_SEGMENT || addresses->address_from[j] == 0)
+            continue;
+        /// if block form cache can not be writed to DB file -> EXIT_ERROR
+        if (AK_write_block(db_cache->cache[i]->block) != EXIT_SUCCESS)
+        {
+            AK_EPI;
+            exit(EXIT_ERROR);
+        }
+        db_cache->cache[i]->dirty = BLOCK_CLEAN;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
 void AK_memoman_test()
 {
     int i;
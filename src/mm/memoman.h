@@ -156,6 +156,7 @@ int AK_redo_log_AK_malloc();
 int AK_query_mem_AK_malloc();
 int AK_memoman_init();
 AK_mem_block *AK_get_block(int num);
+AK_mem_block *AK_get_cached_block(int num);
 void AK_mem_block_modify(AK_mem_block* mem_block, int dirty);
 int AK_refresh_cache();
 
@@ -165,8 +166,10 @@ table_addresses *AK_get_index_segment_addresses(char * segmentName);
 table_addresses *AK_get_table_addresses(char *table);
 table_addresses *AK_get_index_addresses(char * index);
 int AK_find_AK_free_space(table_addresses * addresses);
+int AK_init_new_extent_size(char *table_name, int extent_type, int min_size);
 int AK_init_new_extent(char *table_name, int extent_type);
 int AK_flush_cache();
+int AK_flush_cache_addresses(table_addresses *addresses);
 void AK_memoman_test();
 void AK_memoman_test2();
 
@@ -132,6 +132,114 @@ struct list_node *AK_execute_rel_eq(struct list_node *list_query, const char rel
     AK_EPI;
 }
     
+/**
+ * @brief Replace every sort followed by a limit with a top-k operator, which reads its input once and keeps only the
+ * limit number of rows in memory (see AK_sort_top). A sort is RO_SORT followed by its attributes (for example
+ * "value DESC;id"), a limit is RO_LIMIT followed by the number of rows as a condition. The list is postfix, so only
+ * "o (attributes) l (rows)" (first rows of the sorted input) becomes "k (attributes) (rows)"; "l (rows) o (attributes)"
+ * sorts any rows the limit takes and is left as it is.
+ * @param *list_query RA expresion list
+ * @return returns the same RA expresion list with sorts and limits replaced
+ */
+struct list_node *AK_query_optimization_top_k(struct list_node *list_query) {
+    AK_PRO;
+    struct list_node *list_elem = (struct list_node *) Ak_First_L2(list_query);
+    struct list_node *param, *next_op, *next_param;
+
+    while (list_elem != NULL) {
+        param = list_elem->next;
+        next_op = param ? param->next : NULL;
+        next_param = next_op ? next_op->next : NULL;
+
+        //o (attributes) l (rows) -> k (attributes) (rows)
+        if (list_elem->type == TYPE_OPERATOR && list_elem->data[0] == RO_SORT && next_op != NULL && next_param != NULL
+                && next_op->type == TYPE_OPERATOR && next_op->data[0] == RO_LIMIT
+                && param->type == TYPE_ATTRIBS && next_param->type == TYPE_CONDITION) {
+            list_elem->data[0] = RO_TOP_K;
+            Ak_Delete_L3(&next_op, &list_query);
+            Ak_dbg_messg(LOW, REL_EQ, "top_k: sort (%s) with limit (%s) replaced\n", param->data, next_param->data);
+        }
+        list_elem = list_elem->next;
+    }
+    AK_EPI;
+    return list_query;
+}
+
+/**
+ * @brief Check whether an input of a join in an RA expresion list is known to be ordered by keys. Known inputs are a
+ * table recorded as ordered (see AK_sort_is_ordered) and a table followed by a sort whose attributes start with keys.
+ * @param *list_query RA expresion list
+ * @param *last last element of the input
+ * @param *keys keys
+ * @param num_keys number of keys
+ * @return first element of the input if it is ordered, NULL otherwise
+ */
+static struct list_node *AK_query_optimization_ordered(struct list_node *list_query, struct list_node *last, AK_sort_key *keys, int num_keys) {
+    AK_PRO;
+    AK_sort_key sort_keys[MAX_ATTRIBUTES];
+    struct list_node *sort, *table;
+    int num_sort_keys, i;
+
+    if (last == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    if (last->type == TYPE_OPERAND) {
+        table = AK_sort_is_ordered(last->data, keys, num_keys) ? last : NULL;
+        AK_EPI;
+        return table;
+    }
+
+    //table o (attributes)
+    sort = last->type == TYPE_ATTRIBS ? (struct list_node *) Ak_Previous_L2(last, list_query) : NULL;
+    table = sort != NULL && sort->type == TYPE_OPERATOR && sort->data[0] == RO_SORT ? (struct list_node *) Ak_Previous_L2(sort, list_query) : NULL;
+    if (table == NULL || table->type != TYPE_OPERAND) {
+        AK_EPI;
+        return NULL;
+    }
+    num_sort_keys = AK_sort_parse_keys(last->data, sort_keys);
+    for (i = 0; i < num_keys && i < num_sort_keys; i++) {
+        if (strcmp(sort_keys[i].att_name, keys[i].att_name) != 0 || sort_keys[i].order != keys[i].order)
+            break;
+    }
+    AK_EPI;
+    return i == num_keys ? table : NULL;
+}
+
+/**
+ * @brief Replace every natural join whose both inputs are known to be ordered by join attributes with a merge join,
+ * which reads both inputs once without hashing them (see AK_join_merge). A natural join is RO_NAT_JOIN followed by
+ * its attributes (for example "mbr;id_prof"), its inputs are tables or tables followed by a sort. The result is
+ * RO_MERGE_JOIN with the same attributes.
+ * @param *list_query RA expresion list
+ * @return returns the same RA expresion list with merge joins
+ */
+struct list_node *AK_query_optimization_merge_join(struct list_node *list_query) {
+    AK_PRO;
+    struct list_node *list_elem = (struct list_node *) Ak_First_L2(list_query);
+    struct list_node *second, *first;
+    AK_sort_key keys[MAX_ATTRIBUTES];
+    int num_keys, i;
+
+    while (list_elem != NULL) {
+        if (list_elem->type == TYPE_OPERATOR && list_elem->data[0] == RO_NAT_JOIN && list_elem->next != NULL
+                && list_elem->next->type == TYPE_ATTRIBS) {
+            num_keys = AK_sort_parse_keys(list_elem->next->data, keys);
+            for (i = 0; i < num_keys; i++)
+                keys[i].order = SORT_ASC;
+            second = AK_query_optimization_ordered(list_query, (struct list_node *) Ak_Previous_L2(list_elem, list_query), keys, num_keys);
+            first = second ? AK_query_optimization_ordered(list_query, (struct list_node *) Ak_Previous_L2(second, list_query), keys, num_keys) : NULL;
+            if (first != NULL) {
+                list_elem->data[0] = RO_MERGE_JOIN;
+                Ak_dbg_messg(LOW, REL_EQ, "merge_join: natural join on (%s) of ordered inputs replaced\n", list_elem->next->data);
+            }
+        }
+        list_elem = list_elem->next;
+    }
+    AK_EPI;
+    return list_query;
+}
+
 /**
  * @author Dino Laktašić.
  * @brief Execute all relational equivalences provided by FLAGS (one or more), 
@@ -176,6 +284,11 @@ struct list_node *AK_query_optimization(struct list_node *list_query, const char
     	list_elem = list_elem->next;
     }
 
+    //a sort followed by a limit is always cheaper as top-k, whatever FLAGS are given
+    AK_query_optimization_top_k(list_query);
+    //a natural join of inputs ordered by join attributes is always cheaper as merge join
+    AK_query_optimization_merge_join(list_query);
+
     temp = list_query;
 
     //Get total permutation without repetition number
@@ -326,6 +439,15 @@ struct list_node *mylist9 = (struct list_node *) AK_malloc(sizeof (struct list_n
 struct list_node *mylist10 = (struct list_node *) AK_malloc(sizeof (struct list_node));
     Ak_Init_L3(&mylist10);
 
+struct list_node *mylist11 = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&mylist11);
+
+struct list_node *mylist12 = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&mylist12);
+
+struct list_node *mylist13 = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&mylist13);
+
 
     //*Associativity of union and intersection
     Ak_InsertAtEnd_L3(TYPE_OPERAND, "professor", sizeof ("professor"), mylist);
@@ -406,6 +528,36 @@ struct list_node *mylist10 = (struct list_node *) AK_malloc(sizeof (struct list_
     Ak_InsertAtEnd_L3(TYPE_OPERATOR, "u", sizeof ("u"),  mylist9);
     //*/
 
+    //*Sort followed by limit is replaced with top-k
+    Ak_InsertAtEnd_L3(TYPE_OPERAND, "student", sizeof ("student"), mylist11);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "o", sizeof ("o"), mylist11);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "year DESC;lastname", sizeof ("year DESC;lastname"), mylist11);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "l", sizeof ("l"), mylist11);
+    Ak_InsertAtEnd_L3(TYPE_CONDITION, "5", sizeof ("5"), mylist11);
+    //*/
+
+    //*Limit followed by sort sorts any 5 rows, it is not replaced with top-k
+    Ak_InsertAtEnd_L3(TYPE_OPERAND, "student", sizeof ("student"), mylist13);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "l", sizeof ("l"), mylist13);
+    Ak_InsertAtEnd_L3(TYPE_CONDITION, "5", sizeof ("5"), mylist13);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "o", sizeof ("o"), mylist13);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "year DESC;lastname", sizeof ("year DESC;lastname"), mylist13);
+    //*/
+
+    //*Natural join of tables ordered by join attributes is replaced with merge join
+    AK_sort_key merge_key;
+    memset(&merge_key, 0, sizeof (AK_sort_key));
+    strcpy(merge_key.att_name, "id_prof");
+    merge_key.order = SORT_ASC;
+    AK_sort_set_order("professor", &merge_key, 1);
+    Ak_InsertAtEnd_L3(TYPE_OPERAND, "professor", sizeof ("professor"), mylist12);
+    Ak_InsertAtEnd_L3(TYPE_OPERAND, "student", sizeof ("student"), mylist12);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "o", sizeof ("o"), mylist12);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof;year", sizeof ("id_prof;year"), mylist12);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "n", sizeof ("n"), mylist12);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof", sizeof ("id_prof"), mylist12);
+    //*/
+
     //*Associativity of theta-joins
     Ak_InsertAtEnd_L3(TYPE_OPERAND, "professor", sizeof ("professor"), mylist10);
     Ak_InsertAtEnd_L3(TYPE_OPERAND, "student", sizeof ("student"), mylist10);
@@ -428,6 +580,10 @@ struct list_node *mylist10 = (struct list_node *) AK_malloc(sizeof (struct list_
    AK_print_optimized_query(AK_query_optimization(mylist8, "a", 1));
    AK_print_optimized_query(AK_query_optimization(mylist9, "a", 1));
   AK_print_optimized_query(AK_query_optimization(mylist10, "a", 1));
+   AK_print_optimized_query(AK_query_optimization(mylist11, "c", 1));
+   AK_print_optimized_query(AK_query_optimization(mylist12, "c", 1));
+   AK_print_optimized_query(AK_query_optimization(mylist13, "c", 1));
+   AK_sort_set_order("professor", NULL, 0);
 
 //    time_t end = clock();
   
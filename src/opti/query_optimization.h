@@ -27,6 +27,7 @@
 
 #include "../auxi/mempro.h"
 #include "../sql/view.h"
+#include "../file/filesort.h"
 
 /**
  * @def MAX_PERMUTATION
@@ -37,6 +38,8 @@
 
 void AK_print_optimized_query(struct list_node *list_query);
 struct list_node *AK_execute_rel_eq(struct list_node *list_query, const char rel_eq, const char *FLAGS);
+struct list_node *AK_query_optimization_top_k(struct list_node *list_query);
+struct list_node *AK_query_optimization_merge_join(struct list_node *list_query);
 struct list_node *AK_query_optimization(struct list_node *list_query, const char *FLAGS, const int DIFF_PLANS);
 void AK_query_optimization_test() ; // (struct list_node *list_query)
 
@@ -19,6 +19,7 @@
 
 #include "rel_eq_assoc.h"
 #include "rel_eq_projection.h"
+#include "rel_eq_selection.h"
 
 /**
  * @author Dino Laktašić
@@ -353,6 +354,14 @@ struct list_node *AK_rel_eq_assoc(struct list_node *list_rel_eq) {
                         Ak_dbg_messg(MIDDLE, REL_EQ, "::operator %s inserted in temp list\n", list_elem->data);
                         break;
 
+
+                    case RO_SORT:
+                    case RO_MERGE_JOIN:
+                    case RO_LIMIT:
+                    case RO_TOP_K:
+                        list_elem = AK_rel_eq_copy_barrier(list_elem, temp);
+                        break;
+
                     default:
                         Ak_dbg_messg(LOW, REL_EQ, "Invalid operator: %s", list_elem->data);
                         break;
@@ -452,6 +452,30 @@ struct list_node *AK_rel_eq_split_condition(char *cond) {
     return list_attr;
 }
 
+/**
+ * @brief Function copies an operator that is a barrier for equivalence rules to the end of the temp list together with
+          its operands: sort (RO_SORT) and merge join (RO_MERGE_JOIN, which relies on the order of its inputs) are
+          copied with their attributes, limit (RO_LIMIT) with its number of rows and top-k (RO_TOP_K) with its
+          attributes and number of rows
+ * @param list_elem element of the operator
+ * @param temp temp list
+ * @return last copied element, the rules go on after it
+ */
+struct list_node *AK_rel_eq_copy_barrier(struct list_node *list_elem, struct list_node *temp) {
+    AK_PRO;
+    Ak_InsertAtEnd_L3(list_elem->type, list_elem->data, list_elem->size, temp);
+    Ak_InsertAtEnd_L3(list_elem->next->type, list_elem->next->data, list_elem->next->size, temp);
+    if (list_elem->data[0] != RO_TOP_K) {
+        Ak_dbg_messg(MIDDLE, REL_EQ, "::operator %s inserted with (%s) in temp list\n", list_elem->data, list_elem->next->data);
+        AK_EPI;
+        return list_elem->next;
+    }
+    Ak_InsertAtEnd_L3(list_elem->next->next->type, list_elem->next->next->data, list_elem->next->next->size, temp);
+    Ak_dbg_messg(MIDDLE, REL_EQ, "::operator %s inserted with attributes (%s) and rows (%s) in temp list\n", list_elem->data, list_elem->next->data, list_elem->next->next->data);
+    AK_EPI;
+    return list_elem->next->next;
+}
+
 /**
  * @author Dino Laktašić.
  * @brief Main function for generating RA expresion according to selection equivalence rules 
@@ -702,6 +726,14 @@ struct list_node *AK_rel_eq_selection(struct list_node *list_rel_eq) {
                         Ak_dbg_messg(MIDDLE, REL_EQ, "::operator %s inserted in temp list\n", list_elem->data);
                         break;
 
+
+                    case RO_SORT:
+                    case RO_MERGE_JOIN:
+                    case RO_LIMIT:
+                    case RO_TOP_K:
+                        list_elem = AK_rel_eq_copy_barrier(list_elem, temp);
+                        break;
+
                     default:
                         Ak_dbg_messg(LOW, REL_EQ, "Invalid operator: %s", list_elem->data);
                         break;
@@ -28,6 +28,7 @@ char *AK_rel_eq_get_atrributes_char(char *tblName) ;
 char *AK_rel_eq_cond_attributes(char *cond) ;
 int AK_rel_eq_share_attributes(char *set, char *subset) ;
 struct list_node *AK_rel_eq_split_condition(char *cond) ;
+struct list_node *AK_rel_eq_copy_barrier(struct list_node *list_elem, struct list_node *temp);
 struct list_node *AK_rel_eq_selection(struct list_node *list_rel_eq);
 void AK_print_rel_eq_selection(struct list_node *list_rel_eq) ;
 void AK_rel_eq_selection_test();
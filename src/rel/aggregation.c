@@ -17,9 +17,88 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 
+#include <time.h>
 #include "aggregation.h"
 
-extern search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int iNum_search_params);
+/**
+  * @def AGG_HASH_SEED
+  * @brief Initial value of hashes of group values (FNV-1a)
+  */
+#define AGG_HASH_SEED 2166136261u
+
+/// bytes of memory for groups set by AK_aggregation_set_memory, 0 if AGG_MEMORY is used
+static int AK_agg_forced_memory = 0;
+
+/// number of partitions written to temporary segments by the last aggregation
+static int AK_agg_last_spilled = 0;
+
+/// deepest partitioning of the last aggregation, 0 if it was done in memory
+static int AK_agg_last_depth = 0;
+
+/**
+ * @struct AK_agg_accumulator
+ * @brief Structure that holds an aggregate of one group. Sum, minimum or maximum is kept in the type of the attribute.
+ */
+typedef struct {
+    /// number of values that are not null
+    int count;
+    /// sum, minimum or maximum of int values
+    long long int_value;
+    /// sum, minimum or maximum of float values
+    float float_value;
+    /// sum, minimum or maximum of number values
+    double number_value;
+} AK_agg_accumulator;
+
+/**
+ * @struct AK_agg_state
+ * @brief Structure that holds state of a hash aggregation. Groups are chained in buckets by hashes of their group
+          values; group values are kept in a row buffer and accumulators in an array indexed by group.
+ */
+typedef struct {
+    /// header of the source table
+    AK_header source[MAX_ATTRIBUTES];
+    /// number of attributes of the source table
+    int num_source;
+    /// header of the aggregated table
+    AK_header header[MAX_ATTRIBUTES];
+    /// number of attributes of the aggregated table
+    int num_attr;
+    /// AGG_TASK_* of every attribute of the aggregated table
+    int task[MAX_ATTRIBUTES];
+    /// source attribute of every attribute of the aggregated table
+    int columns[MAX_ATTRIBUTES];
+    /// number of group attributes
+    int num_group;
+    /// source attribute of every group attribute
+    int group[MAX_ATTRIBUTES];
+    /// group values of groups
+    AK_iterator_buffer keys;
+    /// hash of group values of every group
+    unsigned int *group_hash;
+    /// next group in the same bucket, -1 at the end of chain
+    int *chain;
+    /// num_attr accumulators of every group
+    AK_agg_accumulator *acc;
+    /// number of groups
+    int num_groups;
+    /// number of groups arrays can hold
+    int capacity_groups;
+    /// first group of every bucket, -1 for empty bucket
+    int *buckets;
+    /// number of buckets minus one (number of buckets is a power of two)
+    unsigned int mask;
+    /// bytes of memory for groups
+    int memory;
+    /// bulk load of the aggregated table
+    AK_bulk_loader loader;
+    /// number of rows written to the aggregated table
+    int num_written;
+    /// number of partitions written to temporary segments
+    int num_spilled;
+    /// deepest partitioning
+    int max_depth;
+} AK_agg_state;
 
 /**
  @author Dejan Frankovic
@@ -113,7 +192,8 @@ int AK_agg_input_add_to_beginning(AK_header header, int agg_task, AK_agg_input *
   @brief This function is used to handle AVG (average) aggregation. It  goes through array of tasks in input
           object until it comes to task with value -1. While loop examines whether the task in array is equal to
           AGG_TASK_AVG. If so, AGG_TASK_AVG_COUNT is put on the beginning of input object. After that,
-          AGG_TASK_AVG_SUM is put on the begginig of input object.
+          AGG_TASK_AVG_SUM is put on the begginig of input object. AK_aggregation computes averages from its own
+          sums and counts and skips these tasks.
   @param input the input object
   @return No return value
  */
@@ -132,540 +212,667 @@ void AK_agg_input_fix(AK_agg_input *input) {
     AK_EPI;
 }
 
+/**
+ * @brief Function sets number of bytes of memory for groups of an aggregation, for example to aggregate a table whose
+          groups fit in memory by partitions
+ * @param bytes number of bytes, 0 for AGG_MEMORY
+ * @return number of bytes that is used
+ */
+int AK_aggregation_set_memory(int bytes) {
+    AK_PRO;
+    AK_agg_forced_memory = bytes < 0 ? 0 : bytes;
+    AK_EPI;
+    return AK_agg_forced_memory ? AK_agg_forced_memory : AGG_MEMORY;
+}
+
+/**
+ * @brief Function hashes group values of a row (FNV-1a). Values are hashed with their types, so values of different
+          types (a null is a varchar) have different hashes, and 0.0 and -0.0 are hashed as 0.0.
+ * @param agg aggregation
+ * @param value values of the row
+ * @return hash
+ */
+static unsigned int AK_agg_hash(AK_agg_state *agg, AK_iterator_value *value) {
+    unsigned int hash = AGG_HASH_SEED;
+    float number_float;
+    double number_double;
+    char *data;
+    int i, j, size;
+    AK_iterator_value *key;
+
+    for (i = 0; i < agg->num_group; i++) {
+        key = &value[agg->group[i]];
+        data = key->data;
+        size = key->size;
+        if (key->type == TYPE_FLOAT) {
+            memcpy(&number_float, key->data, sizeof (float));
+            if (number_float == 0)
+                number_float = 0;
+            data = (char *) &number_float;
+            size = sizeof (float);
+        } else if (key->type == TYPE_NUMBER) {
+            memcpy(&number_double, key->data, sizeof (double));
+            if (number_double == 0)
+                number_double = 0;
+            data = (char *) &number_double;
+            size = sizeof (double);
+        }
+        hash = (hash ^ (unsigned int) key->type) * 16777619u;
+        for (j = 0; j < size; j++)
+            hash = (hash ^ (unsigned char) data[j]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Function returns memory taken by groups of an aggregation
+ * @param agg aggregation
+ * @return number of bytes
+ */
+static long AK_agg_memory_used(AK_agg_state *agg) {
+    return agg->keys.size + (long) agg->num_groups * (agg->num_group * 3 * sizeof (int) + 2 * sizeof (int)
+            + agg->num_attr * sizeof (AK_agg_accumulator)) + (long) (agg->mask + 1) * sizeof (int);
+}
+
+/**
+ * @brief Function chains groups of an aggregation in buckets by hashes of their keys, with twice as many buckets as
+          groups
+ * @param agg aggregation
+ * @return No return value
+ */
+static void AK_agg_index(AK_agg_state *agg) {
+    unsigned int num_buckets;
+    int group;
+
+    for (num_buckets = 16; num_buckets < 2 * (unsigned int) agg->num_groups; num_buckets *= 2)
+        ;
+    agg->mask = num_buckets - 1;
+    agg->buckets = (int *) AK_realloc(agg->buckets, num_buckets * sizeof (int));
+    memset(agg->buckets, -1, num_buckets * sizeof (int));
+    for (group = 0; group < agg->num_groups; group++) {
+        agg->chain[group] = agg->buckets[agg->group_hash[group] & agg->mask];
+        agg->buckets[agg->group_hash[group] & agg->mask] = group;
+    }
+}
+
+/**
+ * @brief Function finds the group of a row of an aggregation and creates it if it is new. Group values are compared
+          by their types (see AK_sort_compare_values), so all nulls of a group attribute fall into one group.
+ * @param agg aggregation
+ * @param value values of the row
+ * @param hash hash of group values of the row
+ * @return index of the group
+ */
+static int AK_agg_group(AK_agg_state *agg, AK_iterator_value *value, unsigned int hash) {
+    AK_iterator_value key[MAX_ATTRIBUTES];
+    int group, i;
+
+    for (group = agg->buckets[hash & agg->mask]; group != -1; group = agg->chain[group]) {
+        if (agg->group_hash[group] != hash)
+            continue;
+        AK_iterator_buffer_get(&agg->keys, group, key);
+        for (i = 0; i < agg->num_group && AK_sort_compare_values(&key[i], &value[agg->group[i]]) == 0; i++)
+            ;
+        if (i == agg->num_group)
+            return group;
+    }
+
+    group = agg->num_groups;
+    if (group == agg->capacity_groups) {
+        agg->capacity_groups = agg->capacity_groups ? 2 * agg->capacity_groups : 64;
+        agg->group_hash = (unsigned int *) AK_realloc(agg->group_hash, agg->capacity_groups * sizeof (unsigned int));
+        agg->chain = (int *) AK_realloc(agg->chain, agg->capacity_groups * sizeof (int));
+        agg->acc = (AK_agg_accumulator *) AK_realloc(agg->acc, agg->capacity_groups * agg->num_attr * sizeof (AK_agg_accumulator));
+    }
+    for (i = 0; i < agg->num_group; i++)
+        key[i] = value[agg->group[i]];
+    AK_iterator_buffer_add(&agg->keys, key);
+    agg->group_hash[group] = hash;
+    memset(&agg->acc[group * agg->num_attr], 0, agg->num_attr * sizeof (AK_agg_accumulator));
+    agg->num_groups++;
+    if ((unsigned int) agg->num_groups > agg->mask) {
+        AK_agg_index(agg);
+    } else {
+        agg->chain[group] = agg->buckets[hash & agg->mask];
+        agg->buckets[hash & agg->mask] = group;
+    }
+    return group;
+}
+
+/**
+ * @brief Function adds values of a row to accumulators of its group. Null values are not aggregated and values of
+          non numeric attributes are only counted. Accumulators keep sums, minimums and maximums in the type of the
+          attribute (sums of int values as long long).
+ * @param agg aggregation
+ * @param value values of the row
+ * @param group group of the row
+ * @return No return value
+ */
+static void AK_agg_accumulate(AK_agg_state *agg, AK_iterator_value *value, int group) {
+    AK_agg_accumulator *acc = &agg->acc[group * agg->num_attr];
+    AK_iterator_value *current;
+    int i, first, number_int;
+    float number_float;
+    double number_double;
+
+    for (i = 0; i < agg->num_attr; i++, acc++) {
+        if (agg->task[i] == AGG_TASK_GROUP)
+            continue;
+        current = &value[agg->columns[i]];
+        if (current->type != agg->source[agg->columns[i]].type)
+            continue;
+        first = acc->count++ == 0;
+        if (agg->task[i] == AGG_TASK_COUNT)
+            continue;
+
+        switch (current->type) {
+            case TYPE_INT:
+                memcpy(&number_int, current->data, sizeof (int));
+                if (agg->task[i] == AGG_TASK_MAX)
+                    acc->int_value = first || number_int > acc->int_value ? number_int : acc->int_value;
+                else if (agg->task[i] == AGG_TASK_MIN)
+                    acc->int_value = first || number_int < acc->int_value ? number_int : acc->int_value;
+                else
+                    acc->int_value += number_int;
+                break;
+            case TYPE_FLOAT:
+                memcpy(&number_float, current->data, sizeof (float));
+                if (agg->task[i] == AGG_TASK_MAX)
+                    acc->float_value = first || number_float > acc->float_value ? number_float : acc->float_value;
+                else if (agg->task[i] == AGG_TASK_MIN)
+                    acc->float_value = first || number_float < acc->float_value ? number_float : acc->float_value;
+                else
+                    acc->float_value += number_float;
+                break;
+            case TYPE_NUMBER:
+                memcpy(&number_double, current->data, sizeof (double));
+                if (agg->task[i] == AGG_TASK_MAX)
+                    acc->number_value = first || number_double > acc->number_value ? number_double : acc->number_value;
+                else if (agg->task[i] == AGG_TASK_MIN)
+                    acc->number_value = first || number_double < acc->number_value ? number_double : acc->number_value;
+                else
+                    acc->number_value += number_double;
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Function aggregates rows of a table into groups of an aggregation
+ * @param agg aggregation
+ * @param table table
+ * @param limited 1 if reading stops when groups take more than the memory of the aggregation
+ * @param bytes memory groups of the table could take, if reading stopped
+ * @return 1 if all rows were aggregated, 0 if groups do not fit in memory
+ */
+static int AK_agg_read(AK_agg_state *agg, char *table, int limited, long *bytes) {
+    AK_PRO;
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+    unsigned int hash;
+    int fits = 1, i;
+
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (!fits) {
+            //every further row could start a new group
+            for (i = 0; i < agg->num_group; i++)
+                *bytes += scan->value[agg->group[i]].size;
+            *bytes += agg->num_group * 3 * sizeof (int) + 2 * sizeof (int) + agg->num_attr * sizeof (AK_agg_accumulator);
+            continue;
+        }
+        hash = AK_agg_hash(agg, scan->value);
+        AK_agg_accumulate(agg, scan->value, AK_agg_group(agg, scan->value, hash));
+        if (limited && AK_agg_memory_used(agg) > agg->memory) {
+            fits = 0;
+            *bytes += AK_agg_memory_used(agg);
+        }
+    }
+    AK_iterator_free(scan);
+    AK_EPI;
+    return fits;
+}
+
+/**
+ * @brief Function writes groups of an aggregation to the aggregated table. An aggregate with no values is null, a count
+          is 0; averages are computed from sums and counts as float.
+ * @param agg aggregation
+ * @return No return value
+ */
+static void AK_agg_write(AK_agg_state *agg) {
+    AK_PRO;
+    AK_iterator_value key[MAX_ATTRIBUTES];
+    AK_agg_accumulator *acc;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], integer[MAX_ATTRIBUTES], group, source_type, i, j;
+    float real[MAX_ATTRIBUTES];
+    double number[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+
+    for (group = 0; group < agg->num_groups; group++) {
+        if (agg->num_group > 0)
+            AK_iterator_buffer_get(&agg->keys, group, key);
+        acc = &agg->acc[group * agg->num_attr];
+        for (i = j = 0; i < agg->num_attr; i++, acc++) {
+            type[i] = agg->header[i].type;
+            if (agg->task[i] == AGG_TASK_GROUP) {
+                type[i] = key[j].type;
+                data[i] = key[j].data;
+                size[i] = key[j].size;
+                j++;
+                continue;
+            }
+            if (agg->task[i] == AGG_TASK_COUNT) {
+                integer[i] = acc->count;
+                data[i] = (char *) &integer[i];
+                size[i] = sizeof (int);
+                continue;
+            }
+            if (acc->count == 0) {
+                data[i] = NULL;
+                continue;
+            }
+
+            source_type = agg->source[agg->columns[i]].type;
+            if (agg->task[i] == AGG_TASK_AVG) {
+                if (source_type == TYPE_FLOAT)
+                    real[i] = acc->float_value / acc->count;
+                else if (source_type == TYPE_NUMBER)
+                    real[i] = acc->number_value / acc->count;
+                else
+                    real[i] = (double) acc->int_value / acc->count;
+                data[i] = (char *) &real[i];
+                size[i] = sizeof (float);
+            } else if (source_type == TYPE_FLOAT) {
+                real[i] = acc->float_value;
+                data[i] = (char *) &real[i];
+                size[i] = sizeof (float);
+            } else if (source_type == TYPE_NUMBER) {
+                number[i] = acc->number_value;
+                data[i] = (char *) &number[i];
+                size[i] = sizeof (double);
+            } else {
+                integer[i] = (int) acc->int_value;
+                data[i] = (char *) &integer[i];
+                size[i] = sizeof (int);
+            }
+        }
+        //extents of the aggregated table grow with the number of rows written so far
+        agg->num_written++;
+        AK_bulk_add_row(&agg->loader, type, data, size, agg->num_written);
+    }
+    AK_EPI;
+}
+
+static int AK_agg_table(AK_agg_state *agg, char *table, int depth);
+
+/**
+ * @brief Function aggregates a table by partitions, when its groups do not fit in memory. Rows of a group have equal
+          hashes, so they fall into the same partition; rows are written to temporary segments of partitions and every
+          partition is aggregated again, partitioned further if its groups still do not fit.
+ * @param agg aggregation
+ * @param table table
+ * @param bytes memory groups of the table could take
+ * @param depth recursion depth of the partitioning
+ * @return EXIT_SUCCESS, EXIT_ERROR if a temporary segment cannot be created
+ */
+static int AK_agg_partition(AK_agg_state *agg, char *table, long bytes, int depth) {
+    AK_PRO;
+    char (*segment)[MAX_ATT_NAME];
+    AK_bulk_loader *loader;
+    AK_iterator *scan;
+    unsigned int hash;
+    int *rows, type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], num_partitions, partition, i, result = EXIT_SUCCESS;
+    char *data[MAX_ATTRIBUTES];
+
+    num_partitions = (int) (2 * bytes / agg->memory + 1);
+    if (num_partitions > AGG_MAX_PARTITIONS)
+        num_partitions = AGG_MAX_PARTITIONS;
+    if (num_partitions < 2)
+        num_partitions = 2;
+    Ak_dbg_messg(LOW, REL_OP, "AK_aggregation: groups of %s (%ld bytes) aggregated by %d partitions at depth %d\n", table,
+            bytes, num_partitions, depth);
+    segment = AK_calloc(num_partitions, MAX_ATT_NAME);
+    loader = (AK_bulk_loader *) AK_calloc(num_partitions, sizeof (AK_bulk_loader));
+    rows = (int *) AK_calloc(num_partitions, sizeof (int));
+
+    scan = AK_iterator_scan(table, NULL);
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW && result == EXIT_SUCCESS) {
+        hash = AK_agg_hash(agg, scan->value);
+        //the mix with the depth spreads rows of one partition over all partitions of the next level
+        hash = (hash ^ (unsigned int) depth * 0x9E3779B9u) * 2654435761u;
+        partition = (int) ((hash >> 16) % (unsigned int) num_partitions);
+        if (rows[partition] == 0) {
+            if (AK_temp_segment_create(segment[partition], agg->source) == EXIT_ERROR) {
+                result = EXIT_ERROR;
+                break;
+            }
+            AK_bulk_begin(&loader[partition], segment[partition]);
+            agg->num_spilled++;
+        }
+        for (i = 0; i < agg->num_source; i++) {
+            type[i] = scan->value[i].type;
+            size[i] = scan->value[i].size;
+            data[i] = scan->value[i].data;
+        }
+        rows[partition]++;
+        AK_bulk_add_row(&loader[partition], type, data, size, rows[partition]);
+    }
+    AK_iterator_free(scan);
+
+    for (partition = 0; partition < num_partitions; partition++) {
+        if (rows[partition] > 0)
+            AK_bulk_end(&loader[partition]);
+    }
+    for (partition = 0; partition < num_partitions && result == EXIT_SUCCESS; partition++) {
+        if (rows[partition] > 0)
+            result = AK_agg_table(agg, segment[partition], depth + 1);
+    }
+    AK_free(segment);
+    AK_free(loader);
+    AK_free(rows);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function aggregates a table: in memory if its groups fit, otherwise by partitions. Partitions are not split
+          any more after AGG_MAX_DEPTH levels, since rows of one group always fall into one partition.
+ * @param agg aggregation
+ * @param table table
+ * @param depth recursion depth of the partitioning
+ * @return EXIT_SUCCESS, EXIT_ERROR if a temporary segment cannot be created
+ */
+static int AK_agg_table(AK_agg_state *agg, char *table, int depth) {
+    AK_PRO;
+    long bytes = 0;
+    int result = EXIT_SUCCESS;
+
+    if (depth > agg->max_depth)
+        agg->max_depth = depth;
+    agg->num_groups = 0;
+    agg->keys.num_rows = 0;
+    agg->keys.size = 0;
+    AK_agg_index(agg);
+    if (AK_agg_read(agg, table, depth < AGG_MAX_DEPTH, &bytes))
+        AK_agg_write(agg);
+    else
+        result = AK_agg_partition(agg, table, bytes, depth);
+    AK_EPI;
+    return result;
+}
+
 /**
    @author Dejan Frankovic
-   @brief Function aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
-          AGG_TASK_AVG_SUM are put on the beginning of the input object. Then for loop iterates through
-          input tasks and assignes the type of aggregation operation according to aggregation operation.
-	  New table has to be created. For loop goes through given table. GROUP operation is executed separately
-	  from other operations. Addresses of records are put in needed_values array and
-	  results are put in new table
-   @param input input object with list of atributes by which we aggregate and types of aggregations
+   @brief Function aggregates a given table by given attributes. Rows are read once; the group of every row is found in
+          a hash table on its group values and its values are added to typed accumulators of the group (count, and
+          sum, minimum or maximum in the type of the attribute), so COUNT, SUM, MIN, MAX and AVG need one pass and
+          the aggregated table is written only at the end. Attributes of the aggregated table follow the input:
+          group attributes with their values and aggregates as Cnt(x), Sum(x), Max(x), Min(x) and Avg(x). Null values
+          are not aggregated; an aggregate with no values is null, a count is 0. Without group attributes there is
+          one row, even for an empty table. If groups take more than the memory set by AK_aggregation_set_memory,
+          the table is split by hash of group values into partitions in temporary segments, which are deleted when
+          the aggregation ends.
+   @param input input object with list of atributes by which we aggregate and types of aggregations (it is not changed,
+          parts of averages added by AK_agg_input_fix are not needed)
    @param source_table - table name for the source table
    @param agg_table  table name for aggregated table
-   @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR
+   @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR (also if a name of an aggregate would be longer
+          than MAX_ATT_NAME)
 
  */
 int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
-    //int AK_aggregation (AK_header *att_root,int *att_tasks,char *source_table, char *new_table) {
-    int i, j;
     AK_PRO;
-    AK_agg_input_fix(input);
-    AK_header *att_root = (*input).attributes;
-    int *att_tasks = (*input).tasks;
-    int num_aggregations = (*input).counter;
-    // int header_size = AK_header_size(att_root);
-    AK_header agg_head[MAX_ATTRIBUTES];
-    int agg_group_number = 0;
-    int inttemp = 0;
-    double doubletemp = 0;
-    float floattemp = 0;
-
-    char agg_h_name[MAX_ATT_NAME];
-    int agg_h_type;
-    char group_h_name[MAX_ATT_NAME];
-
-    AK_agg_value *needed_values = AK_malloc(sizeof (AK_agg_value) * num_aggregations);
-
-    char new_table[MAX_ATT_NAME];
-    sprintf(new_table, "_%s", agg_table);
-
-    for (i = 0; i < num_aggregations; i++) {
-        agg_h_type = att_root[i].type;
-        switch (att_tasks[i]) {
+    AK_agg_state *agg;
+    AK_iterator *scan;
+    AK_header *header;
+    char name[MAX_ATT_NAME];
+    const char *function;
+    int i, j, type, mark, result;
+
+    if (!AK_table_exist(source_table)) {
+        printf("AK_aggregation: ERROR. Table %s does not exist.\n", source_table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    agg = (AK_agg_state *) AK_calloc(1, sizeof (AK_agg_state));
+    scan = AK_iterator_scan(source_table, NULL);
+    agg->num_source = scan->num_attr;
+    memcpy(agg->source, scan->header, sizeof (agg->source));
+    AK_iterator_free(scan);
+
+    for (i = 0; i < input->counter && i < MAX_ATTRIBUTES; i++) {
+        //parts of averages added by AK_agg_input_fix are not needed, averages are computed from sums and counts
+        if (input->tasks[i] == AGG_TASK_AVG_COUNT || input->tasks[i] == AGG_TASK_AVG_SUM)
+            continue;
+        for (j = 0; j < agg->num_source && strcmp(agg->source[j].att_name, input->attributes[i].att_name) != 0; j++)
+            ;
+        if (j == agg->num_source) {
+            printf("AK_aggregation: ERROR. Attribute %s does not exist.\n", input->attributes[i].att_name);
+            AK_free(agg);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+
+        type = agg->source[j].type;
+        if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+            type = TYPE_INT;
+        switch (input->tasks[i]) {
             case AGG_TASK_GROUP:
-                strcpy(agg_h_name, att_root[i].att_name);
-                strcpy(group_h_name, att_root[i].att_name);
-                agg_group_number++;
+                function = NULL;
+                type = agg->source[j].type;
+                agg->group[agg->num_group++] = j;
                 break;
             case AGG_TASK_COUNT:
-                sprintf(agg_h_name, "Cnt(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
+                function = "Cnt";
+                type = TYPE_INT;
                 break;
             case AGG_TASK_SUM:
-                sprintf(agg_h_name, "Sum(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
+                function = "Sum";
                 break;
             case AGG_TASK_MAX:
-                sprintf(agg_h_name, "Max(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
+                function = "Max";
                 break;
             case AGG_TASK_MIN:
-                sprintf(agg_h_name, "Min(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_AVG:
-                sprintf(agg_h_name, "Avg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
-                break;
-            case AGG_TASK_AVG_COUNT:
-                sprintf(agg_h_name, "_cAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
+                function = "Min";
                 break;
-            case AGG_TASK_AVG_SUM:
-                sprintf(agg_h_name, "_sAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
+            default:
+                function = "Avg";
+                type = TYPE_FLOAT;
                 break;
         }
-        needed_values[i].agg_task = att_tasks[i];
-        strcpy(needed_values[i].att_name, att_root[i].att_name);
-        agg_head[i] = *(AK_header*) AK_create_header(agg_h_name, agg_h_type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        if (function == NULL)
+            strcpy(name, agg->source[j].att_name);
+        else if (snprintf(name, sizeof (name), "%s(%s)", function, agg->source[j].att_name) >= (int) sizeof (name)) {
+            printf("AK_aggregation: ERROR. Name of %s(%s) is too long.\n", function, agg->source[j].att_name);
+            AK_free(agg);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        agg->task[agg->num_attr] = input->tasks[i];
+        agg->columns[agg->num_attr] = j;
+        header = (AK_header *) AK_create_header(name, type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&agg->header[agg->num_attr], header, sizeof (AK_header));
+        AK_free(header);
+        agg->num_attr++;
     }
 
-    // removing rest of the unneeded attributes (where attribute id is greater than number of used aggregations)
-    for (i = num_aggregations; i < MAX_ATTRIBUTES; i++) {
-        memcpy(&agg_head[i], "\0", sizeof ( "\0"));
+    agg->memory = AK_agg_forced_memory ? AK_agg_forced_memory : AGG_MEMORY;
+    AK_iterator_buffer_init(&agg->keys, agg->num_group);
+    AK_initialize_new_segment(agg_table, SEGMENT_TYPE_TABLE, agg->header);
+    AK_bulk_begin(&agg->loader, agg_table);
+
+    //temporary segments of partitions are deleted when the aggregation ends
+    mark = AK_temp_begin();
+    result = AK_agg_table(agg, source_table, 0);
+    AK_temp_end(mark);
+    //without group attributes an empty table still has one row of aggregates
+    if (agg->num_group == 0 && agg->num_written == 0) {
+        agg->num_groups = 1;
+        agg->capacity_groups = 1;
+        agg->acc = (AK_agg_accumulator *) AK_realloc(agg->acc, agg->num_attr * sizeof (AK_agg_accumulator));
+        memset(agg->acc, 0, agg->num_attr * sizeof (AK_agg_accumulator));
+        AK_agg_write(agg);
     }
-    
-
-    int startAddress = AK_initialize_new_segment(new_table, SEGMENT_TYPE_TABLE, agg_head);
-
-    if (startAddress != EXIT_ERROR)
-        printf("\nTABLE %s CREATED!\n", new_table);
-
-
-
-    // ovo bi bila neka optimizacija, da sort radi kak spada..
-    //sort_segment(source_table,group_h_name);
-
-
-    search_params search_parameters[agg_group_number];
-    search_result sresult;
-    j = 0;
-
-
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(source_table);
-    int num_attr = AK_num_attr(source_table);
-
-    int k, l, m, n, o, counter;
-
-    AK_block *temp;
-    AK_mem_block *mem_block;
-
-    /*
-    AK_list_elem row_root = (AK_list_elem) AK_malloc(sizeof (AK_list));
-    Ak_Init_L3(&row_root);
-````*/
-
-    struct list_node * row_root = (struct list_node*) AK_malloc(sizeof(struct list_node));
-    Ak_Init_L3(&row_root);
-
-    i = 0;
-    counter = 0;
+    AK_bulk_end(&agg->loader);
+
+    Ak_dbg_messg(LOW, REL_OP, "AK_aggregation: %s aggregated into %s: %d rows, %d partitions written, depth %d\n",
+            source_table, agg_table, agg->num_written, agg->num_spilled, agg->max_depth);
+    AK_agg_last_spilled = agg->num_spilled;
+    AK_agg_last_depth = agg->max_depth;
+    AK_iterator_buffer_free(&agg->keys);
+    AK_free(agg->group_hash);
+    AK_free(agg->chain);
+    AK_free(agg->acc);
+    AK_free(agg->buckets);
+    AK_free(agg);
+    AK_EPI;
+    return result;
+}
 
-    while (addresses->address_from[ i ] != 0) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            temp = (AK_block*) AK_read_block(j);
-            if ( temp->last_tuple_dict_id == 0 )
-            	break;
-            for (k = 0; k < temp->last_tuple_dict_id; k += num_attr) {
-                counter++;
-                n = 0;
-
-                //aggregation when no grouping is done will be executed separately to skip the unsorted search
-                if(agg_group_number == 0){
-                	for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-								switch (needed_values[m].agg_task) {
-									case AGG_TASK_COUNT:
-										//no break is intentional
-									case AGG_TASK_AVG_COUNT:
-										memcpy(needed_values[m].data, &counter, sizeof(int));
-										needed_values[m].data[sizeof(int)] = '\0';
-										break;
-
-									case AGG_TASK_MAX:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) < inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) < floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) < doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_MIN:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) > inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) > floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) > doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_SUM:
-										//no break is intentional
-									case AGG_TASK_AVG_SUM:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												inttemp += *((int*) needed_values[m].data);
-												memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												floattemp += *((float *)needed_values[m].data);
-												memcpy(needed_values[m].data, &floattemp, sizeof (float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												doubletemp += *((double*) needed_values[m].data);
-												memcpy(needed_values[m].data, &doubletemp, sizeof (double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-								}
-							}
-						}
-					}
-				}
-				else{
-
-					for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-
-								memcpy(needed_values[m].data, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-								needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-
-								if (needed_values[m].agg_task == AGG_TASK_GROUP) {
-									search_parameters[n].iSearchType = SEARCH_PARTICULAR;
-									search_parameters[n].pData_lower = AK_malloc(temp->tuple_dict[k + l].size + 1);
-									memcpy(search_parameters[n].pData_lower, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-									((char *) search_parameters[n].pData_lower)[ temp->tuple_dict[k + l].size ] = '\0';
-									search_parameters[n].szAttribute = (temp->header[l].att_name);
-									n++;
-								}
-							}
-						}
-					}
-
-					sresult = AK_search_unsorted(new_table, search_parameters, agg_group_number);
-
-					if (sresult.iNum_tuple_addresses == 0) {
-						Ak_DeleteAll_L3(&row_root);
-
-						for (l = 0; l < num_aggregations; l++) {
-							switch (needed_values[l].agg_task) {
-								case AGG_TASK_COUNT:
-									//no break is intentional
-								case AGG_TASK_AVG_COUNT:
-									inttemp = 1;
-									/**
-									 * THIS SINGLE LINE BELOW (memcpy) is the purpose of ALL evil in the world!
-									 * This line is the reason why test function prints one extra empty 
-									 * row with "nulls" at the end! Trust me! Comment it, and you will see - 
-									 * test function will not print extra row with nulls (but counts and averages 
-									 * in table will be all messed up!)
-									 * After two days of hard research, I still have not found what is the
-									 * reason behind printing extra row at the end! Fellow programmer,
-									 * if you really really want to solve this issue, arm yourself with
-									 * at least 2 liters of hot coffee!
-									 *
-									 * What this line does? What is the purpose of this line in the universe?
-									 * Well, fellow programmer, this line sets the initial count to 1.
-									 * That means if name "Ivan" is found, it will have count of 1
-									 * because, well, that's the first Ivan that is found!
-									 * If function finds another Ivan (which, actually, will happen),
-									 * this part of code will not handle it (other part of code will).
-									 *
-									 * That actually means that this little piece of code 
-									 * (this line below) only (and ONLY) sets count to 1! And besides that
-									 * causes every other evil in the world. :O
-									 *
-									 * P.S. The reason for that may be in linked list, or in AK_insert_row()
-									 * You'll have to check every piece of AKDB code to find cause!
-									 * I have found out that additional line is added when k == 25.
-									 * There may be problem in linked lists or in AK_insert_row function
-									 * or somewhere else. Who knows.
-									 *
-									 * If I didn't handle that last row (which has one attribute of size 0),
-									 * test would not pass!
-									 *
-									 * Good luck, fellow programmer!
-									 */
-									memcpy(needed_values[l].data, &inttemp, sizeof(int));
-									needed_values[l].data[sizeof (int) ] = '\0';
-									Ak_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, row_root);
-									break;
-
-								case AGG_TASK_AVG:
-									//no break is intentional
-								case AGG_TASK_MAX:
-									//no break is intentional
-								case AGG_TASK_MIN:
-									//no break is intentional
-								case AGG_TASK_SUM:
-									//no break is intentional
-								case AGG_TASK_GROUP:
-									//no break is intentional
-								case AGG_TASK_AVG_SUM:
-									//no break is intentional
-								default:
-									Ak_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, row_root);
-							}
-
-						}
-						//FILE  -  ISPRAVITI
-						Ak_insert_row(row_root);
-
-					} else {
-						mem_block = AK_get_block(sresult.aiBlocks[0]);
-
-						for (l = 0; l < num_attr; l++) {
-							for (m = 0; m < num_aggregations; m++) {
-								if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-									switch (needed_values[m].agg_task) {
-										case AGG_TASK_COUNT:
-											//no break is intentional
-										case AGG_TASK_AVG_COUNT:
-											inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address)) + 1;
-											memcpy(&mem_block->block->data[mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address], &inttemp, sizeof (int));
-											break;
-
-										case AGG_TASK_SUM:
-											//no break is intentional
-										case AGG_TASK_AVG_SUM:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int*) needed_values[m].data) + *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float*) needed_values[m].data) + *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double*) needed_values[m].data) + *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													break;
-											}
-											break;
-
-										case AGG_TASK_MAX:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) > inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) > floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) > doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_MIN:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) < inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) < floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) < doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_AVG:
-											inttemp = floattemp = -1;
-											for (o = 0; o < num_aggregations; o++) {
-												sprintf(agg_h_name, "_cAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													inttemp = *((int*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-												sprintf(agg_h_name, "_sAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													floattemp = *((float*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-
-												if (inttemp != -1 && doubletemp != -1)
-													break;
-											}
-											floattemp = floattemp / (float) inttemp;
-											memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-											break;
-
-										case AGG_TASK_GROUP:
-											break;
-									}
-								}
-							}
-						}
-						AK_deallocate_search_result(sresult);
-						
-						Ak_DeleteAll_L3(&row_root);
-
-						for (l = 0; l<num_aggregations;l++) {
-							if (needed_values[l].agg_task == AGG_TASK_GROUP)
-							   inttemp = 1;
-							else
-								inttemp = 0;
-							Ak_Insert_New_Element_For_Update(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, row_root, inttemp);
-						}
-
-						//Ak_update_delete_row_from_block(mem_block->block, row_root, 0);
-                        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
-					}
-				}
-            }
+/**
+ * @brief Function checks a table aggregated by the aggregation test against aggregates computed while its source was
+          generated. Every group has to be in the table once.
+ * @param table aggregated table
+ * @param count number of values of every group that are not null
+ * @param sum sum of values of every group
+ * @param min minimum of values of every group
+ * @param max maximum of values of every group
+ * @param amount sum of amounts of every group
+ * @param num_groups number of groups
+ * @return number of errors
+ */
+static int AK_agg_test_check(char *table, int *count, int *sum, int *min, int *max, float *amount, int num_groups) {
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+    int *found = (int *) AK_calloc(num_groups, sizeof (int));
+    char name[MAX_VARCHAR_LENGTH];
+    int group, integer[4], i, num_errors = 0;
+    float real[2];
+
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        memcpy(&group, scan->value[0].data, sizeof (int));
+        for (i = 0; i < 4; i++)
+            memcpy(&integer[i], scan->value[2 + i].data, sizeof (int));
+        for (i = 0; i < 2; i++)
+            memcpy(&real[i], scan->value[6 + i].data, sizeof (float));
+        sprintf(name, "group%d", group);
+        if (group < 0 || group >= num_groups || scan->value[1].size != (int) strlen(name)
+                || memcmp(scan->value[1].data, name, scan->value[1].size) != 0 || integer[0] != count[group]
+                || integer[1] != sum[group] || integer[2] != min[group] || integer[3] != max[group]
+                || real[0] != amount[group] / 4 || real[1] != amount[group]) {
+            num_errors++;
+            continue;
         }
-        i++;
+        found[group]++;
     }
-
-    //if there is no grouping, we only need to insert one row into the table and we can insert it straight into the destination table
-    if(agg_group_number == 0){
-
-    	AK_header agg_head_final[MAX_ATTRIBUTES];
-    	j = 0;
-
-    	for (i = 0; i < num_aggregations; i++) {
-			if (agg_head[i].att_name[0] != '_') {
-				agg_head_final[j] = agg_head[i];
-				j++;
-			}
-		}
-
-    	startAddress = AK_initialize_new_segment(agg_table, SEGMENT_TYPE_TABLE, agg_head_final);
-
-		if (startAddress != EXIT_ERROR)
-			printf("\nTABLE %s CREATED!\n", agg_table);
-
-    	
-	Ak_DeleteAll_L3(&row_root);
-
-		for (l = 0; l < num_aggregations; l++) {
-
-			switch (needed_values[l].agg_task) {
-
-				case AGG_TASK_AVG_SUM:
-					floattemp = *((float *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG_COUNT:
-					inttemp = *((int *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG:
-					floattemp = floattemp/inttemp;
-					memcpy(needed_values[l].data, &floattemp, sizeof(float));
-					needed_values[l].data[sizeof(float)] = '\0';
-					//no break is intentional
-				case AGG_TASK_COUNT:
-					//no break is intentional
-				case AGG_TASK_MAX:
-					//no break is intentional
-				case AGG_TASK_MIN:
-					//no break is intentional
-				case AGG_TASK_SUM:
-					//no break is intentional
-				default:
-					Ak_Insert_New_Element(agg_head[l].type, needed_values[l].data, agg_table, agg_head[l].att_name, row_root);
-					break;
-			}
-
-		}
-		Ak_insert_row(row_root);
+    AK_iterator_free(scan);
+    for (i = 0; i < num_groups; i++) {
+        if (found[i] != 1)
+            num_errors++;
     }
-    else{
-
-	struct list_node * projection_att = (struct list_node*) AK_malloc(sizeof(struct list_node));
-	Ak_Init_L3(&projection_att);
-
-	for (i = 0; i < num_aggregations; i++) {
-			if (agg_head[i].att_name[0] != '_') {
-				Ak_InsertAtEnd_L3(TYPE_ATTRIBS, agg_head[i].att_name, strlen(agg_head[i].att_name), projection_att);
-
-			}
-		}
+    AK_free(found);
+    return num_errors;
+}
 
-		AK_projection(new_table, agg_table, projection_att);
+/**
+ * @brief Function tests aggregation of a generated table with 500 groups of 4 rows (every seventh value is null), in
+          memory and by partitions with 16 KiB of memory, and aggregation without group attributes
+ * @return number of errors
+ */
+static int AK_agg_test_groups() {
+    AK_header header[5], *temp;
+    AK_bulk_loader loader;
+    AK_agg_input aggregation;
+    AK_iterator *scan;
+    char *names[4] = {"grp", "name", "value", "amount"}, name[MAX_VARCHAR_LENGTH], *data[4], table[MAX_ATT_NAME];
+    int types[4] = {TYPE_INT, TYPE_VARCHAR, TYPE_INT, TYPE_FLOAT};
+    int count[500], sum[500], min[500], max[500], type[4], size[4], group, row, memory, mark, total, total_sum, i, num_errors = 0;
+    float amount[500], value;
+    struct timespec start, end;
+
+    for (i = 0; i < 4; i++) {
+        temp = (AK_header *) AK_create_header(names[i], types[i], FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[i], temp, sizeof (AK_header));
+        AK_free(temp);
+    }
+    memset(&header[4], 0, sizeof (AK_header));
+    AK_initialize_new_segment("agg_groups", SEGMENT_TYPE_TABLE, header);
+
+    memset(count, 0, sizeof (count));
+    memset(sum, 0, sizeof (sum));
+    memset(amount, 0, sizeof (amount));
+    AK_bulk_begin(&loader, "agg_groups");
+    for (row = 0; row < 2000; row++) {
+        group = row % 500;
+        sprintf(name, "group%d", group);
+        value = row / 8.0f;
+        data[0] = (char *) &group;
+        data[1] = name;
+        data[2] = row % 7 == 0 ? NULL : (char *) &row;
+        data[3] = (char *) &value;
+        size[0] = sizeof (int);
+        size[1] = strlen(name);
+        size[2] = sizeof (int);
+        size[3] = sizeof (float);
+        //a null value changes its type to varchar
+        memcpy(type, types, sizeof (types));
+        AK_bulk_add_row(&loader, type, data, size, 2000 - row);
+        amount[group] += value;
+        if (row % 7 != 0) {
+            min[group] = count[group] == 0 || row < min[group] ? row : min[group];
+            max[group] = count[group] == 0 || row > max[group] ? row : max[group];
+            sum[group] += row;
+            count[group]++;
+        }
+    }
+    AK_bulk_end(&loader);
 
-		
-		Ak_DeleteAll_L3(&projection_att);
-		AK_free(projection_att);
+    AK_agg_input_init(&aggregation);
+    AK_agg_input_add(header[0], AGG_TASK_GROUP, &aggregation);
+    AK_agg_input_add(header[1], AGG_TASK_GROUP, &aggregation);
+    AK_agg_input_add(header[2], AGG_TASK_COUNT, &aggregation);
+    AK_agg_input_add(header[2], AGG_TASK_SUM, &aggregation);
+    AK_agg_input_add(header[2], AGG_TASK_MIN, &aggregation);
+    AK_agg_input_add(header[2], AGG_TASK_MAX, &aggregation);
+    AK_agg_input_add(header[3], AGG_TASK_AVG, &aggregation);
+    AK_agg_input_add(header[3], AGG_TASK_SUM, &aggregation);
+
+    for (memory = 0; memory <= 16 * 1024; memory += 16 * 1024) {
+        AK_aggregation_set_memory(memory);
+        sprintf(table, "agg_groups_%d", memory);
+        mark = AK_temp_begin();
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        AK_aggregation(&aggregation, "agg_groups", table);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        i = AK_agg_test_check(table, count, sum, min, max, amount, 500);
+        //groups of 16 KiB have to be aggregated by partitions, which are deleted at the end
+        i += AK_temp_begin() != mark || (memory > 0 && AK_agg_last_spilled == 0);
+        printf("GROUP BY grp, name with %d KiB of memory: %.3f s, %d partitions written, depth %d, errors: %d\n",
+                AK_aggregation_set_memory(memory) / 1024, end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9,
+                AK_agg_last_spilled, AK_agg_last_depth, i);
+        num_errors += i;
     }
+    AK_aggregation_set_memory(0);
 
-    //@TODO zamijeniti ovaj segment sa AK_drop_table() jednom kad ga netko napravi
-	addresses = (table_addresses*) AK_get_table_addresses(new_table);
-	i = 0;
-	while (addresses->address_from[i] != 0) {
-		AK_delete_extent(addresses->address_from[i], addresses->address_to[i]);
-		i++;
-	}
-    AK_free(needed_values);
-    AK_free(row_root);
-    AK_free(temp);
-    AK_EPI;
-    return EXIT_SUCCESS;
+    //without group attributes there is one row: non null values are counted and summed
+    AK_agg_input_init(&aggregation);
+    AK_agg_input_add(header[2], AGG_TASK_COUNT, &aggregation);
+    AK_agg_input_add(header[2], AGG_TASK_SUM, &aggregation);
+    AK_aggregation(&aggregation, "agg_groups", "agg_groups_total");
+    for (i = total = total_sum = 0; i < 500; i++) {
+        total += count[i];
+        total_sum += sum[i];
+    }
+    scan = AK_iterator_scan("agg_groups_total", NULL);
+    AK_iterator_open(scan);
+    for (row = 0; AK_iterator_next(scan) == ITERATOR_ROW; row++) {
+        memcpy(&group, scan->value[0].data, sizeof (int));
+        memcpy(&i, scan->value[1].data, sizeof (int));
+        num_errors += group != total || i != total_sum;
+    }
+    AK_iterator_free(scan);
+    num_errors += row != 1;
+    return num_errors;
 }
 
 void Ak_aggregation_test() {
@@ -784,7 +991,7 @@ void Ak_aggregation_test() {
 
             for (k = 0; k < block->last_tuple_dict_id; k += agg_numcol) {
             	/** 
-            	 * This variable was added to handle bug described in this file.
+            	 * This variable was added to handle a bug of the old aggregation, which wrote an extra row of empty values.
             	 */
             	int is_row_empty = 0;
             	for (l=0; l<6; l++) {
@@ -864,6 +1071,8 @@ void Ak_aggregation_test() {
     }
     AK_free(first_names);
 
+    num_errors += AK_agg_test_groups();
+
     if ( num_errors == 0 ) {
     	printf("\nTEST PASSED!\n");
     } else {
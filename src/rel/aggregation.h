@@ -23,6 +23,10 @@
 #include "selection.h"
 #include "projection.h"
 #include "../file/filesearch.h"
+#include "../file/files.h"
+#include "../file/filesort.h"
+#include "../file/bulkload.h"
+#include "iterator.h"
 #include "../auxi/mempro.h"
 
 #define AGG_TASK_GROUP 1
@@ -34,6 +38,24 @@
 #define AGG_TASK_AVG_COUNT 10 //used internaly
 #define AGG_TASK_AVG_SUM 11 //used internaly
 
+/**
+  * @def AGG_MEMORY
+  * @brief Constant declaring default number of bytes of memory for groups of an aggregation
+  */
+#define AGG_MEMORY (4 * 1024 * 1024)
+
+/**
+  * @def AGG_MAX_PARTITIONS
+  * @brief Constant declaring maximal number of partitions of an aggregation whose groups do not fit in memory
+  */
+#define AGG_MAX_PARTITIONS 32
+
+/**
+  * @def AGG_MAX_DEPTH
+  * @brief Constant declaring maximal number of times partitions of an aggregation are partitioned again
+  */
+#define AGG_MAX_DEPTH 3
+
 /**
   * @author Unknown
   * @struct AK_agg_value
@@ -61,6 +83,7 @@ int AK_agg_input_add(AK_header header, int agg_task, AK_agg_input *input);
 int AK_agg_input_add_to_beginning(AK_header header, int agg_task, AK_agg_input *input);
 void AK_agg_input_fix(AK_agg_input *input);
 int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table);
+int AK_aggregation_set_memory(int bytes);
 void Ak_aggregation_test();
 
 #endif
@@ -0,0 +1,2076 @@
+/**
+@file batch.c Provides functions for vectorized (batch at a time) query execution
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <time.h>
+#include "batch.h"
+#include "../file/bulkload.h"
+
+/**
+  * @def BATCH_HASH_SEED
+  * @brief Initial value of hashes of group and join keys (FNV-1a)
+  */
+#define BATCH_HASH_SEED 2166136261u
+
+/**
+ * @struct AK_batch_operand
+ * @brief Structure that holds one value of the stack of a vectorized predicate, for all selected rows of a batch
+ */
+typedef struct {
+    /// 1 if value is the same for all rows (constant)
+    int scalar;
+    /// number of a constant
+    double value;
+    /// data of a constant
+    const char *data;
+    /// size of data of a constant
+    int size;
+    /// vector the value was read from, NULL for a constant
+    AK_vector *column;
+    /// 1 if column is a varchar, compared up to its terminating zero
+    int varchar;
+    /// numbers and truth values of rows, indexed by row
+    double *number;
+} AK_batch_operand;
+
+/**
+ * @struct AK_batch_program
+ * @brief Structure that holds compiled predicate and the stack of vectors it is evaluated on. The program is the one
+          of AK_predicate_compile, but every instruction is executed for all selected rows of a batch before the next one.
+ */
+typedef struct {
+    /// compiled predicate
+    AK_predicate *predicate;
+    /// stack, one operand for every value the program can hold at once
+    AK_batch_operand *stack;
+    /// numbers of all stack operands
+    double *numbers;
+    /// results of comparisons
+    int cmp[BATCH_SIZE];
+} AK_batch_program;
+
+/**
+ * @struct AK_batch_scan_state
+ * @brief Structure that holds state of a vectorized table scan
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// expression rows have to satisfy, can be NULL
+    struct list_node *expr;
+    /// compiled expression, NULL if there is no expression or it could not be compiled
+    AK_batch_program *program;
+    /// conditions checked against zone map
+    AK_zone_filter filter;
+    /// zone map of the table, pinned from open to close (see AK_zone_map_open)
+    AK_zone_map *map;
+    /// extents of the table
+    table_addresses *addresses;
+    /// index of the current extent
+    int extent;
+    /// address of the current block
+    int address;
+    /// tuple_dict index of the next row in the current block
+    int slot;
+    /// copy of the current block
+    AK_block *block;
+    /// 1 if block holds the current block
+    int loaded;
+    /// 1 after the last block
+    int done;
+    /// list for rows checked by AK_check_if_row_satisfies_expression when expression could not be compiled
+    struct list_node *row_root;
+    /// tuple_dict indexes of rows decoded into the batch
+    int slots[BATCH_SIZE];
+} AK_batch_scan_state;
+
+/**
+ * @struct AK_batch_select_state
+ * @brief Structure that holds state of a vectorized selection over any input
+ */
+typedef struct {
+    /// expression rows have to satisfy
+    struct list_node *expr;
+    /// compiled expression, NULL if it could not be compiled
+    AK_batch_program *program;
+    /// list for rows checked by AK_check_if_row_satisfies_expression when expression could not be compiled
+    struct list_node *row_root;
+} AK_batch_select_state;
+
+/**
+ * @struct AK_batch_project_state
+ * @brief Structure that holds state of a vectorized projection
+ */
+typedef struct {
+    /// input attribute of every produced attribute
+    int columns[MAX_ATTRIBUTES];
+} AK_batch_project_state;
+
+/**
+ * @struct AK_batch_limit_state
+ * @brief Structure that holds state of a vectorized limit
+ */
+typedef struct {
+    /// maximal number of produced rows
+    int limit;
+} AK_batch_limit_state;
+
+/**
+ * @struct AK_batch_aggregate_state
+ * @brief Structure that holds state of a hash aggregation. Groups are found in an open addressing hash table on hashes
+          of their key values; keys are kept in a row buffer and aggregates in arrays indexed by group.
+ */
+typedef struct {
+    /// AGG_TASK_* of every produced attribute
+    int task[MAX_ATTRIBUTES];
+    /// input attribute of every produced attribute
+    int columns[MAX_ATTRIBUTES];
+    /// number of group attributes
+    int num_group;
+    /// input attribute of every group attribute
+    int group[MAX_ATTRIBUTES];
+    /// key values of groups
+    AK_iterator_buffer keys;
+    /// key hash of every group
+    unsigned int *group_hash;
+    /// sum, minimum or maximum of every group and produced attribute
+    double *acc;
+    /// number of values of every group and produced attribute
+    int *count;
+    /// number of groups
+    int num_groups;
+    /// number of groups arrays can hold
+    int capacity_groups;
+    /// hash table of group indexes, -1 for empty bucket
+    int *buckets;
+    /// number of buckets (power of two)
+    int num_buckets;
+    /// number of groups already produced
+    int emitted;
+    /// key hash of every row of the current input batch
+    unsigned int hash[BATCH_SIZE];
+    /// group of every row of the current input batch
+    int group_id[BATCH_SIZE];
+    /// decoded values of every row of the current input batch
+    double number[BATCH_SIZE];
+} AK_batch_aggregate_state;
+
+/**
+ * @struct AK_batch_join_state
+ * @brief Structure that holds state of a hash join. Rows of the right input are materialized in memory and chained in
+          buckets by hash of their join values; the left input is probed a batch at a time.
+ */
+typedef struct {
+    /// number of join attributes
+    int num_join;
+    /// left input attribute of every join attribute
+    int left_join[MAX_ATTRIBUTES];
+    /// right input attribute of every join attribute
+    int right_join[MAX_ATTRIBUTES];
+    /// 1 if produced attribute comes from the right input
+    int right[MAX_ATTRIBUTES];
+    /// input attribute of every produced attribute
+    int columns[MAX_ATTRIBUTES];
+    /// rows of the right input
+    AK_iterator_buffer rows;
+    /// join key hash of every right row
+    unsigned int *row_hash;
+    /// next right row in the same bucket, -1 at the end of chain
+    int *chain;
+    /// first right row of every bucket, -1 for empty bucket
+    int *buckets;
+    /// number of buckets minus one (number of buckets is a power of two)
+    unsigned int mask;
+    /// current left batch, NULL if a new one has to be read
+    AK_batch *left;
+    /// index in selection of the current left batch of the row being probed
+    int position;
+    /// next right row compared with the probed row, -1 if the probed row is done, -2 if its probe did not start
+    int next_row;
+    /// join key hash of every row of the current left batch
+    unsigned int hash[BATCH_SIZE];
+    /// values of the current right row
+    AK_iterator_value right_value[MAX_ATTRIBUTES];
+} AK_batch_join_state;
+
+/**
+ * @brief Function returns size of one value of a type which is stored in a fixed width vector
+ * @param type data type
+ * @return size of value, 0 if values of type have variable size
+ */
+static int AK_batch_width(int type) {
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            return sizeof (int);
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            return sizeof (double);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Function hashes bytes of a value (FNV-1a)
+ * @param hash hash of previous values
+ * @param data value data
+ * @param size value size
+ * @return hash
+ */
+static unsigned int AK_batch_hash(unsigned int hash, const char *data, int size) {
+    int i;
+
+    for (i = 0; i < size; i++)
+        hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief Function initializes a batch which owns vectors for attributes of a header
+ * @param batch batch
+ * @param header header of rows
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+void AK_batch_init(AK_batch *batch, AK_header *header, int num_attr) {
+    AK_PRO;
+    AK_vector *vector;
+    int i;
+
+    memset(batch, 0, sizeof (AK_batch));
+    batch->num_attr = num_attr;
+    batch->owner = 1;
+    for (i = 0; i < num_attr; i++) {
+        vector = &batch->column[i];
+        vector->type = header[i].type;
+        vector->width = AK_batch_width(vector->type);
+        if (vector->width) {
+            vector->values = (char *) AK_calloc(BATCH_SIZE, vector->width);
+        } else {
+            vector->data = (char **) AK_calloc(BATCH_SIZE, sizeof (char *));
+            vector->size = (int *) AK_calloc(BATCH_SIZE, sizeof (int));
+            vector->offset = (int *) AK_calloc(BATCH_SIZE, sizeof (int));
+        }
+        vector->null = (unsigned char *) AK_calloc(BATCH_SIZE, sizeof (unsigned char));
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function empties a batch before it is filled again
+ * @param batch batch
+ * @return No return value
+ */
+void AK_batch_reset(AK_batch *batch) {
+    batch->num_rows = 0;
+    batch->num_selected = 0;
+    batch->arena_size = 0;
+}
+
+/**
+ * @brief Function stores a value into a vector of a batch. A value whose type is not the type of the attribute is a
+          null (AK_insert_row stores null as TYPE_VARCHAR "null"). Values of variable size are copied into the arena
+          and get their pointers in AK_batch_finish.
+ * @param batch batch
+ * @param column attribute index
+ * @param row row index
+ * @param type value type
+ * @param data value data
+ * @param size value size
+ * @return No return value
+ */
+void AK_batch_set_value(AK_batch *batch, int column, int row, int type, char *data, int size) {
+    AK_vector *vector = &batch->column[column];
+    char *value;
+
+    vector->null[row] = type != vector->type;
+    if (vector->width) {
+        value = vector->values + row * vector->width;
+        if (vector->null[row] || size != vector->width) {
+            memset(value, 0, vector->width);
+            memcpy(value, data, size < vector->width ? size : vector->width);
+        } else {
+            memcpy(value, data, vector->width);
+        }
+        return;
+    }
+
+    if (batch->arena_size + size > batch->arena_capacity) {
+        batch->arena_capacity = batch->arena_size + size > 2 * batch->arena_capacity ? batch->arena_size + size : 2 * batch->arena_capacity;
+        batch->arena = (char *) AK_realloc(batch->arena, batch->arena_capacity);
+    }
+    memcpy(batch->arena + batch->arena_size, data, size);
+    vector->offset[row] = batch->arena_size;
+    vector->size[row] = size;
+    batch->arena_size += size;
+}
+
+/**
+ * @brief Function finishes filling of a batch: variable size values get pointers into the arena and all rows are
+          selected
+ * @param batch batch
+ * @return No return value
+ */
+void AK_batch_finish(AK_batch *batch) {
+    AK_vector *vector;
+    int i, row;
+
+    for (i = 0; i < batch->num_attr; i++) {
+        vector = &batch->column[i];
+        if (vector->width == 0) {
+            for (row = 0; row < batch->num_rows; row++)
+                vector->data[row] = batch->arena + vector->offset[row];
+        }
+    }
+    for (row = 0; row < batch->num_rows; row++)
+        batch->selection[row] = row;
+    batch->num_selected = batch->num_rows;
+}
+
+/**
+ * @brief Function gets one value of a batch in the form rows have in blocks
+ * @param batch batch
+ * @param column attribute index
+ * @param row row index
+ * @param value value, data points into the batch
+ * @return No return value
+ */
+void AK_batch_value(AK_batch *batch, int column, int row, AK_iterator_value *value) {
+    AK_vector *vector = &batch->column[column];
+
+    if (vector->width) {
+        if (vector->null[row]) {
+            value->type = TYPE_VARCHAR;
+            value->data = "null";
+            value->size = strlen("null");
+        } else {
+            value->type = vector->type;
+            value->data = vector->values + row * vector->width;
+            value->size = vector->width;
+        }
+    } else {
+        value->type = vector->null[row] ? TYPE_VARCHAR : vector->type;
+        value->data = vector->data[row];
+        value->size = vector->size[row];
+    }
+}
+
+/**
+ * @brief Function frees vectors of a batch, borrowed vectors are not freed
+ * @param batch batch
+ * @return No return value
+ */
+void AK_batch_free(AK_batch *batch) {
+    AK_PRO;
+    int i;
+
+    if (batch->owner) {
+        for (i = 0; i < batch->num_attr; i++) {
+            AK_free(batch->column[i].values);
+            AK_free(batch->column[i].data);
+            AK_free(batch->column[i].size);
+            AK_free(batch->column[i].offset);
+            AK_free(batch->column[i].null);
+        }
+        AK_free(batch->arena);
+    }
+    memset(batch, 0, sizeof (AK_batch));
+    AK_EPI;
+}
+
+/**
+ * @brief Function compiles an expression into a vectorized predicate
+ * @param expr list with postfix notation of the logical expression
+ * @param header header of rows
+ * @param num_attr number of attributes
+ * @return program, NULL if expression could not be compiled
+ */
+static AK_batch_program *AK_batch_program_new(struct list_node *expr, AK_header *header, int num_attr) {
+    AK_PRO;
+    AK_batch_program *program;
+    AK_predicate *predicate = AK_predicate_compile(expr, header, num_attr, num_attr);
+    int i, depth = 0, max_depth = 0;
+
+    if (predicate == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    for (i = 0; i < predicate->num_instr; i++) {
+        depth += predicate->instr[i].op == PREDICATE_COLUMN || predicate->instr[i].op == PREDICATE_CONSTANT ? 1 : -1;
+        if (depth > max_depth)
+            max_depth = depth;
+    }
+
+    program = (AK_batch_program *) AK_calloc(1, sizeof (AK_batch_program));
+    program->predicate = predicate;
+    program->stack = (AK_batch_operand *) AK_calloc(max_depth, sizeof (AK_batch_operand));
+    program->numbers = (double *) AK_malloc(max_depth * BATCH_SIZE * sizeof (double));
+    for (i = 0; i < max_depth; i++)
+        program->stack[i].number = program->numbers + i * BATCH_SIZE;
+    AK_EPI;
+    return program;
+}
+
+/**
+ * @brief Function frees a vectorized predicate
+ * @param program program, can be NULL
+ * @return No return value
+ */
+static void AK_batch_program_free(AK_batch_program *program) {
+    AK_PRO;
+    if (program != NULL) {
+        AK_predicate_free(program->predicate);
+        AK_free(program->stack);
+        AK_free(program->numbers);
+        AK_free(program);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function reads a column of a batch onto the stack of a vectorized predicate, numeric values are decoded
+ * @param operand stack operand
+ * @param batch batch
+ * @param instr column instruction
+ * @return No return value
+ */
+static void AK_batch_program_column(AK_batch_operand *operand, AK_batch *batch, AK_predicate_instr *instr) {
+    AK_vector *vector = &batch->column[instr->column];
+    int *selection = batch->selection;
+    int n = batch->num_selected, k;
+
+    operand->scalar = 0;
+    operand->column = vector;
+    operand->varchar = instr->type == TYPE_VARCHAR;
+    if (vector->width == 0)
+        return;
+
+    switch (instr->type) {
+        case TYPE_FLOAT:
+            for (k = 0; k < n; k++)
+                operand->number[selection[k]] = *(float *) (vector->values + selection[k] * sizeof (double));
+            break;
+        case TYPE_NUMBER:
+            for (k = 0; k < n; k++)
+                operand->number[selection[k]] = ((double *) vector->values)[selection[k]];
+            break;
+        default:
+            for (k = 0; k < n; k++)
+                operand->number[selection[k]] = ((int *) vector->values)[selection[k]];
+            break;
+    }
+}
+
+/**
+ * @brief Function gets bytes of an operand for one row, for comparisons of non numeric values
+ * @param operand stack operand
+ * @param row row index
+ * @param size size of bytes
+ * @return bytes
+ */
+static const char *AK_batch_program_bytes(AK_batch_operand *operand, int row, int *size) {
+    AK_vector *vector = operand->column;
+
+    if (vector == NULL) {
+        *size = operand->size;
+        return operand->data;
+    }
+    if (vector->width) {
+        *size = vector->width;
+        return vector->values + row * vector->width;
+    }
+    *size = operand->varchar ? (int) strnlen(vector->data[row], vector->size[row]) : vector->size[row];
+    return vector->data[row];
+}
+
+/**
+ * @brief Function evaluates a vectorized predicate on all selected rows of a batch and removes rows which do not
+          satisfy it from the selection. Results are the same as AK_predicate_eval gives for every row.
+ * @param program vectorized predicate
+ * @param batch batch
+ * @return No return value
+ */
+static void AK_batch_program_eval(AK_batch_program *program, AK_batch *batch) {
+    AK_batch_operand *a, *b;
+    AK_predicate_instr *instr;
+    const char *data_a, *data_b;
+    int *selection = batch->selection, *cmp = program->cmp;
+    int n = batch->num_selected, depth = 0, i, k, r, size, size_a, size_b;
+    double x, y;
+
+    for (i = 0; i < program->predicate->num_instr; i++) {
+        instr = &program->predicate->instr[i];
+
+        switch (instr->op) {
+            case PREDICATE_COLUMN:
+                AK_batch_program_column(&program->stack[depth++], batch, instr);
+                continue;
+
+            case PREDICATE_CONSTANT:
+                a = &program->stack[depth++];
+                a->scalar = 1;
+                a->value = instr->number;
+                a->data = program->predicate->constants + instr->offset;
+                a->size = instr->size;
+                a->column = NULL;
+                continue;
+        }
+
+        b = &program->stack[--depth];
+        a = &program->stack[depth - 1];
+        switch (instr->op) {
+            case PREDICATE_AND:
+            case PREDICATE_OR:
+                for (k = 0; k < n; k++) {
+                    r = selection[k];
+                    x = a->scalar ? a->value : a->number[r];
+                    y = b->scalar ? b->value : b->number[r];
+                    a->number[r] = instr->op == PREDICATE_AND ? x != 0 && y != 0 : x != 0 || y != 0;
+                }
+                break;
+
+            case PREDICATE_ADD:
+            case PREDICATE_SUB:
+            case PREDICATE_MUL:
+            case PREDICATE_DIV:
+                for (k = 0; k < n; k++) {
+                    r = selection[k];
+                    x = a->scalar ? a->value : a->number[r];
+                    y = b->scalar ? b->value : b->number[r];
+                    if (instr->op == PREDICATE_ADD)
+                        x += y;
+                    else if (instr->op == PREDICATE_SUB)
+                        x -= y;
+                    else if (instr->op == PREDICATE_MUL)
+                        x *= y;
+                    else if (y == 0 || (instr->type == TYPE_INT && (int) y == 0))
+                        x = 0;
+                    else if (instr->type == TYPE_INT)
+                        x = (int) x / (int) y;
+                    else
+                        x /= y;
+                    a->number[r] = x;
+                }
+                break;
+
+            default:
+                if (instr->mode == PREDICATE_NUMERIC) {
+                    for (k = 0; k < n; k++) {
+                        r = selection[k];
+                        x = a->scalar ? a->value : a->number[r];
+                        y = b->scalar ? b->value : b->number[r];
+                        cmp[r] = (x > y) - (x < y);
+                    }
+                } else {
+                    for (k = 0; k < n; k++) {
+                        r = selection[k];
+                        data_a = AK_batch_program_bytes(a, r, &size_a);
+                        data_b = AK_batch_program_bytes(b, r, &size_b);
+                        size = size_a < size_b ? size_a : size_b;
+                        cmp[r] = memcmp(data_a, data_b, size);
+                        if (cmp[r] == 0)
+                            cmp[r] = size_a - size_b;
+                    }
+                }
+
+                switch (instr->op) {
+                    case PREDICATE_EQ:
+                        for (k = 0; k < n; k++)
+                            a->number[selection[k]] = cmp[selection[k]] == 0;
+                        break;
+                    case PREDICATE_NE:
+                        for (k = 0; k < n; k++)
+                            a->number[selection[k]] = cmp[selection[k]] != 0;
+                        break;
+                    case PREDICATE_LT:
+                        for (k = 0; k < n; k++)
+                            a->number[selection[k]] = cmp[selection[k]] < 0;
+                        break;
+                    case PREDICATE_GT:
+                        for (k = 0; k < n; k++)
+                            a->number[selection[k]] = cmp[selection[k]] > 0;
+                        break;
+                    case PREDICATE_LE:
+                        for (k = 0; k < n; k++)
+                            a->number[selection[k]] = cmp[selection[k]] <= 0;
+                        break;
+                    default:
+                        for (k = 0; k < n; k++)
+                            a->number[selection[k]] = cmp[selection[k]] >= 0;
+                        break;
+                }
+                break;
+        }
+        //the result is a vector even if both operands were constants, their column bytes are kept like in AK_predicate_eval
+        a->scalar = 0;
+    }
+
+    a = &program->stack[0];
+    if (a->scalar) {
+        batch->num_selected = a->value != 0 ? n : 0;
+        return;
+    }
+    for (k = i = 0; k < n; k++) {
+        selection[i] = selection[k];
+        i += a->number[selection[k]] != 0;
+    }
+    batch->num_selected = i;
+}
+
+/**
+ * @brief Function removes rows which do not satisfy an expression that could not be compiled from the selection of a
+          batch. Every row is put into a list and checked with AK_check_if_row_satisfies_expression.
+ * @param batch batch
+ * @param header header of rows
+ * @param expr expression
+ * @param row_root empty list used for the check
+ * @return No return value
+ */
+static void AK_batch_check_rows(AK_batch *batch, AK_header *header, struct list_node *expr, struct list_node *row_root) {
+    AK_PRO;
+    AK_iterator_value value;
+    char data[MAX_VARCHAR_LENGTH];
+    int i, k, selected = 0, size;
+
+    for (k = 0; k < batch->num_selected; k++) {
+        for (i = 0; i < batch->num_attr; i++) {
+            AK_batch_value(batch, i, batch->selection[k], &value);
+            size = value.size < MAX_VARCHAR_LENGTH ? value.size : MAX_VARCHAR_LENGTH - 1;
+            memcpy(data, value.data, size);
+            data[size] = '\0';
+            Ak_Insert_New_Element(value.type, data, expr->table, header[i].att_name, row_root);
+        }
+        if (AK_check_if_row_satisfies_expression(row_root, expr))
+            batch->selection[selected++] = batch->selection[k];
+        Ak_DeleteAll_L3(&row_root);
+    }
+    batch->num_selected = selected;
+    AK_EPI;
+}
+
+/**
+ * @brief Function opens a vectorized table scan
+ * @param op scan
+ * @return EXIT_SUCCESS, EXIT_ERROR if table does not exist
+ */
+static int AK_batch_scan_open(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_scan_state *scan = (AK_batch_scan_state *) op->state;
+
+    scan->addresses = (table_addresses *) AK_get_table_addresses(scan->table);
+    if (scan->addresses->address_from[0] == 0) {
+        printf("AK_batch_scan_open: ERROR. Table %s does not exist.\n", scan->table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    scan->map = AK_zone_map_open(scan->table);
+    scan->extent = 0;
+    scan->address = scan->addresses->address_from[0] - 1;
+    scan->loaded = 0;
+    scan->done = 0;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function copies the next block of a vectorized table scan which zone map does not rule out
+ * @param scan state of the scan
+ * @return EXIT_SUCCESS if a block was copied, EXIT_ERROR after the last block
+ */
+static int AK_batch_scan_block(AK_batch_scan_state *scan) {
+    AK_mem_block *mem_block;
+
+    while (!scan->done) {
+        scan->address++;
+        if (scan->address >= scan->addresses->address_to[scan->extent]) {
+            scan->extent++;
+            if (scan->extent >= MAX_EXTENTS_IN_SEGMENT || scan->addresses->address_from[scan->extent] == 0) {
+                scan->done = 1;
+                break;
+            }
+            scan->address = scan->addresses->address_from[scan->extent];
+        }
+        if (AK_zone_map_check(scan->map, scan->address, &scan->filter) != ZONE_MAP_READ)
+            continue;
+
+        //block is copied, its rows are decoded over several calls and other operators use the cache in between
+        mem_block = (AK_mem_block *) AK_get_block(scan->address);
+        memcpy(scan->block, mem_block->block, sizeof (AK_block));
+        AK_zone_map_refresh(scan->map, scan->block);
+        scan->slot = 0;
+        scan->loaded = 1;
+        return EXIT_SUCCESS;
+    }
+    scan->loaded = 0;
+    return EXIT_ERROR;
+}
+
+/**
+ * @brief Function decodes rows of the current block into vectors of a batch, one attribute at a time
+ * @param op scan
+ * @param count number of rows in slots of the scan state
+ * @return No return value
+ */
+static void AK_batch_scan_decode(AK_batch_operator *op, int count) {
+    AK_batch_scan_state *scan = (AK_batch_scan_state *) op->state;
+    AK_batch *batch = &op->batch;
+    AK_block *block = scan->block;
+    AK_tuple_dict *entry;
+    AK_vector *vector;
+    int i, c, row = batch->num_rows;
+
+    for (c = 0; c < op->num_attr; c++) {
+        vector = &batch->column[c];
+        for (i = 0; i < count; i++) {
+            entry = &block->tuple_dict[scan->slots[i] + c];
+            if (vector->width && entry->type == vector->type && entry->size == vector->width) {
+                memcpy(vector->values + (row + i) * vector->width, block->data + entry->address, vector->width);
+                vector->null[row + i] = 0;
+            } else {
+                AK_batch_set_value(batch, c, row + i, entry->type, (char *) block->data + entry->address, entry->size);
+            }
+        }
+    }
+    batch->num_rows += count;
+}
+
+/**
+ * @brief Function produces the next batch of a vectorized table scan. Batch is filled with rows of as many blocks as
+          it takes, and then filtered as a whole.
+ * @param op scan
+ * @return batch, NULL after the last one
+ */
+static AK_batch *AK_batch_scan_next(AK_batch_operator *op) {
+    AK_batch_scan_state *scan = (AK_batch_scan_state *) op->state;
+    AK_batch *batch = &op->batch;
+    AK_tuple_dict *dict;
+    int count;
+
+    for (;;) {
+        AK_batch_reset(batch);
+        while (batch->num_rows < BATCH_SIZE) {
+            if (!scan->loaded || scan->slot + op->num_attr > DATA_BLOCK_SIZE
+                    || scan->block->tuple_dict[scan->slot].type == FREE_INT) {
+                if (AK_batch_scan_block(scan) == EXIT_ERROR)
+                    break;
+                continue;
+            }
+
+            dict = scan->block->tuple_dict;
+            for (count = 0; batch->num_rows + count < BATCH_SIZE && scan->slot + op->num_attr <= DATA_BLOCK_SIZE
+                    && dict[scan->slot].type != FREE_INT; scan->slot += op->num_attr) {
+                if (dict[scan->slot].type != 0)
+                    scan->slots[count++] = scan->slot;
+            }
+            AK_batch_scan_decode(op, count);
+        }
+        if (batch->num_rows == 0)
+            return NULL;
+
+        AK_batch_finish(batch);
+        if (scan->program != NULL)
+            AK_batch_program_eval(scan->program, batch);
+        else if (scan->expr != NULL)
+            AK_batch_check_rows(batch, op->header, scan->expr, scan->row_root);
+        if (batch->num_selected > 0)
+            return batch;
+    }
+}
+
+/**
+ * @brief Function closes a vectorized table scan
+ * @param op scan
+ * @return No return value
+ */
+static void AK_batch_scan_close(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_scan_state *scan = (AK_batch_scan_state *) op->state;
+
+    AK_free(scan->addresses);
+    scan->addresses = NULL;
+    AK_zone_map_close(scan->map);
+    scan->map = NULL;
+    scan->loaded = 0;
+    AK_EPI;
+}
+
+/**
+ * @brief Function frees state of a vectorized table scan
+ * @param op scan
+ * @return No return value
+ */
+static void AK_batch_scan_destroy(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_scan_state *scan = (AK_batch_scan_state *) op->state;
+
+    AK_batch_program_free(scan->program);
+    AK_free(scan->block);
+    AK_free(scan->row_root);
+    AK_EPI;
+}
+
+/**
+ * @brief Function allocates an operator
+ * @param state_size size of state of the operator
+ * @return operator
+ */
+static AK_batch_operator *AK_batch_new(size_t state_size) {
+    AK_batch_operator *op = (AK_batch_operator *) AK_calloc(1, sizeof (AK_batch_operator));
+
+    op->state = AK_calloc(1, state_size);
+    return op;
+}
+
+/**
+ * @brief Function creates a vectorized table scan. Rows are decoded into vectors one attribute at a time, blocks whose
+          zone maps rule expression out are not read and expression is evaluated on whole batches.
+ * @param table table name
+ * @param expr list with postfix notation of the logical expression, NULL for all rows
+ * @return scan, NULL if table does not exist
+ */
+AK_batch_operator *AK_batch_scan(char *table, struct list_node *expr) {
+    AK_PRO;
+    AK_batch_operator *op;
+    AK_batch_scan_state *scan;
+    AK_header *header = (AK_header *) AK_get_header(table);
+    int num_attr = AK_num_attr(table);
+
+    if (header == NULL || num_attr <= 0) {
+        printf("AK_batch_scan: ERROR. Table %s does not exist.\n", table);
+        AK_free(header);
+        AK_EPI;
+        return NULL;
+    }
+
+    op = AK_batch_new(sizeof (AK_batch_scan_state));
+    op->open = AK_batch_scan_open;
+    op->next = AK_batch_scan_next;
+    op->close = AK_batch_scan_close;
+    op->destroy = AK_batch_scan_destroy;
+    op->num_attr = num_attr < MAX_ATTRIBUTES ? num_attr : MAX_ATTRIBUTES;
+    memcpy(op->header, header, op->num_attr * sizeof (AK_header));
+    AK_free(header);
+    AK_batch_init(&op->batch, op->header, op->num_attr);
+
+    scan = (AK_batch_scan_state *) op->state;
+    strncpy(scan->table, table, MAX_ATT_NAME - 1);
+    scan->expr = expr;
+    scan->program = expr != NULL ? AK_batch_program_new(expr, op->header, op->num_attr) : NULL;
+    AK_zone_filter_init(&scan->filter);
+    if (scan->program != NULL)
+        AK_predicate_ranges(scan->program->predicate, op->num_attr, &scan->filter);
+    scan->block = (AK_block *) AK_malloc(sizeof (AK_block));
+    scan->row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&scan->row_root);
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @brief Function opens an operator with one input
+ * @param op operator
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_batch_unary_open(AK_batch_operator *op) {
+    AK_PRO;
+    int result = AK_batch_open(op->child[0]);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function closes an operator with one input
+ * @param op operator
+ * @return No return value
+ */
+static void AK_batch_unary_close(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_close(op->child[0]);
+    AK_EPI;
+}
+
+/**
+ * @brief Function produces the next batch of input with at least one row which satisfies expression of a selection.
+          Only the selection vector of the input batch is changed.
+ * @param op selection
+ * @return batch, NULL after the last one
+ */
+static AK_batch *AK_batch_select_next(AK_batch_operator *op) {
+    AK_batch_select_state *select = (AK_batch_select_state *) op->state;
+    AK_batch *batch;
+
+    while ((batch = AK_batch_next(op->child[0])) != NULL) {
+        if (select->program != NULL)
+            AK_batch_program_eval(select->program, batch);
+        else
+            AK_batch_check_rows(batch, op->header, select->expr, select->row_root);
+        if (batch->num_selected > 0)
+            return batch;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function frees state of a vectorized selection
+ * @param op selection
+ * @return No return value
+ */
+static void AK_batch_select_destroy(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_select_state *select = (AK_batch_select_state *) op->state;
+
+    AK_batch_program_free(select->program);
+    AK_free(select->row_root);
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a vectorized selection over batches of any operator. Expression on a table is better given
+          to AK_batch_scan, which can skip blocks by zone maps.
+ * @param child input operator
+ * @param expr list with postfix notation of the logical expression
+ * @return selection, NULL if input is NULL
+ */
+AK_batch_operator *AK_batch_select(AK_batch_operator *child, struct list_node *expr) {
+    AK_PRO;
+    AK_batch_operator *op;
+    AK_batch_select_state *select;
+
+    if (child == NULL || expr == NULL) {
+        AK_EPI;
+        return child;
+    }
+
+    op = AK_batch_new(sizeof (AK_batch_select_state));
+    op->open = AK_batch_unary_open;
+    op->next = AK_batch_select_next;
+    op->close = AK_batch_unary_close;
+    op->destroy = AK_batch_select_destroy;
+    op->child[0] = child;
+    op->num_attr = child->num_attr;
+    memcpy(op->header, child->header, sizeof (op->header));
+
+    select = (AK_batch_select_state *) op->state;
+    select->expr = expr;
+    select->program = AK_batch_program_new(expr, op->header, op->num_attr);
+    select->row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&select->row_root);
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @brief Function produces the next batch of a projection, which borrows vectors of the input batch
+ * @param op projection
+ * @return batch, NULL after the last one
+ */
+static AK_batch *AK_batch_project_next(AK_batch_operator *op) {
+    AK_batch_project_state *project = (AK_batch_project_state *) op->state;
+    AK_batch *input = AK_batch_next(op->child[0]), *batch = &op->batch;
+    int i;
+
+    if (input == NULL)
+        return NULL;
+    for (i = 0; i < op->num_attr; i++)
+        batch->column[i] = input->column[project->columns[i]];
+    batch->num_attr = op->num_attr;
+    batch->num_rows = input->num_rows;
+    batch->num_selected = input->num_selected;
+    memcpy(batch->selection, input->selection, input->num_selected * sizeof (int));
+    return batch;
+}
+
+/**
+ * @brief Function creates a vectorized projection, attributes are produced in the order of the list
+ * @param child input operator
+ * @param att list of attributes
+ * @return projection, NULL if input is NULL or an attribute does not exist (input is freed)
+ */
+AK_batch_operator *AK_batch_project(AK_batch_operator *child, struct list_node *att) {
+    AK_PRO;
+    AK_batch_operator *op;
+    AK_batch_project_state *project;
+    struct list_node *list_elem;
+    int i;
+
+    if (child == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+
+    op = AK_batch_new(sizeof (AK_batch_project_state));
+    op->open = AK_batch_unary_open;
+    op->next = AK_batch_project_next;
+    op->close = AK_batch_unary_close;
+    op->child[0] = child;
+    project = (AK_batch_project_state *) op->state;
+
+    for (list_elem = Ak_First_L2(att); list_elem != NULL && op->num_attr < MAX_ATTRIBUTES; list_elem = list_elem->next) {
+        for (i = 0; i < child->num_attr && strcmp(child->header[i].att_name, list_elem->data) != 0; i++)
+            ;
+        if (i == child->num_attr) {
+            printf("AK_batch_project: ERROR. Attribute %s does not exist.\n", list_elem->data);
+            AK_batch_operator_free(op);
+            AK_EPI;
+            return NULL;
+        }
+        project->columns[op->num_attr] = i;
+        memcpy(&op->header[op->num_attr], &child->header[i], sizeof (AK_header));
+        op->num_attr++;
+    }
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @brief Function produces the next batch of the input until limit rows are produced. The selection vector of the
+          batch which crosses the limit is cut, and then the input is closed, so scans below stop reading blocks.
+ * @param op limit
+ * @return batch, NULL after the last one
+ */
+static AK_batch *AK_batch_limit_next(AK_batch_operator *op) {
+    AK_batch_limit_state *limit = (AK_batch_limit_state *) op->state;
+    AK_batch *batch = NULL;
+
+    if (op->num_rows >= limit->limit || (batch = AK_batch_next(op->child[0])) == NULL) {
+        AK_batch_close(op->child[0]);
+        return NULL;
+    }
+    if (batch->num_selected > limit->limit - op->num_rows)
+        batch->num_selected = limit->limit - op->num_rows;
+    return batch;
+}
+
+/**
+ * @brief Function creates a vectorized limit (LIMIT n): only the first limit rows of the input are produced
+ * @param child input operator
+ * @param limit maximal number of produced rows
+ * @return limit, NULL if input is NULL
+ */
+AK_batch_operator *AK_batch_limit(AK_batch_operator *child, int limit) {
+    AK_PRO;
+    AK_batch_operator *op;
+
+    if (child == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+
+    op = AK_batch_new(sizeof (AK_batch_limit_state));
+    op->open = AK_batch_unary_open;
+    op->next = AK_batch_limit_next;
+    op->close = AK_batch_unary_close;
+    op->child[0] = child;
+    op->num_attr = child->num_attr;
+    memcpy(op->header, child->header, sizeof (op->header));
+    ((AK_batch_limit_state *) op->state)->limit = limit < 0 ? 0 : limit;
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @brief Function finds the group of one row of an input batch of a hash aggregation and creates it if it is new
+ * @param agg state of the aggregation
+ * @param batch input batch
+ * @param row row index
+ * @return group index
+ */
+static int AK_batch_aggregate_group(AK_batch_aggregate_state *agg, AK_batch *batch, int row) {
+    AK_iterator_value value[MAX_ATTRIBUTES], key[MAX_ATTRIBUTES];
+    unsigned int hash = agg->hash[row], bucket;
+    int i, group;
+
+    for (i = 0; i < agg->num_group; i++)
+        AK_batch_value(batch, agg->group[i], row, &value[i]);
+
+    for (bucket = hash & (agg->num_buckets - 1); (group = agg->buckets[bucket]) != -1; bucket = (bucket + 1) & (agg->num_buckets - 1)) {
+        if (agg->group_hash[group] != hash)
+            continue;
+        AK_iterator_buffer_get(&agg->keys, group, key);
+        for (i = 0; i < agg->num_group; i++) {
+            if (key[i].size != value[i].size || memcmp(key[i].data, value[i].data, key[i].size) != 0)
+                break;
+        }
+        if (i == agg->num_group)
+            return group;
+    }
+
+    if (agg->num_groups == agg->capacity_groups) {
+        agg->capacity_groups = agg->capacity_groups ? 2 * agg->capacity_groups : 64;
+        agg->group_hash = (unsigned int *) AK_realloc(agg->group_hash, agg->capacity_groups * sizeof (unsigned int));
+        agg->acc = (double *) AK_realloc(agg->acc, agg->capacity_groups * MAX_ATTRIBUTES * sizeof (double));
+        agg->count = (int *) AK_realloc(agg->count, agg->capacity_groups * MAX_ATTRIBUTES * sizeof (int));
+    }
+    group = agg->num_groups++;
+    agg->group_hash[group] = hash;
+    memset(agg->acc + group * MAX_ATTRIBUTES, 0, MAX_ATTRIBUTES * sizeof (double));
+    memset(agg->count + group * MAX_ATTRIBUTES, 0, MAX_ATTRIBUTES * sizeof (int));
+    AK_iterator_buffer_add(&agg->keys, value);
+    agg->buckets[bucket] = group;
+
+    //table is kept at most half full
+    if (2 * agg->num_groups > agg->num_buckets) {
+        agg->num_buckets *= 2;
+        agg->buckets = (int *) AK_realloc(agg->buckets, agg->num_buckets * sizeof (int));
+        memset(agg->buckets, -1, agg->num_buckets * sizeof (int));
+        for (i = 0; i < agg->num_groups; i++) {
+            for (bucket = agg->group_hash[i] & (agg->num_buckets - 1); agg->buckets[bucket] != -1; bucket = (bucket + 1) & (agg->num_buckets - 1))
+                ;
+            agg->buckets[bucket] = i;
+        }
+    }
+    return group;
+}
+
+/**
+ * @brief Function adds selected rows of an input batch to groups of a hash aggregation. Key hashes, groups and every
+          aggregate are computed in separate loops over the batch.
+ * @param op aggregation
+ * @param batch input batch
+ * @return No return value
+ */
+static void AK_batch_aggregate_add(AK_batch_operator *op, AK_batch *batch) {
+    AK_batch_aggregate_state *agg = (AK_batch_aggregate_state *) op->state;
+    AK_iterator_value value;
+    AK_vector *vector;
+    int *selection = batch->selection, *count;
+    int n = batch->num_selected, i, k, r, index;
+    double *acc, x;
+
+    for (k = 0; k < n; k++)
+        agg->hash[selection[k]] = BATCH_HASH_SEED;
+    for (i = 0; i < agg->num_group; i++) {
+        for (k = 0; k < n; k++) {
+            r = selection[k];
+            AK_batch_value(batch, agg->group[i], r, &value);
+            agg->hash[r] = AK_batch_hash(agg->hash[r], value.data, value.size);
+        }
+    }
+    for (k = 0; k < n; k++)
+        agg->group_id[selection[k]] = AK_batch_aggregate_group(agg, batch, selection[k]);
+
+    for (i = 0; i < op->num_attr; i++) {
+        if (agg->task[i] == AGG_TASK_GROUP)
+            continue;
+        vector = &batch->column[agg->columns[i]];
+        acc = agg->acc + i;
+        count = agg->count + i;
+
+        if (agg->task[i] == AGG_TASK_COUNT || vector->width == 0) {
+            //values of non numeric attributes are only counted
+            for (k = 0; k < n; k++) {
+                r = selection[k];
+                count[agg->group_id[r] * MAX_ATTRIBUTES] += !vector->null[r];
+            }
+            continue;
+        }
+
+        switch (vector->type) {
+            case TYPE_FLOAT:
+                for (k = 0; k < n; k++)
+                    agg->number[selection[k]] = *(float *) (vector->values + selection[k] * sizeof (double));
+                break;
+            case TYPE_NUMBER:
+                for (k = 0; k < n; k++)
+                    agg->number[selection[k]] = ((double *) vector->values)[selection[k]];
+                break;
+            default:
+                for (k = 0; k < n; k++)
+                    agg->number[selection[k]] = ((int *) vector->values)[selection[k]];
+                break;
+        }
+
+        for (k = 0; k < n; k++) {
+            r = selection[k];
+            if (vector->null[r])
+                continue;
+            index = agg->group_id[r] * MAX_ATTRIBUTES;
+            x = agg->number[r];
+            if (agg->task[i] == AGG_TASK_MAX)
+                acc[index] = count[index] == 0 || x > acc[index] ? x : acc[index];
+            else if (agg->task[i] == AGG_TASK_MIN)
+                acc[index] = count[index] == 0 || x < acc[index] ? x : acc[index];
+            else
+                acc[index] += x;
+            count[index]++;
+        }
+    }
+}
+
+/**
+ * @brief Function opens a hash aggregation and aggregates all rows of its input
+ * @param op aggregation
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_batch_aggregate_open(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_aggregate_state *agg = (AK_batch_aggregate_state *) op->state;
+    AK_batch *batch;
+
+    if (AK_batch_open(op->child[0]) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_iterator_buffer_init(&agg->keys, agg->num_group);
+    agg->num_groups = agg->capacity_groups = agg->emitted = 0;
+    agg->num_buckets = 64;
+    agg->buckets = (int *) AK_malloc(agg->num_buckets * sizeof (int));
+    memset(agg->buckets, -1, agg->num_buckets * sizeof (int));
+    //without group attributes there is one group, even for an empty input
+    if (agg->num_group == 0) {
+        agg->hash[0] = BATCH_HASH_SEED;
+        AK_batch_aggregate_group(agg, NULL, 0);
+    }
+
+    while ((batch = AK_batch_next(op->child[0])) != NULL)
+        AK_batch_aggregate_add(op, batch);
+    AK_batch_close(op->child[0]);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function produces the next batch of groups of a hash aggregation
+ * @param op aggregation
+ * @return batch, NULL after the last one
+ */
+static AK_batch *AK_batch_aggregate_next(AK_batch_operator *op) {
+    AK_batch_aggregate_state *agg = (AK_batch_aggregate_state *) op->state;
+    AK_iterator_value key[MAX_ATTRIBUTES];
+    AK_batch *batch = &op->batch;
+    char data[sizeof (double)];
+    int i, j, group, row, index, integer;
+    float real;
+    double number;
+
+    AK_batch_reset(batch);
+    for (; agg->emitted < agg->num_groups && batch->num_rows < BATCH_SIZE; batch->num_rows++) {
+        group = agg->emitted++;
+        row = batch->num_rows;
+        if (agg->num_group > 0)
+            AK_iterator_buffer_get(&agg->keys, group, key);
+
+        for (i = j = 0; i < op->num_attr; i++) {
+            index = group * MAX_ATTRIBUTES + i;
+            if (agg->task[i] == AGG_TASK_GROUP) {
+                AK_batch_set_value(batch, i, row, key[j].type, key[j].data, key[j].size);
+                j++;
+                continue;
+            }
+            if (agg->task[i] == AGG_TASK_COUNT || agg->count[index] == 0) {
+                integer = agg->count[index];
+                if (agg->task[i] == AGG_TASK_COUNT)
+                    AK_batch_set_value(batch, i, row, TYPE_INT, (char *) &integer, sizeof (int));
+                else
+                    AK_batch_set_value(batch, i, row, TYPE_VARCHAR, "null", strlen("null"));
+                continue;
+            }
+
+            number = agg->task[i] == AGG_TASK_AVG ? agg->acc[index] / agg->count[index] : agg->acc[index];
+            memset(data, 0, sizeof (data));
+            switch (op->header[i].type) {
+                case TYPE_FLOAT:
+                    real = number;
+                    memcpy(data, &real, sizeof (float));
+                    break;
+                case TYPE_NUMBER:
+                    memcpy(data, &number, sizeof (double));
+                    break;
+                default:
+                    integer = number;
+                    memcpy(data, &integer, sizeof (int));
+                    break;
+            }
+            AK_batch_set_value(batch, i, row, op->header[i].type, data, AK_batch_width(op->header[i].type));
+        }
+    }
+    if (batch->num_rows == 0)
+        return NULL;
+    AK_batch_finish(batch);
+    return batch;
+}
+
+/**
+ * @brief Function closes a hash aggregation
+ * @param op aggregation
+ * @return No return value
+ */
+static void AK_batch_aggregate_close(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_aggregate_state *agg = (AK_batch_aggregate_state *) op->state;
+
+    AK_batch_close(op->child[0]);
+    AK_iterator_buffer_free(&agg->keys);
+    AK_free(agg->group_hash);
+    AK_free(agg->acc);
+    AK_free(agg->count);
+    AK_free(agg->buckets);
+    agg->group_hash = NULL;
+    agg->acc = NULL;
+    agg->count = NULL;
+    agg->buckets = NULL;
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a hash aggregation like AK_aggregation: attributes of input are produced in its order, group
+          attributes with their values and aggregates as Cnt(x), Sum(x), Max(x), Min(x) and Avg(x). Null values are
+          not aggregated; an aggregate with no values is null, a count is 0.
+ * @param child input operator
+ * @param input attributes and AGG_TASK_* tasks, as for AK_aggregation (it is not changed)
+ * @return aggregation, NULL if input is NULL, an attribute does not exist or a name of an aggregate would be longer
+          than MAX_ATT_NAME (input is freed)
+ */
+AK_batch_operator *AK_batch_aggregate(AK_batch_operator *child, AK_agg_input *input) {
+    AK_PRO;
+    AK_batch_operator *op;
+    AK_batch_aggregate_state *agg;
+    AK_header *header;
+    char name[MAX_ATT_NAME];
+    const char *function;
+    int i, j, type;
+
+    if (child == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+
+    op = AK_batch_new(sizeof (AK_batch_aggregate_state));
+    op->open = AK_batch_aggregate_open;
+    op->next = AK_batch_aggregate_next;
+    op->close = AK_batch_aggregate_close;
+    op->child[0] = child;
+    agg = (AK_batch_aggregate_state *) op->state;
+
+    for (i = 0; i < input->counter && i < MAX_ATTRIBUTES; i++) {
+        //parts of averages added by AK_agg_input_fix are not needed, averages are computed from sums and counts
+        if (input->tasks[i] == AGG_TASK_AVG_COUNT || input->tasks[i] == AGG_TASK_AVG_SUM)
+            continue;
+        for (j = 0; j < child->num_attr && strcmp(child->header[j].att_name, input->attributes[i].att_name) != 0; j++)
+            ;
+        if (j == child->num_attr) {
+            printf("AK_batch_aggregate: ERROR. Attribute %s does not exist.\n", input->attributes[i].att_name);
+            AK_batch_operator_free(op);
+            AK_EPI;
+            return NULL;
+        }
+
+        type = child->header[j].type;
+        if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+            type = TYPE_INT;
+        switch (input->tasks[i]) {
+            case AGG_TASK_GROUP:
+                function = NULL;
+                type = child->header[j].type;
+                agg->group[agg->num_group++] = j;
+                break;
+            case AGG_TASK_COUNT:
+                function = "Cnt";
+                type = TYPE_INT;
+                break;
+            case AGG_TASK_SUM:
+                function = "Sum";
+                break;
+            case AGG_TASK_MAX:
+                function = "Max";
+                break;
+            case AGG_TASK_MIN:
+                function = "Min";
+                break;
+            default:
+                function = "Avg";
+                type = TYPE_FLOAT;
+                break;
+        }
+        if (function == NULL)
+            strcpy(name, child->header[j].att_name);
+        else if (snprintf(name, sizeof (name), "%s(%s)", function, child->header[j].att_name) >= (int) sizeof (name)) {
+            printf("AK_batch_aggregate: ERROR. Name of %s(%s) is too long.\n", function, child->header[j].att_name);
+            AK_batch_operator_free(op);
+            AK_EPI;
+            return NULL;
+        }
+        agg->task[op->num_attr] = input->tasks[i];
+        agg->columns[op->num_attr] = j;
+        header = (AK_header *) AK_create_header(name, type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&op->header[op->num_attr], header, sizeof (AK_header));
+        AK_free(header);
+        op->num_attr++;
+    }
+    AK_batch_init(&op->batch, op->header, op->num_attr);
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @brief Function opens a hash join: rows of the right input are materialized and chained in buckets
+ * @param op join
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_batch_join_open(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_join_state *join = (AK_batch_join_state *) op->state;
+    AK_batch_operator *right = op->child[1];
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    AK_batch *batch;
+    unsigned int hash, num_buckets = 16;
+    int i, k, row;
+
+    if (AK_batch_open(op->child[0]) == EXIT_ERROR || AK_batch_open(right) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_iterator_buffer_init(&join->rows, right->num_attr);
+    while ((batch = AK_batch_next(right)) != NULL) {
+        for (k = 0; k < batch->num_selected; k++) {
+            for (i = 0; i < right->num_attr; i++)
+                AK_batch_value(batch, i, batch->selection[k], &value[i]);
+            for (i = 0, hash = BATCH_HASH_SEED; i < join->num_join; i++)
+                hash = AK_batch_hash(hash, value[join->right_join[i]].data, value[join->right_join[i]].size);
+            if (join->rows.num_rows % 1024 == 0)
+                join->row_hash = (unsigned int *) AK_realloc(join->row_hash, (join->rows.num_rows + 1024) * sizeof (unsigned int));
+            join->row_hash[join->rows.num_rows] = hash;
+            AK_iterator_buffer_add(&join->rows, value);
+        }
+    }
+    AK_batch_close(right);
+
+    while (num_buckets < 2 * (unsigned int) join->rows.num_rows)
+        num_buckets *= 2;
+    join->mask = num_buckets - 1;
+    join->buckets = (int *) AK_malloc(num_buckets * sizeof (int));
+    memset(join->buckets, -1, num_buckets * sizeof (int));
+    join->chain = (int *) AK_malloc((join->rows.num_rows + 1) * sizeof (int));
+    //rows are chained from the last one, so every chain lists right rows in input order
+    for (row = join->rows.num_rows - 1; row >= 0; row--) {
+        join->chain[row] = join->buckets[join->row_hash[row] & join->mask];
+        join->buckets[join->row_hash[row] & join->mask] = row;
+    }
+    join->left = NULL;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function produces the next batch of pairs of left and right rows which are equal on all join attributes.
+          Join keys of a left batch are hashed in one loop; if the output batch gets full while a left row is probed,
+          the probe continues where it stopped on the next call.
+ * @param op join
+ * @return batch, NULL after the last one
+ */
+static AK_batch *AK_batch_join_next(AK_batch_operator *op) {
+    AK_batch_join_state *join = (AK_batch_join_state *) op->state;
+    AK_batch *batch = &op->batch, *left;
+    AK_iterator_value value, *right_value;
+    int i, k, r, right_row;
+
+    AK_batch_reset(batch);
+    while (batch->num_rows < BATCH_SIZE) {
+        if (join->left == NULL || join->position >= join->left->num_selected) {
+            if ((join->left = AK_batch_next(op->child[0])) == NULL)
+                break;
+            left = join->left;
+            for (k = 0; k < left->num_selected; k++)
+                join->hash[left->selection[k]] = BATCH_HASH_SEED;
+            for (i = 0; i < join->num_join; i++) {
+                for (k = 0; k < left->num_selected; k++) {
+                    r = left->selection[k];
+                    AK_batch_value(left, join->left_join[i], r, &value);
+                    join->hash[r] = AK_batch_hash(join->hash[r], value.data, value.size);
+                }
+            }
+            join->position = 0;
+            join->next_row = -2;
+        }
+
+        left = join->left;
+        r = left->selection[join->position];
+        if (join->next_row == -2)
+            join->next_row = join->buckets[join->hash[r] & join->mask];
+
+        while (join->next_row != -1 && batch->num_rows < BATCH_SIZE) {
+            right_row = join->next_row;
+            join->next_row = join->chain[right_row];
+            if (join->row_hash[right_row] != join->hash[r])
+                continue;
+            AK_iterator_buffer_get(&join->rows, right_row, join->right_value);
+            for (i = 0; i < join->num_join; i++) {
+                right_value = &join->right_value[join->right_join[i]];
+                AK_batch_value(left, join->left_join[i], r, &value);
+                if (value.size != right_value->size || memcmp(value.data, right_value->data, value.size) != 0)
+                    break;
+            }
+            if (i < join->num_join)
+                continue;
+
+            for (i = 0; i < op->num_attr; i++) {
+                if (join->right[i])
+                    value = join->right_value[join->columns[i]];
+                else
+                    AK_batch_value(left, join->columns[i], r, &value);
+                AK_batch_set_value(batch, i, batch->num_rows, value.type, value.data, value.size);
+            }
+            batch->num_rows++;
+        }
+        if (join->next_row == -1) {
+            join->position++;
+            join->next_row = -2;
+        }
+    }
+    if (batch->num_rows == 0)
+        return NULL;
+    AK_batch_finish(batch);
+    return batch;
+}
+
+/**
+ * @brief Function closes a hash join
+ * @param op join
+ * @return No return value
+ */
+static void AK_batch_join_close(AK_batch_operator *op) {
+    AK_PRO;
+    AK_batch_join_state *join = (AK_batch_join_state *) op->state;
+
+    AK_batch_close(op->child[0]);
+    AK_batch_close(op->child[1]);
+    AK_iterator_buffer_free(&join->rows);
+    AK_free(join->row_hash);
+    AK_free(join->chain);
+    AK_free(join->buckets);
+    join->row_hash = NULL;
+    join->chain = NULL;
+    join->buckets = NULL;
+    join->left = NULL;
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a hash join with the result of AK_join: produced rows have attributes of the left input
+          which are not join attributes, followed by all attributes of the right input. Right input is materialized in
+          a hash table, left input is probed a batch at a time.
+ * @param left left input operator
+ * @param right right input operator
+ * @param att list of join attributes
+ * @return join, NULL if an input is NULL, a join attribute does not exist or there are too many attributes (inputs are freed)
+ */
+AK_batch_operator *AK_batch_join(AK_batch_operator *left, AK_batch_operator *right, struct list_node *att) {
+    AK_PRO;
+    AK_batch_operator *op;
+    AK_batch_join_state *join;
+    struct list_node *list_elem;
+    int i, j, is_join;
+
+    if (left == NULL || right == NULL) {
+        AK_batch_operator_free(left);
+        AK_batch_operator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+
+    op = AK_batch_new(sizeof (AK_batch_join_state));
+    op->open = AK_batch_join_open;
+    op->next = AK_batch_join_next;
+    op->close = AK_batch_join_close;
+    op->child[0] = left;
+    op->child[1] = right;
+    join = (AK_batch_join_state *) op->state;
+
+    for (list_elem = Ak_First_L2(att); list_elem != NULL && join->num_join < MAX_ATTRIBUTES; list_elem = list_elem->next) {
+        for (i = 0; i < left->num_attr && strcmp(left->header[i].att_name, list_elem->data) != 0; i++)
+            ;
+        for (j = 0; j < right->num_attr && strcmp(right->header[j].att_name, list_elem->data) != 0; j++)
+            ;
+        if (i == left->num_attr || j == right->num_attr) {
+            printf("AK_batch_join: ERROR. Join attribute %s does not exist.\n", list_elem->data);
+            AK_batch_operator_free(op);
+            AK_EPI;
+            return NULL;
+        }
+        join->left_join[join->num_join] = i;
+        join->right_join[join->num_join] = j;
+        join->num_join++;
+    }
+
+    for (i = 0; i < left->num_attr + right->num_attr; i++) {
+        if (i < left->num_attr) {
+            for (j = is_join = 0; j < join->num_join; j++)
+                is_join |= join->left_join[j] == i;
+            if (is_join)
+                continue;
+        }
+        if (op->num_attr == MAX_ATTRIBUTES) {
+            printf("AK_batch_join: ERROR. Join has more than %d attributes.\n", MAX_ATTRIBUTES);
+            AK_batch_operator_free(op);
+            AK_EPI;
+            return NULL;
+        }
+        join->right[op->num_attr] = i >= left->num_attr;
+        join->columns[op->num_attr] = i < left->num_attr ? i : i - left->num_attr;
+        memcpy(&op->header[op->num_attr], i < left->num_attr ? &left->header[i] : &right->header[i - left->num_attr], sizeof (AK_header));
+        op->num_attr++;
+    }
+    AK_batch_init(&op->batch, op->header, op->num_attr);
+    AK_EPI;
+    return op;
+}
+
+/**
+ * @brief Function opens an operator and its inputs
+ * @param op operator
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_batch_open(AK_batch_operator *op) {
+    AK_PRO;
+    int result;
+
+    if (op == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (op->opened)
+        AK_batch_close(op);
+    op->num_rows = 0;
+    op->opened = 1;
+    result = op->open(op);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function produces the next batch of an operator
+ * @param op operator
+ * @return batch with at least one selected row, NULL after the last one
+ */
+AK_batch *AK_batch_next(AK_batch_operator *op) {
+    AK_batch *batch;
+
+    if (!op->opened || (batch = op->next(op)) == NULL)
+        return NULL;
+    op->num_rows += batch->num_selected;
+    return batch;
+}
+
+/**
+ * @brief Function closes an operator and its inputs
+ * @param op operator
+ * @return No return value
+ */
+void AK_batch_close(AK_batch_operator *op) {
+    AK_PRO;
+    if (op != NULL && op->opened) {
+        op->opened = 0;
+        op->close(op);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function frees an operator and its inputs
+ * @param op operator, can be NULL
+ * @return No return value
+ */
+void AK_batch_operator_free(AK_batch_operator *op) {
+    AK_PRO;
+    if (op != NULL) {
+        AK_batch_close(op);
+        AK_batch_operator_free(op->child[0]);
+        AK_batch_operator_free(op->child[1]);
+        if (op->destroy != NULL)
+            op->destroy(op);
+        AK_batch_free(&op->batch);
+        AK_free(op->state);
+        AK_free(op);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function runs a plan and counts its rows without writing them
+ * @param op root operator of the plan
+ * @return number of rows, EXIT_ERROR if plan could not be opened
+ */
+int AK_batch_count(AK_batch_operator *op) {
+    AK_PRO;
+    int rows;
+
+    if (op == NULL || AK_batch_open(op) == EXIT_ERROR) {
+        AK_batch_close(op);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    while (AK_batch_next(op) != NULL)
+        ;
+    rows = op->num_rows;
+    AK_batch_close(op);
+    AK_EPI;
+    return rows;
+}
+
+/**
+ * @brief Function runs a plan and writes all its rows into a new table, which is the only table written by the plan
+ * @param op root operator of the plan
+ * @param table name of the new table
+ * @return EXIT_SUCCESS, EXIT_ERROR if plan or table could not be created
+ */
+int AK_batch_materialize(AK_batch_operator *op, char *table) {
+    AK_PRO;
+    struct list_node *row_root;
+    AK_iterator_value value;
+    AK_batch *batch;
+    char data[MAX_VARCHAR_LENGTH];
+    int i, k, size;
+
+    if (op == NULL || AK_batch_open(op) == EXIT_ERROR) {
+        printf("AK_batch_materialize: ERROR. Plan for table %s cannot be opened.\n", table);
+        AK_batch_close(op);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, op->header) == EXIT_ERROR) {
+        AK_batch_close(op);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&row_root);
+    while ((batch = AK_batch_next(op)) != NULL) {
+        for (k = 0; k < batch->num_selected; k++) {
+            for (i = 0; i < op->num_attr; i++) {
+                AK_batch_value(batch, i, batch->selection[k], &value);
+                size = value.size < MAX_VARCHAR_LENGTH ? value.size : MAX_VARCHAR_LENGTH - 1;
+                memcpy(data, value.data, size);
+                data[size] = '\0';
+                Ak_Insert_New_Element(value.type, data, table, op->header[i].att_name, row_root);
+            }
+            Ak_insert_row(row_root);
+            Ak_DeleteAll_L3(&row_root);
+        }
+    }
+    Ak_dbg_messg(LOW, REL_OP, "AK_batch_materialize: %d rows written to %s\n", op->num_rows, table);
+    AK_batch_close(op);
+    AK_free(row_root);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function returns seconds passed since a moment
+ * @param start moment
+ * @return seconds
+ */
+static double AK_batch_seconds(struct timespec *start) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return end.tv_sec - start->tv_sec + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+/**
+ * @brief Function runs a pipelined plan and counts its rows
+ * @param iterator root operator of the plan
+ * @param sum if not NULL, sum of the first attribute (an integer) of all rows is added to it
+ * @return number of rows
+ */
+static int AK_batch_test_iterator(AK_iterator *iterator, double *sum) {
+    int rows, integer;
+
+    AK_iterator_open(iterator);
+    while (AK_iterator_next(iterator) == ITERATOR_ROW) {
+        if (sum != NULL) {
+            memcpy(&integer, iterator->value[0].data, sizeof (int));
+            *sum += integer;
+        }
+    }
+    rows = iterator->num_rows;
+    AK_iterator_close(iterator);
+    return rows;
+}
+
+/**
+ * @brief Function sums Cnt(value) and Sum(value) over all groups of an aggregated table with a vectorized aggregation
+ * @param table aggregated table
+ * @param count sum of counts
+ * @param sum sum of sums
+ * @return number of groups
+ */
+static int AK_batch_test_totals(char *table, int *count, int *sum) {
+    AK_header *header = (AK_header *) AK_get_header(table);
+    AK_agg_input input;
+    AK_batch_operator *plan;
+    AK_batch *batch;
+    AK_iterator_value value;
+    char *names[2] = {"Cnt(value)", "Sum(value)"};
+    int i, j, groups = AK_get_num_records(table);
+
+    *count = *sum = 0;
+    AK_agg_input_init(&input);
+    for (j = 0; j < 2; j++) {
+        for (i = 0; i < AK_num_attr(table); i++) {
+            if (strcmp(header[i].att_name, names[j]) == 0)
+                AK_agg_input_add(header[i], AGG_TASK_SUM, &input);
+        }
+    }
+    AK_free(header);
+
+    plan = AK_batch_aggregate(AK_batch_scan(table, NULL), &input);
+    AK_batch_open(plan);
+    if (input.counter == 2 && (batch = AK_batch_next(plan)) != NULL) {
+        AK_batch_value(batch, 0, 0, &value);
+        memcpy(count, value.data, sizeof (int));
+        AK_batch_value(batch, 1, 0, &value);
+        memcpy(sum, value.data, sizeof (int));
+    }
+    AK_batch_operator_free(plan);
+    return groups;
+}
+
+/**
+ * @brief Function for testing vectorized execution. Queries on a bulk loaded table are run in batches and tuple at a
+          time (pipelined plans), results are compared and times are printed.
+ * @return No return value
+ */
+void AK_batch_test() {
+    AK_PRO;
+    char *table = "batch_test", *groups = "batch_group";
+    char grp[MAX_VARCHAR_LENGTH], label[MAX_VARCHAR_LENGTH];
+    AK_header header[5], group_header[3], *temp;
+    AK_bulk_loader loader;
+    AK_agg_input input;
+    AK_batch_operator *plan;
+    AK_iterator *iterator;
+    AK_batch *batch;
+    AK_iterator_value result;
+    struct list_node *expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *expr_grp = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *att = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *join_att = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    char *names[4] = {"id", "grp", "value", "weight"};
+    int type[4] = {TYPE_INT, TYPE_VARCHAR, TYPE_INT, TYPE_FLOAT};
+    int size[4] = {sizeof (int), 0, sizeof (int), sizeof (double)};
+    char *data[4];
+    int id, value, lower = 300, upper = 700, rows = 20000, num_groups = 20, passed = 1, i;
+    int batch_rows, tuple_rows, batch_count, batch_total, batch_agg[4], tuple_agg[4];
+    double weight, batch_sum = 0, tuple_sum = 0, batch_seconds, tuple_seconds;
+    float real;
+    struct timespec start;
+
+    printf("\n********** VECTORIZED EXECUTION TEST **********\n\n");
+
+    for (i = 0; i < 4; i++) {
+        temp = (AK_header *) AK_create_header(names[i], type[i], FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[i], temp, sizeof (AK_header));
+        AK_free(temp);
+    }
+    memset(&header[4], 0, sizeof (AK_header));
+    AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, header);
+
+    AK_bulk_begin(&loader, table);
+    data[0] = (char *) &id;
+    data[1] = grp;
+    data[2] = (char *) &value;
+    data[3] = (char *) &weight;
+    for (i = 0; i < rows; i++) {
+        id = i;
+        sprintf(grp, "group%d", i % num_groups);
+        size[1] = strlen(grp);
+        value = (i * 7919) % 1000;
+        //float values are stored in the first bytes of a double sized value
+        weight = 0;
+        real = (i % 100) / 4.0;
+        memcpy(&weight, &real, sizeof (float));
+        AK_bulk_add_row(&loader, type, data, size, rows - i);
+    }
+    AK_bulk_end(&loader);
+
+    memcpy(&group_header[0], &header[1], sizeof (AK_header));
+    temp = (AK_header *) AK_create_header("label", TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&group_header[1], temp, sizeof (AK_header));
+    AK_free(temp);
+    memset(&group_header[2], 0, sizeof (AK_header));
+    AK_initialize_new_segment(groups, SEGMENT_TYPE_TABLE, group_header);
+    AK_bulk_begin(&loader, groups);
+    data[0] = grp;
+    data[1] = label;
+    type[0] = type[1] = TYPE_VARCHAR;
+    for (i = 0; i < num_groups; i++) {
+        sprintf(grp, "group%d", i);
+        sprintf(label, "label of group %d", i);
+        size[0] = strlen(grp);
+        size[1] = strlen(label);
+        AK_bulk_add_row(&loader, type, data, size, num_groups - i);
+    }
+    AK_bulk_end(&loader);
+
+    Ak_Init_L3(&expr);
+    Ak_Init_L3(&expr_grp);
+    Ak_Init_L3(&att);
+    Ak_Init_L3(&join_att);
+    strcpy(expr->table, table);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "value", sizeof ("value"), expr);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &lower, sizeof (int), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "value", sizeof ("value"), expr);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &upper, sizeof (int), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    strcpy(expr_grp->table, table);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), expr_grp);
+    Ak_InsertAtEnd_L3(TYPE_VARCHAR, "group3", strlen("group3"), expr_grp);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr_grp);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "value", sizeof ("value"), att);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), att);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), join_att);
+
+    printf("QUERY: SELECT value, id FROM batch_test WHERE value > 300 AND value < 700;\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    plan = AK_batch_project(AK_batch_scan(table, expr), att);
+    AK_batch_open(plan);
+    while ((batch = AK_batch_next(plan)) != NULL) {
+        for (i = 0; i < batch->num_selected; i++)
+            batch_sum += ((int *) batch->column[0].values)[batch->selection[i]];
+    }
+    batch_rows = plan->num_rows;
+    AK_batch_operator_free(plan);
+    batch_seconds = AK_batch_seconds(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    iterator = AK_iterator_project(AK_iterator_scan(table, expr), att);
+    tuple_rows = AK_batch_test_iterator(iterator, &tuple_sum);
+    AK_iterator_free(iterator);
+    tuple_seconds = AK_batch_seconds(&start);
+
+    printf("Batches: %d rows (sum %.0f) %.3f s\nPipelined: %d rows (sum %.0f) %.3f s\n",
+            batch_rows, batch_sum, batch_seconds, tuple_rows, tuple_sum, tuple_seconds);
+    passed &= batch_rows == tuple_rows && batch_rows > 0 && batch_sum == tuple_sum;
+
+    printf("\nQUERY: SELECT * FROM batch_test WHERE grp = 'group3';\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    batch_rows = AK_batch_count(AK_batch_select(AK_batch_scan(table, NULL), expr_grp));
+    batch_seconds = AK_batch_seconds(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    iterator = AK_iterator_select(AK_iterator_scan(table, NULL), expr_grp);
+    tuple_rows = AK_batch_test_iterator(iterator, NULL);
+    AK_iterator_free(iterator);
+    tuple_seconds = AK_batch_seconds(&start);
+    printf("Batches: %d rows %.3f s\nPipelined: %d rows %.3f s\n", batch_rows, batch_seconds, tuple_rows, tuple_seconds);
+    passed &= batch_rows == rows / num_groups && tuple_rows == batch_rows;
+
+    printf("\nQUERY: SELECT * FROM batch_test WHERE grp = 'group3' LIMIT 10;\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    batch_rows = AK_batch_count(AK_batch_limit(AK_batch_select(AK_batch_scan(table, NULL), expr_grp), 10));
+    batch_seconds = AK_batch_seconds(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    iterator = AK_iterator_limit(AK_iterator_select(AK_iterator_scan(table, NULL), expr_grp), 10);
+    tuple_rows = AK_batch_test_iterator(iterator, NULL);
+    AK_iterator_free(iterator);
+    tuple_seconds = AK_batch_seconds(&start);
+    printf("Batches: %d rows %.3f s\nPipelined: %d rows %.3f s\n", batch_rows, batch_seconds, tuple_rows, tuple_seconds);
+    passed &= batch_rows == 10 && tuple_rows == 10;
+
+    printf("\nQUERY: SELECT * FROM batch_test NATURAL JOIN batch_group;\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    plan = AK_batch_join(AK_batch_scan(table, NULL), AK_batch_scan(groups, NULL), join_att);
+    batch_rows = AK_batch_count(plan);
+    passed &= plan != NULL && plan->num_attr == 5;
+    AK_batch_operator_free(plan);
+    batch_seconds = AK_batch_seconds(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    iterator = AK_iterator_join(AK_iterator_scan(table, NULL), AK_iterator_scan(groups, NULL), join_att);
+    tuple_rows = AK_batch_test_iterator(iterator, NULL);
+    AK_iterator_free(iterator);
+    tuple_seconds = AK_batch_seconds(&start);
+    printf("Batches: %d rows %.3f s\nPipelined: %d rows %.3f s\n", batch_rows, batch_seconds, tuple_rows, tuple_seconds);
+    passed &= batch_rows == rows && tuple_rows == rows;
+
+    printf("\nQUERY: SELECT grp, COUNT(value), SUM(value), MAX(value), MIN(value), AVG(weight) FROM batch_test GROUP BY grp;\n");
+    AK_agg_input_init(&input);
+    AK_agg_input_add(header[1], AGG_TASK_GROUP, &input);
+    AK_agg_input_add(header[2], AGG_TASK_COUNT, &input);
+    AK_agg_input_add(header[2], AGG_TASK_SUM, &input);
+    AK_agg_input_add(header[2], AGG_TASK_MAX, &input);
+    AK_agg_input_add(header[2], AGG_TASK_MIN, &input);
+    AK_agg_input_add(header[3], AGG_TASK_AVG, &input);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    plan = AK_batch_aggregate(AK_batch_scan(table, NULL), &input);
+    passed &= AK_batch_materialize(plan, "batch_aggregate") == EXIT_SUCCESS;
+    AK_batch_operator_free(plan);
+    batch_seconds = AK_batch_seconds(&start);
+    AK_print_table("batch_aggregate");
+
+    //totals of all groups against a pipelined scan of all rows
+    tuple_sum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    iterator = AK_iterator_project(AK_iterator_scan(table, NULL), att);
+    tuple_rows = AK_batch_test_iterator(iterator, &tuple_sum);
+    AK_iterator_free(iterator);
+    tuple_seconds = AK_batch_seconds(&start);
+    batch_rows = AK_batch_test_totals("batch_aggregate", &batch_count, &batch_total);
+    printf("Batches: %d groups, %d rows (sum %d) %.3f s\nPipelined scan: %d rows (sum %.0f) %.3f s\n",
+            batch_rows, batch_count, batch_total, batch_seconds, tuple_rows, tuple_sum, tuple_seconds);
+    passed &= batch_rows == num_groups && batch_count == rows && tuple_rows == rows && batch_total == tuple_sum;
+
+    //aggregates of one group against the same aggregates computed tuple at a time
+    iterator = AK_iterator_project(AK_iterator_select(AK_iterator_scan(table, NULL), expr_grp), att);
+    AK_iterator_open(iterator);
+    memset(tuple_agg, 0, sizeof (tuple_agg));
+    while (AK_iterator_next(iterator) == ITERATOR_ROW) {
+        memcpy(&value, iterator->value[0].data, sizeof (int));
+        tuple_agg[2] = tuple_agg[0] == 0 || value > tuple_agg[2] ? value : tuple_agg[2];
+        tuple_agg[3] = tuple_agg[0] == 0 || value < tuple_agg[3] ? value : tuple_agg[3];
+        tuple_agg[0]++;
+        tuple_agg[1] += value;
+    }
+    AK_iterator_free(iterator);
+
+    memset(batch_agg, 0, sizeof (batch_agg));
+    plan = AK_batch_select(AK_batch_scan("batch_aggregate", NULL), expr_grp);
+    AK_batch_open(plan);
+    batch = AK_batch_next(plan);
+    for (i = 0; batch != NULL && batch->num_selected == 1 && i < 4; i++) {
+        AK_batch_value(batch, i + 1, batch->selection[0], &result);
+        memcpy(&batch_agg[i], result.data, sizeof (int));
+    }
+    AK_batch_operator_free(plan);
+    printf("group3: count %d, sum %d, max %d, min %d; tuple at a time: count %d, sum %d, max %d, min %d\n",
+            batch_agg[0], batch_agg[1], batch_agg[2], batch_agg[3], tuple_agg[0], tuple_agg[1], tuple_agg[2], tuple_agg[3]);
+    passed &= memcmp(batch_agg, tuple_agg, sizeof (batch_agg)) == 0 && tuple_agg[0] == rows / num_groups;
+
+    plan = AK_batch_project(AK_batch_scan(table, NULL), join_att);
+    passed &= plan != NULL && plan->num_attr == 1;
+    AK_batch_operator_free(plan);
+    passed &= AK_batch_aggregate(AK_batch_scan(groups, NULL), &input) == NULL;
+
+    Ak_DeleteAll_L3(&expr);
+    Ak_DeleteAll_L3(&expr_grp);
+    Ak_DeleteAll_L3(&att);
+    Ak_DeleteAll_L3(&join_att);
+    AK_free(expr);
+    AK_free(expr_grp);
+    AK_free(att);
+    AK_free(join_att);
+    printf("\nTest %s\n", passed ? "SUCCESS" : "FAILED");
+    AK_EPI;
+}
@@ -0,0 +1,135 @@
+/**
+@file batch.h Header file that provides data structures and functions for vectorized (batch at a time) query execution
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef BATCH
+#define BATCH
+
+#include "iterator.h"
+#include "aggregation.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def BATCH_SIZE
+  * @brief Constant declaring maximal number of rows of one batch
+  */
+#define BATCH_SIZE 1024
+
+/**
+ * @struct AK_vector
+ * @brief Structure that holds values of one attribute for all rows of a batch. Values of numeric types are stored in
+          one array of width bytes per row (int for INT, DATE, DATETIME and TIME, float in the first bytes of a
+          double sized value for FLOAT, double for NUMBER), values of other types are pointers with sizes.
+ */
+typedef struct {
+    /// data type of attribute
+    int type;
+    /// size of one value of a numeric type, 0 for values of variable size
+    int width;
+    /// numeric values, width bytes per row
+    char *values;
+    /// variable size values
+    char **data;
+    /// sizes of variable size values
+    int *size;
+    /// offsets of variable size values in arena of the batch while the batch is filled
+    int *offset;
+    /// 1 for rows where value is null (stored as TYPE_VARCHAR "null" in a numeric column)
+    unsigned char *null;
+} AK_vector;
+
+/**
+ * @struct AK_batch
+ * @brief Structure that holds up to BATCH_SIZE rows as one vector per attribute. Rows that take part in the result are
+          listed in the selection vector, so filters only shrink the selection and never move values.
+ */
+typedef struct {
+    /// number of attributes
+    int num_attr;
+    /// vector of every attribute
+    AK_vector column[MAX_ATTRIBUTES];
+    /// number of rows in vectors
+    int num_rows;
+    /// number of selected rows
+    int num_selected;
+    /// indexes of selected rows in ascending order
+    int selection[BATCH_SIZE];
+    /// data of variable size values
+    char *arena;
+    /// used bytes of arena
+    int arena_size;
+    /// allocated bytes of arena
+    int arena_capacity;
+    /// 1 if vectors are allocated by this batch, 0 if they are borrowed from another batch
+    int owner;
+} AK_batch;
+
+typedef struct AK_batch_operator AK_batch_operator;
+
+/**
+ * @struct AK_batch_operator
+ * @brief Structure that defines an operator of a vectorized query plan. It works like AK_iterator, but every call of
+          next produces a batch of rows, so the cost of calling operators and interpreting expressions is paid once
+          per batch instead of once per row.
+ */
+struct AK_batch_operator {
+    /// prepares operator (and its children) for producing batches
+    int (*open)(AK_batch_operator *op);
+    /// produces the next batch with at least one selected row, NULL after the last one
+    AK_batch *(*next)(AK_batch_operator *op);
+    /// releases resources acquired by open
+    void (*close)(AK_batch_operator *op);
+    /// frees state of operator, can be NULL
+    void (*destroy)(AK_batch_operator *op);
+    /// input operators, NULL if operator has less inputs
+    AK_batch_operator *child[2];
+    /// header of produced rows
+    AK_header header[MAX_ATTRIBUTES];
+    /// number of attributes of produced rows
+    int num_attr;
+    /// batch produced by the operator
+    AK_batch batch;
+    /// number of selected rows produced since open
+    int num_rows;
+    /// 1 between open and close
+    int opened;
+    /// state of operator
+    void *state;
+};
+
+void AK_batch_init(AK_batch *batch, AK_header *header, int num_attr);
+void AK_batch_reset(AK_batch *batch);
+void AK_batch_set_value(AK_batch *batch, int column, int row, int type, char *data, int size);
+void AK_batch_finish(AK_batch *batch);
+void AK_batch_value(AK_batch *batch, int column, int row, AK_iterator_value *value);
+void AK_batch_free(AK_batch *batch);
+AK_batch_operator *AK_batch_scan(char *table, struct list_node *expr);
+AK_batch_operator *AK_batch_select(AK_batch_operator *child, struct list_node *expr);
+AK_batch_operator *AK_batch_project(AK_batch_operator *child, struct list_node *att);
+AK_batch_operator *AK_batch_limit(AK_batch_operator *child, int limit);
+AK_batch_operator *AK_batch_aggregate(AK_batch_operator *child, AK_agg_input *input);
+AK_batch_operator *AK_batch_join(AK_batch_operator *left, AK_batch_operator *right, struct list_node *att);
+int AK_batch_open(AK_batch_operator *op);
+AK_batch *AK_batch_next(AK_batch_operator *op);
+void AK_batch_close(AK_batch_operator *op);
+void AK_batch_operator_free(AK_batch_operator *op);
+int AK_batch_count(AK_batch_operator *op);
+int AK_batch_materialize(AK_batch_operator *op, char *table);
+void AK_batch_test();
+
+#endif
@@ -22,8 +22,10 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "set_op.h"
 
 int AK_difference(char *srcTable1, char *srcTable2, char *dstTable);
+int AK_difference_all(char *srcTable1, char *srcTable2, char *dstTable);
 void Ak_op_difference_test();
 
 #endif
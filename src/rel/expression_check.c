@@ -29,6 +29,7 @@
  * @return 0 if arithmetic statement is false, 1 if arithmetic statement is true
  */
 
+#include <math.h>
 #include "expression_check.h"
 
 //int AK_check_arithmetic_statement(AK_list_elem el, const char *op, const char *a, const char *b) {
@@ -359,6 +360,522 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
     return result;
 }
 
+/**
+ * @struct AK_predicate_value
+ * @brief Structure that holds one value on the stack of a compiled predicate
+ */
+typedef struct {
+    /// value data, for non numeric values
+    const char *data;
+    /// size of data
+    int size;
+    /// decoded value, for numeric values and truth values
+    double number;
+    /// 1 if value is null
+    int is_null;
+} AK_predicate_value;
+
+/**
+ * @brief Function checks whether values of a data type are compared and computed as numbers
+ * @param type data type
+ * @return 1 if type is numeric, 0 otherwise
+ */
+static int AK_predicate_numeric(int type) {
+    return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_NUMBER || type == TYPE_DATE
+        || type == TYPE_DATETIME || type == TYPE_TIME;
+}
+
+/**
+ * @brief Function decodes a numeric value stored in a block or an expression
+ * @param type numeric data type
+ * @param data value data
+ * @return decoded value
+ */
+static double AK_predicate_number(int type, const char *data) {
+    int integer;
+    float real;
+    double number;
+
+    switch (type) {
+        case TYPE_FLOAT:
+            memcpy(&real, data, sizeof (float));
+            return real;
+        case TYPE_NUMBER:
+            memcpy(&number, data, sizeof (double));
+            return number;
+        default:
+            memcpy(&integer, data, sizeof (int));
+            return integer;
+    }
+}
+
+/**
+ * @brief Function returns instruction for an operator of postfix expression
+ * @param op operator
+ * @return PREDICATE_* operation code, EXIT_ERROR if operator is not supported
+ */
+static int AK_predicate_operator(const char *op) {
+    AK_PRO;
+    const char *ops[] = {"=", "<>", "<", ">", "<=", ">=", "+", "-", "*", "/", "AND", "OR"};
+    int i;
+
+    for (i = 0; i < sizeof (ops) / sizeof (ops[0]); i++) {
+        if (strcmp(op, ops[i]) == 0) {
+            AK_EPI;
+            return PREDICATE_EQ + i;
+        }
+    }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @brief  Function compiles logical expression in postfix notation into a predicate program. Attribute names are
+           resolved against the table header once, types of all operands are checked, numeric constants are decoded
+           and every comparison gets its comparison mode, so the program can be evaluated on block tuples without
+           building row lists. For joins header is the joined header and columns after the first left_num_attr
+           attributes are read from the right row.
+ * @param expr list with the logical expression in postfix notation
+ * @param header table header
+ * @param num_attr number of attributes in header
+ * @param left_num_attr number of attributes of the left row (num_attr for one table)
+ * @return compiled predicate, NULL if expression can not be compiled (unknown column or operator, wrong operand types)
+ */
+AK_predicate *AK_predicate_compile(struct list_node *expr, AK_header *header, int num_attr, int left_num_attr) {
+    AK_PRO;
+    struct list_node *el;
+    AK_predicate *predicate;
+    AK_predicate_instr *instr;
+    int types[PREDICATE_STACK_SIZE];
+    int depth = 0, constants_size = 0, num_instr = 0, i, a, b;
+
+    if (expr == NULL || header == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+
+    for (el = Ak_First_L2(expr); el; el = el->next) {
+        num_instr++;
+        if (el->type != TYPE_ATTRIBS && el->type != TYPE_OPERATOR)
+            constants_size += el->size;
+    }
+    if (num_instr == 0) {
+        AK_EPI;
+        return NULL;
+    }
+
+    predicate = (AK_predicate *) AK_malloc(sizeof (AK_predicate));
+    predicate->instr = (AK_predicate_instr *) AK_malloc(num_instr * sizeof (AK_predicate_instr));
+    predicate->constants = (char *) AK_malloc(constants_size + 1);
+    predicate->num_instr = 0;
+    constants_size = 0;
+
+    for (el = Ak_First_L2(expr); el; el = el->next) {
+        instr = &predicate->instr[predicate->num_instr++];
+        memset(instr, 0, sizeof (AK_predicate_instr));
+
+        if (el->type == TYPE_ATTRIBS) {
+            for (i = 0; i < num_attr; i++) {
+                if (strcmp(header[i].att_name, el->data) == 0)
+                    break;
+            }
+            if (i == num_attr) {
+                Ak_dbg_messg(MIDDLE, REL_OP, "Predicate compile was not able to find column: %s\n", el->data);
+                break;
+            }
+            instr->op = PREDICATE_COLUMN;
+            instr->type = header[i].type;
+            instr->right = i >= left_num_attr;
+            instr->column = instr->right ? i - left_num_attr : i;
+
+        } else if (el->type == TYPE_OPERATOR) {
+            instr->op = AK_predicate_operator(el->data);
+            if (instr->op == EXIT_ERROR || depth < 2) {
+                Ak_dbg_messg(MIDDLE, REL_OP, "Predicate compile can not compile operator: %s\n", el->data);
+                break;
+            }
+            a = types[depth - 2];
+            b = types[depth - 1];
+            depth -= 2;
+
+            if (instr->op >= PREDICATE_ADD && instr->op <= PREDICATE_DIV) {
+                if (!AK_predicate_numeric(a) || !AK_predicate_numeric(b))
+                    break;
+                instr->type = (a == TYPE_FLOAT || a == TYPE_NUMBER || b == TYPE_FLOAT || b == TYPE_NUMBER) ? TYPE_NUMBER : TYPE_INT;
+            } else if (instr->op == PREDICATE_AND || instr->op == PREDICATE_OR) {
+                if (!AK_predicate_numeric(a) || !AK_predicate_numeric(b))
+                    break;
+                instr->type = TYPE_INT;
+            } else {
+                instr->mode = AK_predicate_numeric(a) && AK_predicate_numeric(b) ? PREDICATE_NUMERIC : PREDICATE_BYTES;
+                instr->type = TYPE_INT;
+            }
+
+        } else {
+            instr->op = PREDICATE_CONSTANT;
+            instr->type = el->type;
+            if (AK_predicate_numeric(el->type)) {
+                instr->number = AK_predicate_number(el->type, el->data);
+            } else {
+                instr->size = el->type == TYPE_VARCHAR ? strnlen(el->data, el->size) : el->size;
+                instr->offset = constants_size;
+                memcpy(predicate->constants + constants_size, el->data, instr->size);
+                constants_size += instr->size;
+            }
+        }
+
+        if (depth == PREDICATE_STACK_SIZE)
+            break;
+        types[depth++] = instr->type;
+    }
+
+    if (el != NULL || depth != 1 || !AK_predicate_numeric(types[0])) {
+        AK_predicate_free(predicate);
+        AK_EPI;
+        return NULL;
+    }
+
+    AK_EPI;
+    return predicate;
+}
+
+/**
+ * @brief  Function evaluates compiled predicate on one row of a block, or on a pair of rows when predicate was compiled
+           for a join. Values are read directly from block data using resolved tuple_dict offsets. Null is stored as
+           varchar "null", so a value of a numeric column stored with another type is null: arithmetic with null gives
+           null and a comparison with null is not satisfied.
+ * @param predicate compiled predicate
+ * @param left block of the (left) row
+ * @param left_slot tuple_dict index of the first attribute of the (left) row
+ * @param right block of the right row, NULL if predicate does not use right row
+ * @param right_slot tuple_dict index of the first attribute of the right row
+ * @return 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_predicate_eval_pair(AK_predicate *predicate, AK_block *left, int left_slot, AK_block *right, int right_slot) {
+    AK_PRO;
+    AK_predicate_value stack[PREDICATE_STACK_SIZE];
+    AK_predicate_value *a, *b;
+    AK_predicate_instr *instr;
+    AK_tuple_dict *entry;
+    AK_block *block;
+    int depth = 0, i, cmp, size;
+
+    for (i = 0; i < predicate->num_instr; i++) {
+        instr = &predicate->instr[i];
+
+        switch (instr->op) {
+            case PREDICATE_COLUMN:
+                block = instr->right ? right : left;
+                entry = &block->tuple_dict[(instr->right ? right_slot : left_slot) + instr->column];
+                a = &stack[depth++];
+                a->data = (const char *) &block->data[entry->address];
+                a->size = entry->size;
+                a->number = 0;
+                a->is_null = AK_predicate_numeric(instr->type) && entry->type != instr->type;
+                if (a->is_null)
+                    break;
+                if (AK_predicate_numeric(instr->type))
+                    a->number = AK_predicate_number(instr->type, a->data);
+                else if (instr->type == TYPE_VARCHAR)
+                    a->size = strnlen(a->data, a->size);
+                break;
+
+            case PREDICATE_CONSTANT:
+                a = &stack[depth++];
+                a->data = predicate->constants + instr->offset;
+                a->size = instr->size;
+                a->number = instr->number;
+                a->is_null = 0;
+                break;
+
+            case PREDICATE_AND:
+            case PREDICATE_OR:
+                b = &stack[--depth];
+                a = &stack[depth - 1];
+                if (instr->op == PREDICATE_AND)
+                    a->number = a->number != 0 && b->number != 0;
+                else
+                    a->number = a->number != 0 || b->number != 0;
+                break;
+
+            case PREDICATE_ADD:
+            case PREDICATE_SUB:
+            case PREDICATE_MUL:
+            case PREDICATE_DIV:
+                b = &stack[--depth];
+                a = &stack[depth - 1];
+                a->is_null |= b->is_null;
+                if (a->is_null)
+                    break;
+                if (instr->op == PREDICATE_ADD)
+                    a->number += b->number;
+                else if (instr->op == PREDICATE_SUB)
+                    a->number -= b->number;
+                else if (instr->op == PREDICATE_MUL)
+                    a->number *= b->number;
+                else if (b->number == 0 || (instr->type == TYPE_INT && (int) b->number == 0))
+                    a->number = 0;
+                else if (instr->type == TYPE_INT)
+                    a->number = (int) a->number / (int) b->number;
+                else
+                    a->number /= b->number;
+                break;
+
+            default:
+                b = &stack[--depth];
+                a = &stack[depth - 1];
+                if (a->is_null || b->is_null) {
+                    a->number = 0;
+                    a->is_null = 0;
+                    break;
+                }
+                if (instr->mode == PREDICATE_NUMERIC) {
+                    cmp = (a->number > b->number) - (a->number < b->number);
+                } else {
+                    size = a->size < b->size ? a->size : b->size;
+                    cmp = memcmp(a->data, b->data, size);
+                    if (cmp == 0)
+                        cmp = a->size - b->size;
+                }
+
+                switch (instr->op) {
+                    case PREDICATE_EQ:
+                        a->number = cmp == 0;
+                        break;
+                    case PREDICATE_NE:
+                        a->number = cmp != 0;
+                        break;
+                    case PREDICATE_LT:
+                        a->number = cmp < 0;
+                        break;
+                    case PREDICATE_GT:
+                        a->number = cmp > 0;
+                        break;
+                    case PREDICATE_LE:
+                        a->number = cmp <= 0;
+                        break;
+                    default:
+                        a->number = cmp >= 0;
+                        break;
+                }
+                break;
+        }
+    }
+
+    AK_EPI;
+    return stack[0].number != 0;
+}
+
+/**
+ * @brief  Function evaluates compiled predicate on one row of a block
+ * @param predicate compiled predicate
+ * @param block block of the row
+ * @param slot tuple_dict index of the first attribute of the row
+ * @return 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_predicate_eval(AK_predicate *predicate, AK_block *block, int slot) {
+    AK_PRO;
+    int result = AK_predicate_eval_pair(predicate, block, slot, NULL, 0);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function derives conditions on column values which every row satisfying the predicate meets, so blocks whose
+           zone maps or Bloom filters rule them out can be skipped. The program is evaluated on conditions instead of
+           values: a numeric comparison of a column with a constant gives a range of that column (strict comparisons
+           are taken as inclusive) and = on a string column gives an equality. AND keeps conditions of both operands,
+           OR joins ranges into the smallest range covering both and keeps an equality only if both operands have it.
+           Everything else (<>, arithmetic, columns of the right row) puts no condition on values.
+ * @param predicate compiled predicate
+ * @param num_attr number of attributes of the (left) row
+ * @param filter scan filter the conditions are added to, equalities point to constants of the predicate
+ * @return number of conditions added
+ */
+int AK_predicate_ranges(AK_predicate *predicate, int num_attr, AK_zone_filter *filter) {
+    AK_PRO;
+    //kind of every stack value: column, constant, condition, or unknown value
+    enum { RANGE_COLUMN, RANGE_CONSTANT, RANGE_CONDITION, RANGE_UNKNOWN } kind[PREDICATE_STACK_SIZE];
+    AK_predicate_instr *source[PREDICATE_STACK_SIZE];
+    //lower and upper bound of every column for every stack value
+    double *bounds = (double *) AK_malloc(PREDICATE_STACK_SIZE * 2 * num_attr * sizeof (double));
+    //constant every column is equal to for every stack value, NULL if there is none
+    AK_predicate_instr **equal = (AK_predicate_instr **) AK_malloc(PREDICATE_STACK_SIZE * num_attr * sizeof (AK_predicate_instr *));
+    double *a, *b;
+    AK_predicate_instr *instr, *column, *constant, **equal_a, **equal_b;
+    int depth = 0, added = 0, i, j, op;
+
+    for (i = 0; i < predicate->num_instr; i++) {
+        instr = &predicate->instr[i];
+
+        if (instr->op == PREDICATE_COLUMN || instr->op == PREDICATE_CONSTANT) {
+            kind[depth] = instr->op == PREDICATE_CONSTANT ? RANGE_CONSTANT : instr->right ? RANGE_UNKNOWN : RANGE_COLUMN;
+            source[depth++] = instr;
+            continue;
+        }
+
+        depth--;
+        a = &bounds[(depth - 1) * 2 * num_attr];
+        b = &bounds[depth * 2 * num_attr];
+        equal_a = &equal[(depth - 1) * num_attr];
+        equal_b = &equal[depth * num_attr];
+
+        if (instr->op == PREDICATE_AND || instr->op == PREDICATE_OR) {
+            //a value which is not a condition is true for some rows and puts no condition on them
+            for (j = 0; j < num_attr; j++) {
+                if (kind[depth - 1] != RANGE_CONDITION) {
+                    a[2 * j] = -HUGE_VAL;
+                    a[2 * j + 1] = HUGE_VAL;
+                    equal_a[j] = NULL;
+                }
+                if (kind[depth] != RANGE_CONDITION) {
+                    b[2 * j] = -HUGE_VAL;
+                    b[2 * j + 1] = HUGE_VAL;
+                    equal_b[j] = NULL;
+                }
+                if (instr->op == PREDICATE_AND) {
+                    a[2 * j] = a[2 * j] > b[2 * j] ? a[2 * j] : b[2 * j];
+                    a[2 * j + 1] = a[2 * j + 1] < b[2 * j + 1] ? a[2 * j + 1] : b[2 * j + 1];
+                    if (equal_a[j] == NULL)
+                        equal_a[j] = equal_b[j];
+                } else {
+                    a[2 * j] = a[2 * j] < b[2 * j] ? a[2 * j] : b[2 * j];
+                    a[2 * j + 1] = a[2 * j + 1] > b[2 * j + 1] ? a[2 * j + 1] : b[2 * j + 1];
+                    if (equal_a[j] != NULL && (equal_b[j] == NULL || equal_a[j]->size != equal_b[j]->size
+                            || memcmp(predicate->constants + equal_a[j]->offset, predicate->constants + equal_b[j]->offset, equal_a[j]->size) != 0))
+                        equal_a[j] = NULL;
+                }
+            }
+            kind[depth - 1] = RANGE_CONDITION;
+            continue;
+        }
+
+        if (instr->op >= PREDICATE_ADD || instr->op == PREDICATE_NE
+                || !((kind[depth - 1] == RANGE_COLUMN && kind[depth] == RANGE_CONSTANT)
+                || (kind[depth - 1] == RANGE_CONSTANT && kind[depth] == RANGE_COLUMN))) {
+            kind[depth - 1] = RANGE_UNKNOWN;
+            continue;
+        }
+
+        //constant on the left side turns the comparison around (5 < a is a > 5)
+        op = instr->op;
+        column = source[kind[depth - 1] == RANGE_COLUMN ? depth - 1 : depth];
+        constant = source[kind[depth - 1] == RANGE_COLUMN ? depth : depth - 1];
+        if (kind[depth - 1] == RANGE_CONSTANT) {
+            if (op == PREDICATE_LT || op == PREDICATE_LE)
+                op = PREDICATE_GT;
+            else if (op == PREDICATE_GT || op == PREDICATE_GE)
+                op = PREDICATE_LT;
+        }
+        for (j = 0; j < num_attr; j++) {
+            a[2 * j] = -HUGE_VAL;
+            a[2 * j + 1] = HUGE_VAL;
+            equal_a[j] = NULL;
+        }
+        kind[depth - 1] = RANGE_CONDITION;
+
+        if (instr->mode == PREDICATE_NUMERIC) {
+            if (op != PREDICATE_LT && op != PREDICATE_LE)
+                a[2 * column->column] = constant->number;
+            if (op != PREDICATE_GT && op != PREDICATE_GE)
+                a[2 * column->column + 1] = constant->number;
+        } else if (op == PREDICATE_EQ && !AK_predicate_numeric(column->type) && !AK_predicate_numeric(constant->type)) {
+            equal_a[column->column] = constant;
+        }
+    }
+
+    for (j = 0; depth == 1 && kind[0] == RANGE_CONDITION && j < num_attr; j++) {
+        if (bounds[2 * j] != -HUGE_VAL || bounds[2 * j + 1] != HUGE_VAL) {
+            filter->range_column[filter->num_ranges] = j;
+            filter->lower[filter->num_ranges] = bounds[2 * j];
+            filter->upper[filter->num_ranges] = bounds[2 * j + 1];
+            filter->num_ranges++;
+            added++;
+        }
+        if (equal[j] != NULL) {
+            filter->value_column[filter->num_values] = j;
+            filter->value[filter->num_values] = predicate->constants + equal[j]->offset;
+            filter->value_size[filter->num_values] = equal[j]->size;
+            filter->num_values++;
+            added++;
+        }
+    }
+
+    AK_free(equal);
+    AK_free(bounds);
+    AK_EPI;
+    return added;
+}
+
+/**
+ * @brief  Function frees compiled predicate
+ * @param predicate compiled predicate, can be NULL
+ * @return No return value
+ */
+void AK_predicate_free(AK_predicate *predicate) {
+    AK_PRO;
+    if (predicate != NULL) {
+        AK_free(predicate->instr);
+        AK_free(predicate->constants);
+        AK_free(predicate);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function counts rows of a table which satisfy expression, using compiled predicate and row list interpreter
+ * @param table table name
+ * @param expr list with the logical expression in postfix notation
+ * @param compiled pointer to number of rows satisfying compiled predicate, -1 if expression was not compiled
+ * @param interpreted pointer to number of rows satisfying expression interpreted on row lists
+ * @return No return value
+ */
+static void AK_expression_check_count(char *table, struct list_node *expr, int *compiled, int *interpreted) {
+    AK_PRO;
+    AK_header *header = (AK_header *) AK_get_header(table);
+    int num_attr = AK_num_attr(table);
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(table);
+    AK_predicate *predicate = AK_predicate_compile(expr, header, num_attr, num_attr);
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_block *block;
+    char data[MAX_VARCHAR_LENGTH];
+    int i, j, k, l;
+
+    Ak_Init_L3(&row_root);
+    *compiled = predicate == NULL ? -1 : 0;
+    *interpreted = 0;
+
+    for (i = 0; addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            block = ((AK_mem_block *) AK_get_block(j))->block;
+            for (k = 0; k < DATA_BLOCK_SIZE && block->tuple_dict[k].type != FREE_INT; k += num_attr) {
+                if (block->tuple_dict[k].type == 0)
+                    continue;
+                if (predicate != NULL)
+                    *compiled += AK_predicate_eval(predicate, block, k);
+
+                for (l = 0; l < num_attr; l++) {
+                    memcpy(data, &block->data[block->tuple_dict[k + l].address], block->tuple_dict[k + l].size);
+                    data[block->tuple_dict[k + l].size] = '\0';
+                    Ak_Insert_New_Element(block->tuple_dict[k + l].type, data, table, header[l].att_name, row_root);
+                }
+                *interpreted += AK_check_if_row_satisfies_expression(row_root, expr) != 0;
+                Ak_DeleteAll_L3(&row_root);
+            }
+        }
+    }
+
+    AK_predicate_free(predicate);
+    AK_free(row_root);
+    AK_free(addresses);
+    AK_free(header);
+    AK_EPI;
+}
+
+/**
+ * @brief  Function for testing of expression checking and compiled predicates on table student
+ * @return No return value
+ */
 void Ak_expression_check_test()
 {
     AK_PRO;
@@ -372,8 +889,108 @@ void Ak_expression_check_test()
 
     outcome = AK_check_arithmetic_statement(elem, op, a, b);
 
-    printf("The outcome is: %d", outcome);
+    printf("The outcome is: %d\n", outcome);
 
     AK_free(elem);
+
+    struct list_node *expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    int year = 2010, compiled, interpreted, passed = 1;
+    float weight = 95.0;
+
+    Ak_Init_L3(&expr);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof (int), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
+    Ak_InsertAtEnd_L3(TYPE_VARCHAR, "Robert", sizeof ("Robert"), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    AK_expression_check_count("student", expr, &compiled, &interpreted);
+    printf("year > 2010 AND firstname = 'Robert': compiled %d, interpreted %d\n", compiled, interpreted);
+    passed &= compiled == interpreted && compiled == 1;
+
+    //scans skip blocks by year range and by Bloom filter of firstname
+    AK_header *header = (AK_header *) AK_get_header("student");
+    int num_attr = AK_num_attr("student");
+    AK_predicate *predicate = AK_predicate_compile(expr, header, num_attr, num_attr);
+    AK_zone_filter filter;
+    AK_zone_filter_init(&filter);
+    AK_predicate_ranges(predicate, num_attr, &filter);
+    printf("Scan conditions: %d ranges, %d values\n", filter.num_ranges, filter.num_values);
+    passed &= filter.num_ranges == 1 && filter.lower[0] == year && filter.num_values == 1
+            && filter.value_size[0] == strlen("Robert") && memcmp(filter.value[0], "Robert", strlen("Robert")) == 0;
+    AK_predicate_free(predicate);
+    AK_free(header);
+    Ak_DeleteAll_L3(&expr);
+
+    //interpreter compares only first bytes of strings, 'Ivan' rows satisfy it as well
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
+    Ak_InsertAtEnd_L3(TYPE_VARCHAR, "Ivana", sizeof ("Ivana"), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_expression_check_count("student", expr, &compiled, &interpreted);
+    printf("firstname = 'Ivana': compiled %d, interpreted %d\n", compiled, interpreted);
+    passed &= compiled == 1;
+    Ak_DeleteAll_L3(&expr);
+
+    //operands of OR are not the two last results
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
+    Ak_InsertAtEnd_L3(TYPE_VARCHAR, "Dino", sizeof ("Dino"), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof (int), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "weight", sizeof ("weight"), expr);
+    Ak_InsertAtEnd_L3(TYPE_FLOAT, (char *) &weight, sizeof (float), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof ("OR"), expr);
+    AK_expression_check_count("student", expr, &compiled, &interpreted);
+    printf("firstname = 'Dino' OR (year > 2010 AND weight < 95.0): compiled %d, interpreted %d\n", compiled, interpreted);
+    passed &= compiled == 9;
+    Ak_DeleteAll_L3(&expr);
+
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "no_such_column", sizeof ("no_such_column"), expr);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof (int), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    AK_expression_check_count("student", expr, &compiled, &interpreted);
+    printf("no_such_column > 2010: compiled %d, interpreted %d\n", compiled, interpreted);
+    passed &= compiled == -1 && interpreted == 0;
+    Ak_DeleteAll_L3(&expr);
+
+    //value of the second row is null, it satisfies no comparison
+    AK_header null_header[MAX_ATTRIBUTES], *temp;
+    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    int id, value = 5, zero = 0;
+
+    memset(null_header, 0, sizeof (null_header));
+    temp = (AK_header *) AK_create_header("id", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(null_header, temp, sizeof (AK_header));
+    AK_free(temp);
+    temp = (AK_header *) AK_create_header("value", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(null_header + 1, temp, sizeof (AK_header));
+    AK_free(temp);
+    AK_initialize_new_segment("expression_null", SEGMENT_TYPE_TABLE, null_header);
+    Ak_Init_L3(&row);
+    for (id = 1; id <= 2; id++) {
+        Ak_Insert_New_Element(TYPE_INT, &id, "expression_null", "id", row);
+        if (id == 1)
+            Ak_Insert_New_Element(TYPE_INT, &value, "expression_null", "value", row);
+        Ak_insert_row(row);
+        Ak_DeleteAll_L3(&row);
+    }
+    AK_free(row);
+
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "value", sizeof ("value"), expr);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, "+", sizeof ("+"), expr);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &zero, sizeof (int), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    AK_expression_check_count("expression_null", expr, &compiled, &interpreted);
+    printf("value + id > 0 with null value: compiled %d, interpreted %d\n", compiled, interpreted);
+    passed &= compiled == 1;
+    Ak_DeleteAll_L3(&expr);
+    AK_free(expr);
+
+    printf("\nTest %s\n", passed ? "SUCCESS" : "FAILED");
     AK_EPI;
 }
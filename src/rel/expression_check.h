@@ -22,14 +22,110 @@
 
 #include "../file/table.h"
 #include "../file/fileio.h"
+#include "../file/zonemap.h"
 #include "../auxi/mempro.h"
 /*
 int AK_check_arithmetic_statement(AK_list_elem el, const char *op, const char *a, const char *b);
 int AK_check_if_row_satisfies_expression(AK_list_elem row_root, AK_list *expr);
 */
 
+/**
+  * @def PREDICATE_STACK_SIZE
+  * @brief Constant declaring maximal depth of the value stack of a compiled predicate
+  */
+#define PREDICATE_STACK_SIZE 32
+
+/**
+  * @def PREDICATE_COLUMN
+  * @brief Instruction which pushes value of a column of the evaluated row
+  */
+#define PREDICATE_COLUMN 0
+
+/**
+  * @def PREDICATE_CONSTANT
+  * @brief Instruction which pushes a constant from the expression
+  */
+#define PREDICATE_CONSTANT 1
+
+/**
+  * @def PREDICATE_EQ
+  * @brief Instructions which compare two top values of the stack and push 1 or 0
+  */
+#define PREDICATE_EQ 2
+#define PREDICATE_NE 3
+#define PREDICATE_LT 4
+#define PREDICATE_GT 5
+#define PREDICATE_LE 6
+#define PREDICATE_GE 7
+
+/**
+  * @def PREDICATE_ADD
+  * @brief Instructions which compute arithmetic operation on two top values of the stack
+  */
+#define PREDICATE_ADD 8
+#define PREDICATE_SUB 9
+#define PREDICATE_MUL 10
+#define PREDICATE_DIV 11
+
+/**
+  * @def PREDICATE_AND
+  * @brief Instructions which combine two top truth values of the stack
+  */
+#define PREDICATE_AND 12
+#define PREDICATE_OR 13
+
+/**
+  * @def PREDICATE_NUMERIC
+  * @brief Comparison modes resolved at compile time: decoded numeric values or bytes (strings are compared as bytes)
+  */
+#define PREDICATE_NUMERIC 0
+#define PREDICATE_BYTES 1
+
+/**
+ * @struct AK_predicate_instr
+ * @brief Structure that defines one instruction of a compiled predicate
+ */
+typedef struct {
+    /// PREDICATE_* operation code
+    int op;
+    /// data type of the value the instruction pushes
+    int type;
+    /// PREDICATE_NUMERIC or PREDICATE_BYTES for comparisons
+    int mode;
+    /// column index in the left row, or in the right row if right is set
+    int column;
+    /// 1 if column is read from the right row of a join
+    int right;
+    /// offset of constant in AK_predicate->constants
+    int offset;
+    /// size of constant
+    int size;
+    /// value of numeric constant
+    double number;
+} AK_predicate_instr;
+
+/**
+ * @struct AK_predicate
+ * @brief Structure that defines a predicate compiled from postfix expression and table header. Column names are
+          resolved to tuple_dict offsets and constants are decoded once, so evaluation works directly on block tuples.
+ */
+typedef struct {
+    /// number of instructions
+    int num_instr;
+    /// instructions
+    AK_predicate_instr *instr;
+    /// data of non numeric constants
+    char *constants;
+} AK_predicate;
+
 int AK_check_arithmetic_statement(struct list_node *el, const char *op, const char *a, const char *b);
 int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list_node *expr);
+AK_predicate *AK_predicate_compile(struct list_node *expr, AK_header *header, int num_attr, int left_num_attr);
+int AK_predicate_eval_pair(AK_predicate *predicate, AK_block *left, int left_slot, AK_block *right, int right_slot);
+int AK_predicate_eval(AK_predicate *predicate, AK_block *block, int slot);
+int AK_predicate_ranges(AK_predicate *predicate, int num_attr, AK_zone_filter *filter);
+void AK_predicate_free(AK_predicate *predicate);
+void Ak_expression_check_test();
 
 
 #endif /* CONSTRAINT_CHECKER_H_ */
@@ -23,6 +23,7 @@
 #include "../file/fileio.h"
 #include "../rec/archive_log.h"
 #include "../auxi/mempro.h"
+#include "set_op.h"
 
 /**
  * @author Dino Laktašić
@@ -37,6 +38,7 @@ typedef struct {
 } intersect_attr;
 
 int AK_intersect(char *srcTable1, char *srcTable2, char *dstTable);
+int AK_intersect_all(char *srcTable1, char *srcTable2, char *dstTable);
 void Ak_op_intersect_test();
 
 #endif
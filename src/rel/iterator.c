@@ -0,0 +1,1111 @@
+/**
+@file iterator.c Provides functions for pipelined (iterator) query execution
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "iterator.h"
+#include "selection.h"
+#include "projection.h"
+#include "nat_join.h"
+#include "union.h"
+
+/**
+ * @struct AK_iterator_scan_state
+ * @brief Structure that holds state of a table scan
+ */
+typedef struct {
+    /// table name
+    char table[MAX_ATT_NAME];
+    /// expression rows have to satisfy, can be NULL
+    struct list_node *expr;
+    /// compiled expression, NULL if there is no expression or it could not be compiled
+    AK_predicate *predicate;
+    /// conditions checked against zone map
+    AK_zone_filter filter;
+    /// zone map of the table, pinned from open to close (see AK_zone_map_open)
+    AK_zone_map *map;
+    /// extents of the table
+    table_addresses *addresses;
+    /// index of the current extent
+    int extent;
+    /// address of the current block
+    int address;
+    /// tuple_dict index of the next row in the current block
+    int slot;
+    /// copy of the current block, values of produced rows point into it
+    AK_block *block;
+    /// 1 if block holds the current block
+    int loaded;
+    /// list for rows checked by AK_check_if_row_satisfies_expression when expression could not be compiled
+    struct list_node *row_root;
+} AK_iterator_scan_state;
+
+/**
+ * @struct AK_iterator_select_state
+ * @brief Structure that holds state of a selection over any input
+ */
+typedef struct {
+    /// expression rows have to satisfy
+    struct list_node *expr;
+    /// compiled expression, NULL if it could not be compiled
+    AK_predicate *predicate;
+    /// block the current row is copied to for AK_predicate_eval
+    AK_block *block;
+    /// list for rows checked by AK_check_if_row_satisfies_expression when expression could not be compiled
+    struct list_node *row_root;
+} AK_iterator_select_state;
+
+/**
+ * @struct AK_iterator_project_state
+ * @brief Structure that holds state of a projection
+ */
+typedef struct {
+    /// input attribute of every produced attribute
+    int columns[MAX_ATTRIBUTES];
+} AK_iterator_project_state;
+
+/**
+ * @struct AK_iterator_join_state
+ * @brief Structure that holds state of a natural join. Rows of the right input are materialized in memory by open,
+          rows of the left input are pipelined.
+ */
+typedef struct {
+    /// number of join attributes
+    int num_join;
+    /// left input attribute of every join attribute
+    int left_join[MAX_ATTRIBUTES];
+    /// right input attribute of every join attribute
+    int right_join[MAX_ATTRIBUTES];
+    /// 1 if produced attribute comes from the right input
+    int right[MAX_ATTRIBUTES];
+    /// input attribute of every produced attribute
+    int columns[MAX_ATTRIBUTES];
+    /// rows of the right input
+    AK_iterator_buffer rows;
+    /// current right row
+    AK_iterator_value right_value[MAX_ATTRIBUTES];
+    /// next right row compared with the current left row
+    int right_row;
+    /// 1 if the left input has a current row
+    int left_valid;
+} AK_iterator_join_state;
+
+/**
+ * @struct AK_iterator_union_state
+ * @brief Structure that holds state of a union
+ */
+typedef struct {
+    /// input that produces rows
+    int current;
+} AK_iterator_union_state;
+
+/**
+ * @struct AK_iterator_limit_state
+ * @brief Structure that holds state of a limit
+ */
+typedef struct {
+    /// maximal number of produced rows
+    int limit;
+} AK_iterator_limit_state;
+
+/**
+ * @brief Function allocates an operator
+ * @param state_size size of state of the operator
+ * @return operator
+ */
+static AK_iterator *AK_iterator_new(size_t state_size) {
+    AK_iterator *iterator = (AK_iterator *) AK_calloc(1, sizeof (AK_iterator));
+
+    iterator->state = AK_calloc(1, state_size);
+    return iterator;
+}
+
+/**
+ * @brief Function initializes a buffer of rows
+ * @param buffer buffer
+ * @param num_attr number of values of every row
+ * @return No return value
+ */
+void AK_iterator_buffer_init(AK_iterator_buffer *buffer, int num_attr) {
+    AK_PRO;
+    memset(buffer, 0, sizeof (AK_iterator_buffer));
+    buffer->num_attr = num_attr;
+    AK_EPI;
+}
+
+/**
+ * @brief Function copies a row into a buffer
+ * @param buffer buffer
+ * @param value values of the row
+ * @return No return value
+ */
+void AK_iterator_buffer_add(AK_iterator_buffer *buffer, AK_iterator_value *value) {
+    int i, size = 0, *entry;
+
+    for (i = 0; i < buffer->num_attr; i++)
+        size += value[i].size;
+    if (buffer->num_rows == buffer->capacity_rows) {
+        buffer->capacity_rows = buffer->capacity_rows ? 2 * buffer->capacity_rows : 64;
+        buffer->entries = (int *) AK_realloc(buffer->entries, buffer->capacity_rows * buffer->num_attr * 3 * sizeof (int));
+    }
+    if (buffer->size + size > buffer->capacity) {
+        buffer->capacity = buffer->size + size > 2 * buffer->capacity ? buffer->size + size : 2 * buffer->capacity;
+        buffer->data = (char *) AK_realloc(buffer->data, buffer->capacity);
+    }
+
+    entry = buffer->entries + buffer->num_rows * buffer->num_attr * 3;
+    for (i = 0; i < buffer->num_attr; i++, entry += 3) {
+        entry[0] = value[i].type;
+        entry[1] = value[i].size;
+        entry[2] = buffer->size;
+        memcpy(buffer->data + buffer->size, value[i].data, value[i].size);
+        buffer->size += value[i].size;
+    }
+    buffer->num_rows++;
+}
+
+/**
+ * @brief Function gets a row of a buffer, values point into the buffer until the next row is added
+ * @param buffer buffer
+ * @param row index of the row
+ * @param value values of the row
+ * @return No return value
+ */
+void AK_iterator_buffer_get(AK_iterator_buffer *buffer, int row, AK_iterator_value *value) {
+    int i, *entry = buffer->entries + row * buffer->num_attr * 3;
+
+    for (i = 0; i < buffer->num_attr; i++, entry += 3) {
+        value[i].type = entry[0];
+        value[i].size = entry[1];
+        value[i].data = buffer->data + entry[2];
+    }
+}
+
+/**
+ * @brief Function frees rows of a buffer
+ * @param buffer buffer
+ * @return No return value
+ */
+void AK_iterator_buffer_free(AK_iterator_buffer *buffer) {
+    AK_PRO;
+    AK_free(buffer->entries);
+    AK_free(buffer->data);
+    AK_iterator_buffer_init(buffer, buffer->num_attr);
+    AK_EPI;
+}
+
+/**
+ * @brief Function puts the current row of an operator into a list, ready for Ak_insert_row or
+          AK_check_if_row_satisfies_expression
+ * @param iterator operator
+ * @param table table name written to list elements
+ * @param row_root empty list the row is put into
+ * @return No return value
+ */
+void AK_iterator_row_list(AK_iterator *iterator, char *table, struct list_node *row_root) {
+    AK_PRO;
+    char data[MAX_VARCHAR_LENGTH];
+    int i, size;
+
+    for (i = 0; i < iterator->num_attr; i++) {
+        size = iterator->value[i].size < MAX_VARCHAR_LENGTH ? iterator->value[i].size : MAX_VARCHAR_LENGTH - 1;
+        memcpy(data, iterator->value[i].data, size);
+        data[size] = '\0';
+        Ak_Insert_New_Element(iterator->value[i].type, data, table, iterator->header[i].att_name, row_root);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function checks the current row of an operator with an expression which could not be compiled
+ * @param iterator operator
+ * @param expr expression
+ * @param row_root empty list used for the check
+ * @return 1 if row satisfies expression, 0 otherwise
+ */
+static int AK_iterator_check_row(AK_iterator *iterator, struct list_node *expr, struct list_node *row_root) {
+    int result;
+
+    AK_iterator_row_list(iterator, expr->table, row_root);
+    result = AK_check_if_row_satisfies_expression(row_root, expr);
+    Ak_DeleteAll_L3(&row_root);
+    return result;
+}
+
+/**
+ * @brief Function opens a table scan
+ * @param iterator scan
+ * @return EXIT_SUCCESS, EXIT_ERROR if table does not exist
+ */
+static int AK_iterator_scan_open(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_scan_state *scan = (AK_iterator_scan_state *) iterator->state;
+
+    scan->addresses = (table_addresses *) AK_get_table_addresses(scan->table);
+    if (scan->addresses->address_from[0] == 0) {
+        printf("AK_iterator_scan_open: ERROR. Table %s does not exist.\n", scan->table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    scan->map = AK_zone_map_open(scan->table);
+    scan->extent = 0;
+    scan->address = scan->addresses->address_from[0] - 1;
+    scan->loaded = 0;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function copies the next block of a table scan which zone map does not rule out
+ * @param scan state of the scan
+ * @return ITERATOR_ROW if a block was copied, ITERATOR_END after the last block
+ */
+static int AK_iterator_scan_block(AK_iterator_scan_state *scan) {
+    AK_mem_block *mem_block;
+
+    for (;;) {
+        scan->address++;
+        if (scan->address >= scan->addresses->address_to[scan->extent]) {
+            scan->extent++;
+            if (scan->extent >= MAX_EXTENTS_IN_SEGMENT || scan->addresses->address_from[scan->extent] == 0) {
+                scan->loaded = 0;
+                return ITERATOR_END;
+            }
+            scan->address = scan->addresses->address_from[scan->extent];
+        }
+        if (AK_zone_map_check(scan->map, scan->address, &scan->filter) != ZONE_MAP_READ)
+            continue;
+
+        //block is copied, other operators can push it out of the cache while its rows are used
+        mem_block = (AK_mem_block *) AK_get_block(scan->address);
+        memcpy(scan->block, mem_block->block, sizeof (AK_block));
+        AK_zone_map_refresh(scan->map, scan->block);
+        scan->slot = 0;
+        scan->loaded = 1;
+        return ITERATOR_ROW;
+    }
+}
+
+/**
+ * @brief Function produces the next row of a table scan which satisfies its expression
+ * @param iterator scan
+ * @return ITERATOR_ROW or ITERATOR_END
+ */
+static int AK_iterator_scan_next(AK_iterator *iterator) {
+    AK_iterator_scan_state *scan = (AK_iterator_scan_state *) iterator->state;
+    AK_tuple_dict *entry;
+    int i, slot;
+
+    for (;;) {
+        if (!scan->loaded || scan->slot + iterator->num_attr > DATA_BLOCK_SIZE
+                || scan->block->tuple_dict[scan->slot].type == FREE_INT) {
+            if (AK_iterator_scan_block(scan) == ITERATOR_END)
+                return ITERATOR_END;
+            continue;
+        }
+
+        slot = scan->slot;
+        scan->slot += iterator->num_attr;
+        if (scan->block->tuple_dict[slot].type == 0)
+            continue;
+        if (scan->predicate != NULL && !AK_predicate_eval(scan->predicate, scan->block, slot))
+            continue;
+
+        for (i = 0; i < iterator->num_attr; i++) {
+            entry = &scan->block->tuple_dict[slot + i];
+            iterator->value[i].type = entry->type;
+            iterator->value[i].size = entry->size;
+            iterator->value[i].data = (char *) scan->block->data + entry->address;
+        }
+        if (scan->predicate == NULL && scan->expr != NULL && !AK_iterator_check_row(iterator, scan->expr, scan->row_root))
+            continue;
+        return ITERATOR_ROW;
+    }
+}
+
+/**
+ * @brief Function closes a table scan
+ * @param iterator scan
+ * @return No return value
+ */
+static void AK_iterator_scan_close(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_scan_state *scan = (AK_iterator_scan_state *) iterator->state;
+
+    AK_free(scan->addresses);
+    scan->addresses = NULL;
+    AK_zone_map_close(scan->map);
+    scan->map = NULL;
+    scan->loaded = 0;
+    AK_EPI;
+}
+
+/**
+ * @brief Function frees state of a table scan
+ * @param iterator scan
+ * @return No return value
+ */
+static void AK_iterator_scan_destroy(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_scan_state *scan = (AK_iterator_scan_state *) iterator->state;
+
+    AK_predicate_free(scan->predicate);
+    AK_free(scan->block);
+    AK_free(scan->row_root);
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a table scan. Rows which do not satisfy expression are filtered in the scan itself with
+          compiled expression, and blocks whose zone maps rule the expression out are not read.
+ * @param table table name
+ * @param expr list with postfix notation of the logical expression, NULL for all rows
+ * @return scan, NULL if table does not exist
+ */
+AK_iterator *AK_iterator_scan(char *table, struct list_node *expr) {
+    AK_PRO;
+    AK_iterator *iterator;
+    AK_iterator_scan_state *scan;
+    AK_header *header = (AK_header *) AK_get_header(table);
+    int num_attr = AK_num_attr(table);
+
+    if (header == NULL || num_attr <= 0) {
+        printf("AK_iterator_scan: ERROR. Table %s does not exist.\n", table);
+        AK_free(header);
+        AK_EPI;
+        return NULL;
+    }
+
+    iterator = AK_iterator_new(sizeof (AK_iterator_scan_state));
+    iterator->open = AK_iterator_scan_open;
+    iterator->next = AK_iterator_scan_next;
+    iterator->close = AK_iterator_scan_close;
+    iterator->destroy = AK_iterator_scan_destroy;
+    iterator->num_attr = num_attr < MAX_ATTRIBUTES ? num_attr : MAX_ATTRIBUTES;
+    memcpy(iterator->header, header, iterator->num_attr * sizeof (AK_header));
+    AK_free(header);
+
+    scan = (AK_iterator_scan_state *) iterator->state;
+    strncpy(scan->table, table, MAX_ATT_NAME - 1);
+    scan->expr = expr;
+    scan->predicate = expr != NULL ? AK_predicate_compile(expr, iterator->header, iterator->num_attr, iterator->num_attr) : NULL;
+    AK_zone_filter_init(&scan->filter);
+    if (scan->predicate != NULL)
+        AK_predicate_ranges(scan->predicate, iterator->num_attr, &scan->filter);
+    scan->block = (AK_block *) AK_malloc(sizeof (AK_block));
+    scan->row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&scan->row_root);
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function opens a selection
+ * @param iterator selection
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_select_open(AK_iterator *iterator) {
+    AK_PRO;
+    int result = AK_iterator_open(iterator->child[0]);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function produces the next row of input which satisfies expression of a selection. Values of the row are
+          copied into a block, so compiled expression is evaluated the same way as in a table scan.
+ * @param iterator selection
+ * @return ITERATOR_ROW or ITERATOR_END
+ */
+static int AK_iterator_select_next(AK_iterator *iterator) {
+    AK_iterator_select_state *select = (AK_iterator_select_state *) iterator->state;
+    AK_iterator *child = iterator->child[0];
+    int i, address;
+
+    while (AK_iterator_next(child) == ITERATOR_ROW) {
+        memcpy(iterator->value, child->value, child->num_attr * sizeof (AK_iterator_value));
+
+        if (select->predicate == NULL) {
+            if (AK_iterator_check_row(iterator, select->expr, select->row_root))
+                return ITERATOR_ROW;
+            continue;
+        }
+
+        for (i = address = 0; i < iterator->num_attr; i++) {
+            select->block->tuple_dict[i].type = child->value[i].type;
+            select->block->tuple_dict[i].size = child->value[i].size;
+            select->block->tuple_dict[i].address = address;
+            memcpy(select->block->data + address, child->value[i].data, child->value[i].size);
+            address += child->value[i].size;
+        }
+        if (AK_predicate_eval(select->predicate, select->block, 0))
+            return ITERATOR_ROW;
+    }
+    return ITERATOR_END;
+}
+
+/**
+ * @brief Function closes a selection
+ * @param iterator selection
+ * @return No return value
+ */
+static void AK_iterator_select_close(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_close(iterator->child[0]);
+    AK_EPI;
+}
+
+/**
+ * @brief Function frees state of a selection
+ * @param iterator selection
+ * @return No return value
+ */
+static void AK_iterator_select_destroy(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_select_state *select = (AK_iterator_select_state *) iterator->state;
+
+    AK_predicate_free(select->predicate);
+    AK_free(select->block);
+    AK_free(select->row_root);
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a selection over rows of any operator. Expression on a table is better given to
+          AK_iterator_scan, which filters rows without copying them.
+ * @param child input operator
+ * @param expr list with postfix notation of the logical expression
+ * @return selection, NULL if input is NULL
+ */
+AK_iterator *AK_iterator_select(AK_iterator *child, struct list_node *expr) {
+    AK_PRO;
+    AK_iterator *iterator;
+    AK_iterator_select_state *select;
+
+    if (child == NULL || expr == NULL) {
+        AK_EPI;
+        return child;
+    }
+
+    iterator = AK_iterator_new(sizeof (AK_iterator_select_state));
+    iterator->open = AK_iterator_select_open;
+    iterator->next = AK_iterator_select_next;
+    iterator->close = AK_iterator_select_close;
+    iterator->destroy = AK_iterator_select_destroy;
+    iterator->child[0] = child;
+    iterator->num_attr = child->num_attr;
+    memcpy(iterator->header, child->header, sizeof (iterator->header));
+
+    select = (AK_iterator_select_state *) iterator->state;
+    select->expr = expr;
+    select->predicate = AK_predicate_compile(expr, iterator->header, iterator->num_attr, iterator->num_attr);
+    select->block = (AK_block *) AK_calloc(1, sizeof (AK_block));
+    select->row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&select->row_root);
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function opens a projection
+ * @param iterator projection
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_project_open(AK_iterator *iterator) {
+    AK_PRO;
+    int result = AK_iterator_open(iterator->child[0]);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function produces the next row of a projection, values are not copied
+ * @param iterator projection
+ * @return ITERATOR_ROW or ITERATOR_END
+ */
+static int AK_iterator_project_next(AK_iterator *iterator) {
+    AK_iterator_project_state *project = (AK_iterator_project_state *) iterator->state;
+    int i;
+
+    if (AK_iterator_next(iterator->child[0]) == ITERATOR_END)
+        return ITERATOR_END;
+    for (i = 0; i < iterator->num_attr; i++)
+        iterator->value[i] = iterator->child[0]->value[project->columns[i]];
+    return ITERATOR_ROW;
+}
+
+/**
+ * @brief Function closes a projection
+ * @param iterator projection
+ * @return No return value
+ */
+static void AK_iterator_project_close(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_close(iterator->child[0]);
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a projection, attributes are produced in the order of the list
+ * @param child input operator
+ * @param att list of attributes
+ * @return projection, NULL if input is NULL or an attribute does not exist (input is freed)
+ */
+AK_iterator *AK_iterator_project(AK_iterator *child, struct list_node *att) {
+    AK_PRO;
+    AK_iterator *iterator;
+    AK_iterator_project_state *project;
+    struct list_node *list_elem;
+    int i;
+
+    if (child == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+
+    iterator = AK_iterator_new(sizeof (AK_iterator_project_state));
+    iterator->open = AK_iterator_project_open;
+    iterator->next = AK_iterator_project_next;
+    iterator->close = AK_iterator_project_close;
+    iterator->child[0] = child;
+    project = (AK_iterator_project_state *) iterator->state;
+
+    for (list_elem = Ak_First_L2(att); list_elem != NULL && iterator->num_attr < MAX_ATTRIBUTES; list_elem = list_elem->next) {
+        for (i = 0; i < child->num_attr && strcmp(child->header[i].att_name, list_elem->data) != 0; i++)
+            ;
+        if (i == child->num_attr) {
+            printf("AK_iterator_project: ERROR. Attribute %s does not exist.\n", list_elem->data);
+            AK_iterator_free(iterator);
+            AK_EPI;
+            return NULL;
+        }
+        project->columns[iterator->num_attr] = i;
+        memcpy(&iterator->header[iterator->num_attr], &child->header[i], sizeof (AK_header));
+        iterator->num_attr++;
+    }
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function opens a natural join and materializes rows of its right input
+ * @param iterator join
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_join_open(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_join_state *join = (AK_iterator_join_state *) iterator->state;
+    AK_iterator *right = iterator->child[1];
+
+    if (AK_iterator_open(iterator->child[0]) == EXIT_ERROR || AK_iterator_open(right) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_iterator_buffer_init(&join->rows, right->num_attr);
+    while (AK_iterator_next(right) == ITERATOR_ROW)
+        AK_iterator_buffer_add(&join->rows, right->value);
+    AK_iterator_close(right);
+    join->left_valid = 0;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function produces the next pair of left and right rows which are equal on all join attributes
+ * @param iterator join
+ * @return ITERATOR_ROW or ITERATOR_END
+ */
+static int AK_iterator_join_next(AK_iterator *iterator) {
+    AK_iterator_join_state *join = (AK_iterator_join_state *) iterator->state;
+    AK_iterator *left = iterator->child[0];
+    AK_iterator_value *a, *b;
+    int i;
+
+    for (;;) {
+        if (!join->left_valid) {
+            if (AK_iterator_next(left) == ITERATOR_END)
+                return ITERATOR_END;
+            join->left_valid = 1;
+            join->right_row = 0;
+        }
+
+        while (join->right_row < join->rows.num_rows) {
+            AK_iterator_buffer_get(&join->rows, join->right_row++, join->right_value);
+            for (i = 0; i < join->num_join; i++) {
+                a = &left->value[join->left_join[i]];
+                b = &join->right_value[join->right_join[i]];
+                if (a->size != b->size || memcmp(a->data, b->data, a->size) != 0)
+                    break;
+            }
+            if (i < join->num_join)
+                continue;
+
+            for (i = 0; i < iterator->num_attr; i++)
+                iterator->value[i] = join->right[i] ? join->right_value[join->columns[i]] : left->value[join->columns[i]];
+            return ITERATOR_ROW;
+        }
+        join->left_valid = 0;
+    }
+}
+
+/**
+ * @brief Function closes a natural join
+ * @param iterator join
+ * @return No return value
+ */
+static void AK_iterator_join_close(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_join_state *join = (AK_iterator_join_state *) iterator->state;
+
+    AK_iterator_close(iterator->child[0]);
+    AK_iterator_close(iterator->child[1]);
+    AK_iterator_buffer_free(&join->rows);
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a natural join like AK_join: produced rows have attributes of the left input which are not
+          join attributes, followed by all attributes of the right input. Right input is materialized in memory, left
+          input is pipelined.
+ * @param left left input operator
+ * @param right right input operator
+ * @param att list of join attributes
+ * @return join, NULL if an input is NULL, a join attribute does not exist or there are too many attributes (inputs are freed)
+ */
+AK_iterator *AK_iterator_join(AK_iterator *left, AK_iterator *right, struct list_node *att) {
+    AK_PRO;
+    AK_iterator *iterator;
+    AK_iterator_join_state *join;
+    struct list_node *list_elem;
+    int i, j, is_join;
+
+    if (left == NULL || right == NULL) {
+        AK_iterator_free(left);
+        AK_iterator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+
+    iterator = AK_iterator_new(sizeof (AK_iterator_join_state));
+    iterator->open = AK_iterator_join_open;
+    iterator->next = AK_iterator_join_next;
+    iterator->close = AK_iterator_join_close;
+    iterator->child[0] = left;
+    iterator->child[1] = right;
+    join = (AK_iterator_join_state *) iterator->state;
+
+    for (list_elem = Ak_First_L2(att); list_elem != NULL && join->num_join < MAX_ATTRIBUTES; list_elem = list_elem->next) {
+        for (i = 0; i < left->num_attr && strcmp(left->header[i].att_name, list_elem->data) != 0; i++)
+            ;
+        for (j = 0; j < right->num_attr && strcmp(right->header[j].att_name, list_elem->data) != 0; j++)
+            ;
+        if (i == left->num_attr || j == right->num_attr) {
+            printf("AK_iterator_join: ERROR. Join attribute %s does not exist.\n", list_elem->data);
+            AK_iterator_free(iterator);
+            AK_EPI;
+            return NULL;
+        }
+        join->left_join[join->num_join] = i;
+        join->right_join[join->num_join] = j;
+        join->num_join++;
+    }
+
+    for (i = 0; i < left->num_attr + right->num_attr; i++) {
+        if (i < left->num_attr) {
+            for (j = is_join = 0; j < join->num_join; j++)
+                is_join |= join->left_join[j] == i;
+            if (is_join)
+                continue;
+        }
+        if (iterator->num_attr == MAX_ATTRIBUTES) {
+            printf("AK_iterator_join: ERROR. Join has more than %d attributes.\n", MAX_ATTRIBUTES);
+            AK_iterator_free(iterator);
+            AK_EPI;
+            return NULL;
+        }
+        join->right[iterator->num_attr] = i >= left->num_attr;
+        join->columns[iterator->num_attr] = i < left->num_attr ? i : i - left->num_attr;
+        memcpy(&iterator->header[iterator->num_attr], i < left->num_attr ? &left->header[i] : &right->header[i - left->num_attr], sizeof (AK_header));
+        iterator->num_attr++;
+    }
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function opens a union
+ * @param iterator union
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_union_open(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_union_state *state = (AK_iterator_union_state *) iterator->state;
+
+    state->current = 0;
+    if (AK_iterator_open(iterator->child[0]) == EXIT_ERROR || AK_iterator_open(iterator->child[1]) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function produces the next row of the first input, and of the second input when the first one ends
+ * @param iterator union
+ * @return ITERATOR_ROW or ITERATOR_END
+ */
+static int AK_iterator_union_next(AK_iterator *iterator) {
+    AK_iterator_union_state *state = (AK_iterator_union_state *) iterator->state;
+
+    for (; state->current < 2; state->current++) {
+        if (AK_iterator_next(iterator->child[state->current]) == ITERATOR_ROW) {
+            memcpy(iterator->value, iterator->child[state->current]->value, iterator->num_attr * sizeof (AK_iterator_value));
+            return ITERATOR_ROW;
+        }
+    }
+    return ITERATOR_END;
+}
+
+/**
+ * @brief Function closes a union
+ * @param iterator union
+ * @return No return value
+ */
+static void AK_iterator_union_close(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_close(iterator->child[0]);
+    AK_iterator_close(iterator->child[1]);
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a union like AK_union_all: rows of both inputs are produced, duplicates are kept
+ * @param first first input operator
+ * @param second second input operator
+ * @return union, NULL if an input is NULL or inputs have different number of attributes (inputs are freed)
+ */
+AK_iterator *AK_iterator_union(AK_iterator *first, AK_iterator *second) {
+    AK_PRO;
+    AK_iterator *iterator;
+
+    if (first == NULL || second == NULL || first->num_attr != second->num_attr) {
+        if (first != NULL && second != NULL)
+            printf("AK_iterator_union: ERROR. Inputs have different number of attributes.\n");
+        AK_iterator_free(first);
+        AK_iterator_free(second);
+        AK_EPI;
+        return NULL;
+    }
+
+    iterator = AK_iterator_new(sizeof (AK_iterator_union_state));
+    iterator->open = AK_iterator_union_open;
+    iterator->next = AK_iterator_union_next;
+    iterator->close = AK_iterator_union_close;
+    iterator->child[0] = first;
+    iterator->child[1] = second;
+    iterator->num_attr = first->num_attr;
+    memcpy(iterator->header, first->header, sizeof (iterator->header));
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function opens a limit
+ * @param iterator limit
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_limit_open(AK_iterator *iterator) {
+    AK_PRO;
+    int result = AK_iterator_open(iterator->child[0]);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function produces the next row of the input until limit rows are produced. Then the input is closed, so
+          scans below stop reading blocks as soon as the consumer has all its rows.
+ * @param iterator limit
+ * @return ITERATOR_ROW or ITERATOR_END
+ */
+static int AK_iterator_limit_next(AK_iterator *iterator) {
+    AK_iterator_limit_state *state = (AK_iterator_limit_state *) iterator->state;
+
+    if (iterator->num_rows >= state->limit || AK_iterator_next(iterator->child[0]) == ITERATOR_END) {
+        AK_iterator_close(iterator->child[0]);
+        return ITERATOR_END;
+    }
+    memcpy(iterator->value, iterator->child[0]->value, iterator->num_attr * sizeof (AK_iterator_value));
+    return ITERATOR_ROW;
+}
+
+/**
+ * @brief Function closes a limit
+ * @param iterator limit
+ * @return No return value
+ */
+static void AK_iterator_limit_close(AK_iterator *iterator) {
+    AK_PRO;
+    AK_iterator_close(iterator->child[0]);
+    AK_EPI;
+}
+
+/**
+ * @brief Function creates a limit (LIMIT n): only the first limit rows of the input are produced
+ * @param child input operator
+ * @param limit maximal number of produced rows
+ * @return limit, NULL if input is NULL
+ */
+AK_iterator *AK_iterator_limit(AK_iterator *child, int limit) {
+    AK_PRO;
+    AK_iterator *iterator;
+
+    if (child == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+
+    iterator = AK_iterator_new(sizeof (AK_iterator_limit_state));
+    iterator->open = AK_iterator_limit_open;
+    iterator->next = AK_iterator_limit_next;
+    iterator->close = AK_iterator_limit_close;
+    iterator->child[0] = child;
+    iterator->num_attr = child->num_attr;
+    memcpy(iterator->header, child->header, sizeof (iterator->header));
+    ((AK_iterator_limit_state *) iterator->state)->limit = limit < 0 ? 0 : limit;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function checks whether a plan produces at least one row (EXISTS). The plan is closed after its first row,
+          so scans read only blocks up to the first matching row.
+ * @param iterator root operator of the plan
+ * @return 1 if plan produces a row, 0 if it does not, EXIT_ERROR if plan could not be opened
+ */
+int AK_iterator_exists(AK_iterator *iterator) {
+    AK_PRO;
+    int exists;
+
+    if (iterator == NULL || AK_iterator_open(iterator) == EXIT_ERROR) {
+        AK_iterator_close(iterator);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    exists = AK_iterator_next(iterator) == ITERATOR_ROW;
+    AK_iterator_close(iterator);
+    AK_EPI;
+    return exists;
+}
+
+/**
+ * @brief Function opens an operator and its inputs
+ * @param iterator operator
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_iterator_open(AK_iterator *iterator) {
+    AK_PRO;
+    int result;
+
+    if (iterator == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (iterator->opened)
+        AK_iterator_close(iterator);
+    iterator->num_rows = 0;
+    iterator->opened = 1;
+    result = iterator->open(iterator);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function produces the next row of an operator into its value
+ * @param iterator operator
+ * @return ITERATOR_ROW or ITERATOR_END
+ */
+int AK_iterator_next(AK_iterator *iterator) {
+    if (!iterator->opened || iterator->next(iterator) == ITERATOR_END)
+        return ITERATOR_END;
+    iterator->num_rows++;
+    return ITERATOR_ROW;
+}
+
+/**
+ * @brief Function closes an operator and its inputs
+ * @param iterator operator
+ * @return No return value
+ */
+void AK_iterator_close(AK_iterator *iterator) {
+    AK_PRO;
+    if (iterator != NULL && iterator->opened) {
+        iterator->opened = 0;
+        iterator->close(iterator);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function frees an operator and its inputs
+ * @param iterator operator, can be NULL
+ * @return No return value
+ */
+void AK_iterator_free(AK_iterator *iterator) {
+    AK_PRO;
+    if (iterator != NULL) {
+        AK_iterator_close(iterator);
+        AK_iterator_free(iterator->child[0]);
+        AK_iterator_free(iterator->child[1]);
+        if (iterator->destroy != NULL)
+            iterator->destroy(iterator);
+        AK_free(iterator->state);
+        AK_free(iterator);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function runs a plan and writes all its rows into a new table, which is the only table written by the plan
+ * @param iterator root operator of the plan
+ * @param table name of the new table
+ * @return EXIT_SUCCESS, EXIT_ERROR if plan or table could not be created
+ */
+int AK_iterator_materialize(AK_iterator *iterator, char *table) {
+    AK_PRO;
+    struct list_node *row_root;
+
+    if (iterator == NULL || AK_iterator_open(iterator) == EXIT_ERROR) {
+        printf("AK_iterator_materialize: ERROR. Plan for table %s cannot be opened.\n", table);
+        AK_iterator_close(iterator);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, iterator->header) == EXIT_ERROR) {
+        AK_iterator_close(iterator);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&row_root);
+    while (AK_iterator_next(iterator) == ITERATOR_ROW) {
+        AK_iterator_row_list(iterator, table, row_root);
+        Ak_insert_row(row_root);
+        Ak_DeleteAll_L3(&row_root);
+    }
+    Ak_dbg_messg(LOW, REL_OP, "AK_iterator_materialize: %d rows written to %s\n", iterator->num_rows, table);
+    AK_iterator_close(iterator);
+    AK_free(row_root);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function for testing pipelined execution. Every query is run both as a pipelined plan, which writes only its
+          result, and with relational operators, which write a table after every operator, and results are compared.
+ * @return No return value
+ */
+void AK_iterator_test() {
+    AK_PRO;
+    printf("\n********** PIPELINED EXECUTION TEST **********\n\n");
+
+    struct list_node *expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *att = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *join_att = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_iterator *plan;
+    int year = 2005, passed = 1, rows, expected;
+
+    Ak_Init_L3(&expr);
+    Ak_Init_L3(&att);
+    Ak_Init_L3(&join_att);
+    strcpy(expr->table, "student");
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof (int), expr);
+    Ak_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), att);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), att);
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "id_department", sizeof ("id_department"), join_att);
+
+    printf("\nQUERY: SELECT firstname, year FROM student WHERE year > 2005;\n\n");
+    plan = AK_iterator_project(AK_iterator_scan("student", expr), att);
+    passed &= AK_iterator_materialize(plan, "iterator_test1") == EXIT_SUCCESS;
+    AK_iterator_free(plan);
+    AK_print_table("iterator_test1");
+    AK_selection("student", "iterator_selection", expr);
+    AK_projection("iterator_selection", "iterator_projection", att);
+    rows = AK_get_num_records("iterator_test1");
+    expected = AK_get_num_records("iterator_projection");
+    printf("Pipelined plan: %d rows, operators: %d rows\n", rows, expected);
+    passed &= rows == expected && rows > 0 && AK_num_attr("iterator_test1") == 2;
+
+    printf("\nQUERY: SELECT * FROM employee NATURAL JOIN department;\n\n");
+    plan = AK_iterator_join(AK_iterator_scan("employee", NULL), AK_iterator_scan("department", NULL), join_att);
+    passed &= AK_iterator_materialize(plan, "iterator_test2") == EXIT_SUCCESS;
+    AK_iterator_free(plan);
+    AK_print_table("iterator_test2");
+    AK_join("employee", "department", "iterator_join", join_att);
+    rows = AK_get_num_records("iterator_test2");
+    expected = AK_get_num_records("iterator_join");
+    printf("Pipelined plan: %d rows, operators: %d rows\n", rows, expected);
+    passed &= rows == expected && AK_num_attr("iterator_test2") == AK_num_attr("iterator_join");
+
+    printf("\nQUERY: SELECT firstname, year FROM student WHERE year > 2005 UNION ALL SELECT firstname, year FROM student;\n\n");
+    plan = AK_iterator_union(AK_iterator_project(AK_iterator_scan("student", expr), att),
+            AK_iterator_select(AK_iterator_project(AK_iterator_scan("student", NULL), att), NULL));
+    passed &= AK_iterator_materialize(plan, "iterator_test3") == EXIT_SUCCESS;
+    AK_iterator_free(plan);
+    rows = AK_get_num_records("iterator_test3");
+    expected = AK_get_num_records("iterator_test1") + AK_get_num_records("student");
+    printf("Pipelined plan: %d rows, expected: %d rows\n", rows, expected);
+    passed &= rows == expected;
+
+    printf("\nQUERY: SELECT firstname, year FROM (SELECT * FROM student) WHERE year > 2005;\n\n");
+    plan = AK_iterator_select(AK_iterator_project(AK_iterator_scan("student", NULL), att), expr);
+    passed &= AK_iterator_materialize(plan, "iterator_test4") == EXIT_SUCCESS;
+    AK_iterator_free(plan);
+    rows = AK_get_num_records("iterator_test4");
+    expected = AK_get_num_records("iterator_test1");
+    printf("Pipelined plan: %d rows, expected: %d rows\n", rows, expected);
+    passed &= rows == expected;
+
+    printf("\nQUERY: SELECT firstname, year FROM student WHERE year > 2005 LIMIT 2;\n\n");
+    plan = AK_iterator_limit(AK_iterator_project(AK_iterator_scan("student", expr), att), 2);
+    passed &= AK_iterator_materialize(plan, "iterator_test5") == EXIT_SUCCESS;
+    AK_iterator_free(plan);
+    rows = AK_get_num_records("iterator_test5");
+    expected = AK_get_num_records("iterator_test1") < 2 ? AK_get_num_records("iterator_test1") : 2;
+    printf("Pipelined plan: %d rows, expected: %d rows\n", rows, expected);
+    passed &= rows == expected;
+
+    plan = AK_iterator_scan("student", expr);
+    rows = AK_iterator_exists(plan);
+    AK_iterator_free(plan);
+    printf("EXISTS (SELECT * FROM student WHERE year > 2005): %d\n", rows);
+    passed &= rows == (AK_get_num_records("iterator_test1") > 0);
+
+    passed &= AK_iterator_project(AK_iterator_scan("student", NULL), join_att) == NULL;
+
+    Ak_DeleteAll_L3(&expr);
+    Ak_DeleteAll_L3(&att);
+    Ak_DeleteAll_L3(&join_att);
+    AK_free(expr);
+    AK_free(att);
+    AK_free(join_att);
+    printf("\nTest %s\n", passed ? "SUCCESS" : "FAILED");
+    AK_EPI;
+}
@@ -0,0 +1,128 @@
+/**
+@file iterator.h Header file that provides data structures and functions for pipelined (iterator) query execution
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef ITERATOR
+#define ITERATOR
+
+#include "expression_check.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../file/zonemap.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def ITERATOR_END
+  * @brief Result of next function of an iterator: there are no more rows
+  */
+#define ITERATOR_END 0
+
+/**
+  * @def ITERATOR_ROW
+  * @brief Result of next function of an iterator: a row is in AK_iterator->value
+  */
+#define ITERATOR_ROW 1
+
+/**
+ * @struct AK_iterator_value
+ * @brief Structure that holds one value of the current row of an iterator. Data is not copied, it points to a block
+          or buffer of the operator which produced it and is valid until its next function is called again.
+ */
+typedef struct {
+    /// data type
+    int type;
+    /// data size
+    int size;
+    /// data
+    char *data;
+} AK_iterator_value;
+
+/**
+ * @struct AK_iterator_buffer
+ * @brief Structure that holds rows materialized in memory by an operator which needs all rows of its input (join
+          build, sort)
+ */
+typedef struct {
+    /// number of values of every row
+    int num_attr;
+    /// number of rows
+    int num_rows;
+    /// number of rows entries can hold
+    int capacity_rows;
+    /// type, size and data offset of every value
+    int *entries;
+    /// data of all values
+    char *data;
+    /// used bytes of data
+    int size;
+    /// allocated bytes of data
+    int capacity;
+} AK_iterator_buffer;
+
+typedef struct AK_iterator AK_iterator;
+
+/**
+ * @struct AK_iterator
+ * @brief Structure that defines an operator of a pipelined query plan (open/next/close iterator). Every call of next
+          produces one row in value, rows flow from scans to the root without being written to temporary tables.
+ */
+struct AK_iterator {
+    /// prepares operator (and its children) for producing rows
+    int (*open)(AK_iterator *iterator);
+    /// produces the next row, returns ITERATOR_ROW or ITERATOR_END
+    int (*next)(AK_iterator *iterator);
+    /// releases resources acquired by open
+    void (*close)(AK_iterator *iterator);
+    /// frees state of operator, can be NULL
+    void (*destroy)(AK_iterator *iterator);
+    /// input operators, NULL if operator has less inputs
+    AK_iterator *child[2];
+    /// header of produced rows
+    AK_header header[MAX_ATTRIBUTES];
+    /// number of attributes of produced rows
+    int num_attr;
+    /// current row
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    /// number of rows produced since open
+    int num_rows;
+    /// 1 between open and close
+    int opened;
+    /// state of operator
+    void *state;
+};
+
+void AK_iterator_buffer_init(AK_iterator_buffer *buffer, int num_attr);
+void AK_iterator_buffer_add(AK_iterator_buffer *buffer, AK_iterator_value *value);
+void AK_iterator_buffer_get(AK_iterator_buffer *buffer, int row, AK_iterator_value *value);
+void AK_iterator_buffer_free(AK_iterator_buffer *buffer);
+AK_iterator *AK_iterator_scan(char *table, struct list_node *expr);
+AK_iterator *AK_iterator_select(AK_iterator *child, struct list_node *expr);
+AK_iterator *AK_iterator_project(AK_iterator *child, struct list_node *att);
+AK_iterator *AK_iterator_join(AK_iterator *left, AK_iterator *right, struct list_node *att);
+AK_iterator *AK_iterator_union(AK_iterator *first, AK_iterator *second);
+AK_iterator *AK_iterator_limit(AK_iterator *child, int limit);
+int AK_iterator_exists(AK_iterator *iterator);
+int AK_iterator_open(AK_iterator *iterator);
+int AK_iterator_next(AK_iterator *iterator);
+void AK_iterator_close(AK_iterator *iterator);
+void AK_iterator_free(AK_iterator *iterator);
+void AK_iterator_row_list(AK_iterator *iterator, char *table, struct list_node *row_root);
+int AK_iterator_materialize(AK_iterator *iterator, char *table);
+void AK_iterator_test();
+
+#endif
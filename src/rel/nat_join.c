@@ -17,8 +17,113 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  17 */
 
+#include <time.h>
 #include "nat_join.h"
 
+/**
+  * @def JOIN_HASH_SEED
+  * @brief Initial value of hashes of join keys (FNV-1a)
+  */
+#define JOIN_HASH_SEED 2166136261u
+
+/**
+  * @def JOIN_BUILD
+  * @brief Index of the build input of a hash join, its rows are kept in memory
+  */
+#define JOIN_BUILD 0
+
+/**
+  * @def JOIN_PROBE
+  * @brief Index of the probe input of a hash join, its rows are looked up in the build rows
+  */
+#define JOIN_PROBE 1
+
+/// bytes of memory for rows of the build input set by AK_join_set_memory, 0 if JOIN_MEMORY is used
+static int AK_join_forced_memory = 0;
+
+/// number of partitions written to temporary segments by the last hash join
+static int AK_join_last_spilled = 0;
+
+/// deepest partitioning of the last hash join, 0 if it was done in memory
+static int AK_join_last_depth = 0;
+
+/// 1 if the last join was a merge join
+static int AK_join_last_merge = 0;
+
+/// number of rows of the outer table of the index nested-loop join test
+#define JOIN_TEST_OUTER_ROWS 5
+
+/// 1 if the last join was an index nested-loop join
+static int AK_join_last_index = 0;
+
+/**
+ * @struct AK_join_state
+ * @brief Structure that holds state of one hash join. Rows of the build input are kept in memory and chained in
+          buckets by hash of their join values, rows of the probe input are looked up one at a time.
+ */
+typedef struct {
+    /// number of join attributes
+    int num_join;
+    /// number of attributes of the build and the probe input
+    int num_attr[2];
+    /// headers of the build and the probe input
+    AK_header header[2][MAX_ATTRIBUTES];
+    /// join attributes of the build and the probe input
+    int join[2][MAX_ATTRIBUTES];
+    /// number of attributes of the joined table
+    int num_out;
+    /// input (JOIN_BUILD or JOIN_PROBE) of every attribute of the joined table
+    int out_input[MAX_ATTRIBUTES];
+    /// input attribute of every attribute of the joined table
+    int out_column[MAX_ATTRIBUTES];
+    /// rows of the build input
+    AK_iterator_buffer rows;
+    /// join key hash of every build row
+    unsigned int *row_hash;
+    /// partition of every build row of a hybrid hash join
+    int *row_partition;
+    /// next build row in the same bucket, -1 at the end of chain
+    int *chain;
+    /// number of rows row_hash and chain can hold
+    int capacity_rows;
+    /// first build row of every bucket, -1 for empty bucket
+    int *buckets;
+    /// number of buckets minus one (number of buckets is a power of two)
+    unsigned int mask;
+    /// bytes of memory for build rows
+    int memory;
+    /// bulk load of the joined table
+    AK_bulk_loader loader;
+    /// number of joined rows
+    int num_joined;
+    /// number of partitions written to temporary segments
+    int num_spilled;
+    /// deepest partitioning
+    int max_depth;
+} AK_join_state;
+
+/**
+ * @struct AK_join_spill
+ * @brief Structure that holds partitions of one level of a hybrid hash join. Partitions kept in memory are joined
+          while inputs are read, other partitions of both inputs are written to temporary segments.
+ */
+typedef struct {
+    /// number of partitions
+    int num_partitions;
+    /// recursion depth of the partitioning
+    int depth;
+    /// 1 for partitions whose build rows are kept in memory
+    int resident[JOIN_MAX_PARTITIONS];
+    /// number of partitions kept in memory
+    int num_resident;
+    /// temporary segments of partitions of the build and the probe input
+    char segment[2][JOIN_MAX_PARTITIONS][MAX_ATT_NAME];
+    /// bulk loads of temporary segments
+    AK_bulk_loader loader[2][JOIN_MAX_PARTITIONS];
+    /// number of rows written to temporary segments
+    int rows[2][JOIN_MAX_PARTITIONS];
+} AK_join_spill;
+
 /**
  * @author Matija Novak, optimized, and updated to work with AK_list by Dino Laktašić
  * @brief  Function to make header for the new table and call the function to create the segment
@@ -263,14 +368,15 @@ void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, s
 
 /**
  * @author Matija Novak, updated to work with AK_list and support cacheing by Dino Laktašić
- * @brief Function to make nat_join betwen two tables on some attributes
+ * @brief Function to make nat_join betwen two tables on some attributes with a block nested loop: every block of the
+          first table is compared with every block of the second one. AK_join is a hash join and should be used instead.
  * @param srcTable1 name of the first table to join
  * @param srcTable2 name of the second table to join
  * @param att attributes on which we make nat_join
  * @param dstTable name of the nat_join table
  * @return if success returns EXIT_SUCCESS
  */
-int AK_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att) {
+int AK_join_nested_loop(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att) {
 
     AK_PRO;
     table_addresses *src_addr1 = (table_addresses *) AK_get_table_addresses(srcTable1);
@@ -343,6 +449,1047 @@ int AK_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node
     }
     AK_EPI;
 }
+/**
+ * @brief Function sets number of bytes of memory for rows of the build input of a hash join, for example to join
+          tables that fit in memory by partitions
+ * @param bytes number of bytes, 0 for JOIN_MEMORY
+ * @return number of bytes that is used
+ */
+int AK_join_set_memory(int bytes) {
+    AK_PRO;
+    AK_join_forced_memory = bytes < 0 ? 0 : bytes;
+    AK_EPI;
+    return AK_join_forced_memory ? AK_join_forced_memory : JOIN_MEMORY;
+}
+
+/**
+ * @brief Function checks whether a row has a null join value. Such a row is equal to no row, so it is never joined.
+ * @param join hash join
+ * @param input JOIN_BUILD or JOIN_PROBE
+ * @param value values of the row
+ * @return 1 if a join value is null, 0 otherwise
+ */
+static int AK_join_has_null(AK_join_state *join, int input, AK_iterator_value *value) {
+    int i, column;
+
+    for (i = 0; i < join->num_join; i++) {
+        column = join->join[input][i];
+        if (value[column].type != join->header[input][column].type)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function hashes join values of a row (FNV-1a). Values are hashed by their types, so values that compare equal
+          have equal hashes (0.0 and -0.0 are hashed as 0.0).
+ * @param join hash join
+ * @param input JOIN_BUILD or JOIN_PROBE
+ * @param value values of the row
+ * @return hash
+ */
+static unsigned int AK_join_hash(AK_join_state *join, int input, AK_iterator_value *value) {
+    unsigned int hash = JOIN_HASH_SEED;
+    AK_iterator_value *key;
+    float number_float;
+    double number_double;
+    char *data;
+    int i, j, size;
+
+    for (i = 0; i < join->num_join; i++) {
+        key = &value[join->join[input][i]];
+        data = key->data;
+        size = key->size;
+        if (key->type == TYPE_FLOAT) {
+            memcpy(&number_float, key->data, sizeof (float));
+            if (number_float == 0)
+                number_float = 0;
+            data = (char *) &number_float;
+            size = sizeof (float);
+        } else if (key->type == TYPE_NUMBER) {
+            memcpy(&number_double, key->data, sizeof (double));
+            if (number_double == 0)
+                number_double = 0;
+            data = (char *) &number_double;
+            size = sizeof (double);
+        }
+        for (j = 0; j < size; j++)
+            hash = (hash ^ (unsigned char) data[j]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Function appends one row to a bulk load
+ * @param loader bulk loader
+ * @param value values of the row
+ * @param num_attr number of values
+ * @param rows_left number of rows that are still to be loaded including this one
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_join_load_row(AK_bulk_loader *loader, AK_iterator_value *value, int num_attr, int rows_left) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], i;
+    char *data[MAX_ATTRIBUTES];
+
+    for (i = 0; i < num_attr; i++) {
+        type[i] = value[i].type;
+        size[i] = value[i].size;
+        data[i] = value[i].data;
+    }
+    return AK_bulk_add_row(loader, type, data, size, rows_left);
+}
+
+/**
+ * @brief Function returns memory taken by build rows of a hash join
+ * @param join hash join
+ * @return number of bytes
+ */
+static long AK_join_memory_used(AK_join_state *join) {
+    return join->rows.size + (long) join->rows.num_rows * (join->num_attr[JOIN_BUILD] * 3 + 3) * (long) sizeof (int);
+}
+
+/**
+ * @brief Function adds one row to build rows of a hash join
+ * @param join hash join
+ * @param value values of the row
+ * @param hash hash of join values of the row
+ * @param partition partition of the row
+ * @return No return value
+ */
+static void AK_join_add_row(AK_join_state *join, AK_iterator_value *value, unsigned int hash, int partition) {
+    if (join->rows.num_rows == join->capacity_rows) {
+        join->capacity_rows = join->capacity_rows ? 2 * join->capacity_rows : 1024;
+        join->row_hash = (unsigned int *) AK_realloc(join->row_hash, join->capacity_rows * sizeof (unsigned int));
+        join->row_partition = (int *) AK_realloc(join->row_partition, join->capacity_rows * sizeof (int));
+        join->chain = (int *) AK_realloc(join->chain, join->capacity_rows * sizeof (int));
+    }
+    join->row_hash[join->rows.num_rows] = hash;
+    join->row_partition[join->rows.num_rows] = partition;
+    AK_iterator_buffer_add(&join->rows, value);
+}
+
+/**
+ * @brief Function chains build rows of a hash join in buckets by their hashes. Rows are chained from the last one, so
+          rows of a bucket are visited in the order they were read.
+ * @param join hash join
+ * @return No return value
+ */
+static void AK_join_index(AK_join_state *join) {
+    unsigned int num_buckets;
+    int row;
+
+    for (num_buckets = 16; num_buckets < 2 * (unsigned int) join->rows.num_rows; num_buckets *= 2)
+        ;
+    join->mask = num_buckets - 1;
+    join->buckets = (int *) AK_realloc(join->buckets, num_buckets * sizeof (int));
+    memset(join->buckets, -1, num_buckets * sizeof (int));
+    for (row = join->rows.num_rows - 1; row >= 0; row--) {
+        join->chain[row] = join->buckets[join->row_hash[row] & join->mask];
+        join->buckets[join->row_hash[row] & join->mask] = row;
+    }
+}
+
+/**
+ * @brief Function reads rows of the build input into memory and chains them in buckets by their hashes. Rows with
+          a null join value are left out.
+ * @param join hash join
+ * @param table build input
+ * @param limited 1 if reading stops when rows take more than the memory of the join
+ * @param bytes memory all rows would take, if reading stopped
+ * @return 1 if all rows were read, 0 if they do not fit in memory
+ */
+static int AK_join_build(AK_join_state *join, char *table, int limited, long *bytes) {
+    AK_PRO;
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+    int fits = 1, i;
+
+    join->rows.num_rows = 0;
+    join->rows.size = 0;
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (AK_join_has_null(join, JOIN_BUILD, scan->value))
+            continue;
+        if (!fits) {
+            for (i = 0; i < join->num_attr[JOIN_BUILD]; i++)
+                *bytes += scan->value[i].size;
+            *bytes += (join->num_attr[JOIN_BUILD] * 3 + 3) * (long) sizeof (int);
+            continue;
+        }
+        AK_join_add_row(join, scan->value, AK_join_hash(join, JOIN_BUILD, scan->value), 0);
+        if (limited && AK_join_memory_used(join) > join->memory) {
+            fits = 0;
+            *bytes = AK_join_memory_used(join);
+        }
+    }
+    AK_iterator_free(scan);
+    if (fits)
+        AK_join_index(join);
+    AK_EPI;
+    return fits;
+}
+
+/**
+ * @brief Function looks up one row of the probe input in the buckets of build rows and writes joined rows. Join
+          values are compared by their types (see AK_sort_compare_values).
+ * @param join hash join
+ * @param value values of the probe row
+ * @param hash hash of join values of the probe row
+ * @return No return value
+ */
+static void AK_join_probe_row(AK_join_state *join, AK_iterator_value *value, unsigned int hash) {
+    AK_iterator_value build[MAX_ATTRIBUTES], out[MAX_ATTRIBUTES];
+    int row, i;
+
+    for (row = join->buckets[hash & join->mask]; row != -1; row = join->chain[row]) {
+        if (join->row_hash[row] != hash)
+            continue;
+        AK_iterator_buffer_get(&join->rows, row, build);
+        for (i = 0; i < join->num_join; i++) {
+            if (AK_sort_compare_values(&build[join->join[JOIN_BUILD][i]], &value[join->join[JOIN_PROBE][i]]) != 0)
+                break;
+        }
+        if (i < join->num_join)
+            continue;
+        for (i = 0; i < join->num_out; i++)
+            out[i] = join->out_input[i] == JOIN_BUILD ? build[join->out_column[i]] : value[join->out_column[i]];
+        //extents of the joined table grow with the number of rows written so far
+        AK_join_load_row(&join->loader, out, join->num_out, join->num_joined + 1);
+        join->num_joined++;
+    }
+}
+
+/**
+ * @brief Function looks up every row of the probe input in the buckets of build rows and writes joined rows
+ * @param join hash join
+ * @param table probe input
+ * @return No return value
+ */
+static void AK_join_probe(AK_join_state *join, char *table) {
+    AK_PRO;
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (!AK_join_has_null(join, JOIN_PROBE, scan->value))
+            AK_join_probe_row(join, scan->value, AK_join_hash(join, JOIN_PROBE, scan->value));
+    }
+    AK_iterator_free(scan);
+    AK_EPI;
+}
+
+/**
+ * @brief Function returns partition of a row of a hash join. The hash is mixed with the recursion depth, so rows of
+          one partition are spread over all partitions when it is partitioned again.
+ * @param hash hash of join values of the row
+ * @param depth recursion depth of the partitioning
+ * @param num_partitions number of partitions
+ * @return partition
+ */
+static int AK_join_partition_of(unsigned int hash, int depth, int num_partitions) {
+    hash = (hash ^ (unsigned int) depth * 0x9E3779B9u) * 2654435761u;
+    return (int) ((hash >> 16) % (unsigned int) num_partitions);
+}
+
+/**
+ * @brief Function writes a row of a partition that is not kept in memory to its temporary segment, which is created
+          with the first row
+ * @param join hash join
+ * @param spill partitioning
+ * @param input JOIN_BUILD or JOIN_PROBE
+ * @param partition partition of the row
+ * @param value values of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the segment cannot be created
+ */
+static int AK_join_spill_row(AK_join_state *join, AK_join_spill *spill, int input, int partition, AK_iterator_value *value) {
+    AK_bulk_loader *loader = &spill->loader[input][partition];
+
+    if (spill->rows[input][partition] == 0) {
+        if (AK_temp_segment_create(spill->segment[input][partition], join->header[input]) == EXIT_ERROR)
+            return EXIT_ERROR;
+        AK_bulk_begin(loader, spill->segment[input][partition]);
+        join->num_spilled++;
+    }
+    //extents of temporary segments grow with the number of rows written so far
+    spill->rows[input][partition]++;
+    return AK_join_load_row(loader, value, join->num_attr[input], spill->rows[input][partition]);
+}
+
+/**
+ * @brief Function moves build rows of the last partition kept in memory to its temporary segment and removes them
+          from memory
+ * @param join hash join
+ * @param spill partitioning
+ * @return EXIT_SUCCESS, EXIT_ERROR if the segment cannot be created
+ */
+static int AK_join_evict(AK_join_state *join, AK_join_spill *spill) {
+    AK_PRO;
+    AK_iterator_buffer rows;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    int partition, row, kept = 0, result = EXIT_SUCCESS;
+
+    for (partition = spill->num_partitions - 1; !spill->resident[partition]; partition--)
+        ;
+    spill->resident[partition] = 0;
+    spill->num_resident--;
+
+    AK_iterator_buffer_init(&rows, join->num_attr[JOIN_BUILD]);
+    for (row = 0; row < join->rows.num_rows; row++) {
+        AK_iterator_buffer_get(&join->rows, row, value);
+        if (join->row_partition[row] == partition) {
+            if (AK_join_spill_row(join, spill, JOIN_BUILD, partition, value) == EXIT_ERROR)
+                result = EXIT_ERROR;
+            continue;
+        }
+        join->row_hash[kept] = join->row_hash[row];
+        join->row_partition[kept] = join->row_partition[row];
+        AK_iterator_buffer_add(&rows, value);
+        kept++;
+    }
+    AK_iterator_buffer_free(&join->rows);
+    join->rows = rows;
+    Ak_dbg_messg(MIDDLE, REL_OP, "AK_join: partition %d of depth %d written to a temporary segment\n", partition, spill->depth);
+    AK_EPI;
+    return result;
+}
+
+static int AK_join_tables(AK_join_state *join, char *build, char *probe, int depth);
+
+/**
+ * @brief Function joins two inputs with a hybrid hash join, when build rows do not fit in memory. Both inputs are
+          split into partitions by hash, twice as many as memory would hold, so uneven partitions can stay in memory.
+          All partitions start in memory; while build rows take more memory than the join has, the last partition
+          still in memory is moved to a temporary segment. Probe rows of partitions in memory are joined at once, probe
+          rows of other partitions are written to temporary segments, and every pair of written partitions is joined
+          again (partitioned further if it still does not fit).
+ * @param join hash join
+ * @param build build input
+ * @param probe probe input
+ * @param bytes memory all build rows would take
+ * @param depth recursion depth of the partitioning
+ * @return EXIT_SUCCESS, EXIT_ERROR if a temporary segment cannot be created
+ */
+static int AK_join_hybrid(AK_join_state *join, char *build, char *probe, long bytes, int depth) {
+    AK_PRO;
+    AK_join_spill *spill = (AK_join_spill *) AK_calloc(1, sizeof (AK_join_spill));
+    AK_iterator *scan;
+    unsigned int hash;
+    int partition, input, result = EXIT_SUCCESS;
+
+    spill->num_partitions = (int) (2 * bytes / join->memory + 1);
+    if (spill->num_partitions > JOIN_MAX_PARTITIONS)
+        spill->num_partitions = JOIN_MAX_PARTITIONS;
+    if (spill->num_partitions < 2)
+        spill->num_partitions = 2;
+    spill->depth = depth;
+    spill->num_resident = spill->num_partitions;
+    for (partition = 0; partition < spill->num_partitions; partition++)
+        spill->resident[partition] = 1;
+    Ak_dbg_messg(LOW, REL_OP, "AK_join: %ld bytes of %s joined by %d partitions at depth %d\n", bytes, build,
+            spill->num_partitions, depth);
+
+    join->rows.num_rows = 0;
+    join->rows.size = 0;
+    scan = AK_iterator_scan(build, NULL);
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW && result == EXIT_SUCCESS) {
+        if (AK_join_has_null(join, JOIN_BUILD, scan->value))
+            continue;
+        hash = AK_join_hash(join, JOIN_BUILD, scan->value);
+        partition = AK_join_partition_of(hash, depth, spill->num_partitions);
+        if (!spill->resident[partition]) {
+            result = AK_join_spill_row(join, spill, JOIN_BUILD, partition, scan->value);
+            continue;
+        }
+        AK_join_add_row(join, scan->value, hash, partition);
+        while (AK_join_memory_used(join) > join->memory && spill->num_resident > 0 && result == EXIT_SUCCESS)
+            result = AK_join_evict(join, spill);
+    }
+    AK_iterator_free(scan);
+    AK_join_index(join);
+
+    scan = AK_iterator_scan(probe, NULL);
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW && result == EXIT_SUCCESS) {
+        if (AK_join_has_null(join, JOIN_PROBE, scan->value))
+            continue;
+        hash = AK_join_hash(join, JOIN_PROBE, scan->value);
+        partition = AK_join_partition_of(hash, depth, spill->num_partitions);
+        if (spill->resident[partition])
+            AK_join_probe_row(join, scan->value, hash);
+        else if (spill->rows[JOIN_BUILD][partition] > 0)
+            result = AK_join_spill_row(join, spill, JOIN_PROBE, partition, scan->value);
+    }
+    AK_iterator_free(scan);
+
+    for (input = 0; input < 2; input++) {
+        for (partition = 0; partition < spill->num_partitions; partition++) {
+            if (spill->rows[input][partition] > 0)
+                AK_bulk_end(&spill->loader[input][partition]);
+        }
+    }
+    for (partition = 0; partition < spill->num_partitions && result == EXIT_SUCCESS; partition++) {
+        if (spill->rows[JOIN_BUILD][partition] > 0 && spill->rows[JOIN_PROBE][partition] > 0)
+            result = AK_join_tables(join, spill->segment[JOIN_BUILD][partition], spill->segment[JOIN_PROBE][partition], depth + 1);
+    }
+    AK_free(spill);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function joins two inputs with a hash join: in memory if build rows fit, otherwise by a hybrid hash join.
+          Partitions are not split any more after JOIN_MAX_DEPTH levels, since rows with equal join values always
+          fall into one partition.
+ * @param join hash join
+ * @param build build input
+ * @param probe probe input
+ * @param depth recursion depth of the partitioning
+ * @return EXIT_SUCCESS, EXIT_ERROR if a temporary segment cannot be created
+ */
+static int AK_join_tables(AK_join_state *join, char *build, char *probe, int depth) {
+    AK_PRO;
+    long bytes = 0;
+    int result = EXIT_SUCCESS;
+
+    if (depth > join->max_depth)
+        join->max_depth = depth;
+    if (AK_join_build(join, build, depth < JOIN_MAX_DEPTH, &bytes))
+        AK_join_probe(join, probe);
+    else
+        result = AK_join_hybrid(join, build, probe, bytes, depth);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function compares join values of two rows of a join
+ * @param join join
+ * @param first values of the first row
+ * @param first_input input of the first row (JOIN_BUILD or JOIN_PROBE)
+ * @param second values of the second row
+ * @param second_input input of the second row
+ * @return negative, zero or positive number, as join values of the first row are lower, equal or greater
+ */
+static int AK_join_compare_keys(AK_join_state *join, AK_iterator_value *first, int first_input, AK_iterator_value *second, int second_input) {
+    int i, result;
+
+    for (i = 0; i < join->num_join; i++) {
+        result = AK_sort_compare_values(&first[join->join[first_input][i]], &second[join->join[second_input][i]]);
+        if (result != 0)
+            return result;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function reads the next row of an input of a merge join, skipping rows with a null join value. The row is
+          copied to last, so the following row can be checked against it.
+ * @param join join
+ * @param scan scan of the input
+ * @param input JOIN_BUILD or JOIN_PROBE
+ * @param last buffer with the previous row of the input
+ * @return ITERATOR_ROW, ITERATOR_END after the last row, JOIN_UNORDERED if join values of the row are lower than
+           join values of the previous row
+ */
+static int AK_join_merge_next(AK_join_state *join, AK_iterator *scan, int input, AK_iterator_buffer *last) {
+    AK_iterator_value previous[MAX_ATTRIBUTES];
+
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (AK_join_has_null(join, input, scan->value))
+            continue;
+        if (last->num_rows > 0) {
+            AK_iterator_buffer_get(last, 0, previous);
+            if (AK_join_compare_keys(join, scan->value, input, previous, input) < 0)
+                return JOIN_UNORDERED;
+        }
+        last->num_rows = 0;
+        last->size = 0;
+        AK_iterator_buffer_add(last, scan->value);
+        return ITERATOR_ROW;
+    }
+    return ITERATOR_END;
+}
+
+/**
+ * @brief Function joins two inputs ordered by join values with a merge join. Both inputs are read once; rows of the
+          build input with equal join values (a duplicate run) are kept in memory and joined with every row of the
+          probe input with the same values. Rows whose join values are lower than those of the previous row of the
+          same input stop the join, since the order was wrong.
+ * @param join join
+ * @param build build input (duplicate runs are kept from it)
+ * @param probe probe input
+ * @return EXIT_SUCCESS, JOIN_UNORDERED if an input is not ordered by join values
+ */
+static int AK_join_merge_rows(AK_join_state *join, char *build, char *probe) {
+    AK_PRO;
+    AK_iterator *scan[2];
+    AK_iterator_buffer last[2];
+    AK_iterator_value run[MAX_ATTRIBUTES], out[MAX_ATTRIBUTES];
+    int state[2], input, row, i, compare, result = EXIT_SUCCESS;
+
+    scan[JOIN_BUILD] = AK_iterator_scan(build, NULL);
+    scan[JOIN_PROBE] = AK_iterator_scan(probe, NULL);
+    for (input = 0; input < 2; input++) {
+        AK_iterator_buffer_init(&last[input], join->num_attr[input]);
+        AK_iterator_open(scan[input]);
+        state[input] = AK_join_merge_next(join, scan[input], input, &last[input]);
+    }
+
+    while (state[JOIN_BUILD] == ITERATOR_ROW && state[JOIN_PROBE] == ITERATOR_ROW) {
+        compare = AK_join_compare_keys(join, scan[JOIN_BUILD]->value, JOIN_BUILD, scan[JOIN_PROBE]->value, JOIN_PROBE);
+        if (compare < 0) {
+            state[JOIN_BUILD] = AK_join_merge_next(join, scan[JOIN_BUILD], JOIN_BUILD, &last[JOIN_BUILD]);
+            continue;
+        }
+        if (compare > 0) {
+            state[JOIN_PROBE] = AK_join_merge_next(join, scan[JOIN_PROBE], JOIN_PROBE, &last[JOIN_PROBE]);
+            continue;
+        }
+
+        //duplicate run of the build input
+        join->rows.num_rows = 0;
+        join->rows.size = 0;
+        do {
+            AK_iterator_buffer_add(&join->rows, scan[JOIN_BUILD]->value);
+            state[JOIN_BUILD] = AK_join_merge_next(join, scan[JOIN_BUILD], JOIN_BUILD, &last[JOIN_BUILD]);
+            if (state[JOIN_BUILD] != ITERATOR_ROW)
+                break;
+            AK_iterator_buffer_get(&join->rows, 0, run);
+        } while (AK_join_compare_keys(join, scan[JOIN_BUILD]->value, JOIN_BUILD, run, JOIN_BUILD) == 0);
+
+        //every probe row with the same join values is joined with the whole run
+        AK_iterator_buffer_get(&join->rows, 0, run);
+        while (state[JOIN_PROBE] == ITERATOR_ROW
+                && AK_join_compare_keys(join, run, JOIN_BUILD, scan[JOIN_PROBE]->value, JOIN_PROBE) == 0) {
+            for (row = 0; row < join->rows.num_rows; row++) {
+                AK_iterator_buffer_get(&join->rows, row, run);
+                for (i = 0; i < join->num_out; i++)
+                    out[i] = join->out_input[i] == JOIN_BUILD ? run[join->out_column[i]] : scan[JOIN_PROBE]->value[join->out_column[i]];
+                AK_join_load_row(&join->loader, out, join->num_out, join->num_joined + 1);
+                join->num_joined++;
+            }
+            AK_iterator_buffer_get(&join->rows, 0, run);
+            state[JOIN_PROBE] = AK_join_merge_next(join, scan[JOIN_PROBE], JOIN_PROBE, &last[JOIN_PROBE]);
+        }
+    }
+
+    //the rest of an input is read only to check its order
+    for (input = 0; input < 2; input++) {
+        while (state[input] == ITERATOR_ROW)
+            state[input] = AK_join_merge_next(join, scan[input], input, &last[input]);
+        if (state[input] == JOIN_UNORDERED)
+            result = JOIN_UNORDERED;
+        AK_iterator_free(scan[input]);
+        AK_iterator_buffer_free(&last[input]);
+    }
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function joins every row of the outer table with rows of the inner table found through a hash index of the
+          inner table on join attributes, so only blocks of the inner table that hold matching rows are read. Index
+          entries with the hash value of the outer row point to candidate rows, which are read by their addresses
+          and compared by join values, since different values can have the same hash value.
+ * @param join join, the inner table is its build input
+ * @param outer outer table
+ * @param index name of the hash index of the inner table
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index is empty
+ */
+static int AK_join_index_rows(AK_join_state *join, char *outer, char *index) {
+    AK_PRO;
+    AK_iterator *scan;
+    AK_iterator_value *key, inner[MAX_ATTRIBUTES], out[MAX_ATTRIBUTES];
+    AK_tuple_dict *entry;
+    AK_block *block;
+    AK_rid rid;
+    struct_add *buckets, adds[HASH_BUCKET_SIZE];
+    int modulo, hash, num_adds, row, i;
+
+    buckets = AK_get_hash_buckets(index, &modulo);
+    if (buckets == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    scan = AK_iterator_scan(outer, NULL);
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (AK_join_has_null(join, JOIN_PROBE, scan->value))
+            continue;
+        hash = 0;
+        for (i = 0; i < join->num_join; i++) {
+            key = &scan->value[join->join[JOIN_PROBE][i]];
+            hash += AK_hash_value(key->type, key->data, key->size);
+        }
+        //buckets are chosen by the unsigned hash value like in AK_insert_in_hash_index
+        num_adds = AK_find_in_hash_bucket(&buckets[(unsigned int) hash % modulo], hash, adds);
+
+        //matching rows are copied before they are written, writing can push their blocks out of the cache
+        join->rows.num_rows = 0;
+        join->rows.size = 0;
+        for (row = 0; row < num_adds; row++) {
+            rid.block = adds[row].addBlock;
+            rid.slot = adds[row].indexTd;
+            block = ((AK_mem_block *) AK_get_block(rid.block))->block;
+            //entries of deleted rows are left in the index
+            if (AK_rid_num_attr(block, rid) != join->num_attr[JOIN_BUILD])
+                continue;
+            for (i = 0; i < join->num_attr[JOIN_BUILD]; i++) {
+                entry = &block->tuple_dict[rid.slot + i];
+                inner[i].type = entry->type;
+                inner[i].size = entry->size;
+                inner[i].data = (char *) block->data + entry->address;
+            }
+            if (!AK_join_has_null(join, JOIN_BUILD, inner) && AK_join_compare_keys(join, inner, JOIN_BUILD, scan->value, JOIN_PROBE) == 0)
+                AK_iterator_buffer_add(&join->rows, inner);
+        }
+        for (row = 0; row < join->rows.num_rows; row++) {
+            AK_iterator_buffer_get(&join->rows, row, inner);
+            for (i = 0; i < join->num_out; i++)
+                out[i] = join->out_input[i] == JOIN_BUILD ? inner[join->out_column[i]] : scan->value[join->out_column[i]];
+            AK_join_load_row(&join->loader, out, join->num_out, join->num_joined + 1);
+            join->num_joined++;
+        }
+    }
+    AK_iterator_free(scan);
+    AK_free(buckets);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function prepares a hash join of two tables: finds join attributes in both inputs and the input of every
+          attribute of the joined table (attributes of the first table except join attributes, then all attributes
+          of the second table, as AK_create_join_block_header writes them)
+ * @param join hash join
+ * @param tables names of the first and second table
+ * @param build index of the table that is the build input (0 or 1)
+ * @param att attributes on which we make nat_join
+ * @return EXIT_SUCCESS, EXIT_ERROR if a join attribute does not exist in both tables
+ */
+static int AK_join_init(AK_join_state *join, char **tables, int build, struct list_node *att) {
+    AK_PRO;
+    struct list_node *list_elem;
+    AK_header *header;
+    int input, table, i, j;
+
+    memset(join, 0, sizeof (AK_join_state));
+    for (table = 0; table < 2; table++) {
+        input = table == build ? JOIN_BUILD : JOIN_PROBE;
+        header = (AK_header *) AK_get_header(tables[table]);
+        for (i = 0; i < MAX_ATTRIBUTES && strcmp(header[i].att_name, "") != 0; i++)
+            memcpy(&join->header[input][i], &header[i], sizeof (AK_header));
+        join->num_attr[input] = i;
+        AK_free(header);
+    }
+
+    for (list_elem = Ak_First_L2(att); list_elem != NULL && join->num_join < MAX_ATTRIBUTES; list_elem = list_elem->next) {
+        for (input = 0; input < 2; input++) {
+            for (i = 0; i < join->num_attr[input] && strcmp(join->header[input][i].att_name, list_elem->data) != 0; i++)
+                ;
+            if (i == join->num_attr[input]) {
+                printf("AK_join: ERROR. Join attribute %s does not exist in both tables.\n", list_elem->data);
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            join->join[input][join->num_join] = i;
+        }
+        join->num_join++;
+    }
+
+    for (table = 0; table < 2; table++) {
+        input = table == build ? JOIN_BUILD : JOIN_PROBE;
+        for (i = 0; i < join->num_attr[input] && join->num_out < MAX_ATTRIBUTES; i++) {
+            for (j = 0; table == 0 && j < join->num_join && join->join[input][j] != i; j++)
+                ;
+            if (table == 0 && j < join->num_join)
+                continue;
+            join->out_input[join->num_out] = input;
+            join->out_column[join->num_out] = i;
+            join->num_out++;
+        }
+    }
+    AK_iterator_buffer_init(&join->rows, join->num_attr[JOIN_BUILD]);
+    join->memory = AK_join_forced_memory ? AK_join_forced_memory : JOIN_MEMORY;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function counts blocks of a table from its extents
+ * @param addresses extents of the table
+ * @return number of blocks
+ */
+static int AK_join_blocks(table_addresses *addresses) {
+    int i, blocks = 0;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        blocks += addresses->address_to[i] - addresses->address_from[i];
+    return blocks;
+}
+
+/**
+ * @brief Function checks whether rows of both tables of a join are known to be ordered by join attributes, in
+          ascending order and in the order the attributes are given (see AK_sort_is_ordered)
+ * @param tables names of the first and the second table
+ * @param att join attributes
+ * @return 1 if both tables are ordered, 0 otherwise
+ */
+static int AK_join_ordered(char **tables, struct list_node *att) {
+    AK_PRO;
+    AK_sort_key keys[MAX_ATTRIBUTES];
+    struct list_node *list_elem;
+    int num_keys = 0;
+
+    for (list_elem = Ak_First_L2(att); list_elem != NULL && num_keys < MAX_ATTRIBUTES; list_elem = list_elem->next) {
+        memset(&keys[num_keys], 0, sizeof (AK_sort_key));
+        strncpy(keys[num_keys].att_name, list_elem->data, MAX_ATT_NAME - 1);
+        keys[num_keys].order = SORT_ASC;
+        num_keys++;
+    }
+    num_keys = AK_sort_is_ordered(tables[0], keys, num_keys) && AK_sort_is_ordered(tables[1], keys, num_keys);
+    AK_EPI;
+    return num_keys;
+}
+
+/**
+ * @brief Function chooses the inner table of an index nested-loop join. A table can be the inner table if it has a
+          hash index on join attributes named by AK_hash_index_name that is current (built after the last write to
+          the table, see AK_index_is_current) and join attributes are of types the hash index supports. The join is
+          chosen if reading the index once for every row of the other table reads fewer blocks than scanning the
+          inner table; rows of the other table are counted only if it has no more blocks. Blocks are counted from
+          extents.
+ * @param join join
+ * @param tables names of the first and the second table
+ * @param addresses extents of the first and the second table
+ * @param att join attributes
+ * @param index name of the index of the chosen inner table is written to it
+ * @return index of the inner table (0 or 1), -1 if tables are not joined through an index
+ */
+static int AK_join_index_choice(AK_join_state *join, char **tables, table_addresses **addresses, struct list_node *att, char *index) {
+    AK_PRO;
+    int inner, blocks[2], i, type, rows;
+
+    for (i = 0; i < 2 * join->num_join; i++) {
+        type = join->header[i % 2][join->join[i % 2][i / 2]].type;
+        if (type != TYPE_INT && type != TYPE_VARCHAR) {
+            AK_EPI;
+            return -1;
+        }
+    }
+    blocks[0] = AK_join_blocks(addresses[0]);
+    blocks[1] = AK_join_blocks(addresses[1]);
+    for (inner = 0; inner < 2; inner++) {
+        if (blocks[1 - inner] > blocks[inner])
+            continue;
+        AK_hash_index_name(tables[inner], att, index);
+        if (!AK_index_is_current(index))
+            continue;
+        rows = AK_get_num_records(tables[1 - inner]);
+        if (rows * JOIN_INDEX_PROBE_BLOCKS < blocks[inner]) {
+            AK_EPI;
+            return inner;
+        }
+    }
+    AK_EPI;
+    return -1;
+}
+
+/**
+ * @brief Function joins two tables with a merge join or a hash join into a new table
+ * @param srcTable1 name of the first table to join
+ * @param srcTable2 name of the second table to join
+ * @param dstTable name of the nat_join table
+ * @param att attributes on which we make nat_join
+ * @param merge 1 for a merge join, 0 for a hash join
+ * @return EXIT_SUCCESS, EXIT_ERROR if tables cannot be joined
+ */
+static int AK_join_execute(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att, int merge) {
+    AK_PRO;
+    table_addresses *src_addr1 = (table_addresses *) AK_get_table_addresses(srcTable1);
+    table_addresses *src_addr2 = (table_addresses *) AK_get_table_addresses(srcTable2);
+    table_addresses *addresses[2] = {src_addr1, src_addr2};
+    char *tables[2] = {srcTable1, srcTable2}, index[MAX_VARCHAR_LENGTH];
+    AK_join_state join;
+    int build, inner = -1, mark, result = EXIT_SUCCESS;
+
+    if (src_addr1->address_from[0] == 0 || src_addr2->address_from[0] == 0) {
+        Ak_dbg_messg(LOW, REL_OP, "\n AK_join: Table/s doesn't exist!");
+        AK_free(src_addr1);
+        AK_free(src_addr2);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    build = AK_join_blocks(src_addr2) <= AK_join_blocks(src_addr1) ? 1 : 0;
+    if (AK_join_init(&join, tables, build, att) == EXIT_ERROR) {
+        AK_free(src_addr1);
+        AK_free(src_addr2);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    //the inner table of an index nested-loop join takes the place of the build input
+    if (!merge)
+        inner = AK_join_index_choice(&join, tables, addresses, att, index);
+    if (inner != -1 && inner != build) {
+        build = inner;
+        AK_iterator_buffer_free(&join.rows);
+        AK_join_init(&join, tables, build, att);
+    }
+    AK_create_join_block_header(src_addr1->address_from[0], src_addr2->address_from[0], dstTable, att);
+    Ak_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s and %s\n", dstTable, srcTable1, srcTable2);
+    AK_bulk_begin(&join.loader, dstTable);
+
+    if (inner != -1 && AK_join_index_rows(&join, tables[1 - build], index) == EXIT_ERROR)
+        inner = -1;
+    if (merge) {
+        result = AK_join_merge_rows(&join, tables[build], tables[1 - build]);
+        if (result == JOIN_UNORDERED) {
+            //the order was wrong, rows joined so far are thrown away and tables are joined again by hashing
+            Ak_dbg_messg(LOW, REL_OP, "AK_join: tables %s and %s are not ordered by join attributes, hash join is used\n", srcTable1, srcTable2);
+            AK_bulk_end(&join.loader);
+            AK_delete_segment(dstTable, SEGMENT_TYPE_TABLE);
+            AK_create_join_block_header(src_addr1->address_from[0], src_addr2->address_from[0], dstTable, att);
+            AK_bulk_begin(&join.loader, dstTable);
+            join.num_joined = 0;
+            merge = 0;
+        }
+    }
+    AK_free(src_addr1);
+    AK_free(src_addr2);
+
+    if (!merge && inner == -1) {
+        //temporary segments of partitions are deleted when the join ends
+        mark = AK_temp_begin();
+        result = AK_join_tables(&join, tables[build], tables[1 - build], 0);
+        AK_temp_end(mark);
+    }
+    AK_bulk_end(&join.loader);
+
+    Ak_dbg_messg(LOW, REL_OP, "AK_join: %d rows joined into %s by %s join, %d partitions written, depth %d\n", join.num_joined,
+            dstTable, merge ? "merge" : inner != -1 ? "index nested-loop" : "hash", join.num_spilled, join.max_depth);
+    AK_join_last_spilled = join.num_spilled;
+    AK_join_last_depth = join.max_depth;
+    AK_join_last_merge = merge;
+    AK_join_last_index = inner != -1;
+    AK_iterator_buffer_free(&join.rows);
+    AK_free(join.row_hash);
+    AK_free(join.row_partition);
+    AK_free(join.chain);
+    AK_free(join.buckets);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function to make nat_join betwen two tables on some attributes with a merge join, for tables ordered by join
+          attributes (ascending, in the order the attributes are given). Both tables are read once, side by side.
+          The order is checked while rows are read; if it is wrong, the tables are joined with a hash join instead.
+ * @param srcTable1 name of the first table to join
+ * @param srcTable2 name of the second table to join
+ * @param dstTable name of the nat_join table
+ * @param att attributes on which we make nat_join
+ * @return if success returns EXIT_SUCCESS
+ */
+int AK_join_merge(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att) {
+    AK_PRO;
+    int result = AK_join_execute(srcTable1, srcTable2, dstTable, att, 1);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function to make nat_join betwen two tables on some attributes. If both tables are known to be ordered by
+          join attributes (see AK_sort_is_ordered), they are joined with a merge join (see AK_join_merge). If one
+          table has a hash index on join attributes (named by AK_hash_index_name) and the other table has so few rows
+          that looking them up reads fewer blocks than a scan, rows are looked up in the index (index nested-loop
+          join). Otherwise the table with fewer blocks is the build input of a hash join: its rows are read into memory and chained in
+          buckets by hash of their join values, then every row of the other table is looked up in its bucket. Values
+          are hashed and compared by their types, and null join values match no row. If build rows take more than the
+          memory set by AK_join_set_memory, the join becomes a hybrid hash join over temporary segments, which are
+          deleted when the join ends.
+ * @param srcTable1 name of the first table to join
+ * @param srcTable2 name of the second table to join
+ * @param att attributes on which we make nat_join
+ * @param dstTable name of the nat_join table
+ * @return if success returns EXIT_SUCCESS
+ */
+int AK_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att) {
+    AK_PRO;
+    char *tables[2] = {srcTable1, srcTable2};
+    int result = AK_join_execute(srcTable1, srcTable2, dstTable, att, AK_join_ordered(tables, att));
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function creates two tables for the hash join test: join_left_n with n rows (id, key) and join_right_n with
+          n / 8 rows (key, name), so every left row is joined with one right row
+ * @param n number of left rows
+ * @return No return value
+ */
+static void AK_join_test_tables(int n) {
+    AK_header header[3], *temp;
+    AK_bulk_loader loader;
+    char table[MAX_ATT_NAME], name[MAX_VARCHAR_LENGTH], *data[2];
+    int type[2], size[2], id, key, i;
+
+    for (i = 0; i < 2; i++) {
+        temp = (AK_header *) AK_create_header(i == 0 ? "id" : "key", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[0], temp, sizeof (AK_header));
+        AK_free(temp);
+        temp = (AK_header *) AK_create_header(i == 0 ? "key" : "name", i == 0 ? TYPE_INT : TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[1], temp, sizeof (AK_header));
+        AK_free(temp);
+        memset(&header[2], 0, sizeof (AK_header));
+        sprintf(table, i == 0 ? "join_left_%d" : "join_right_%d", n);
+        AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, header);
+
+        AK_bulk_begin(&loader, table);
+        for (id = 0; id < (i == 0 ? n : n / 8); id++) {
+            key = i == 0 ? (id * 7) % (n / 8) : id;
+            sprintf(name, "name%d", id);
+            type[0] = TYPE_INT;
+            type[1] = i == 0 ? TYPE_INT : TYPE_VARCHAR;
+            data[0] = i == 0 ? (char *) &id : (char *) &key;
+            data[1] = i == 0 ? (char *) &key : name;
+            size[0] = sizeof (int);
+            size[1] = i == 0 ? sizeof (int) : strlen(name);
+            AK_bulk_add_row(&loader, type, data, size, (i == 0 ? n : n / 8) - id);
+        }
+        AK_bulk_end(&loader);
+    }
+}
+
+/**
+ * @brief Function creates two tables with skewed keys for the hash join test: join_skew_build with 300 rows (key,
+          name), 200 of them with key 0, and join_skew_probe with 50 rows (id, key), 10 of them with key 0
+ * @return No return value
+ */
+static void AK_join_test_skew_tables() {
+    AK_header header[3], *temp;
+    AK_bulk_loader loader;
+    char *table[2] = {"join_skew_build", "join_skew_probe"}, name[MAX_VARCHAR_LENGTH], *data[2];
+    int type[2], size[2], id, key, i;
+
+    for (i = 0; i < 2; i++) {
+        temp = (AK_header *) AK_create_header(i == 0 ? "key" : "id", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[0], temp, sizeof (AK_header));
+        AK_free(temp);
+        temp = (AK_header *) AK_create_header(i == 0 ? "name" : "key", i == 0 ? TYPE_VARCHAR : TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[1], temp, sizeof (AK_header));
+        AK_free(temp);
+        memset(&header[2], 0, sizeof (AK_header));
+        AK_initialize_new_segment(table[i], SEGMENT_TYPE_TABLE, header);
+
+        AK_bulk_begin(&loader, table[i]);
+        for (id = 0; id < (i == 0 ? 300 : 50); id++) {
+            key = i == 0 ? (id < 200 ? 0 : id) : (id < 10 ? 0 : 200 + id);
+            sprintf(name, "name%d", key);
+            type[0] = TYPE_INT;
+            type[1] = i == 0 ? TYPE_VARCHAR : TYPE_INT;
+            data[0] = i == 0 ? (char *) &key : (char *) &id;
+            data[1] = i == 0 ? name : (char *) &key;
+            size[0] = sizeof (int);
+            size[1] = i == 0 ? strlen(name) : sizeof (int);
+            AK_bulk_add_row(&loader, type, data, size, (i == 0 ? 300 : 50) - id);
+        }
+        AK_bulk_end(&loader);
+    }
+}
+
+/**
+ * @brief Function creates the outer table of the index nested-loop join test: join_outer with JOIN_TEST_OUTER_ROWS
+          rows (id, key), keys as in join_left_4000
+ * @return No return value
+ */
+static void AK_join_test_outer_table() {
+    AK_header header[3], *temp;
+    AK_bulk_loader loader;
+    char *data[2];
+    int type[2] = {TYPE_INT, TYPE_INT}, size[2] = {sizeof (int), sizeof (int)}, id, key, i;
+
+    for (i = 0; i < 2; i++) {
+        temp = (AK_header *) AK_create_header(i == 0 ? "id" : "key", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[i], temp, sizeof (AK_header));
+        AK_free(temp);
+    }
+    memset(&header[2], 0, sizeof (AK_header));
+    AK_initialize_new_segment("join_outer", SEGMENT_TYPE_TABLE, header);
+
+    AK_bulk_begin(&loader, "join_outer");
+    for (id = 0; id < JOIN_TEST_OUTER_ROWS; id++) {
+        key = (id * 7) % 500;
+        data[0] = (char *) &id;
+        data[1] = (char *) &key;
+        AK_bulk_add_row(&loader, type, data, size, JOIN_TEST_OUTER_ROWS - id);
+    }
+    AK_bulk_end(&loader);
+}
+
+/**
+ * @brief Function checks a joined table of join_skew_probe and join_skew_build: every row has to hold the key of its
+          probe row and the name of its build row
+ * @param table joined table
+ * @param rows number of rows of the table
+ * @return 1 if all rows are joined correctly, 0 otherwise
+ */
+static int AK_join_test_skew_check(char *table, int *rows) {
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+    char name[MAX_VARCHAR_LENGTH];
+    int id, key, correct = 1;
+
+    *rows = 0;
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        memcpy(&id, scan->value[0].data, sizeof (int));
+        memcpy(&key, scan->value[1].data, sizeof (int));
+        sprintf(name, "name%d", key);
+        correct &= key == (id < 10 ? 0 : 200 + id) && scan->value[2].size == (int) strlen(name)
+                && memcmp(scan->value[2].data, name, scan->value[2].size) == 0;
+        (*rows)++;
+    }
+    AK_iterator_free(scan);
+    return correct;
+}
+
+/**
+ * @brief Function checks a joined table of the hash join test: every row has to hold the key of its left row and
+          the name of the right row with that key. Hashes of rows are summed, so tables with the same rows in any
+          order have the same sum.
+ * @param table joined table
+ * @param n number of left rows
+ * @param rows number of rows of the table
+ * @param checksum sum of row hashes
+ * @return 1 if all rows are joined correctly, 0 otherwise
+ */
+static int AK_join_test_check(char *table, int n, int *rows, unsigned long *checksum) {
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+    char name[MAX_VARCHAR_LENGTH];
+    unsigned int hash;
+    int id, key, i, j, correct = 1;
+
+    *rows = 0;
+    *checksum = 0;
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        memcpy(&id, scan->value[0].data, sizeof (int));
+        memcpy(&key, scan->value[1].data, sizeof (int));
+        sprintf(name, "name%d", key);
+        correct &= key == (id * 7) % (n / 8) && scan->value[2].size == (int) strlen(name)
+                && memcmp(scan->value[2].data, name, scan->value[2].size) == 0;
+        hash = JOIN_HASH_SEED;
+        for (i = 0; i < scan->num_attr; i++) {
+            hash = (hash ^ (unsigned int) scan->value[i].type) * 16777619u;
+            for (j = 0; j < scan->value[i].size; j++)
+                hash = (hash ^ (unsigned char) scan->value[i].data[j]) * 16777619u;
+        }
+        *checksum += hash;
+        (*rows)++;
+    }
+    AK_iterator_free(scan);
+    return correct;
+}
+
 /**
  * @author Matija Novak
  * @brief Function for natural join testing
@@ -359,8 +1506,135 @@ void AK_op_join_test() {
     AK_join("employee", "department", "nat_join_test", att);
     AK_print_table("nat_join_test");
 
-    
     Ak_DeleteAll_L3(&att);
+
+    //hash join against block nested loop join for tables of growing size, and in memory against partitions
+    printf("\n********** HASH JOIN TEST **********\n\n");
+    char left[MAX_ATT_NAME], right[MAX_ATT_NAME], result[MAX_ATT_NAME];
+    struct timespec start, end;
+    double seconds[2];
+    unsigned long checksum[2];
+    int n, rows[2], correct[2], partitions, mark, success = 1;
+
+    Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "key", sizeof ("key"), att);
+    for (n = 1000; n <= 4000; n *= 2) {
+        AK_join_test_tables(n);
+        sprintf(left, "join_left_%d", n);
+        sprintf(right, "join_right_%d", n);
+        sprintf(result, "join_hash_%d", n);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        AK_join(left, right, result, att);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds[0] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+        correct[0] = AK_join_test_check(result, n, &rows[0], &checksum[0]);
+        success &= correct[0] && rows[0] == n;
+        printf("%d x %d rows: hash join %d rows, %.3f s, correct: %d\n", n, n / 8, rows[0], seconds[0], correct[0]);
+    }
+
+    n /= 2;
+    sprintf(result, "join_partitioned_%d", n);
+    partitions = AK_join_set_memory(8 * 1024);
+    mark = AK_temp_begin();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    AK_join(left, right, result, att);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    AK_join_set_memory(0);
+    seconds[1] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+    correct[1] = AK_join_test_check(result, n, &rows[1], &checksum[1]);
+    success &= correct[1] && rows[1] == rows[0] && checksum[1] == checksum[0] && AK_join_last_spilled > 0 && AK_temp_begin() == mark;
+    printf("%d x %d rows with %d KiB of memory: %d rows, %.3f s, %d partitions written, same rows: %d\n", n, n / 8,
+            partitions / 1024, rows[1], seconds[1], AK_join_last_spilled, rows[1] == rows[0] && checksum[1] == checksum[0]);
+
+    //200 build rows with one key cannot be split by partitioning, so partitions are split until JOIN_MAX_DEPTH
+    AK_join_test_skew_tables();
+    AK_join_set_memory(4 * 1024);
+    AK_join("join_skew_probe", "join_skew_build", "join_skew", att);
+    AK_join_set_memory(0);
+    correct[1] = AK_join_test_skew_check("join_skew", &rows[1]);
+    success &= correct[1] && rows[1] == 10 * 200 + 40 && AK_join_last_depth == JOIN_MAX_DEPTH && AK_temp_begin() == mark;
+    printf("skewed keys with 4 KiB of memory: %d rows, correct: %d, %d partitions written, depth %d\n", rows[1], correct[1],
+            AK_join_last_spilled, AK_join_last_depth);
+
+    //tables sorted by the join attribute are joined with a merge join, duplicate runs on both sides
+    printf("\n********** MERGE JOIN TEST **********\n\n");
+    AK_sort_key key;
+    memset(&key, 0, sizeof (AK_sort_key));
+    strcpy(key.att_name, "key");
+    key.order = SORT_ASC;
+    sprintf(result, "join_left_sorted_%d", n);
+    AK_sort_table(left, result, &key, 1);
+    sprintf(left, "join_left_sorted_%d", n);
+    sprintf(result, "join_right_sorted_%d", n);
+    AK_sort_table(right, result, &key, 1);
+    sprintf(right, "join_right_sorted_%d", n);
+    sprintf(result, "join_merge_%d", n);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    AK_join(left, right, result, att);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds[1] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+    correct[1] = AK_join_test_check(result, n, &rows[1], &checksum[1]);
+    success &= AK_join_last_merge && correct[1] && rows[1] == rows[0] && checksum[1] == checksum[0];
+    printf("%d x %d sorted rows: merge join %d, %d rows, %.3f s (hash join %.3f s), same rows: %d\n", n, n / 8,
+            AK_join_last_merge, rows[1], seconds[1], seconds[0], rows[1] == rows[0] && checksum[1] == checksum[0]);
+
+    AK_sort_table("join_skew_build", "join_skew_build_sorted", &key, 1);
+    AK_sort_table("join_skew_probe", "join_skew_probe_sorted", &key, 1);
+    AK_join("join_skew_probe_sorted", "join_skew_build_sorted", "join_skew_merge", att);
+    correct[1] = AK_join_test_skew_check("join_skew_merge", &rows[1]);
+    success &= AK_join_last_merge && correct[1] && rows[1] == 10 * 200 + 40;
+    printf("skewed keys sorted: merge join %d, %d rows, correct: %d\n", AK_join_last_merge, rows[1], correct[1]);
+
+    //a table declared ordered, but not ordered, is joined by hashing after the merge join finds the wrong order
+    AK_sort_set_order("join_left_1000", &key, 1);
+    AK_sort_set_order("join_right_1000", &key, 1);
+    AK_join("join_left_1000", "join_right_1000", "join_unordered_1000", att);
+    correct[1] = AK_join_test_check("join_unordered_1000", 1000, &rows[1], &checksum[1]);
+    success &= !AK_join_last_merge && correct[1] && rows[1] == 1000;
+    printf("1000 x 125 rows declared ordered: merge join %d, %d rows, correct: %d\n", AK_join_last_merge, rows[1], correct[1]);
+
+    //a few rows are joined with a large table through its hash index on the join attribute
+    printf("\n********** INDEX NESTED-LOOP JOIN TEST **********\n\n");
+    char index[MAX_VARCHAR_LENGTH];
+    AK_join_test_outer_table();
+    AK_hash_index_name("join_right_4000", att, index);
+    AK_create_hash_index("join_right_4000", att, index);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    AK_join("join_outer", "join_right_4000", "join_index", att);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds[1] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+    correct[1] = AK_join_test_check("join_index", 4000, &rows[1], &checksum[1]);
+    success &= AK_join_last_index && correct[1] && rows[1] == JOIN_TEST_OUTER_ROWS;
+    printf("%d x 500 rows: index nested-loop join %d, %d rows, %.3f s, correct: %d\n", JOIN_TEST_OUTER_ROWS,
+            AK_join_last_index, rows[1], seconds[1], correct[1]);
+    //block nested loop join reads every pair of blocks, so it is only timed with the small outer table
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    AK_join_nested_loop("join_outer", "join_right_4000", "join_loop", att);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds[0] = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+    AK_join_test_check("join_loop", 4000, &rows[0], &checksum[0]);
+    printf("%d x 500 rows: block nested loop join %d rows, %.3f s\n", JOIN_TEST_OUTER_ROWS, rows[0], seconds[0]);
+    AK_join("join_left_1000", "join_right_4000", "join_index_large", att);
+    correct[1] = AK_join_test_check("join_index_large", 1000, &rows[1], &checksum[1]);
+    success &= !AK_join_last_index && correct[1] && rows[1] == 1000;
+    printf("1000 x 500 rows: index nested-loop join %d, %d rows, correct: %d\n", AK_join_last_index, rows[1], correct[1]);
+
+    //a row inserted after the index was built is not in the index, so the index is not used until it is built again
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    Ak_Init_L3(&row_root);
+    int new_key = -1;
+    Ak_Insert_New_Element(TYPE_INT, &new_key, "join_right_4000", "key", row_root);
+    Ak_Insert_New_Element(TYPE_VARCHAR, "name-1", "join_right_4000", "name", row_root);
+    Ak_insert_row(row_root);
+    Ak_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_join("join_outer", "join_right_4000", "join_index_stale", att);
+    correct[1] = AK_join_test_check("join_index_stale", 4000, &rows[1], &checksum[1]);
+    success &= !AK_join_last_index && correct[1] && rows[1] == JOIN_TEST_OUTER_ROWS;
+    printf("%d x 501 rows after an insert: index nested-loop join %d, %d rows, correct: %d\n", JOIN_TEST_OUTER_ROWS,
+            AK_join_last_index, rows[1], correct[1]);
+
+    printf("\nTest %s\n", success ? "SUCCESS" : "FAILED");
+    Ak_DeleteAll_L3(&att);
+    AK_free(att);
     AK_EPI;
 }
-
@@ -22,7 +22,43 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../rel/projection.h"
+#include "../rel/iterator.h"
+#include "../file/filesort.h"
+#include "../file/bulkload.h"
+#include "../file/idx/hash.h"
 #include "../auxi/mempro.h"
+
+/**
+  * @def JOIN_MEMORY
+  * @brief Constant declaring default number of bytes of memory for rows of the build input of a hash join
+  */
+#define JOIN_MEMORY (4 * 1024 * 1024)
+
+/**
+  * @def JOIN_MAX_PARTITIONS
+  * @brief Constant declaring maximal number of partitions of a hash join whose build input does not fit in memory
+  */
+#define JOIN_MAX_PARTITIONS 32
+
+/**
+  * @def JOIN_MAX_DEPTH
+  * @brief Constant declaring maximal number of times partitions of a hash join are partitioned again
+  */
+#define JOIN_MAX_DEPTH 3
+
+/**
+  * @def JOIN_UNORDERED
+  * @brief Constant returned by a merge join whose input is not ordered by join attributes
+  */
+#define JOIN_UNORDERED 2
+
+/**
+  * @def JOIN_INDEX_PROBE_BLOCKS
+  * @brief Constant declaring estimated number of blocks read for one row of the outer table of an index nested-loop
+           join (a hash bucket and the block of the matching row)
+  */
+#define JOIN_INDEX_PROBE_BLOCKS 2
+
 /*
 void AK_create_join_block_header(int table_address1, int table_address2, char *new_table, AK_list *att);
 void AK_merge_block_join(AK_list *row_root, AK_list *row_root_insert, AK_block *temp_block, char *new_table);
@@ -31,6 +67,9 @@ void AK_create_join_block_header(int table_address1, int table_address2, char *n
 void AK_merge_block_join(struct list_node *row_root, struct list_node *row_root_insert, AK_block *temp_block, char *new_table);
 void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, struct list_node *att, char *new_table);
 //int AK_join(char *srcTable1, char * srcTable2, char * dstTable, AK_list *att);
+int AK_join_nested_loop(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att);
+int AK_join_set_memory(int bytes);
+int AK_join_merge(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att);
 int AK_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *att);
 void AK_op_join_test();
 
@@ -168,9 +168,50 @@ void AK_copy_block_projection(AK_block *old_block, struct list_node *att, char *
     AK_free(row_root);
 }
 
+/**
+ * @struct AK_projection_context
+ * @brief Structure that holds a projection shared by all scan workers
+ */
+typedef struct {
+    /// number of attributes of the source table
+    int num_attr;
+    /// indexes of source attributes copied to the projection table, in the order of the source header
+    int columns[MAX_ATTRIBUTES];
+    /// number of copied attributes
+    int num_columns;
+} AK_projection_context;
+
+/**
+ * @brief  Function copies projected values of all rows of a block, like AK_copy_block_projection, called by scan workers
+ * @param block block read by the worker
+ * @param context projection (AK_projection_context)
+ * @param result rows copied by the worker (AK_scan_rows)
+ * @return EXIT_SUCCESS
+ */
+static int AK_projection_block(AK_block *block, void *context, void *result) {
+    AK_projection_context *projection = (AK_projection_context *) context;
+    int columns[MAX_ATTRIBUTES];
+    int i, k, num_columns, overflow;
+    AK_tuple_dict *entry;
+
+    for (k = 0; k + projection->num_attr <= DATA_BLOCK_SIZE; k += projection->num_attr) {
+        //only values with data are copied, a row without any of them is not inserted
+        for (i = num_columns = 0; i < projection->num_columns; i++) {
+            entry = &block->tuple_dict[k + projection->columns[i]];
+            overflow = entry->size + entry->address;
+            if (entry->size != 0 && overflow < block->AK_free_space + 1 && overflow > -1)
+                columns[num_columns++] = projection->columns[i];
+        }
+        if (num_columns > 0)
+            AK_scan_rows_add((AK_scan_rows *) result, block, k, columns, num_columns);
+    }
+    return EXIT_SUCCESS;
+}
+
 /**
  * @author Matija Novak, rewrited and optimized by Dino Laktašić, now support cacheing
- * @brief  Function makes a projection of some table
+ * @brief  Function makes a projection of some table. Blocks of the source table are scanned by a pool of workers
+ *         (see scan.c) which copy projected values, rows are inserted in the order of blocks.
  * @param att - list of atributes on which we make projection
  * @param dstTable table name for projection table
  * @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR
@@ -188,32 +229,40 @@ int AK_projection(char *srcTable, char *dstTable, struct list_node *att) {
         Ak_dbg_messg(LOW, REL_OP, "TABLE %s CREATED from %s!\n", dstTable, srcTable);
         Ak_dbg_messg(MIDDLE, REL_OP, "\nAK_projection: start copying data\n");
 
-        int startAddress = 0, i = 0, j;
-
-        //for each extent that contains blocks needed for projection
-        for (i = 0; src_addr->address_from[i] != 0; i++) { //MAX_EXTENTS_IN_SEGMENT
-            startAddress = src_addr->address_from[i];
-
-            if (startAddress != 0) {
-                Ak_dbg_messg(MIDDLE, REL_OP, "\nAK_projection: copy extent: %d\n", i);
-
-                //for each block in extent
-                for (j = startAddress; j <= src_addr->address_to[i]; j++) {
-                    AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
-                    //AK_block *temp = (AK_block *) AK_read_block(j);
-
-                    if (temp->block->last_tuple_dict_id == 0) {
-                        break;
-                    }
+        AK_header *header = (AK_header *) AK_get_header(srcTable);
+        struct list_node *row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
+        struct list_node *list_elem;
+        AK_projection_context projection;
+        AK_scan_rows rows[SCAN_MAX_WORKERS];
+        int i, head, offset, num_workers;
+
+        Ak_Init_L3(&row_root);
+
+        //attributes are copied in the order of the source header, as in AK_copy_block_projection
+        projection.num_attr = AK_num_attr(srcTable);
+        projection.num_columns = 0;
+        for (head = 0; head < projection.num_attr; head++) {
+            for (list_elem = Ak_First_L2(att); list_elem != NULL; list_elem = list_elem->next) {
+                if (strcmp(list_elem->data, header[head].att_name) == 0 && projection.num_columns < MAX_ATTRIBUTES)
+                    projection.columns[projection.num_columns++] = head;
+            }
+        }
 
-                    Ak_dbg_messg(MIDDLE, REL_OP, "\nAK_projection: copy block: %d\n", j);
+        memset(rows, 0, sizeof (rows));
+        num_workers = AK_scan_parallel(src_addr, NULL, NULL, AK_projection_block, &projection, rows, sizeof (AK_scan_rows));
 
-                    //get projection tuples from block
-                    AK_copy_block_projection(temp->block, att, dstTable);
-                }
-            } else break;
+        for (i = 0; i < num_workers; i++) {
+            offset = 0;
+            while (AK_scan_rows_next(&rows[i], &offset, dstTable, header, row_root)) {
+                Ak_dbg_messg(HIGH, REL_OP, "\nInsert row to projection table.\n");
+                Ak_insert_row(row_root);
+                Ak_DeleteAll_L3(&row_root);
+            }
+            AK_scan_rows_free(&rows[i]);
         }
-		
+
+        AK_free(row_root);
+        AK_free(header);
         AK_free(src_addr);
         Ak_dbg_messg(LOW, REL_OP, "PROJECTION_TEST_SUCCESS\n\n");
 	AK_EPI;
@@ -21,9 +21,50 @@
 
 
 
+/**
+ * @struct AK_selection_context
+ * @brief Structure that holds a selection shared by all scan workers
+ */
+typedef struct {
+    /// compiled expression, NULL if expression could not be compiled
+    AK_predicate *predicate;
+    /// number of attributes of the source table
+    int num_attr;
+    /// indexes of all attributes
+    int columns[MAX_ATTRIBUTES];
+    /// maximal number of rows one worker copies, 0 for all rows
+    int limit;
+} AK_selection_context;
+
+/**
+ * @brief  Function copies rows of a block that satisfy compiled expression, called by scan workers
+ * @param block block read by the worker
+ * @param context selection (AK_selection_context)
+ * @param result rows copied by the worker (AK_scan_rows)
+ * @return EXIT_SUCCESS, SCAN_SATISFIED when the worker has copied as many rows as the selection is limited to
+ */
+static int AK_selection_block(AK_block *block, void *context, void *result) {
+	AK_selection_context *selection = (AK_selection_context *) context;
+	int k;
+
+	for (k = 0; k + selection->num_attr <= DATA_BLOCK_SIZE; k += selection->num_attr) {
+		if (block->tuple_dict[k].type == FREE_INT)
+			break;
+		if (block->tuple_dict[k].type == 0)
+			continue;
+		if (selection->predicate != NULL && !AK_predicate_eval(selection->predicate, block, k))
+			continue;
+		AK_scan_rows_add((AK_scan_rows *) result, block, k, selection->columns, selection->num_attr);
+		if (((AK_scan_rows *) result)->num_rows == selection->limit)
+			return SCAN_SATISFIED;
+	}
+	return EXIT_SUCCESS;
+}
+
 /**
  * @author Matija Šestak.
- * @brief  Function which implements selection
+ * @brief  Function which implements selection. Blocks of the source table are scanned by a pool of workers (see
+ *         scan.c) which evaluate compiled expression and copy matching rows, rows are inserted in the order of blocks.
  * @param *srcTable source table name
  * @param *dstTable destination table name
  * @param *expr list with posfix notation of the logical expression
@@ -31,6 +72,22 @@
  */
 //int AK_selection(char *srcTable, char *dstTable, AK_list *expr) {
 int AK_selection(char *srcTable, char *dstTable, struct list_node *expr) {
+	AK_PRO;
+	int result = AK_selection_limit(srcTable, dstTable, expr, 0);
+	AK_EPI;
+	return result;
+}
+
+/**
+ * @brief  Function which implements selection of at most limit rows (the first ones in the order of blocks), for
+ *         existence checks and previews. Scan workers stop reading blocks once the rows are found.
+ * @param *srcTable source table name
+ * @param *dstTable destination table name
+ * @param *expr list with posfix notation of the logical expression
+ * @param limit maximal number of selected rows, 0 for all rows
+ * @return EXIT_SUCCESS
+ */
+int AK_selection_limit(char *srcTable, char *dstTable, struct list_node *expr, int limit) {
         AK_PRO;
 	AK_header *t_header = (AK_header *) AK_get_header(srcTable);
 	int num_attr = AK_num_attr(srcTable);
@@ -51,39 +108,42 @@ int AK_selection(char *srcTable, char *dstTable, struct list_node *expr) {
 		struct list_node * row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
 		Ak_Init_L3(&row_root);
 		
-		int i, j, k, l, type, size, address;
-		char data[MAX_VARCHAR_LENGTH];
-
-		for (i = 0; src_addr->address_from[i] != 0; i++) {
-
-			for (j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
-
-				AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
-				if (temp->block->last_tuple_dict_id == 0)
-					break;
-				for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-
-					if (temp->block->tuple_dict[k].type == FREE_INT)
-						break;
-
-					for (l = 0; l < num_attr; l++) {
-						type = temp->block->tuple_dict[k + l].type;
-						size = temp->block->tuple_dict[k + l].size;
-						address = temp->block->tuple_dict[k + l].address;
-						memcpy(data, &(temp->block->data[address]), size);
-						data[size] = '\0';
-						Ak_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
-					}
-
-					if (AK_check_if_row_satisfies_expression(row_root, expr))
-						Ak_insert_row(row_root);
-
-					
-					Ak_DeleteAll_L3(&row_root);
+		int i, offset, num_workers, num_rows = 0;
+		AK_selection_context selection;
+		AK_scan_rows rows[SCAN_MAX_WORKERS];
+
+		//expression is compiled once, rows that fail it are never copied into a list
+		selection.predicate = AK_predicate_compile(expr, t_header, num_attr, num_attr);
+		selection.num_attr = num_attr;
+		for (i = 0; i < num_attr; i++)
+			selection.columns[i] = i;
+		//rows of an expression that is not compiled are checked after the scan, so its workers cannot stop early
+		selection.limit = selection.predicate != NULL && limit > 0 ? limit : 0;
+
+		//blocks whose zone maps or Bloom filters prove the expression false are not read
+		AK_zone_filter filter;
+		AK_zone_map *map = AK_zone_map_get(srcTable);
+		AK_zone_filter_init(&filter);
+		if (selection.predicate != NULL)
+			AK_predicate_ranges(selection.predicate, num_attr, &filter);
+
+		memset(rows, 0, sizeof (rows));
+		num_workers = AK_scan_parallel(src_addr, map, &filter, AK_selection_block, &selection, rows, sizeof (AK_scan_rows));
+
+		for (i = 0; i < num_workers; i++) {
+			offset = 0;
+			while ((limit <= 0 || num_rows < limit) && AK_scan_rows_next(&rows[i], &offset, dstTable, t_header, row_root)) {
+				if (selection.predicate != NULL || AK_check_if_row_satisfies_expression(row_root, expr)) {
+					Ak_insert_row(row_root);
+					num_rows++;
 				}
+
+				Ak_DeleteAll_L3(&row_root);
 			}
+			AK_scan_rows_free(&rows[i]);
 		}
 
+		AK_predicate_free(selection.predicate);
 		AK_free(src_addr);
 		AK_free(t_header);
 		AK_free(row_root);
@@ -140,6 +200,12 @@ void AK_op_selection_test() {
 	Ak_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof ("OR"), expr1);
 	printf("\nQUERY: SELECT * FROM student WHERE weight > 83.750 OR firstname = 'Dino';\n\n");
 	AK_selection(srcTable1, destTable1, expr1);
+
+	printf("\nQUERY: SELECT * FROM student WHERE weight > 83.750 OR firstname = 'Dino' LIMIT 2;\n\n");
+	AK_selection_limit(srcTable1, "selection_test_limit", expr1, 2);
+	printf("Limited selection returned %d of %d rows: %s\n", AK_get_num_records("selection_test_limit"),
+		AK_get_num_records(destTable1),
+		AK_get_num_records("selection_test_limit") == (AK_get_num_records(destTable1) < 2 ? AK_get_num_records(destTable1) : 2) ? "SUCCESS" : "FAILED");
 	printf("\n Test is successful :) \n");
 	Ak_DeleteAll_L3(&expr1);
 	AK_free(expr1);
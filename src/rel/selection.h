@@ -25,10 +25,13 @@
 #include "../auxi/constants.h"
 #include "../auxi/configuration.h"
 #include "../file/files.h"
+#include "../file/zonemap.h"
+#include "../file/scan.h"
 #include "../auxi/mempro.h"
 
 //int AK_selection(char *srcTable, char *dstTable, AK_list *expr);
 int AK_selection(char *srcTable, char *dstTable, struct list_node *expr);
+int AK_selection_limit(char *srcTable, char *dstTable, struct list_node *expr, int limit);
 void AK_op_selection_test();
 void AK_op_selection_test2();
 void AK_op_selection_test_redolog();
@@ -0,0 +1,684 @@
+/**
+@file set_op.c Provides functions for hash based set operations (union, intersect and difference)
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <time.h>
+#include "set_op.h"
+
+/**
+  * @def SET_OP_HASH_SEED
+  * @brief Initial value of hashes of rows (FNV-1a)
+  */
+#define SET_OP_HASH_SEED 2166136261u
+
+/// bytes of memory for distinct rows set by AK_set_op_set_memory, 0 if SET_OP_MEMORY is used
+static int AK_set_op_forced_memory = 0;
+
+/// number of partitions written to temporary segments by the last set operation
+static int AK_set_op_last_spilled = 0;
+
+/// deepest partitioning of the last set operation, 0 if it was done in memory
+static int AK_set_op_last_depth = 0;
+
+/**
+ * @struct AK_set_op_state
+ * @brief Structure that holds state of one set operation. Distinct rows are kept in memory, chained in buckets by
+          their hashes, with the number of copies of every row in the first and in the second table.
+ */
+typedef struct {
+    /// SET_OP_UNION, SET_OP_INTERSECT or SET_OP_DIFFERENCE
+    int op;
+    /// 1 if duplicate rows are kept (ALL), 0 if every row is written once
+    int all;
+    /// number of attributes of both tables
+    int num_attr;
+    /// header of both tables
+    AK_header header[MAX_ATTRIBUTES];
+    /// distinct rows
+    AK_iterator_buffer rows;
+    /// hash of every distinct row
+    unsigned int *row_hash;
+    /// number of copies of every distinct row in the first and the second table
+    int *count[2];
+    /// next row in the same bucket, -1 at the end of chain
+    int *chain;
+    /// number of rows row_hash, count and chain can hold
+    int capacity_rows;
+    /// first row of every bucket, -1 for empty bucket
+    int *buckets;
+    /// number of buckets minus one (number of buckets is a power of two)
+    unsigned int mask;
+    /// bytes of memory for distinct rows
+    int memory;
+    /// bulk load of the result table
+    AK_bulk_loader loader;
+    /// number of rows written to the result table
+    int num_written;
+    /// number of partitions written to temporary segments
+    int num_spilled;
+    /// deepest partitioning
+    int max_depth;
+} AK_set_op_state;
+
+/**
+ * @struct AK_set_op_spill
+ * @brief Structure that holds partitions of both tables of one level of a set operation whose distinct rows do not
+          fit in memory
+ */
+typedef struct {
+    /// number of partitions
+    int num_partitions;
+    /// temporary segments of partitions of the first and the second table
+    char segment[2][SET_OP_MAX_PARTITIONS][MAX_ATT_NAME];
+    /// bulk loads of temporary segments
+    AK_bulk_loader loader[2][SET_OP_MAX_PARTITIONS];
+    /// number of rows written to temporary segments
+    int rows[2][SET_OP_MAX_PARTITIONS];
+} AK_set_op_spill;
+
+/**
+ * @brief Function sets number of bytes of memory for distinct rows of a set operation, for example to process tables
+          that fit in memory by partitions
+ * @param bytes number of bytes, 0 for SET_OP_MEMORY
+ * @return number of bytes that is used
+ */
+int AK_set_op_set_memory(int bytes) {
+    AK_PRO;
+    AK_set_op_forced_memory = bytes < 0 ? 0 : bytes;
+    AK_EPI;
+    return AK_set_op_forced_memory ? AK_set_op_forced_memory : SET_OP_MEMORY;
+}
+
+/**
+ * @brief Function hashes all values of a row (FNV-1a). Values are hashed with their types, so values of different
+          types (a null is a varchar) have different hashes, and 0.0 and -0.0 are hashed as 0.0.
+ * @param value values of the row
+ * @param num_attr number of values
+ * @return hash
+ */
+static unsigned int AK_set_op_hash(AK_iterator_value *value, int num_attr) {
+    unsigned int hash = SET_OP_HASH_SEED;
+    float number_float;
+    double number_double;
+    char *data;
+    int i, j, size;
+
+    for (i = 0; i < num_attr; i++) {
+        data = value[i].data;
+        size = value[i].size;
+        if (value[i].type == TYPE_FLOAT) {
+            memcpy(&number_float, value[i].data, sizeof (float));
+            if (number_float == 0)
+                number_float = 0;
+            data = (char *) &number_float;
+            size = sizeof (float);
+        } else if (value[i].type == TYPE_NUMBER) {
+            memcpy(&number_double, value[i].data, sizeof (double));
+            if (number_double == 0)
+                number_double = 0;
+            data = (char *) &number_double;
+            size = sizeof (double);
+        }
+        hash = (hash ^ (unsigned int) value[i].type) * 16777619u;
+        for (j = 0; j < size; j++)
+            hash = (hash ^ (unsigned char) data[j]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Function returns memory taken by distinct rows of a set operation
+ * @param set set operation
+ * @return number of bytes
+ */
+static long AK_set_op_memory_used(AK_set_op_state *set) {
+    return set->rows.size + (long) set->rows.num_rows * (set->num_attr * 3 + 5) * (long) sizeof (int)
+            + (long) (set->mask + 1) * sizeof (int);
+}
+
+/**
+ * @brief Function chains distinct rows of a set operation in buckets by their hashes, with twice as many buckets as
+          rows
+ * @param set set operation
+ * @return No return value
+ */
+static void AK_set_op_index(AK_set_op_state *set) {
+    unsigned int num_buckets;
+    int row;
+
+    for (num_buckets = 16; num_buckets < 2 * (unsigned int) set->rows.num_rows; num_buckets *= 2)
+        ;
+    set->mask = num_buckets - 1;
+    set->buckets = (int *) AK_realloc(set->buckets, num_buckets * sizeof (int));
+    memset(set->buckets, -1, num_buckets * sizeof (int));
+    for (row = 0; row < set->rows.num_rows; row++) {
+        set->chain[row] = set->buckets[set->row_hash[row] & set->mask];
+        set->buckets[set->row_hash[row] & set->mask] = row;
+    }
+}
+
+/**
+ * @brief Function looks up a row among distinct rows of a set operation. Values are compared by their types (see
+          AK_sort_compare_values), so rows are equal if all their values are equal, nulls included.
+ * @param set set operation
+ * @param value values of the row
+ * @param hash hash of the row
+ * @return index of the equal distinct row, -1 if there is none
+ */
+static int AK_set_op_find(AK_set_op_state *set, AK_iterator_value *value, unsigned int hash) {
+    AK_iterator_value stored[MAX_ATTRIBUTES];
+    int row, i;
+
+    for (row = set->buckets[hash & set->mask]; row != -1; row = set->chain[row]) {
+        if (set->row_hash[row] != hash)
+            continue;
+        AK_iterator_buffer_get(&set->rows, row, stored);
+        for (i = 0; i < set->num_attr && AK_sort_compare_values(&stored[i], &value[i]) == 0; i++)
+            ;
+        if (i == set->num_attr)
+            return row;
+    }
+    return -1;
+}
+
+/**
+ * @brief Function adds a row to distinct rows of a set operation. Buckets are doubled when there are as many rows
+          as buckets.
+ * @param set set operation
+ * @param value values of the row
+ * @param hash hash of the row
+ * @return index of the added row
+ */
+static int AK_set_op_add(AK_set_op_state *set, AK_iterator_value *value, unsigned int hash) {
+    int row = set->rows.num_rows;
+
+    if (row == set->capacity_rows) {
+        set->capacity_rows = set->capacity_rows ? 2 * set->capacity_rows : 1024;
+        set->row_hash = (unsigned int *) AK_realloc(set->row_hash, set->capacity_rows * sizeof (unsigned int));
+        set->count[0] = (int *) AK_realloc(set->count[0], set->capacity_rows * sizeof (int));
+        set->count[1] = (int *) AK_realloc(set->count[1], set->capacity_rows * sizeof (int));
+        set->chain = (int *) AK_realloc(set->chain, set->capacity_rows * sizeof (int));
+    }
+    AK_iterator_buffer_add(&set->rows, value);
+    set->row_hash[row] = hash;
+    set->count[0][row] = 0;
+    set->count[1][row] = 0;
+    if ((unsigned int) set->rows.num_rows > set->mask) {
+        AK_set_op_index(set);
+    } else {
+        set->chain[row] = set->buckets[hash & set->mask];
+        set->buckets[hash & set->mask] = row;
+    }
+    return row;
+}
+
+/**
+ * @brief Function counts copies of rows of one table of a set operation. Rows of the first table, and of the
+          second table of a union, are added to distinct rows; rows of the second table of other operations are only
+          counted if they are equal to a distinct row, since the result holds no other rows.
+ * @param set set operation
+ * @param table table
+ * @param input 0 for the first table, 1 for the second table
+ * @param limited 1 if reading stops when distinct rows take more than the memory of the set operation
+ * @param bytes memory rows of the table would take is added to it, if reading stopped
+ * @return 1 if all rows were read, 0 if they do not fit in memory
+ */
+static int AK_set_op_read(AK_set_op_state *set, char *table, int input, int limited, long *bytes) {
+    AK_PRO;
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+    unsigned int hash;
+    int row, fits = 1, i;
+
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (!fits) {
+            for (i = 0; i < set->num_attr; i++)
+                *bytes += scan->value[i].size;
+            *bytes += (set->num_attr * 3 + 5) * (long) sizeof (int);
+            continue;
+        }
+        hash = AK_set_op_hash(scan->value, set->num_attr);
+        row = AK_set_op_find(set, scan->value, hash);
+        if (row == -1 && (input == 0 || set->op == SET_OP_UNION))
+            row = AK_set_op_add(set, scan->value, hash);
+        if (row != -1)
+            set->count[input][row]++;
+        if (limited && AK_set_op_memory_used(set) > set->memory) {
+            fits = 0;
+            *bytes += AK_set_op_memory_used(set);
+        }
+    }
+    AK_iterator_free(scan);
+    AK_EPI;
+    return fits;
+}
+
+/**
+ * @brief Function writes the result of a set operation from counted copies of distinct rows. A row with m copies in
+          the first and n copies in the second table is written: by union once (ALL: m + n times), by intersect
+          once if m and n are not 0 (ALL: min(m, n) times), by difference once if n is 0 (ALL: max(m - n, 0) times).
+ * @param set set operation
+ * @return No return value
+ */
+static void AK_set_op_write(AK_set_op_state *set) {
+    AK_PRO;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], row, copies, m, n, i;
+    char *data[MAX_ATTRIBUTES];
+
+    for (row = 0; row < set->rows.num_rows; row++) {
+        m = set->count[0][row];
+        n = set->count[1][row];
+        switch (set->op) {
+            case SET_OP_UNION:
+                copies = set->all ? m + n : 1;
+                break;
+            case SET_OP_INTERSECT:
+                copies = set->all ? (m < n ? m : n) : m > 0 && n > 0;
+                break;
+            default:
+                copies = set->all ? (m > n ? m - n : 0) : m > 0 && n == 0;
+        }
+        if (copies == 0)
+            continue;
+        AK_iterator_buffer_get(&set->rows, row, value);
+        for (i = 0; i < set->num_attr; i++) {
+            type[i] = value[i].type;
+            size[i] = value[i].size;
+            data[i] = value[i].data;
+        }
+        while (copies-- > 0) {
+            //extents of the result table grow with the number of rows written so far
+            set->num_written++;
+            AK_bulk_add_row(&set->loader, type, data, size, set->num_written);
+        }
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function writes a row of a table of a set operation to the temporary segment of its partition, which is
+          created with the first row
+ * @param set set operation
+ * @param spill partitioning
+ * @param input 0 for the first table, 1 for the second table
+ * @param partition partition of the row
+ * @param value values of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the segment cannot be created
+ */
+static int AK_set_op_spill_row(AK_set_op_state *set, AK_set_op_spill *spill, int input, int partition, AK_iterator_value *value) {
+    AK_bulk_loader *loader = &spill->loader[input][partition];
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], i;
+    char *data[MAX_ATTRIBUTES];
+
+    if (spill->rows[input][partition] == 0) {
+        if (AK_temp_segment_create(spill->segment[input][partition], set->header) == EXIT_ERROR)
+            return EXIT_ERROR;
+        AK_bulk_begin(loader, spill->segment[input][partition]);
+        set->num_spilled++;
+    }
+    for (i = 0; i < set->num_attr; i++) {
+        type[i] = value[i].type;
+        size[i] = value[i].size;
+        data[i] = value[i].data;
+    }
+    spill->rows[input][partition]++;
+    return AK_bulk_add_row(loader, type, data, size, spill->rows[input][partition]);
+}
+
+static int AK_set_op_tables(AK_set_op_state *set, char **tables, int depth);
+
+/**
+ * @brief Function processes two tables of a set operation by partitions, when their distinct rows do not fit in
+          memory. Equal rows have equal hashes, so they fall into the same partition, and the result is the union of
+          results of all pairs of partitions. Rows of both tables are written to temporary segments of partitions
+          (rows of the second table only for partitions that have rows of the first table, unless the operation is a
+          union), then every pair of partitions is processed again, partitioned further if it still does not fit.
+ * @param set set operation
+ * @param tables first and second table, NULL for an empty table
+ * @param bytes memory rows of the tables would take
+ * @param depth recursion depth of the partitioning
+ * @return EXIT_SUCCESS, EXIT_ERROR if a temporary segment cannot be created
+ */
+static int AK_set_op_partition(AK_set_op_state *set, char **tables, long bytes, int depth) {
+    AK_PRO;
+    AK_set_op_spill *spill = (AK_set_op_spill *) AK_calloc(1, sizeof (AK_set_op_spill));
+    AK_iterator *scan;
+    char *partition_tables[2];
+    unsigned int hash;
+    int partition, input, result = EXIT_SUCCESS;
+
+    spill->num_partitions = (int) (2 * bytes / set->memory + 1);
+    if (spill->num_partitions > SET_OP_MAX_PARTITIONS)
+        spill->num_partitions = SET_OP_MAX_PARTITIONS;
+    if (spill->num_partitions < 2)
+        spill->num_partitions = 2;
+    Ak_dbg_messg(LOW, REL_OP, "AK_set_op: %ld bytes of %s processed by %d partitions at depth %d\n", bytes, tables[0],
+            spill->num_partitions, depth);
+
+    for (input = 0; input < 2; input++) {
+        if (tables[input] == NULL)
+            continue;
+        scan = AK_iterator_scan(tables[input], NULL);
+        AK_iterator_open(scan);
+        while (AK_iterator_next(scan) == ITERATOR_ROW && result == EXIT_SUCCESS) {
+            hash = AK_set_op_hash(scan->value, set->num_attr);
+            //the mix with the depth spreads rows of one partition over all partitions of the next level
+            hash = (hash ^ (unsigned int) depth * 0x9E3779B9u) * 2654435761u;
+            partition = (int) ((hash >> 16) % (unsigned int) spill->num_partitions);
+            if (input == 0 || set->op == SET_OP_UNION || spill->rows[0][partition] > 0)
+                result = AK_set_op_spill_row(set, spill, input, partition, scan->value);
+        }
+        AK_iterator_free(scan);
+    }
+
+    for (input = 0; input < 2; input++) {
+        for (partition = 0; partition < spill->num_partitions; partition++) {
+            if (spill->rows[input][partition] > 0)
+                AK_bulk_end(&spill->loader[input][partition]);
+        }
+    }
+    for (partition = 0; partition < spill->num_partitions && result == EXIT_SUCCESS; partition++) {
+        for (input = 0; input < 2; input++)
+            partition_tables[input] = spill->rows[input][partition] > 0 ? spill->segment[input][partition] : NULL;
+        if (partition_tables[0] != NULL || partition_tables[1] != NULL)
+            result = AK_set_op_tables(set, partition_tables, depth + 1);
+    }
+    AK_free(spill);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function processes two tables of a set operation: in memory if their distinct rows fit, otherwise by
+          partitions. Partitions are not split any more after SET_OP_MAX_DEPTH levels, since equal rows always fall
+          into one partition.
+ * @param set set operation
+ * @param tables first and second table, NULL for an empty table
+ * @param depth recursion depth of the partitioning
+ * @return EXIT_SUCCESS, EXIT_ERROR if a temporary segment cannot be created
+ */
+static int AK_set_op_tables(AK_set_op_state *set, char **tables, int depth) {
+    AK_PRO;
+    long bytes = 0;
+    int input, fits = 1, result = EXIT_SUCCESS;
+
+    if (depth > set->max_depth)
+        set->max_depth = depth;
+    set->rows.num_rows = 0;
+    set->rows.size = 0;
+    AK_set_op_index(set);
+    for (input = 0; input < 2 && fits; input++) {
+        if (tables[input] != NULL)
+            fits = AK_set_op_read(set, tables[input], input, depth < SET_OP_MAX_DEPTH, &bytes);
+        //with no rows of the first table only a union has a result
+        if (input == 0 && set->rows.num_rows == 0 && set->op != SET_OP_UNION)
+            break;
+    }
+    if (fits)
+        AK_set_op_write(set);
+    else
+        result = AK_set_op_partition(set, tables, bytes, depth);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function copies all rows of two tables to the result of a union that keeps duplicate rows (UNION ALL)
+ * @param set set operation
+ * @param tables first and second table
+ * @return No return value
+ */
+static void AK_set_op_append(AK_set_op_state *set, char **tables) {
+    AK_PRO;
+    AK_iterator *scan;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], input, i;
+    char *data[MAX_ATTRIBUTES];
+
+    for (input = 0; input < 2; input++) {
+        scan = AK_iterator_scan(tables[input], NULL);
+        AK_iterator_open(scan);
+        while (AK_iterator_next(scan) == ITERATOR_ROW) {
+            for (i = 0; i < set->num_attr; i++) {
+                type[i] = scan->value[i].type;
+                size[i] = scan->value[i].size;
+                data[i] = scan->value[i].data;
+            }
+            set->num_written++;
+            AK_bulk_add_row(&set->loader, type, data, size, set->num_written);
+        }
+        AK_iterator_free(scan);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function makes a set operation of two tables with the same schema into a new table. Rows are hashed by all
+          their values and looked up in a hash table of distinct rows, which counts copies of every row in both
+          tables, so both tables are read once and rows are compared by their types only when hashes are equal.
+          Union keeps distinct rows of both tables, intersect (a semi-join) rows of the first table that are in the
+          second table, difference (an anti-join) rows of the first table that are not in the second table. Without
+          all every row is written once (SQL UNION, INTERSECT and EXCEPT), with all duplicate rows are kept
+          (UNION ALL, INTERSECT ALL and EXCEPT ALL). If distinct rows take more than the memory set by
+          AK_set_op_set_memory, both tables are split by hash into partitions in temporary segments, which are
+          deleted when the operation ends.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @param op SET_OP_UNION, SET_OP_INTERSECT or SET_OP_DIFFERENCE
+ * @param all 1 to keep duplicate rows, 0 to write every row once
+ * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
+ */
+int AK_set_op(char *srcTable1, char *srcTable2, char *dstTable, int op, int all) {
+    AK_PRO;
+    char *names[3] = {"Union", "Intersect", "Difference"};
+    char *tables[2] = {srcTable1, srcTable2};
+    table_addresses *src_addr1 = (table_addresses *) AK_get_table_addresses(srcTable1);
+    table_addresses *src_addr2 = (table_addresses *) AK_get_table_addresses(srcTable2);
+    AK_set_op_state set;
+    AK_iterator *scan;
+    int mark, result = EXIT_SUCCESS;
+
+    if (src_addr1->address_from[0] == 0 || src_addr2->address_from[0] == 0) {
+        Ak_dbg_messg(LOW, REL_OP, "\nAK_set_op: Table/s doesn't exist!");
+        AK_free(src_addr1);
+        AK_free(src_addr2);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_check_tables_scheme((AK_mem_block *) AK_get_block(src_addr1->address_from[0]),
+            (AK_mem_block *) AK_get_block(src_addr2->address_from[0]), names[op]) == EXIT_ERROR) {
+        AK_free(src_addr1);
+        AK_free(src_addr2);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_free(src_addr1);
+    AK_free(src_addr2);
+
+    memset(&set, 0, sizeof (AK_set_op_state));
+    set.op = op;
+    set.all = all;
+    set.memory = AK_set_op_forced_memory ? AK_set_op_forced_memory : SET_OP_MEMORY;
+    scan = AK_iterator_scan(srcTable1, NULL);
+    set.num_attr = scan->num_attr;
+    memcpy(set.header, scan->header, sizeof (set.header));
+    AK_iterator_free(scan);
+    AK_iterator_buffer_init(&set.rows, set.num_attr);
+
+    AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, set.header);
+    AK_bulk_begin(&set.loader, dstTable);
+    if (op == SET_OP_UNION && all) {
+        AK_set_op_append(&set, tables);
+    } else {
+        //temporary segments of partitions are deleted when the operation ends
+        mark = AK_temp_begin();
+        result = AK_set_op_tables(&set, tables, 0);
+        AK_temp_end(mark);
+    }
+    AK_bulk_end(&set.loader);
+
+    Ak_dbg_messg(LOW, REL_OP, "AK_set_op: %s%s of %s and %s: %d rows, %d partitions written, depth %d\n", names[op],
+            all ? " all" : "", srcTable1, srcTable2, set.num_written, set.num_spilled, set.max_depth);
+    AK_set_op_last_spilled = set.num_spilled;
+    AK_set_op_last_depth = set.max_depth;
+    AK_iterator_buffer_free(&set.rows);
+    AK_free(set.row_hash);
+    AK_free(set.count[0]);
+    AK_free(set.count[1]);
+    AK_free(set.chain);
+    AK_free(set.buckets);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function creates a table for the set operation test: rows (id, name, value) with ids from first to last,
+          every row copies times. Names and values are computed from ids.
+ * @param table table name
+ * @param first first id
+ * @param last last id
+ * @param copies number of copies of every row
+ * @return No return value
+ */
+static void AK_set_op_test_table(char *table, int first, int last, int copies) {
+    AK_header header[4], *temp;
+    AK_bulk_loader loader;
+    char name[MAX_VARCHAR_LENGTH], *data[3];
+    char *names[3] = {"id", "name", "value"};
+    int types[3] = {TYPE_INT, TYPE_VARCHAR, TYPE_FLOAT};
+    int size[3], id, copy, i, rows, num_rows = (last - first + 1) * copies;
+    float value;
+
+    for (i = 0; i < 3; i++) {
+        temp = (AK_header *) AK_create_header(names[i], types[i], FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&header[i], temp, sizeof (AK_header));
+        AK_free(temp);
+    }
+    memset(&header[3], 0, sizeof (AK_header));
+    AK_initialize_new_segment(table, SEGMENT_TYPE_TABLE, header);
+
+    AK_bulk_begin(&loader, table);
+    rows = 0;
+    for (copy = 0; copy < copies; copy++) {
+        for (id = first; id <= last; id++) {
+            sprintf(name, "name%d", id);
+            value = id / 4.0f;
+            data[0] = (char *) &id;
+            data[1] = name;
+            data[2] = (char *) &value;
+            size[0] = sizeof (int);
+            size[1] = strlen(name);
+            size[2] = sizeof (float);
+            AK_bulk_add_row(&loader, types, data, size, num_rows - rows);
+            rows++;
+        }
+    }
+    AK_bulk_end(&loader);
+}
+
+/**
+ * @brief Function checks a result of the set operation test: every row has to hold the name and the value of its id,
+          and every id has to be in the result as many times as expected
+ * @param table result table
+ * @param expected expected number of copies of every id
+ * @param num_ids number of ids
+ * @param rows number of rows of the table
+ * @return 1 if the result is correct, 0 otherwise
+ */
+static int AK_set_op_test_check(char *table, int *expected, int num_ids, int *rows) {
+    AK_iterator *scan = AK_iterator_scan(table, NULL);
+    int *found = (int *) AK_calloc(num_ids, sizeof (int));
+    char name[MAX_VARCHAR_LENGTH];
+    int id, i, correct = 1;
+    float value;
+
+    *rows = 0;
+    AK_iterator_open(scan);
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        memcpy(&id, scan->value[0].data, sizeof (int));
+        memcpy(&value, scan->value[2].data, sizeof (float));
+        sprintf(name, "name%d", id);
+        if (id < 0 || id >= num_ids || scan->value[1].size != (int) strlen(name)
+                || memcmp(scan->value[1].data, name, scan->value[1].size) != 0 || value != id / 4.0f) {
+            correct = 0;
+            continue;
+        }
+        found[id]++;
+        (*rows)++;
+    }
+    AK_iterator_free(scan);
+    for (i = 0; i < num_ids; i++)
+        correct &= found[i] == expected[i];
+    AK_free(found);
+    return correct;
+}
+
+/**
+ * @brief Function for testing hash based set operations. Table set_a holds ids 0 to 299 twice, table set_b ids
+          200 to 499 three times. Every operation is checked in memory and by partitions with 16 KiB of memory.
+ * @return No return value
+ */
+void AK_set_op_test() {
+    AK_PRO;
+    printf("\n********** SET OPERATIONS TEST **********\n\n");
+    char *ops[3] = {"union", "intersect", "difference"}, result[MAX_ATT_NAME];
+    int expected[500], copies[2], memory, op, all, id, rows, correct, mark, success = 1;
+    struct timespec start, end;
+    double seconds;
+
+    AK_set_op_test_table("set_a", 0, 299, 2);
+    AK_set_op_test_table("set_b", 200, 499, 3);
+
+    for (memory = 0; memory <= 16 * 1024; memory += 16 * 1024) {
+        AK_set_op_set_memory(memory);
+        for (op = SET_OP_UNION; op <= SET_OP_DIFFERENCE; op++) {
+            for (all = 0; all < 2; all++) {
+                for (id = 0; id < 500; id++) {
+                    copies[0] = id < 300 ? 2 : 0;
+                    copies[1] = id >= 200 ? 3 : 0;
+                    if (op == SET_OP_UNION)
+                        expected[id] = all ? copies[0] + copies[1] : 1;
+                    else if (op == SET_OP_INTERSECT)
+                        expected[id] = all ? (copies[0] < copies[1] ? copies[0] : copies[1]) : copies[0] && copies[1];
+                    else
+                        expected[id] = all ? (copies[0] > copies[1] ? copies[0] - copies[1] : 0) : copies[0] && !copies[1];
+                }
+                sprintf(result, "set_%s%s_%d", ops[op], all ? "_all" : "", memory);
+                mark = AK_temp_begin();
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                AK_set_op("set_a", "set_b", result, op, all);
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                seconds = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1e9;
+                correct = AK_set_op_test_check(result, expected, 500, &rows);
+                //a union that keeps duplicates only copies rows, it never needs memory
+                success &= correct && AK_temp_begin() == mark && (memory == 0 || (op == SET_OP_UNION && all) || AK_set_op_last_spilled > 0);
+                printf("%s%s with %d KiB of memory: %d rows, %.3f s, %d partitions written, depth %d, correct: %d\n", ops[op],
+                        all ? " all" : "", AK_set_op_set_memory(memory) / 1024, rows, seconds, AK_set_op_last_spilled,
+                        AK_set_op_last_depth, correct);
+            }
+        }
+    }
+    AK_set_op_set_memory(0);
+
+    //tables with different schemas are not processed
+    success &= AK_set_op("set_a", "professor", "set_wrong", SET_OP_UNION, 0) == EXIT_ERROR;
+
+    printf("\nTest %s\n", success ? "SUCCESS" : "FAILED");
+    AK_EPI;
+}
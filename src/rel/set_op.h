@@ -0,0 +1,72 @@
+/**
+@file set_op.h Header file that provides data structures and functions for hash based set operations (union, intersect
+      and difference)
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SET_OP
+#define SET_OP
+
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../file/files.h"
+#include "../file/filesort.h"
+#include "../file/bulkload.h"
+#include "iterator.h"
+#include "../auxi/mempro.h"
+
+/**
+  * @def SET_OP_UNION
+  * @brief Constant declaring union of two tables
+  */
+#define SET_OP_UNION 0
+
+/**
+  * @def SET_OP_INTERSECT
+  * @brief Constant declaring intersect of two tables
+  */
+#define SET_OP_INTERSECT 1
+
+/**
+  * @def SET_OP_DIFFERENCE
+  * @brief Constant declaring difference of two tables
+  */
+#define SET_OP_DIFFERENCE 2
+
+/**
+  * @def SET_OP_MEMORY
+  * @brief Constant declaring default number of bytes of memory for distinct rows of a set operation
+  */
+#define SET_OP_MEMORY (4 * 1024 * 1024)
+
+/**
+  * @def SET_OP_MAX_PARTITIONS
+  * @brief Constant declaring maximal number of partitions of a set operation whose rows do not fit in memory
+  */
+#define SET_OP_MAX_PARTITIONS 32
+
+/**
+  * @def SET_OP_MAX_DEPTH
+  * @brief Constant declaring maximal number of times partitions of a set operation are partitioned again
+  */
+#define SET_OP_MAX_DEPTH 3
+
+int AK_set_op(char *srcTable1, char *srcTable2, char *dstTable, int op, int all);
+int AK_set_op_set_memory(int bytes);
+void AK_set_op_test();
+
+#endif
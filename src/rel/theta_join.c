@@ -146,10 +146,11 @@ int AK_create_theta_join_header(char *srcTable1, char * srcTable2, char *new_tab
  * @param tbl1_num_att number of attributes in the first table
  * @param tbl2_num_att number of attributes in the second table
  * @param constraints list of attributes, (in)equality and logical operators which are the conditions for the join in postfix notation
+ * @param predicate constraints compiled for the joined header, NULL to interpret constraints on row lists
  * @param new_table name of the theta_join table
  * @return No return value
  */
-void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, char *new_table) {
+void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, AK_predicate *predicate, char *new_table) {
     AK_PRO;
     Ak_dbg_messg(HIGH, REL_OP, "\n COPYING THETA JOIN");
 
@@ -164,6 +165,52 @@ void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block,
 
     Ak_Init_L3(&row_root_init);
 
+    if (predicate != NULL) {
+        //pairs are checked on block tuples, only joined rows are copied into a list
+        for (tbl1_row = 0; tbl1_row < DATA_BLOCK_SIZE; tbl1_row += tbl1_num_att) {
+
+            if (tbl1_temp_block->tuple_dict[tbl1_row].type == FREE_INT)
+                break;
+            if (tbl1_temp_block->tuple_dict[tbl1_row].type == 0)
+                continue;
+
+            for (tbl2_row = 0; tbl2_row < DATA_BLOCK_SIZE; tbl2_row += tbl2_num_att) {
+
+                if (tbl2_temp_block->tuple_dict[tbl2_row].type == FREE_INT)
+                    break;
+                if (tbl2_temp_block->tuple_dict[tbl2_row].type == 0)
+                    continue;
+                if (!AK_predicate_eval_pair(predicate, tbl1_temp_block, tbl1_row, tbl2_temp_block, tbl2_row))
+                    continue;
+
+                for (tbl1_att = 0; tbl1_att < tbl1_num_att; tbl1_att++) {
+                    address = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].address;
+                    size = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].size;
+                    type = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].type;
+                    memset(data, 0, MAX_VARCHAR_LENGTH);
+                    memcpy(data, &(tbl1_temp_block->data[address]), size);
+                    Ak_Insert_New_Element(type, data, new_table, t_header[tbl1_att].att_name, row_root_init);
+                }
+                for (tbl2_att = 0; tbl2_att < tbl2_num_att; tbl2_att++) {
+                    address = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].address;
+                    size = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].size;
+                    type = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].type;
+                    memset(data, 0, MAX_VARCHAR_LENGTH);
+                    memcpy(data, &(tbl2_temp_block->data[address]), size);
+                    Ak_Insert_New_Element(type, data, new_table, t_header[tbl1_num_att + tbl2_att].att_name, row_root_init);
+                }
+
+                Ak_insert_row(row_root_init);
+                Ak_DeleteAll_L3(&row_root_init);
+            }
+        }
+
+        AK_free(row_root_init);
+        AK_free(t_header);
+        AK_EPI;
+        return;
+    }
+
     for (tbl1_row = 0; tbl1_row < DATA_BLOCK_SIZE; tbl1_row += tbl1_num_att){
 
     	if (tbl1_temp_block->tuple_dict[tbl1_row].type == FREE_INT)
@@ -241,6 +288,9 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
 		Ak_dbg_messg(MIDDLE, REL_OP, "\nAK_theta_join: start copying data\n");
 
         AK_mem_block *tbl1_temp_block, *tbl2_temp_block;
+        AK_header *t_header = (AK_header *) AK_get_header(dstTable);
+        AK_predicate *predicate = AK_predicate_compile(constraints, t_header, tbl1_num_att + tbl2_num_att, tbl1_num_att);
+        AK_free(t_header);
 
         int i, j, k, l;
         i = j = k = l = 0;
@@ -277,7 +327,7 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
                                     //if there is data in the block
                                     if (tbl2_temp_block->block->AK_free_space != 0) {
 
-                                    		AK_check_constraints(tbl1_temp_block->block, tbl2_temp_block->block, tbl1_num_att, tbl2_num_att, constraints, dstTable);
+                                    		AK_check_constraints(tbl1_temp_block->block, tbl2_temp_block->block, tbl1_num_att, tbl2_num_att, constraints, predicate, dstTable);
                                     }
                                 }
                             } else break;
@@ -287,6 +337,7 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
             } else break;
         }
 
+        AK_predicate_free(predicate);
         AK_free(src_addr1);
         AK_free(src_addr2);
 
@@ -304,6 +355,219 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
     }
 }
 
+/**
+ * @brief Function returns value of a numeric attribute as a double
+ * @param value value of type TYPE_INT, TYPE_FLOAT or TYPE_NUMBER
+ * @return value
+ */
+static double AK_theta_join_number(AK_iterator_value *value) {
+    int integer;
+    float real;
+    double number;
+
+    switch (value->type) {
+        case TYPE_INT:
+            memcpy(&integer, value->data, sizeof (int));
+            return integer;
+        case TYPE_FLOAT:
+            memcpy(&real, value->data, sizeof (float));
+            return real;
+        default:
+            memcpy(&number, value->data, sizeof (double));
+            return number;
+    }
+}
+
+/**
+ * @brief Function reads the next row of an input of a band join, skipping rows whose band attribute is null
+ * @param scan scan of the input
+ * @param column band attribute
+ * @param type type of the band attribute
+ * @param key value of the band attribute of the previous row, set to the value of the read row
+ * @return ITERATOR_ROW, ITERATOR_END after the last row, BAND_UNORDERED if the value is lower than the previous one
+ */
+static int AK_theta_join_band_next(AK_iterator *scan, int column, int type, double *key) {
+    double next;
+
+    while (AK_iterator_next(scan) == ITERATOR_ROW) {
+        if (scan->value[column].type != type)
+            continue;
+        next = AK_theta_join_number(&scan->value[column]);
+        if (next < *key)
+            return BAND_UNORDERED;
+        *key = next;
+        return ITERATOR_ROW;
+    }
+    return ITERATOR_END;
+}
+
+/**
+ * @brief Function joins two tables ordered by their band attributes. Rows of the first table whose value is within
+          the band around the value of the current row of the second table form a window; as the second table is read
+          in order, rows leave the window at its start and enter it at its end, so both tables are read once.
+ * @param tables names of the first and the second table
+ * @param column band attributes of both tables
+ * @param type types of band attributes
+ * @param num_attr numbers of attributes of both tables
+ * @param band half width of the band
+ * @param loader bulk load of the joined table
+ * @return number of joined rows, BAND_UNORDERED if a table is not ordered by its band attribute
+ */
+static int AK_theta_join_band_rows(char **tables, int *column, int *type, int *num_attr, double band, AK_bulk_loader *loader) {
+    AK_PRO;
+    AK_iterator *scan[2];
+    AK_iterator_buffer window, rest;
+    AK_iterator_value value[MAX_ATTRIBUTES];
+    double key[2] = {-DBL_MAX, -DBL_MAX}, *window_key = NULL;
+    int state[2], capacity = 0, first = 0, row, i, num_joined = 0, data_type[2 * MAX_ATTRIBUTES], size[2 * MAX_ATTRIBUTES];
+    char *data[2 * MAX_ATTRIBUTES];
+
+    for (i = 0; i < 2; i++) {
+        scan[i] = AK_iterator_scan(tables[i], NULL);
+        AK_iterator_open(scan[i]);
+    }
+    AK_iterator_buffer_init(&window, num_attr[0]);
+    state[0] = AK_theta_join_band_next(scan[0], column[0], type[0], &key[0]);
+
+    while ((state[1] = AK_theta_join_band_next(scan[1], column[1], type[1], &key[1])) == ITERATOR_ROW && state[0] != BAND_UNORDERED) {
+        //rows below the band leave the window, rows up to the end of the band enter it
+        while (first < window.num_rows && window_key[first] < key[1] - band)
+            first++;
+        while (state[0] == ITERATOR_ROW && key[0] <= key[1] + band) {
+            if (key[0] >= key[1] - band) {
+                if (window.num_rows == capacity) {
+                    capacity = capacity ? 2 * capacity : 256;
+                    window_key = (double *) AK_realloc(window_key, capacity * sizeof (double));
+                }
+                window_key[window.num_rows] = key[0];
+                AK_iterator_buffer_add(&window, scan[0]->value);
+            }
+            state[0] = AK_theta_join_band_next(scan[0], column[0], type[0], &key[0]);
+        }
+
+        for (i = 0; i < num_attr[1]; i++) {
+            data_type[num_attr[0] + i] = scan[1]->value[i].type;
+            data[num_attr[0] + i] = scan[1]->value[i].data;
+            size[num_attr[0] + i] = scan[1]->value[i].size;
+        }
+        for (row = first; row < window.num_rows; row++) {
+            AK_iterator_buffer_get(&window, row, value);
+            for (i = 0; i < num_attr[0]; i++) {
+                data_type[i] = value[i].type;
+                data[i] = value[i].data;
+                size[i] = value[i].size;
+            }
+            //extents of the joined table grow with the number of rows written so far
+            AK_bulk_add_row(loader, data_type, data, size, ++num_joined);
+        }
+
+        //rows that left the window are removed once they take half of it
+        if (first >= 256 && 2 * first >= window.num_rows) {
+            AK_iterator_buffer_init(&rest, num_attr[0]);
+            for (row = first; row < window.num_rows; row++) {
+                AK_iterator_buffer_get(&window, row, value);
+                AK_iterator_buffer_add(&rest, value);
+                window_key[row - first] = window_key[row];
+            }
+            AK_iterator_buffer_free(&window);
+            window = rest;
+            first = 0;
+        }
+    }
+
+    //the rest of the first table is read only to check its order
+    while (state[0] == ITERATOR_ROW)
+        state[0] = AK_theta_join_band_next(scan[0], column[0], type[0], &key[0]);
+    for (i = 0; i < 2; i++)
+        AK_iterator_free(scan[i]);
+    AK_iterator_buffer_free(&window);
+    AK_free(window_key);
+    AK_EPI;
+    return state[0] == BAND_UNORDERED || state[1] == BAND_UNORDERED ? BAND_UNORDERED : num_joined;
+}
+
+/**
+ * @brief Function makes a band join of two tables: every row of the first table is joined with every row of the
+          second table for which att1 BETWEEN att2 - band AND att2 + band. It is a merge join on tables ordered by
+          their band attributes; a table that is not known to be ordered (see AK_sort_is_ordered) is sorted into a
+          helper table first, which is deleted after the join. Rows with a null band attribute match no row. The
+          joined table has all attributes of the first table followed by all attributes of the second one, as
+          AK_theta_join.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the joined table
+ * @param att1 band attribute of the first table (TYPE_INT, TYPE_FLOAT or TYPE_NUMBER)
+ * @param att2 band attribute of the second table (TYPE_INT, TYPE_FLOAT or TYPE_NUMBER)
+ * @param band half width of the band
+ * @return number of joined rows, EXIT_ERROR if tables cannot be joined
+ */
+int AK_theta_join_band(char *srcTable1, char *srcTable2, char *dstTable, char *att1, char *att2, double band) {
+    AK_PRO;
+    char *tables[2] = {srcTable1, srcTable2}, *atts[2] = {att1, att2}, sorted[2][MAX_ATT_NAME], *inputs[2];
+    AK_sort_key key[2];
+    AK_bulk_loader loader;
+    AK_header *header;
+    int column[2], type[2], num_attr[2], input, attempt, result = BAND_UNORDERED;
+
+    for (input = 0; input < 2; input++) {
+        header = (AK_header *) AK_get_header(tables[input]);
+        if (header == NULL) {
+            printf("AK_theta_join_band: ERROR. Table %s does not exist.\n", tables[input]);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        for (num_attr[input] = 0; num_attr[input] < MAX_ATTRIBUTES && strcmp(header[num_attr[input]].att_name, "") != 0; num_attr[input]++)
+            ;
+        for (column[input] = 0; column[input] < num_attr[input] && strcmp(header[column[input]].att_name, atts[input]) != 0; column[input]++)
+            ;
+        type[input] = column[input] < num_attr[input] ? header[column[input]].type : 0;
+        AK_free(header);
+        if (type[input] != TYPE_INT && type[input] != TYPE_FLOAT && type[input] != TYPE_NUMBER) {
+            printf("AK_theta_join_band: ERROR. Attribute %s of table %s does not exist or is not numeric.\n", atts[input], tables[input]);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        memset(&key[input], 0, sizeof (AK_sort_key));
+        strncpy(key[input].att_name, atts[input], MAX_ATT_NAME - 1);
+        key[input].order = SORT_ASC;
+    }
+    if (AK_create_theta_join_header(srcTable1, srcTable2, dstTable) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //a table declared ordered is used as it is; if it is not ordered after all, the join is repeated on sorted tables
+    for (attempt = 0; attempt < 2 && result == BAND_UNORDERED; attempt++) {
+        for (input = 0; input < 2; input++) {
+            inputs[input] = tables[input];
+            if (attempt == 0 && AK_sort_is_ordered(tables[input], &key[input], 1))
+                continue;
+            snprintf(sorted[input], MAX_ATT_NAME, "BAND_JOIN_%d_%s", input, tables[input]);
+            if (AK_sort_table(tables[input], sorted[input], &key[input], 1) != EXIT_ERROR)
+                inputs[input] = sorted[input];
+        }
+
+        AK_bulk_begin(&loader, dstTable);
+        result = AK_theta_join_band_rows(inputs, column, type, num_attr, band, &loader);
+        AK_bulk_end(&loader);
+
+        for (input = 0; input < 2; input++) {
+            if (inputs[input] != tables[input]) {
+                AK_delete_segment(sorted[input], SEGMENT_TYPE_TABLE);
+                AK_sort_set_order(sorted[input], NULL, 0);
+            }
+        }
+        if (result == BAND_UNORDERED) {
+            Ak_dbg_messg(LOW, REL_OP, "AK_theta_join_band: tables %s and %s are not ordered by band attributes, they are sorted\n", srcTable1, srcTable2);
+            AK_delete_segment(dstTable, SEGMENT_TYPE_TABLE);
+            AK_create_theta_join_header(srcTable1, srcTable2, dstTable);
+        }
+    }
+    Ak_dbg_messg(LOW, REL_OP, "AK_theta_join_band: %d rows of %s and %s joined into %s\n", result, srcTable1, srcTable2, dstTable);
+    AK_EPI;
+    return result;
+}
+
 /**
  * @author Tomislav Mikulček
  * @brief Function for testing the theta join
@@ -347,19 +611,68 @@ void AK_op_theta_join_test() {
     AK_theta_join("employee", "department", "theta_join_test3", constraints);
     AK_print_table("theta_join_test3");
     Ak_DeleteAll_L3(&constraints);
-    char num = 102;
+    int num = 37895;
     printf("SELECT * FROM student, professor2 WHERE year + id_prof > 37895;\n");
     Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), constraints);
     Ak_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof", sizeof ("id_prof"), constraints);
     Ak_InsertAtEnd_L3(TYPE_OPERATOR, "+", sizeof ("+"), constraints);
-    Ak_InsertAtEnd_L3(TYPE_INT, &num, sizeof (int), constraints);
+    Ak_InsertAtEnd_L3(TYPE_INT, (char *) &num, sizeof (int), constraints);
     Ak_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), constraints);
 
     AK_theta_join("student", "professor2", "theta_join_test4", constraints);
     AK_print_table("theta_join_test4");
-    printf("Test is successful :) \n");
     Ak_DeleteAll_L3(&constraints);
 
+    //band join of an unordered table with a table declared ordered, checked against counts of a nested loop
+    printf("SELECT * FROM band_a, band_b WHERE x BETWEEN y - 5 AND y + 5;\n");
+    AK_header header[3], *temp;
+    AK_bulk_loader loader;
+    AK_sort_key key;
+    AK_iterator *scan;
+    char *names[2][2] = {{"a_id", "x"}, {"b_id", "y"}}, *tables[2] = {"band_a", "band_b"}, *data[2];
+    int value[2][600], type[2] = {TYPE_INT, TYPE_INT}, size[2] = {sizeof (int), sizeof (int)}, rows[2] = {600, 60};
+    int i, j, input, id, x, y, joined, expected = 0, correct = 1;
+
+    for (input = 0; input < 2; input++) {
+        for (i = 0; i < 2; i++) {
+            temp = (AK_header *) AK_create_header(names[input][i], TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+            memcpy(&header[i], temp, sizeof (AK_header));
+            AK_free(temp);
+        }
+        memset(&header[2], 0, sizeof (AK_header));
+        AK_initialize_new_segment(tables[input], SEGMENT_TYPE_TABLE, header);
+        AK_bulk_begin(&loader, tables[input]);
+        for (id = 0; id < rows[input]; id++) {
+            value[input][id] = input == 0 ? (id * 37) % 600 : id * 10;
+            data[0] = (char *) &id;
+            data[1] = (char *) &value[input][id];
+            AK_bulk_add_row(&loader, type, data, size, rows[input] - id);
+        }
+        AK_bulk_end(&loader);
+    }
+    memset(&key, 0, sizeof (AK_sort_key));
+    strcpy(key.att_name, "y");
+    key.order = SORT_ASC;
+    AK_sort_set_order("band_b", &key, 1);
+    for (i = 0; i < rows[0]; i++) {
+        for (j = 0; j < rows[1]; j++)
+            expected += value[0][i] >= value[1][j] - 5 && value[0][i] <= value[1][j] + 5;
+    }
+
+    joined = AK_theta_join_band("band_a", "band_b", "band_join_test", "x", "y", 5);
+    scan = AK_iterator_scan("band_join_test", NULL);
+    AK_iterator_open(scan);
+    for (i = 0; AK_iterator_next(scan) == ITERATOR_ROW; i++) {
+        memcpy(&x, scan->value[1].data, sizeof (int));
+        memcpy(&y, scan->value[3].data, sizeof (int));
+        correct &= x >= y - 5 && x <= y + 5;
+    }
+    AK_iterator_free(scan);
+    correct &= joined == expected && i == expected;
+    printf("band join: %d rows, nested loop: %d rows, correct: %d\n", joined, expected, correct);
+
+    printf(correct ? "Test is successful :) \n" : "Test FAILED\n");
+
     AK_free(constraints);
     AK_EPI;
 }
@@ -21,17 +21,28 @@
 #ifndef THETA_JOIN
 #define THETA_JOIN
 
+#include <float.h>
 #include "expression_check.h"
+#include "iterator.h"
 #include "../file/fileio.h"
+#include "../file/filesort.h"
+#include "../file/bulkload.h"
 #include "../auxi/mempro.h"
 
+/**
+  * @def BAND_UNORDERED
+  * @brief Constant returned by a band join whose input is not ordered by its band attribute
+  */
+#define BAND_UNORDERED -2
+
 //int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, AK_list *constraints);
 int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *constraints);
 int AK_create_theta_join_header(char *srcTable1, char * srcTable2, char *new_table);/*
 void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, AK_list *constraints, char *new_table);
 int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, AK_list *constraints);*/
-void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, char *new_table);
+void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, AK_predicate *predicate, char *new_table);
 int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node *constraints);
+int AK_theta_join_band(char *srcTable1, char *srcTable2, char *dstTable, char *att1, char *att2, double band);
 void AK_op_theta_join_test();
 
 #endif /* THETA_JOIN */
@@ -23,8 +23,10 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "set_op.h"
 
 int AK_union(char *srcTable1, char *srcTable2, char *dstTable);
+int AK_union_all(char *srcTable1, char *srcTable2, char *dstTable);
 void AK_op_union_test();
 
 #endif
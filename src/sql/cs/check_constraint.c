@@ -16,6 +16,7 @@ int AK_check_constraint(char *srcTable, struct list_node *expr) {
     
     int i, j, k, l, type, size, address;
     char data[MAX_VARCHAR_LENGTH];
+    AK_predicate *predicate = AK_predicate_compile(expr, t_header, num_attr, num_attr);
 
     for (i = 0; src_addr->address_from[i] != 0; i++) {
 
@@ -29,6 +30,20 @@ int AK_check_constraint(char *srcTable, struct list_node *expr) {
 
                 if (temp->block->tuple_dict[k].type == FREE_INT)
                     break;
+                if (temp->block->tuple_dict[k].type == 0)
+                    continue;
+
+                if (predicate != NULL) {
+                    if (!AK_predicate_eval(predicate, temp->block, k)) {
+                        AK_predicate_free(predicate);
+                        AK_free(src_addr);
+                        AK_free(t_header);
+                        AK_free(row_root);
+                        AK_EPI;
+                        return 0;
+                    }
+                    continue;
+                }
 
 				for (l = 0; l < num_attr; l++) {
 					type = temp->block->tuple_dict[k + l].type;
@@ -50,6 +65,7 @@ int AK_check_constraint(char *srcTable, struct list_node *expr) {
         }
     }
 
+    AK_predicate_free(predicate);
     AK_free(src_addr);
     AK_free(t_header);
     AK_free(row_root);
@@ -96,35 +96,34 @@ AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
 
 /**
  * @author Dejan Frankovic
- * @brief Function checks referential integrity for one attribute
+ * @brief Function checks referential integrity for one attribute. The parent table is searched for the value with a
+ *        search limited to one tuple, so its scan ends at the first parent row that holds the value.
  * @param child table name
  * @param attribute name (foreign key attribute)
  * @param value of the attribute we're checking
  * @return EXIT ERROR if check failed, EXIT_SUCCESS if referential integrity is ok
  */
 int AK_reference_check_attribute(char *tableName, char *attribute, char *value) {
-    int i;
-    int att_index;
+    int i = 0, found = 1;
 //    AK_list *list_row, *list_col;
-    struct list_node *list_row, *list_col;
+    struct list_node *list_row;
+    search_params params;
     AK_PRO;
-    while ((list_row = AK_get_row(i, "AK_reference")) != NULL) {
+    while (found && (list_row = AK_get_row(i, "AK_reference")) != NULL) {
         if (strcmp(list_row->next->data, tableName) == 0 &&
                 strcmp(list_row->next->next->next->data, attribute) == 0) {
-            att_index = AK_get_attr_index(list_row->next->next->next->next->data, list_row->next->next->next->next->next->data);
-            list_col = AK_get_column(att_index, list_row->next->next->next->next->data);
-            while (strcmp(list_col->data, value) != 0) {
-                list_col = list_col->next;
-                if (list_col == NULL){
-		    AK_EPI;
-                    return EXIT_ERROR;
-		}
-            }
+            params.szAttribute = list_row->next->next->next->next->next->data;
+            params.pData_lower = value;
+            params.pData_upper = NULL;
+            params.iSearchType = SEARCH_PARTICULAR;
+            found = AK_search_exists(list_row->next->next->next->next->data, &params, 1);
         }
+        Ak_DeleteAll_L3(&list_row);
+        AK_free(list_row);
         i++;
     }
     AK_EPI;
-    return EXIT_SUCCESS;
+    return found ? EXIT_SUCCESS : EXIT_ERROR;
 }
 
 /**
@@ -362,16 +361,18 @@ int AK_reference_update(struct list_node *lista, int action) {
 
 /**
  * @author Dejan Franković
- * @brief Function checks new entry for referential integrity.
+ * @brief Function checks new entry for referential integrity. Parent tables are not read row by row, they are
+ *        searched for the referenced values with a search limited to one tuple (see AK_search_exists).
  * @param list of elements for insert row
  * @return EXIT_SUCCESS if referential integrity is ok, EXIT_ERROR if it is compromised
  */
 int AK_reference_check_entry(struct list_node *lista) {
     
-    struct list_node *temp, *row, *temp1;
+    struct list_node *temp, *row;
     int i = 0, j, k, con_num = 0, success;
     char constraints[10][MAX_VARCHAR_LENGTH]; // this 10 should probably be a constant... how many foreign keys can one table have..
-    char attributes[MAX_REFERENCE_ATTRIBUTES][MAX_ATT_NAME];
+    char *attributes[MAX_REFERENCE_ATTRIBUTES];
+    search_params params[MAX_REFERENCE_ATTRIBUTES];
     int is_att_null[MAX_REFERENCE_ATTRIBUTES]; //this is a workaround... when proper null value implementation is in place, this should be solved differently
     
     AK_ref_item reference;
@@ -416,11 +417,13 @@ int AK_reference_check_entry(struct list_node *lista) {
         // fetching relevant attributes from entry list...
         // attributes = AK_malloc(sizeof(char)*MAX_VARCHAR_LENGHT*reference.attributes_number);
         for (j = 0; j < reference.attributes_number; j++) {
+            attributes[j] = NULL;
+            is_att_null[j] = 0;
             temp = lista->next;
             while (temp != NULL) {
 
                 if (temp->constraint == 0 && strcmp(temp->attribute_name, reference.attributes[j]) == 0) {
-                    strcpy(attributes[j], temp->data);
+                    attributes[j] = temp->data;
                     if (reference.type == REF_TYPE_SET_NULL && strcmp(temp->data, "\0") == 0) //if type is 0, the value is PROBABLY null
                         is_att_null[j] = 1;
                     else
@@ -433,31 +436,27 @@ int AK_reference_check_entry(struct list_node *lista) {
         }
 
         if (reference.attributes_number == 1) {
-            if (AK_reference_check_attribute(reference.table, reference.attributes[0], attributes[0]) == EXIT_ERROR) {
+            if (attributes[0] != NULL && AK_reference_check_attribute(reference.table, reference.attributes[0], attributes[0]) == EXIT_ERROR) {
 		AK_EPI;
                 return EXIT_ERROR;
             } else continue;
         }
 
-
-        j = 0;
-        while ((row = AK_get_row(j, reference.parent)) != NULL) { // rows in parent table
-            success = 1;
-            for (k = 0; k < reference.attributes_number; k++) { // attributes in reference
-		temp1 = Ak_GetNth_L2(AK_get_attr_index(reference.parent, reference.parent_attributes[k]), row);
-                if (temp1 != 0x0) {
-                  if (is_att_null[k] || strcmp(temp1->data, attributes[k]) != 0) {
-                      success = 0;
-                      break;
-                  }
-                }
-            }
-            if (success == 1) {
-                //AK_free(attributes);
-		AK_EPI;
-                return EXIT_SUCCESS;
+        // a null value never matches a parent row
+        success = 1;
+        for (k = 0; k < reference.attributes_number; k++) { // attributes in reference
+            if (attributes[k] == NULL || is_att_null[k]) {
+                success = 0;
+                break;
             }
-            j++;
+            params[k].szAttribute = reference.parent_attributes[k];
+            params[k].pData_lower = attributes[k];
+            params[k].pData_upper = NULL;
+            params[k].iSearchType = SEARCH_PARTICULAR;
+        }
+        if (success == 1 && AK_search_exists(reference.parent, params, reference.attributes_number)) {
+            AK_EPI;
+            return EXIT_SUCCESS;
         }
         // AK_free(attributes);
     }
@@ -19,6 +19,118 @@
 
 #include "unique.h"
 
+/**
+ * @struct AK_unique_search
+ * @brief Structure that holds a search for a row whose values (as strings) are equal to checked values, shared by
+ *        all scan workers
+ */
+typedef struct {
+	/// number of attributes of the table
+	int num_attr;
+	/// number of checked attributes
+	int num_columns;
+	/// index of every checked attribute
+	int *columns;
+	/// checked values as strings, in the order of columns
+	char (*values)[MAX_VARCHAR_LENGTH];
+} AK_unique_search;
+
+/**
+ * @brief Function converts a value of a block to a string the same way AK_tuple_to_string converts a value of a row
+ * @param block block of the value
+ * @param entry tuple_dict entry of the value
+ * @param buffer buffer of MAX_VARCHAR_LENGTH bytes for the string
+ * @return 1 if value is converted, 0 if its type has no string form
+ */
+static int AK_unique_value_string(AK_block *block, AK_tuple_dict *entry, char *buffer) {
+	int temp_int, size;
+	float temp_float;
+
+	switch (entry->type) {
+		case TYPE_INT:
+			memcpy(&temp_int, block->data + entry->address, sizeof (int));
+			sprintf(buffer, "%d", temp_int);
+			return 1;
+		case TYPE_FLOAT:
+			memcpy(&temp_float, block->data + entry->address, sizeof (float));
+			sprintf(buffer, "%f", temp_float);
+			return 1;
+		case TYPE_VARCHAR:
+			size = entry->size < MAX_VARCHAR_LENGTH ? entry->size : MAX_VARCHAR_LENGTH - 1;
+			memcpy(buffer, block->data + entry->address, size);
+			buffer[size] = '\0';
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Function looks for a row of a block whose checked values are equal to the searched ones, called by scan
+ *        workers
+ * @param block block read by the worker
+ * @param context search (AK_unique_search)
+ * @param result 1 if the worker found such row (int)
+ * @return EXIT_SUCCESS, SCAN_SATISFIED when a row is found
+ */
+static int AK_unique_block(AK_block *block, void *context, void *result) {
+	AK_unique_search *search = (AK_unique_search *) context;
+	char buffer[MAX_VARCHAR_LENGTH];
+	int k, i, match;
+
+	for (k = 0; k + search->num_attr <= DATA_BLOCK_SIZE; k += search->num_attr) {
+		if (block->tuple_dict[k].type == FREE_INT)
+			break;
+		if (block->tuple_dict[k].type == 0)
+			continue;
+		match = 1;
+		for (i = 0; i < search->num_columns && match; i++)
+			match = AK_unique_value_string(block, &block->tuple_dict[k + search->columns[i]], buffer)
+				&& strcmp(search->values[i], buffer) == 0;
+		if (match) {
+			*((int *) result) = 1;
+			return SCAN_SATISFIED;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function checks whether a table already has a row with given values of given attributes. Blocks are scanned
+ *        only until the first such row is found, instead of fetching every row with AK_get_row.
+ * @param tableName name of table
+ * @param columns indexes of checked attributes
+ * @param values values of checked attributes as strings (see AK_tuple_to_string)
+ * @param num_columns number of checked attributes
+ * @return 1 if such row exists, 0 otherwise
+ */
+static int AK_unique_exists(char *tableName, int *columns, char values[][MAX_VARCHAR_LENGTH], int num_columns) {
+	AK_PRO;
+	AK_unique_search search;
+	int found[SCAN_MAX_WORKERS];
+	int num_workers, exists = 0, i;
+	table_addresses *addresses = (table_addresses *) AK_get_table_addresses(tableName);
+
+	search.num_attr = AK_num_attr(tableName);
+	search.num_columns = num_columns;
+	search.columns = columns;
+	search.values = values;
+	for (i = 0; i < num_columns; i++) {
+		if (columns[i] < 0 || columns[i] >= search.num_attr) {
+			AK_free(addresses);
+			AK_EPI;
+			return 0;
+		}
+	}
+
+	memset(found, 0, sizeof (found));
+	num_workers = AK_scan_parallel(addresses, NULL, NULL, AK_unique_block, &search, found, sizeof (int));
+	for (i = 0; i < num_workers; i++)
+		exists |= found[i];
+	AK_free(addresses);
+	AK_EPI;
+	return exists;
+}
+
 /**
  * @author Domagoj Tuličić, updated by Nenad Makar 
  * @brief Function sets unique constraint on attribute(s)
@@ -234,23 +346,19 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 					char attNameCopy[MAX_VARCHAR_LENGTH];
 					char *nameOfOneAtt;
 					char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
-					struct list_node *attribute2;
 					
 					strcpy(attNameCopy, attName);
 
 					nameOfOneAtt = strtok(attNameCopy, SEPARATOR);
 					while(nameOfOneAtt != NULL)
 					{
-						positionsOfAtts[numOfImpAttPos] = AK_get_attr_index(table->data, nameOfOneAtt) + 1;
+						positionsOfAtts[numOfImpAttPos] = AK_get_attr_index(table->data, nameOfOneAtt);
 						strcpy(namesOfAtts[numOfImpAttPos], nameOfOneAtt);
 						numOfImpAttPos++;
 
 						nameOfOneAtt = strtok(NULL, SEPARATOR);
 					}
 					
-					int h;
-					int impoIndexInArray;
-					int match;
 					int index = 0;
 					char *value2;
 					char newValueCopy2[MAX_VARCHAR_LENGTH];
@@ -267,31 +375,11 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 					}
 
 					
-					for(h=0; h<numRows; h++)
+					//scan stops at the first row with the same values
+					if(AK_unique_exists(table->data, positionsOfAtts, values, numOfImpAttPos))
 					{
-						row2 = AK_get_row(h, table->data);
-
-						match = 1;
-						
-						for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
-						{
-							attribute2 = Ak_GetNth_L2(positionsOfAtts[impoIndexInArray], row2);
-							if(AK_tuple_to_string(attribute2) == NULL)
-							{
-								match = 0;
-							}
-							else if(strcmp(values[impoIndexInArray], AK_tuple_to_string(attribute2)) != 0)
-							{
-								match = 0 ;
-							}
-
-						}
-						
-						if(match == 1)
-						{
-							return EXIT_ERROR;
-							AK_EPI;
-						}
+						AK_EPI;
+						return EXIT_ERROR;
 					}
 					
 					return EXIT_SUCCESS;
@@ -312,23 +400,19 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 		char attNameCopy[MAX_VARCHAR_LENGTH];
 		char *nameOfOneAtt;
 		char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
-		struct list_node *attribute2;
 		
 		strcpy(attNameCopy, attName);
 
 		nameOfOneAtt = strtok(attNameCopy, SEPARATOR);
 		while(nameOfOneAtt != NULL)
 		{
-			positionsOfAtts[numOfImpAttPos] = AK_get_attr_index(tableName, nameOfOneAtt) + 1;
+			positionsOfAtts[numOfImpAttPos] = AK_get_attr_index(tableName, nameOfOneAtt);
 			strcpy(namesOfAtts[numOfImpAttPos], nameOfOneAtt);
 			numOfImpAttPos++;
 
 			nameOfOneAtt = strtok(NULL, SEPARATOR);
 		}
 		
-		int h;
-		int impoIndexInArray;
-		int match;
 		int index = 0;
 		char *value2;
 		char newValueCopy2[MAX_VARCHAR_LENGTH];
@@ -342,33 +426,11 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 		value2 = strtok(NULL, "");
 		strcpy(values[index], value2+strlen(SEPARATOR)-1);
 
-		int numRows = AK_get_num_records(tableName);
-
-		for(h=0; h<numRows; h++)
+		//scan stops at the first row with the same values
+		if(AK_unique_exists(tableName, positionsOfAtts, values, numOfImpAttPos))
 		{
-			row = AK_get_row(h, tableName);
-
-			match = 1;
-			
-			for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
-			{
-				attribute2 = Ak_GetNth_L2(positionsOfAtts[impoIndexInArray], row);
-				if(AK_tuple_to_string(attribute2) == NULL)
-				{
-					match = 0;
-				}
-				else if(strcmp(values[impoIndexInArray], AK_tuple_to_string(attribute2)) != 0)
-				{
-					match = 0 ;
-				}
-
-			}
-			
-			if(match == 1)
-			{
-				return EXIT_ERROR;
-				AK_EPI;
-			}
+			AK_EPI;
+			return EXIT_ERROR;
 		}
 		
 		return EXIT_SUCCESS;
@@ -22,6 +22,7 @@
 
 #include "../../file/table.h"
 #include "../../file/fileio.h"
+#include "../../file/scan.h"
 #include "../../auxi/mempro.h"
 #include "constraint_names.h"
 
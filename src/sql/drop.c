@@ -326,6 +326,8 @@ void AK_drop_help_function(char *tblName, char *sys_table) {
             }
         } else break;
     }
+    AK_table_modified(tblName);
+    AK_zone_map_drop(tblName);
 
     int data_adr = 0;
     int data_size = 0;
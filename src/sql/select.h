@@ -1,6 +1,7 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../rel/selection.h"
+#include "../rel/iterator.h"
 #include "../auxi/auxiliary.h"
 #include "../auxi/mempro.h"
 //int AK_select(char *srcTable,char *destTable,AK_list *atributi,AK_list *uvjet);
@@ -19,11 +19,17 @@
 #include "../auxi/observable.c"
 #include "../auxi/iniparser.c"
 #include "../auxi/auxiliary.c"
+#include "../file/tuple.c"
+#include "../file/filter.c"
+#include "../file/zonemap.c"
+#include "../file/scan.c"
 #include "../file/filesearch.c"
 #include "../file/files.c"
 #include "../file/table.c"
 #include "../file/id.c"
 #include "../file/fileio.c"
+#include "../file/bulkload.c"
+#include "../file/vacuum.c"
 #include "../file/filesort.c"
 #include "../file/idx/index.c"
 #include "../file/idx/btree.c"
@@ -51,6 +57,9 @@
 #include "../rel/expression_check.c"
 #include "../rel/nat_join.c"
 #include "../rel/theta_join.c"
+#include "../rel/iterator.c"
+#include "../rel/batch.c"
+#include "../rel/set_op.c"
 #include "../rel/selection.c"
 #include "../rel/difference.c"
 #include "../rel/sequence.c"
@@ -285,10 +285,22 @@ extern void Ak_Insert_NewelementAd(int addBlock, int indexTd, char *attName, ele
 
 %include "../file/filesort.c"
 %include "../file/filesort.h"
+%include "../file/tuple.c"
+%include "../file/tuple.h"
+%include "../file/filter.c"
+%include "../file/filter.h"
+%include "../file/zonemap.c"
+%include "../file/zonemap.h"
+%include "../file/scan.c"
+%include "../file/scan.h"
 %include "../file/filesearch.c"
 %include "../file/filesearch.h"
 %include "../file/fileio.c"
 %include "../file/fileio.h"
+%include "../file/bulkload.c"
+%include "../file/bulkload.h"
+%include "../file/vacuum.c"
+%include "../file/vacuum.h"
 %include "../file/files.c"
 %include "../file/files.h"
 
@@ -312,6 +324,8 @@ extern void Ak_Insert_NewelementAd(int addBlock, int indexTd, char *attName, ele
 
 %include "../rel/nat_join.c"
 %include "../rel/nat_join.h"
+%include "../rel/set_op.c"
+%include "../rel/set_op.h"
 %include "../rel/intersect.c"
 %include "../rel/intersect.h"
 %include "../rel/difference.c"
@@ -345,6 +359,10 @@ extern struct list_node *AK_rel_eq_get_attributes(char *tblName);
 
 %include "../rel/expression_check.c"
 %include "../rel/expression_check.h"
+%include "../rel/iterator.c"
+%include "../rel/iterator.h"
+%include "../rel/batch.c"
+%include "../rel/batch.h"
 %include "../file/id.c"
 %include "../file/id.h"
 %include "../sql/cs/nnull.c"